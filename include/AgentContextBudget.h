@@ -0,0 +1,70 @@
+/*
+ * AgentContextBudget.h - keeps agent requests within a token budget
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef LMMS_AGENT_CONTEXT_BUDGET_H
+#define LMMS_AGENT_CONTEXT_BUDGET_H
+
+#include <QJsonArray>
+#include <QString>
+#include <vector>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+struct ChatMessage
+{
+	QString role; // "user", "assistant", "system", "tool"
+	QString content;
+	QString toolCallId; // for tool responses
+	QString name; // tool name for tool responses
+	QJsonArray toolCalls; // for assistant messages with tool calls
+};
+
+/**
+	Builds the messages of an agent request so they fit a token budget.
+
+	The current turn, from the latest user message on, is sent as is apart
+	from very large tool results, which are cut down. Tool results of earlier
+	turns are replaced by one line summaries, and if that is not enough the
+	oldest turns are dropped as a whole, so tool calls and their results
+	always stay together.
+*/
+class LMMS_EXPORT AgentContextBudget
+{
+public:
+	//! Tool results longer than this are truncated even in the current turn
+	static constexpr int MaxToolResultChars = 4000;
+
+	explicit AgentContextBudget(int maxTokens);
+
+	// rough estimate, about four bytes of utf-8 per token
+	static int estimateTokens(const QString& text);
+
+	//! @param reservedTokens tokens needed besides the messages, e.g. for tool schemas
+	QJsonArray buildMessages(const QString& systemPrompt, const std::vector<ChatMessage>& history,
+		int reservedTokens) const;
+
+	//! Shortens the arrays in a json tool result until it fits @p maxChars,
+	//! noting how many elements were left out
+	static QString truncateToolResult(const QString& result, int maxChars);
+
+	//! One line description of a tool result
+	static QString summarizeToolResult(const QString& toolName, const QString& result);
+
+private:
+	int m_maxTokens;
+};
+
+} // namespace lmms
+
+#endif // LMMS_AGENT_CONTEXT_BUDGET_H
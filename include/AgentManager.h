@@ -16,28 +16,22 @@
 #include <QString>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <functional>
+#include <map>
 #include <vector>
 #include <memory>
 
 #include "lmms_export.h"
+#include "AgentContextBudget.h"
+#include "AgentTools.h"
+#include "SseParser.h"
 
 namespace lmms
 {
 
-class AgentTools;
-
-struct ChatMessage
-{
-	QString role; // "user", "assistant", "system", "tool"
-	QString content;
-	QString toolCallId; // for tool responses
-	QString name; // tool name for tool responses
-	QJsonArray toolCalls; // for assistant messages with tool calls
-};
-
 struct ToolCall
 {
 	QString id;
@@ -66,6 +60,27 @@ public:
 	
 	const std::vector<ChatMessage>& history() const { return m_conversationHistory; }
 
+	struct ToolLatency
+	{
+		int calls = 0;
+		qint64 totalUs = 0;
+		qint64 maxUs = 0;
+	};
+
+	// how long each tool took to execute over the session, also logged after each call
+	const std::map<QString, ToolLatency>& toolLatencies() const { return m_toolLatencies; }
+
+	struct RequestStats
+	{
+		int payloadBytes = 0;
+		int estimatedTokens = 0;
+		int toolCount = 0;
+		qint64 timeToFirstTokenMs = -1; // -1 until the first delta arrived
+	};
+
+	// one entry per api request of the session, also logged when the response is complete
+	const std::vector<RequestStats>& requestStats() const { return m_requestStats; }
+
 signals:
 	void responseReceived(const QString& response);
 	void streamingChunkReceived(const QString& chunk);
@@ -93,11 +108,22 @@ private:
 	void sendApiRequest();
 	void processApiResponse(const QJsonObject& response);
 	void processStreamingChunk(const QJsonObject& chunk);
+	void resetStreamingState();
+	QJsonArray accumulatedToolCalls() const;
+	struct ToolRun
+	{
+		ToolResult result;
+		qint64 elapsedUs;
+	};
+
 	void handleToolCalls(const QJsonArray& toolCalls);
-	void executeToolCall(const ToolCall& toolCall);
+	// executes m_pendingToolCalls[begin, end), which all have the given access
+	void executeToolCalls(size_t begin, size_t end, ToolAccess access);
+	ToolRun runTool(const ToolCall& toolCall);
 	
 	QJsonObject buildRequestPayload() const;
-	QJsonArray buildToolsArray() const;
+	// names of the tools called since the latest user message
+	QStringList toolsOfCurrentTurn() const;
 	
 	// get the system prompt
 	QString systemPrompt() const;
@@ -105,6 +131,7 @@ private:
 	QNetworkAccessManager* m_networkManager;
 	
 	// config
+	QString m_apiUrl;
 	QString m_apiKey;
 	QString m_model;
 	
@@ -117,14 +144,25 @@ private:
 	
 	// pending tool calls
 	std::vector<ToolCall> m_pendingToolCalls;
-	size_t m_currentToolCallIndex;
+	std::map<QString, ToolLatency> m_toolLatencies;
+	std::vector<RequestStats> m_requestStats;
+	QElapsedTimer m_requestTimer;
 	
+	// tool call whose arguments are still being streamed
+	struct ToolCallBuilder
+	{
+		QString id;
+		QString name;
+		QString arguments;
+	};
+
 	// streaming state
 	QNetworkReply* m_currentReply;
-	QString m_streamBuffer;
+	SseParser m_sseParser;
+	QByteArray m_eventData;
 	QString m_accumulatedContent;
 	QString m_accumulatedThinking;
-	QJsonArray m_accumulatedToolCalls;
+	std::vector<ToolCallBuilder> m_toolCallBuilders;
 	bool m_isStreaming;
 	
 	static AgentManager* s_instance;
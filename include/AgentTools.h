@@ -16,6 +16,7 @@
 #include <QString>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QStringList>
 #include <functional>
 #include <map>
 
@@ -24,11 +25,25 @@
 namespace lmms
 {
 
+//! What a tool call touches, which decides the locking around it
+enum class ToolAccess
+{
+	//! Only reads the project, runs concurrently with the read-only calls next to it
+	ReadOnly,
+	//! Edits the project, all edits of a turn share one engine lock and are
+	//! undone in one step
+	Mutating,
+	//! Runs on its own and isn't known to only read, e.g. transport
+	//! control, or a tool that doesn't exist
+	Standalone
+};
+
 struct ToolDefinition
 {
 	QString name;
 	QString description;
 	QJsonObject parameters;
+	ToolAccess access;
 };
 
 struct ToolResult
@@ -48,19 +63,25 @@ public:
 	AgentTools(QObject* parent = nullptr);
 	~AgentTools() override;
 	
-	// getting all tool defs for api ques
-	// todo get only the relevant tools for the ques
-	QJsonArray getToolDefinitions() const;
+	// tool defs for api ques, the core tools plus the ones relevant to @p request and @p alsoInclude,
+	// all of them if the request is empty or doesn't mention anything the tools deal with.
+	// the model can get the others with request_tools
+	QJsonArray getToolDefinitions(const QString& request = QString(),
+								  const QStringList& alsoInclude = QStringList()) const;
 	
 	
+	// read-only tools may be executed from any thread while the gui thread waits for them,
+	// everything else only on the gui thread
 	ToolResult executeTool(const QString& name, const QJsonObject& args);
 	bool hasTool(const QString& name) const;
+	ToolAccess toolAccess(const QString& name) const;
 
 private:
 	void registerTool(const QString& name, 
 					  const QString& description,
 					  const QJsonObject& parameters,
-					  ToolFunction function);
+					  ToolFunction function,
+					  ToolAccess access = ToolAccess::Mutating);
 	
 	// init all tools
 	void initializeTools();
@@ -80,6 +101,7 @@ private:
 	// SAMPLE TOOLS
 	ToolResult listSamples(const QJsonObject& args);
 	ToolResult getSampleCategories(const QJsonObject& args);
+	ToolResult requestTools(const QJsonObject& args);
 	
 	// NOTE/PATTERN TOOLS
 	ToolResult addNotesToTrack(const QJsonObject& args);
@@ -26,10 +26,12 @@
 #ifndef LMMS_AUDIO_BUS_HANDLE_H
 #define LMMS_AUDIO_BUS_HANDLE_H
 
+#include <atomic>
 #include <memory>
 #include <QString>
 #include <QMutex>
 
+#include "LatencyCompensator.h"
 #include "PlayHandle.h"
 
 namespace lmms
@@ -47,8 +49,9 @@ class BoolModel;
 	It contains an optional @ref EffectChain which is e.g. visualized in the
 	@ref InstrumentTrackWindow or @ref SampleTrackWindow.
 	For processing, it adds all input play handles into an internal buffer,
-	processes the @ref EffectChain (if existing) on that buffer
-	and finally merges the buffer into its @ref MixerChannel.
+	processes the @ref EffectChain (if existing) on that buffer,
+	delays it to line up with the slowest track of its @ref MixerChannel
+	and finally merges the buffer into that channel.
 */
 class AudioBusHandle : public ThreadableJob
 {
@@ -75,6 +78,15 @@ public:
 	EffectChain* effects() { return m_effects.get(); }
 	bool processEffects();
 
+	//! Latency of the play handles' output, e.g. of the instrument, which may be set from any thread
+	void setSourceLatency(f_cnt_t frames) { m_sourceLatency.store(frames, std::memory_order_relaxed); }
+	//! Frames by which the output lags behind, the source's latency plus the effects'
+	f_cnt_t latency() const;
+
+	//! Delays the output by @p frames more, set by the @ref Mixer. False if the delay doesn't fit yet.
+	bool setCompensation(f_cnt_t frames) { return m_compensator.setDelay(frames); }
+	LatencyCompensator* compensator() { return &m_compensator; }
+
 	// ThreadableJob stuff
 	void doProcessing() override;
 	bool requiresProcessing() const override { return true; }
@@ -94,6 +106,9 @@ private:
 
 	std::unique_ptr<EffectChain> m_effects;
 
+	std::atomic<f_cnt_t> m_sourceLatency = 0;
+	LatencyCompensator m_compensator;
+
 	PlayHandleList m_playHandles;
 	QMutex m_playHandleLock;
 
@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "AudioDevice.h"
+#include "AudioTap.h"
 #include "LmmsTypes.h"
 #include "SampleFrame.h"
 #include "LocklessList.h"
@@ -145,6 +146,11 @@ public:
 
 	void removeAudioBusHandle(AudioBusHandle* busHandle);
 
+	const std::vector<AudioBusHandle*>& audioBusHandles() const
+	{
+		return m_audioBusHandles;
+	}
+
 
 	// MIDI-client-stuff
 	inline const QString & midiClientName() const
@@ -218,6 +224,12 @@ public:
 		m_masterGain = mo;
 	}
 
+	//! The final output, after the master gain
+	const AudioTap& outputTap() const
+	{
+		return m_outputTap;
+	}
+
 
 	static inline sample_t clip(const sample_t s)
 	{
@@ -273,7 +285,6 @@ public:
 signals:
 	void qualitySettingsChanged();
 	void sampleRateChanged();
-	void nextAudioBuffer(const lmms::SampleFrame* buffer);
 
 
 private:
@@ -334,6 +345,7 @@ private:
 
 	std::unique_ptr<SampleFrame[]> m_outputBufferRead;
 	std::unique_ptr<SampleFrame[]> m_outputBufferWrite;
+	AudioTap m_outputTap;
 
 	// worker thread stuff
 	std::vector<AudioEngineWorkerThread *> m_workers;
@@ -27,6 +27,7 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <QFile>
 
 #include "LmmsTypes.h"
@@ -70,6 +71,19 @@ public:
 		return m_detailLoad[static_cast<std::size_t>(type)].load(std::memory_order_relaxed);
 	}
 
+	//! Processing times summed up since the last resetTotals(), in microseconds
+	struct Totals
+	{
+		std::uint64_t periods = 0;
+		std::uint64_t frames = 0;
+		std::uint64_t periodTime = 0;
+		std::array<std::uint64_t, DetailCount> detailTime{};
+	};
+
+	//! Not synchronized, only read them while the engine isn't processing, e.g. after a render
+	const Totals& totals() const { return m_totals; }
+	void resetTotals() { m_totals = Totals{}; }
+
 	class Probe
 	{
 	public:
@@ -104,6 +118,8 @@ private:
 	std::array<MicroTimer, DetailCount> m_detailTimer;
 	std::array<int, DetailCount> m_detailTime{0};
 	std::array<std::atomic<float>, DetailCount> m_detailLoad{0};
+
+	Totals m_totals;
 };
 
 } // namespace lmms
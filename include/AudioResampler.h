@@ -25,6 +25,7 @@
 #ifndef LMMS_AUDIO_RESAMPLER_H
 #define LMMS_AUDIO_RESAMPLER_H
 
+#include <cstddef>
 #include <memory>
 #include "AudioBufferView.h"
 #include "lmms_export.h"
@@ -36,6 +37,8 @@ namespace lmms {
  * @brief A utility class for resampling interleaved audio buffers using various resampling algorithms.
  *
  * This class provides support for zero-order hold, linear, and several levels of sinc-based resampling.
+ * Mono and stereo resampler states are recycled through a lock-free pool, so that resamplers can be
+ * created and destroyed on the audio thread without allocating once the pool is warm.
  */
 class LMMS_EXPORT AudioResampler
 {
@@ -114,8 +117,19 @@ public:
 	//! @returns the interpolation mode used by this resampler.
 	auto mode() const -> Mode { return m_mode; }
 
+	/**
+	 * @brief Adds up to `count` new states to the pool for `mode` and `channels`.
+	 * Call this outside of the audio thread to avoid allocations when the first resamplers are created.
+	 */
+	static void reserveStates(Mode mode, ch_cnt_t channels, std::size_t count);
+
 private:
-	struct LMMS_EXPORT StateDeleter { void operator()(void* state); };
+	struct LMMS_EXPORT StateDeleter
+	{
+		Mode mode;
+		ch_cnt_t channels;
+		void operator()(void* state);
+	};
 	std::unique_ptr<void, StateDeleter> m_state;
 	Mode m_mode;
 	ch_cnt_t m_channels = 0;
@@ -0,0 +1,138 @@
+/*
+ * AudioTap.h - lock-free metering and scope data for GUI consumers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_AUDIO_TAP_H
+#define LMMS_AUDIO_TAP_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "LocklessRingBuffer.h"
+#include "SampleFrame.h"
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+/**
+	A point in the signal flow that GUI widgets can watch, e.g. a mixer
+	channel or the master output.
+
+	The audio thread calls process() once per period. If somebody subscribed,
+	the peak and RMS levels of the period and, for scope subscribers, the
+	audio itself are written into lock-free ring buffers, which the
+	subscribers drain at their own frame rate. Without subscribers process()
+	returns right away, so taps nobody looks at cost nothing.
+*/
+class LMMS_EXPORT AudioTap
+{
+	struct State;
+
+public:
+	//! Linear levels of one period, or of everything since the last read
+	struct Levels
+	{
+		float peakLeft = 0.f;
+		float peakRight = 0.f;
+		float rmsLeft = 0.f;
+		float rmsRight = 0.f;
+	};
+
+	//! Periods of levels that are kept for slow readers
+	static constexpr std::size_t LevelsCapacity = 64;
+	//! Frames of scope data that are kept for slow readers
+	static constexpr std::size_t DefaultScopeFrames = 16384;
+
+	explicit AudioTap(std::size_t scopeFrames = DefaultScopeFrames);
+
+	AudioTap(const AudioTap&) = delete;
+	AudioTap& operator=(const AudioTap&) = delete;
+
+	/**
+		Publishes one period, called from the audio thread only.
+
+		@param buffer The period, nullptr for silence
+		@param gain Applied to the levels, scope data is passed on unscaled
+	*/
+	void process(const SampleFrame* buffer, fpp_t frames, float gain = 1.f);
+
+	//! True if any subscriber wants data from this tap
+	bool watched() const;
+
+	//! Most frames a scope subscriber can read at once
+	std::size_t scopeFrames() const { return m_state->scopeFrames; }
+
+	/**
+		A GUI side reader of a tap, unsubscribes when destroyed. It keeps the
+		ring buffers alive, so it may outlive the tap it was created from.
+	*/
+	class LMMS_EXPORT Subscriber
+	{
+	public:
+		//! Reads levels, or the audio itself if @p scope is set
+		explicit Subscriber(const AudioTap& tap, bool scope = false);
+		~Subscriber();
+
+		Subscriber(const Subscriber&) = delete;
+		Subscriber& operator=(const Subscriber&) = delete;
+
+		//! Highest peaks and mean RMS of the periods since the last call, if there were any
+		std::optional<Levels> levels();
+
+		//! Copies the frames written since the last call to @p dest, the newest
+		//! @p maxFrames of them if there are more. Returns the number of frames copied.
+		std::size_t read(SampleFrame* dest, std::size_t maxFrames);
+
+		//! Appends the frames written since the last call to @p window, which always
+		//! holds the latest @p frames frames. Returns the number of new frames.
+		std::size_t updateWindow(SampleFrame* window, std::size_t frames);
+
+	private:
+		std::shared_ptr<State> m_state;
+		bool m_scope;
+		std::optional<LocklessRingBufferReader<Levels>> m_levelsReader;
+		std::optional<LocklessRingBufferReader<SampleFrame>> m_scopeReader;
+	};
+
+private:
+	struct State
+	{
+		explicit State(std::size_t scopeFrames);
+
+		LocklessRingBuffer<Levels> levels;
+		//! Allocated by the first scope subscriber and kept from then on
+		std::unique_ptr<LocklessRingBuffer<SampleFrame>> scope;
+		const std::size_t scopeFrames;
+		std::mutex scopeMutex;
+
+		std::atomic<int> levelSubscribers = 0;
+		std::atomic<int> scopeSubscribers = 0;
+	};
+
+	std::shared_ptr<State> m_state;
+};
+
+} // namespace lmms
+
+#endif // LMMS_AUDIO_TAP_H
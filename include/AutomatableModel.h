@@ -25,6 +25,8 @@
 #ifndef LMMS_AUTOMATABLE_MODEL_H
 #define LMMS_AUTOMATABLE_MODEL_H
 
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <QMap>
 #include <QMutex>
@@ -172,6 +174,10 @@ public:
 	float controllerValue( int frameOffset ) const;
 
 	//! @brief Function that returns sample-exact data as a ValueBuffer
+	//! The buffer is computed at most once per period and published lock-free,
+	//! so concurrent callers share the same data without blocking each other.
+	//! A caller that can't wait for another thread to finish computing it
+	//! gets the previous period's buffer instead.
 	//! @return pointer to model's valueBuffer when s.ex.data exists, NULL otherwise
 	ValueBuffer * valueBuffer();
 
@@ -212,6 +218,10 @@ public:
 	void setInitValue( const float value );
 
 	void setAutomatedValue( const float value );
+	//! @brief Sets sample-exact automation for frames [offset, offset + frames) of this period.
+	//! Like setAutomatedValue(), it takes the values as stored in automation clips.
+	//! valueBuffer() returns them for the rest of the period.
+	void setAutomatedValues(const float* values, f_cnt_t offset, f_cnt_t frames);
 	void setValue( const float value );
 
 	void incValue( int steps )
@@ -306,11 +316,6 @@ public:
 		++s_periodCounter;
 	}
 
-	static void resetPeriodCounter()
-	{
-		s_periodCounter = 0;
-	}
-
 	bool useControllerValue()
 	{
 		return m_useControllerValue;
@@ -378,6 +383,10 @@ private:
 	//! @param value will be modified to rounded value
 	template<class T> void roundAt( T &value, const T &where ) const;
 
+	//! computes this period's sample-exact data into @p target
+	//! @return @p target if there is sample-exact data, nullptr otherwise
+	ValueBuffer* computeValueBuffer(ValueBuffer& target);
+
 
 	ScaleType m_scaleType; //!< scale type, linear by default
 	float m_value;
@@ -405,14 +414,25 @@ private:
 	ControllerConnection* m_controllerConnection;
 
 
-	ValueBuffer m_valueBuffer;
-	long m_lastUpdatedPeriod;
-	static long s_periodCounter;
+	// double buffered, so a buffer handed out in one period is not overwritten
+	// while the next one is being computed
+	std::array<ValueBuffer, 2> m_valueBuffers;
+	std::size_t m_backBuffer;
+
+	// the thread that claims a period computes the buffer, everyone else
+	// spins briefly for it to be published instead of locking a mutex
+	std::atomic<long> m_claimedPeriod;
+	std::atomic<long> m_publishedPeriod;
+	std::atomic<ValueBuffer*> m_publishedBuffer;
 
-	bool m_hasSampleExactData;
+	// sample-exact automation written by the song, valid in period m_automatedPeriod
+	// up to m_automatedFrames. Allocated the first time the model is automated.
+	ValueBuffer m_automationBuffer;
+	long m_automatedPeriod;
+	f_cnt_t m_automatedFrames;
 
-	// prevent several threads from attempting to write the same vb at the same time
-	QMutex m_valueBufferMutex;
+	//! must only ever increase, see valueBuffer()
+	static std::atomic<long> s_periodCounter;
 
 	bool m_useControllerValue;
 
@@ -29,7 +29,10 @@
 
 #include <QMap>
 #include <QPointer>
+#include <span>
+#include <utility>
 
+#include "AutomationCurve.h"
 #include "AutomationNode.h"
 #include "Clip.h"
 
@@ -103,6 +106,16 @@ public:
 		const bool ignoreSurroundingPoints = true
 	);
 
+	/**
+	 * @brief Puts many nodes at once, e.g. when importing. Tangents, length and
+	 *        curve are updated and dataChanged() is emitted only once.
+	 * @param values Unquantized positions and values, sorted by position
+	 * @param tolerance Leaves out nodes if the curve stays within this distance
+	 *        of their values without them. 0 only leaves out nodes the curve
+	 *        passes through anyway.
+	 */
+	void putValues(std::span<const std::pair<TimePos, float>> values, float tolerance = 0.f);
+
 	void removeNode(const TimePos & time);
 	void removeNodes(const int tick0, const int tick1);
 
@@ -169,6 +182,9 @@ public:
 	float valueAt( const TimePos & _time ) const;
 	float *valuesAfter( const TimePos & _time ) const;
 
+	//! The nodes compiled for playback, never nullptr. Safe to call from any thread.
+	std::shared_ptr<const AutomationCurve> curve() const;
+
 	QString name() const;
 
 	// settings-management
@@ -215,6 +231,9 @@ private:
 	void generateTangents(timeMap::iterator it, int numToGenerate);
 	float valueAt( timeMap::const_iterator v, int offset ) const;
 
+	//! Compiles the nodes into a new curve, must be called after every change to them
+	void updateCurve();
+
 	/**
 	 * @brief
 	 * This function combines the song tracks, pattern store tracks,
@@ -233,6 +252,8 @@ private:
 	objectVector m_objects;
 	timeMap m_timeMap;	// actual values
 	timeMap m_oldTimeMap;	// old values for storing the values before setDragValue() is called.
+	// m_timeMap compiled for playback, only accessed with std::atomic_load/store
+	std::shared_ptr<const AutomationCurve> m_curve;
 	float m_tension;
 	bool m_hasAutomation;
 	ProgressionType m_progressionType;
@@ -0,0 +1,100 @@
+/*
+ * AutomationCurve.h - automation nodes compiled for fast playback
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_AUTOMATION_CURVE_H
+#define LMMS_AUTOMATION_CURVE_H
+
+#include <QMap>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+class AutomatableModel;
+
+/**
+	The nodes of an automation clip, compiled into a flat array with one
+	polynomial per segment between two nodes.
+
+	Curves never change, a clip builds a new one whenever it is edited. So the
+	audio thread can look up values and render whole periods sample by sample
+	without locking the clip.
+*/
+class LMMS_EXPORT AutomationCurve
+{
+public:
+	//! The curve from a node up to the next one
+	struct Segment
+	{
+		int start; //!< Position of the node in ticks
+		float inverseLength; //!< One over the ticks until the next node, 0 for the last node
+		float inValue; //!< Value exactly at the node
+		//! Of 1, t, t² and t³, with t going from 0 at this node to 1 at the next one
+		std::array<float, 4> coefficients;
+	};
+
+	AutomationCurve() = default;
+
+	//! @param segments Sorted by their start
+	explicit AutomationCurve(std::vector<Segment> segments);
+
+	bool empty() const { return m_segments.empty(); }
+
+	//! Returns the value at @p tick, 0 before the first node
+	float valueAt(double tick) const;
+
+	//! Writes the values of @p frames frames to @p out, the first one at @p tick
+	//! and each one after it @p ticksPerFrame later
+	void render(double tick, double ticksPerFrame, float* out, std::size_t frames) const;
+
+private:
+	using Iterator = std::vector<Segment>::const_iterator;
+
+	//! Returns the first segment starting after @p tick
+	Iterator segmentAfter(double tick) const;
+
+	//! Returns the value at @p tick, which must be inside of the segment before @p next
+	float valueBefore(Iterator next, double tick) const;
+
+	std::vector<Segment> m_segments;
+};
+
+
+//! The curve an automated model follows and where it is on that curve
+struct AutomationCurvePosition
+{
+	std::shared_ptr<const AutomationCurve> curve;
+	int tick = 0; //!< Relative to the start of the clip
+	bool moving = true; //!< False after the end of the clip, where the value is held
+
+	float value() const { return curve->valueAt(tick); }
+};
+
+using AutomatedCurveMap = QMap<AutomatableModel*, AutomationCurvePosition>;
+
+} // namespace lmms
+
+#endif // LMMS_AUTOMATION_CURVE_H
@@ -33,11 +33,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <memory>
 #include <numbers>
 
 #include "lmms_constants.h"
 #include "LmmsTypes.h"
+#include "LocklessAllocator.h"
 
 
 namespace lmms
@@ -261,6 +264,8 @@ public:
 
 	inline void setFilterType( const FilterType _idx )
 	{
+		// a ramp's coefficients belong to the old type
+		m_rampFrames = 0;
 		m_doubleFilter = _idx == FilterType::DoubleLowPass || _idx == FilterType::DoubleMoog;
 		if( !m_doubleFilter )
 		{
@@ -286,7 +291,8 @@ public:
 		m_doubleFilter( false ),
 		m_sampleRate( (float) _sample_rate ),
 		m_sampleRatio( 1.0f / m_sampleRate ),
-		m_subFilter( nullptr )
+		m_subFilter( nullptr ),
+		m_rampFrames( 0 )
 	{
 		clearHistory();
 	}
@@ -868,8 +874,120 @@ public:
 		}
 	}
 
+	/**
+		Computes the coefficients for @p freq and @p q, but rather than
+		switching to them, moves the current coefficients towards them in
+		@p frames equal steps, one per call of stepFilterCoeffs(). This way
+		a sweep only has to compute coefficients every few frames.
+	*/
+	inline void rampFilterCoeffs( float freq, float q, fpp_t frames )
+	{
+		if( frames == 0 )
+		{
+			calcFilterCoeffs( freq, q );
+			m_rampFrames = 0;
+			return;
+		}
+
+		std::array<float, MaxCoeffs> from;
+		auto c = from.begin();
+		forEachCoeff( [&c]( float& coeff ) { *c++ = coeff; } );
+
+		calcFilterCoeffs( freq, q );
+
+		c = from.begin();
+		auto target = m_rampTarget.begin();
+		auto step = m_rampStep.begin();
+		forEachCoeff( [&]( float& coeff )
+		{
+			*target++ = coeff;
+			*step++ = ( coeff - *c ) / frames;
+			coeff = *c++;
+		} );
+		syncSubFilterCoeffs();
+		m_rampFrames = frames;
+	}
+
+	//! Advances a ramp started by rampFilterCoeffs() by one frame
+	inline void stepFilterCoeffs()
+	{
+		if( m_rampFrames == 0 ) { return; }
+
+		if( --m_rampFrames == 0 )
+		{
+			// land on the target exactly instead of accumulating rounding errors
+			auto target = m_rampTarget.begin();
+			forEachCoeff( [&target]( float& coeff ) { coeff = *target++; } );
+		}
+		else
+		{
+			auto step = m_rampStep.begin();
+			forEachCoeff( [&step]( float& coeff ) { coeff += *step++; } );
+		}
+		syncSubFilterCoeffs();
+	}
+
 
 private:
+	//! The most coefficients any filter type has, see forEachCoeff()
+	static constexpr std::size_t MaxCoeffs = 7;
+
+	//! Calls @p f with each coefficient the current filter type uses
+	template<typename F>
+	inline void forEachCoeff( F&& f )
+	{
+		switch( m_type )
+		{
+			case FilterType::Moog:
+			case FilterType::Tripole:
+				f( m_r ); f( m_p ); f( m_k );
+				break;
+			case FilterType::Lowpass_RC12:
+			case FilterType::Bandpass_RC12:
+			case FilterType::Highpass_RC12:
+			case FilterType::Lowpass_RC24:
+			case FilterType::Bandpass_RC24:
+			case FilterType::Highpass_RC24:
+				f( m_rca ); f( m_rcb ); f( m_rcc ); f( m_rcq );
+				break;
+			case FilterType::Formantfilter:
+			case FilterType::FastFormant:
+				for( int i = 0; i < 2; ++i )
+				{
+					f( m_vfa[i] ); f( m_vfb[i] ); f( m_vfc[i] );
+				}
+				f( m_vfq );
+				break;
+			case FilterType::Lowpass_SV:
+			case FilterType::Bandpass_SV:
+			case FilterType::Highpass_SV:
+			case FilterType::Notch_SV:
+				f( m_svf1 ); f( m_svf2 ); f( m_svq );
+				break;
+			default:
+				f( m_biQuad.m_a1 ); f( m_biQuad.m_a2 );
+				f( m_biQuad.m_b0 ); f( m_biQuad.m_b1 ); f( m_biQuad.m_b2 );
+				break;
+		}
+	}
+
+	//! Hands the coefficients on to the second stage of the double filters
+	inline void syncSubFilterCoeffs()
+	{
+		if( !m_doubleFilter ) { return; }
+
+		if( m_type == FilterType::Moog )
+		{
+			m_subFilter->m_r = m_r;
+			m_subFilter->m_p = m_p;
+			m_subFilter->m_k = m_k;
+		}
+		else
+		{
+			m_subFilter->m_biQuad.setCoeffs( m_biQuad.m_a1, m_biQuad.m_a2, m_biQuad.m_b0, m_biQuad.m_b1, m_biQuad.m_b2 );
+		}
+	}
+
 	// biquad filter
 	BiQuad<CHANNELS> m_biQuad;
 
@@ -909,9 +1027,68 @@ private:
 	float m_sampleRatio;
 	BasicFilters<CHANNELS> * m_subFilter;
 
+	// coefficient ramp, see rampFilterCoeffs()
+	std::array<float, MaxCoeffs> m_rampTarget;
+	std::array<float, MaxCoeffs> m_rampStep;
+	fpp_t m_rampFrames;
+
 } ;
 
 
+
+
+/**
+	Preallocated, lock-free storage for the stereo filters of a track's voices,
+	so a voice can get its filter state on the audio thread without
+	allocating. Voices beyond the pool's capacity fall back to the heap.
+*/
+class BasicFiltersPool
+{
+public:
+	struct Deleter
+	{
+		BasicFiltersPool* pool = nullptr;
+		void operator()(BasicFilters<>* filter) const;
+	};
+	using Ptr = std::unique_ptr<BasicFilters<>, Deleter>;
+
+	explicit BasicFiltersPool(std::size_t capacity) :
+		m_allocator(capacity),
+		m_available(static_cast<int>(capacity))
+	{
+	}
+
+	Ptr acquire(sample_rate_t sampleRate)
+	{
+		// LocklessAllocator complains when it runs dry, so count ourselves
+		if (m_available.fetch_sub(1) <= 0)
+		{
+			++m_available;
+			return Ptr{new BasicFilters<>(sampleRate), Deleter{}};
+		}
+		return Ptr{new (m_allocator.alloc()) BasicFilters<>(sampleRate), Deleter{this}};
+	}
+
+private:
+	void release(BasicFilters<>* filter)
+	{
+		filter->~BasicFilters();
+		m_allocator.free(filter);
+		++m_available;
+	}
+
+	LocklessAllocatorT<BasicFilters<>> m_allocator;
+	std::atomic_int m_available;
+};
+
+
+inline void BasicFiltersPool::Deleter::operator()(BasicFilters<>* filter) const
+{
+	if (pool) { pool->release(filter); }
+	else { delete filter; }
+}
+
+
 } // namespace lmms
 
 #endif // LMMS_BASIC_FILTERS_H
@@ -26,6 +26,8 @@
 #ifndef LMMS_BUFFER_MANAGER_H
 #define LMMS_BUFFER_MANAGER_H
 
+#include <cstddef>
+
 #include "lmms_export.h"
 #include "LmmsTypes.h"
 
@@ -34,12 +36,32 @@ namespace lmms
 
 class SampleFrame;
 
+/**
+	Hands out one-period sample buffers for play handles and audio bus
+	handles. Buffers come from preallocated, cache-aligned slabs, so that
+	acquire() and release() are lock-free and never allocate on the audio
+	thread. When the pool runs low, acquire() wakes a background thread by
+	posting a semaphore, which doesn't block, and that thread adds another
+	slab. If the pool runs dry before that, acquire() falls back to the heap.
+*/
 class LMMS_EXPORT BufferManager
 {
 public:
+	struct Stats
+	{
+		std::size_t capacity; //!< Number of preallocated buffers
+		std::size_t inUse; //!< Number of buffers currently acquired
+		std::size_t highWaterMark; //!< Maximum number of buffers acquired at the same time
+		std::size_t heapAllocations; //!< Number of acquire() calls that found the pool empty
+	};
+
+	//! Slabs made for a smaller @p fpp by an earlier call stop handing out buffers
 	static void init( fpp_t fpp );
+	//! Stops growing the pool, outstanding buffers stay valid
+	static void destroy();
 	static SampleFrame* acquire();
 	static void release( SampleFrame* buf );
+	static Stats stats();
 
 private:
 	static fpp_t s_framesPerPeriod;
@@ -207,6 +207,12 @@ public:
 		return m_workingDir + "recover.mmp";
 	}
 
+	//! Where measured FFTW plans are kept between sessions, next to the config file
+	QString fftwWisdomFile() const;
+
+	//! Where the SampleIndex is kept between sessions
+	QString sampleIndexFile() const;
+
 	inline const QStringList & recentlyOpenedProjects() const
 	{
 		return m_recentlyOpenedProjects;
@@ -28,6 +28,7 @@
 
 #include <span>
 
+#include "AudioBufferView.h"
 #include "AudioEngine.h"
 #include "AutomatableModel.h"
 #include "Engine.h"
@@ -67,6 +68,38 @@ public:
 	//! Returns true if audio was processed and should continue being processed
 	bool processAudioBuffer(SampleFrame* buf, const fpp_t frames);
 
+	//! Same as above for effects that process planar buffers
+	bool processAudioBuffer(PlanarBufferView<float, DEFAULT_CHANNELS> buf);
+
+	/**
+	 * True if the effect works on separate channel buffers, like most plugin
+	 * APIs do. The effect chain then passes planar buffers to
+	 * processPlanarImpl() and only converts from and to the interleaved
+	 * buffers of the engine where it switches between planar and
+	 * interleaved effects.
+	 */
+	virtual bool processesPlanar() const
+	{
+		return false;
+	}
+
+	/**
+	 * The frames by which the effect delays the signal, e.g. for lookahead
+	 * or oversampling. The mixer delays parallel paths by as much, so they
+	 * stay in time with this one. Called from the audio thread once per
+	 * period, so it must be cheap.
+	 */
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
+	//! False if processAudioBuffer() would not call the effect at all
+	inline bool isProcessing() const
+	{
+		return isOkay() && !dontRun() && isEnabled() && isRunning();
+	}
+
 	inline bool isOkay() const
 	{
 		return m_okay;
@@ -166,6 +199,14 @@ protected:
 	 */
 	virtual ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) = 0;
 
+	/**
+	 * Replaces processImpl() for effects whose processesPlanar() returns true
+	 */
+	virtual ProcessStatus processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS>)
+	{
+		return ProcessStatus::Sleep;
+	}
+
 	/**
 	 * Optional method that runs when plugin is sleeping (not enabled,
 	 * not running, not in the Okay state, or in the Don't Run state)
@@ -185,6 +226,9 @@ private:
 	 * turned off and won't be processed again until it receives new audio input.
 	 */
 	void handleAutoQuit(std::span<const SampleFrame> output);
+	void handleAutoQuit(PlanarBufferView<const float, DEFAULT_CHANNELS> output);
+	//! Counts quiet periods and stops the effect after too many
+	void updateAutoQuit(bool quiet);
 
 
 	EffectChain * m_parent;
@@ -26,6 +26,9 @@
 #ifndef LMMS_EFFECT_CHAIN_H
 #define LMMS_EFFECT_CHAIN_H
 
+#include <array>
+
+#include "AudioEngine.h"
 #include "Model.h"
 #include "SerializingObject.h"
 #include "AutomatableModel.h"
@@ -66,6 +69,9 @@ public:
 	bool processAudioBuffer( SampleFrame* _buf, const fpp_t _frames, bool hasInputNoise );
 	void startRunning();
 
+	//! Sum of the latencies of the enabled effects
+	f_cnt_t latency() const;
+
 	void clear();
 
 
@@ -75,6 +81,11 @@ private:
 
 	BoolModel m_enabledModel;
 
+	// planar copy of the buffer, shared by consecutive planar effects
+	// (the engine never processes more than DEFAULT_BUFFER_SIZE frames at once)
+	alignas(16) std::array<std::array<float, DEFAULT_BUFFER_SIZE>, DEFAULT_CHANNELS> m_planarBuffer;
+	std::array<float*, DEFAULT_CHANNELS> m_planarChannels;
+
 
 	friend class gui::EffectRackView;
 
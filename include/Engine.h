@@ -39,6 +39,7 @@ class AudioEngine;
 class Mixer;
 class PatternStore;
 class ProjectJournal;
+class SampleIndex;
 class Song;
 class Ladspa2LMMS;
 
@@ -93,6 +94,12 @@ public:
 		return s_ladspaManager;
 	}
 
+	//! Index of the sample directories, nullptr when rendering from the command line
+	static SampleIndex* sampleIndex()
+	{
+		return s_sampleIndex;
+	}
+
 	static float framesPerTick()
 	{
 		return s_framesPerTick;
@@ -142,6 +149,7 @@ private:
 	static class Lv2Manager* s_lv2Manager;
 #endif
 	static Ladspa2LMMS* s_ladspaManager;
+	static SampleIndex* s_sampleIndex;
 	static void* s_dndPluginKey;
 
 	// even though most methods are static, an instance is needed for Qt slots/signals
@@ -33,6 +33,7 @@
 namespace lmms::gui {
 //! The `FileSearchJob` class allows for searching for files on the filesystem.
 //! Searching occurs on a background thread, and results are emitted as a Qt slot back to the user.
+//! Paths covered by the SampleIndex are looked up in the index instead of being walked.
 class FileSearchJob : public QObject
 {
 	Q_OBJECT
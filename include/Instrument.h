@@ -105,6 +105,14 @@ public:
 		return 0.f;
 	}
 
+	// The frames by which the instrument's output lags behind the notes it
+	// plays, e.g. for a plugin that processes in blocks. Tracks without
+	// that latency are delayed by as much to stay in time with this one.
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
 	// Converts the desired release time in milliseconds to the corresponding
 	// number of frames depending on the sample rate.
 	f_cnt_t desiredReleaseFrames() const
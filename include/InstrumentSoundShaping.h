@@ -25,6 +25,7 @@
 #ifndef LMMS_INSTRUMENT_SOUND_SHAPING_H
 #define LMMS_INSTRUMENT_SOUND_SHAPING_H
 
+#include "BasicFilters.h"
 #include "ComboBoxModel.h"
 #include "EnvelopeAndLfoParameters.h"
 
@@ -71,6 +72,15 @@ public:
 
 	float volumeLevel( NotePlayHandle * _n, const f_cnt_t _frame );
 
+	/**
+		Runs @p buffer through @p filter with the cutoff in Hz and resonance
+		given per frame. They are only read every 16 frames and at the last
+		frame, where the filter coefficients are computed, and the
+		coefficients are interpolated linearly in between.
+	*/
+	static void applyFilter(BasicFilters<>& filter, SampleFrame* buffer, const fpp_t frames,
+		const float* cutoff, const float* resonance);
+
 
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
 	void loadSettings( const QDomElement & _this ) override;
@@ -84,6 +94,12 @@ private:
 	QString getCutoffNodeName() const;
 	QString getResonanceNodeName() const;
 
+	//! Per-frame envelope levels, too large for the stack with big periods.
+	//! The voices of a track are processed on several threads at once, so
+	//! every thread gets its own.
+	struct ControlBuffers;
+	static thread_local ControlBuffers s_controlBuffers;
+
 private:
 	InstrumentTrack * m_instrumentTrack;
 
@@ -95,6 +111,8 @@ private:
 	ComboBoxModel m_filterModel;
 	FloatModel m_filterCutModel;
 	FloatModel m_filterResModel;
+
+	BasicFiltersPool m_filterPool;
 };
 
 
@@ -0,0 +1,102 @@
+/*
+ * LatencyCompensator.h - delays a signal path to line it up with slower ones
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_LATENCY_COMPENSATOR_H
+#define LMMS_LATENCY_COMPENSATOR_H
+
+#include <atomic>
+#include <vector>
+
+#include "LmmsTypes.h"
+#include "SampleFrame.h"
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+/**
+	A delay line on a path into a mixer channel, e.g. from a track or from
+	another channel, that delays it by as much less latency as it has than the
+	slowest path into the same channel.
+
+	The mixer sets the delay once per period on the audio thread, which must
+	not allocate. So a compensator starts without a buffer, and a delay that
+	doesn't fit into the buffer is only applied as far as it fits, until the
+	mixer has swapped in a larger one from the main thread.
+*/
+class LMMS_EXPORT LatencyCompensator
+{
+public:
+	//! Longer latencies are only compensated up to this
+	static constexpr float MaxDelaySeconds = 2.f;
+
+	//! The longest delay at @p sampleRate
+	static f_cnt_t maxDelay(sample_rate_t sampleRate)
+	{
+		return static_cast<f_cnt_t>(MaxDelaySeconds * sampleRate);
+	}
+
+	f_cnt_t delay() const { return m_delay; }
+
+	/**
+		Changes the delay. Audio that is already delayed stays in the buffer:
+		a longer delay inserts silence before it comes out, a shorter one
+		skips the frames it no longer needs to wait for.
+
+		@return False if the buffer is too small for @p frames, until
+			allocate() and adopt() have grown it
+	*/
+	bool setDelay(f_cnt_t frames);
+
+	//! A buffer for the delay last passed to setDelay(), empty if the current one is large enough
+	std::vector<SampleFrame> allocate() const;
+
+	/**
+		Swaps in @p buffer from allocate(), keeping the audio that is delayed.
+		Must not run concurrently to setDelay() or process(). @p buffer holds
+		the old buffer afterwards.
+	*/
+	void adopt(std::vector<SampleFrame>& buffer);
+
+	/**
+		Delays @p buf in place.
+
+		@param hasInput False if the path is silent, @p buf is then treated as
+			silence, and only overwritten while delayed audio comes out
+		@return True if @p buf holds audio afterwards
+	*/
+	bool process(SampleFrame* buf, fpp_t frames, bool hasInput);
+
+private:
+	//! The latest input, the newest frame just before m_write. Empty or a power of two in size.
+	std::vector<SampleFrame> m_buffer;
+	//! Written by setDelay(), read by allocate() on another thread
+	std::atomic<f_cnt_t> m_wantedDelay = 0;
+	f_cnt_t m_delay = 0;
+	f_cnt_t m_write = 0;
+	//! Frames until the last input that wasn't silence has come out again
+	f_cnt_t m_pending = 0;
+};
+
+} // namespace lmms
+
+#endif // LMMS_LATENCY_COMPENSATOR_H
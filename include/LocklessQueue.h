@@ -0,0 +1,103 @@
+/*
+ * LocklessQueue.h - fixed-size single-producer single-consumer queue
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_LOCKLESS_QUEUE_H
+#define LMMS_LOCKLESS_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace lmms
+{
+
+/**
+	Wait-free queue for handing values from exactly one producer thread to
+	exactly one consumer thread, e.g. from a MIDI driver thread to the audio
+	thread. All storage is allocated up front, push() fails instead of
+	allocating when the queue is full.
+*/
+template<typename T>
+class LocklessQueue
+{
+public:
+	//! @param capacity maximum number of queued elements, rounded up to a power of two
+	explicit LocklessQueue(std::size_t capacity) :
+		m_size(roundUpToPowerOfTwo(capacity)),
+		m_buffer(std::make_unique<T[]>(m_size)),
+		m_readIndex(0),
+		m_writeIndex(0)
+	{
+	}
+
+	LocklessQueue(const LocklessQueue&) = delete;
+	LocklessQueue& operator=(const LocklessQueue&) = delete;
+
+	//! Producer side. Returns false if the queue is full.
+	bool push(const T& value)
+	{
+		const auto write = m_writeIndex.load(std::memory_order_relaxed);
+		if (write - m_readIndex.load(std::memory_order_acquire) == m_size) { return false; }
+
+		m_buffer[write & (m_size - 1)] = value;
+		m_writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	//! Consumer side. Returns false if the queue is empty.
+	bool pop(T& value)
+	{
+		const auto read = m_readIndex.load(std::memory_order_relaxed);
+		if (read == m_writeIndex.load(std::memory_order_acquire)) { return false; }
+
+		value = m_buffer[read & (m_size - 1)];
+		m_readIndex.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return m_readIndex.load(std::memory_order_acquire) == m_writeIndex.load(std::memory_order_acquire);
+	}
+
+	std::size_t capacity() const { return m_size; }
+
+private:
+	static std::size_t roundUpToPowerOfTwo(std::size_t n)
+	{
+		std::size_t size = 1;
+		while (size < n) { size <<= 1; }
+		return size;
+	}
+
+	const std::size_t m_size;
+	std::unique_ptr<T[]> m_buffer;
+
+	// kept on separate cache lines so producer and consumer don't false-share
+	alignas(64) std::atomic_size_t m_readIndex;
+	alignas(64) std::atomic_size_t m_writeIndex;
+};
+
+
+} // namespace lmms
+
+#endif // LMMS_LOCKLESS_QUEUE_H
@@ -32,6 +32,7 @@
 #include <lilv/lilv.h>
 #include <memory>
 
+#include "AudioBufferView.h"
 #include "LinkedModelGroups.h"
 #include "lmms_export.h"
 #include "Plugin.h"
@@ -121,6 +122,9 @@ protected:
 	void copyBuffersFromLmms(const SampleFrame* buf, fpp_t frames);
 	//! Copy our ports into buffers passed by LMMS
 	void copyBuffersToLmms(SampleFrame* buf, fpp_t frames) const;
+	//! Same as above for planar buffers
+	void copyBuffersFromLmms(PlanarBufferView<const float, DEFAULT_CHANNELS> buf);
+	void copyBuffersToLmms(PlanarBufferView<float, DEFAULT_CHANNELS> buf) const;
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
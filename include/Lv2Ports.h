@@ -196,6 +196,11 @@ struct Audio : public VisitablePort<Audio, PortBase>
 	void copyBuffersToCore(SampleFrame* lmmsBuf,
 		unsigned channel, fpp_t frames) const;
 
+	//! Same as above for one channel buffer of a planar buffer
+	void copyBuffersFromCore(const float* lmmsBuf, fpp_t frames);
+	void averageWithBuffersFromCore(const float* lmmsBuf, fpp_t frames);
+	void copyBuffersToCore(float* lmmsBuf, fpp_t frames) const;
+
 	bool isSideChain() const { return m_sidechain; }
 	bool isOptional() const { return m_optional; }
 	bool mustBeUsed() const { return !isSideChain() && !isOptional(); }
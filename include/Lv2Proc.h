@@ -35,6 +35,7 @@
 
 #include <ringbuffer/ringbuffer.h>
 
+#include "AudioBufferView.h"
 #include "LinkedModelGroups.h"
 #include "LmmsSemaphore.h"
 #include "Lv2Basics.h"
@@ -146,6 +147,14 @@ public:
 	 */
 	void copyBuffersToCore(SampleFrame* buf, unsigned firstChan, unsigned num,
 								fpp_t frames) const;
+	//! Same as above for planar buffers, @p firstChan is the first channel
+	//! buffer of @p buf that we read from
+	void copyBuffersFromCore(PlanarBufferView<const float, DEFAULT_CHANNELS> buf,
+								unsigned firstChan, unsigned num);
+	//! Same as above for planar buffers, @p firstChan is the first channel
+	//! buffer of @p buf that we write to
+	void copyBuffersToCore(PlanarBufferView<float, DEFAULT_CHANNELS> buf,
+								unsigned firstChan, unsigned num) const;
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -29,6 +29,7 @@
 #include <vector>
 
 
+#include "LmmsTypes.h"
 #include "MidiEvent.h"
 
 class QObject;
@@ -63,6 +64,10 @@ public:
 	// re-implemented methods HAVE to call removePort() of base-class!!
 	virtual void removePort( MidiPort * _port );
 
+	// called by the audio engine at the start of every period to dispatch
+	// the events all ports received since the last period
+	void processQueuedInEvents( fpp_t frames, sample_rate_t sampleRate );
+
 
 	// returns whether client works with raw-MIDI, only needs to be
 	// re-implemented by MidiClientRaw for returning true
@@ -26,6 +26,10 @@
 #ifndef LMMS_MIDI_CLIP_H
 #define LMMS_MIDI_CLIP_H
 
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
 #include "Clip.h"
 #include "Note.h"
 
@@ -52,6 +56,41 @@ public:
 		MelodyClip
 	} ;
 
+	/**
+		Collects note edits and applies them to a clip in one go: the notes
+		are sorted and merged into the clip once, under a single lock of the
+		instrument track, with one journal checkpoint and one dataChanged().
+		Use it instead of addNote()/removeNote() in loops.
+
+		The checkpoint is recorded when the batch is created, the edits are
+		applied by commit() or when the batch is destroyed.
+	*/
+	class LMMS_EXPORT NoteBatch
+	{
+	public:
+		//! @param journal whether to record a journal checkpoint
+		explicit NoteBatch(MidiClip* clip, bool journal = true);
+		~NoteBatch();
+
+		NoteBatch(const NoteBatch&) = delete;
+		NoteBatch& operator=(const NoteBatch&) = delete;
+
+		//! Returns the copy of @p note that the clip will own
+		Note* addNote(const Note& note, bool quantPos = true);
+		//! @p note may be a note of the clip or one added to this batch
+		void removeNote(Note* note);
+		//! Moves a note of the clip, keeping the clip sorted
+		void moveNote(Note* note, TimePos pos, int key);
+
+		void commit();
+
+	private:
+		MidiClip* m_clip;
+		NoteVector m_added;
+		std::unordered_set<Note*> m_removed;
+		std::vector<std::tuple<Note*, TimePos, int>> m_moved;
+	};
+
 	MidiClip( InstrumentTrack* instrumentTrack );
 	~MidiClip() override;
 
@@ -26,19 +26,21 @@
 #ifndef LMMS_MIDI_PORT_H
 #define LMMS_MIDI_PORT_H
 
+#include <chrono>
 #include <QString>
 #include <QList>
 #include <QMap>
 
 #include "Midi.h"
+#include "MidiEvent.h"
 #include "TimePos.h"
 #include "AutomatableModel.h"
+#include "LocklessQueue.h"
 
 namespace lmms
 {
 
 class MidiClient;
-class MidiEvent;
 class MidiEventProcessor;
 
 namespace gui
@@ -68,6 +70,7 @@ class MidiPort : public Model, public SerializingObject
 	mapPropertyFromModel(bool,isWritable,setWritable,m_writableModel);
 public:
 	using Map = QMap<QString, bool>;
+	using Clock = std::chrono::steady_clock;
 
 	enum class Mode
 	{
@@ -111,9 +114,22 @@ public:
 		return outputChannel() ? outputChannel() - 1 : 0;
 	}
 
+	//! Called by MIDI clients from their own thread. The event is only
+	//! timestamped and queued here, see processQueuedInEvents()
 	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos() );
 	void processOutEvent( const MidiEvent& event, const TimePos& time = TimePos() );
 
+	//! Called by the audio thread at the start of each period: hands all
+	//! queued input events to the event processor with in-period frame offsets
+	void processQueuedInEvents( fpp_t frames, sample_rate_t sampleRate );
+
+	//! Maps the time an event was received to a frame offset in the period
+	//! that starts at @p now. Events received during the last period keep
+	//! their relative spacing, so live input is delayed by exactly one
+	//! period instead of jittering with the period boundaries.
+	static f_cnt_t frameOffset( Clock::time_point received, Clock::time_point now,
+		fpp_t frames, sample_rate_t sampleRate );
+
 
 	void saveSettings( QDomDocument& doc, QDomElement& thisElement ) override;
 	void loadSettings( const QDomElement& thisElement ) override;
@@ -173,6 +189,16 @@ private:
 	Map m_readablePorts;
 	Map m_writablePorts;
 
+	struct QueuedInEvent
+	{
+		MidiEvent event;
+		TimePos time;
+		Clock::time_point received;
+	};
+
+	//! MIDI client thread -> audio thread
+	LocklessQueue<QueuedInEvent> m_inEvents;
+
 
 	friend class gui::ControllerConnectionDialog;
 	friend class gui::InstrumentMidiIOView;
@@ -25,6 +25,7 @@
 #ifndef LMMS_MIX_HELPERS_H
 #define LMMS_MIX_HELPERS_H
 
+#include "AudioBufferView.h"
 #include "LmmsTypes.h"
 
 namespace lmms
@@ -44,6 +45,15 @@ void setNaNHandler( bool use );
 
 bool sanitize( SampleFrame* src, int frames );
 
+/*! \brief Same as sanitize for a planar buffer */
+bool sanitize(PlanarBufferView<float, DEFAULT_CHANNELS> buffer);
+
+/*! \brief Split interleaved frames from src into the channels of dst */
+void deinterleave(PlanarBufferView<float, DEFAULT_CHANNELS> dst, const SampleFrame* src);
+
+/*! \brief Join the channels of src into interleaved frames in dst */
+void interleave(SampleFrame* dst, PlanarBufferView<const float, DEFAULT_CHANNELS> src);
+
 /*! \brief Add samples from src to dst */
 void add( SampleFrame* dst, const SampleFrame* src, int frames );
 
@@ -26,8 +26,10 @@
 #define LMMS_MIXER_H
 
 #include "Model.h"
+#include "AudioTap.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
+#include "LatencyCompensator.h"
 #include "ThreadableJob.h"
 
 #include <atomic>
@@ -38,6 +40,7 @@ namespace lmms
 {
 
 
+class AudioBusHandle;
 class MixerRoute;
 using MixerRouteVector = std::vector<MixerRoute*>;
 
@@ -54,8 +57,8 @@ class MixerChannel : public ThreadableJob
 		// set to true if any effect in the channel is enabled and running
 		bool m_stillRunning;
 
-		float m_peakLeft;
-		float m_peakRight;
+		// levels after the fader, for the mixer view and other meters
+		AudioTap m_tap;
 		SampleFrame* m_buffer;
 		bool m_muteBeforeSolo;
 		BoolModel m_muteModel;
@@ -72,6 +75,11 @@ class MixerChannel : public ThreadableJob
 		// pointers to other channels that send to this one
 		MixerRouteVector m_receives;
 
+		// frames by which the slowest track or channel feeding this one lags
+		// behind, and by which the output lags behind after the effects
+		f_cnt_t m_inputLatency;
+		f_cnt_t m_outputLatency;
+
 		int index() const { return m_channelIndex; }
 		void setIndex(int index) { m_channelIndex = index; }
 
@@ -93,6 +101,13 @@ class MixerChannel : public ThreadableJob
 		void doProcessing() override;
 		int m_channelIndex;
 		std::optional<QColor> m_color;
+
+		// receives that are delayed for latency compensation are mixed here
+		// first, as the sender's buffer also goes to its other receivers
+		SampleFrame* m_compensationBuffer;
+		bool m_latencyKnown;
+
+		friend class Mixer;
 };
 
 class MixerRoute : public QObject
@@ -127,12 +142,18 @@ public:
 		return m_to;
 	}
 
+	LatencyCompensator * compensator()
+	{
+		return &m_compensator;
+	}
+
 	void updateName();
 
 	private:
 		MixerChannel * m_from;
 		MixerChannel * m_to;
 		FloatModel m_amount;
+		LatencyCompensator m_compensator;
 };
 
 
@@ -148,6 +169,11 @@ public:
 	void prepareMasterMix();
 	void masterMix( SampleFrame* _buf );
 
+	// work out the latency of every channel and delay the tracks and sends
+	// that are faster than others into the same channel, so they line up.
+	// called once per period before the tracks mix into the channels
+	void compensateLatency(const std::vector<AudioBusHandle*>& busHandles);
+
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
 	void loadSettings( const QDomElement & _this ) override;
 
@@ -222,7 +248,15 @@ private:
 	// make sure we have at least num channels
 	void allocateChannelsTo(int num);
 
+	// works out the latencies of ch after the ones of all channels sending to it
+	void updateOutputLatency(MixerChannel* ch);
+
+	// gives the compensators whose delay doesn't fit larger buffers, on the main thread
+	void growCompensators();
+
 	int m_lastSoloed;
+	// set by the audio thread when it asked for growCompensators()
+	std::atomic<bool> m_growingCompensators = false;
 } ;
 
 
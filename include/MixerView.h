@@ -26,7 +26,10 @@
 #define LMMS_GUI_MIXER_VIEW_H
 
 #include <QWidget>
+#include <memory>
+#include <vector>
 
+#include "AudioTap.h"
 #include "MixerChannelView.h"
 #include "ModelView.h"
 #include "SerializingObject.h"
@@ -40,6 +43,7 @@ class QScrollArea;
 namespace lmms
 {
 	class Mixer;
+	class MixerChannel;
 }
 
 namespace lmms::gui
@@ -126,6 +130,15 @@ private:
 
 	void updateMaxChannelSelector();
 
+	struct Meter
+	{
+		MixerChannel* channel;
+		std::unique_ptr<AudioTap::Subscriber> levels;
+	};
+	// subscriptions to the channel taps while the mixer is visible,
+	// dropped whenever channels are deleted or reordered
+	std::vector<Meter> m_meters;
+
 	friend class MixerChannelView;
 } ;
 
@@ -48,7 +48,7 @@ class LMMS_EXPORT NotePlayHandle : public PlayHandle, public Note
 {
 public:
 	void * m_pluginData;
-	std::unique_ptr<BasicFilters<>> m_filter;
+	BasicFiltersPool::Ptr m_filter;
 
 	// length of the declicking fade in
 	fpp_t m_fadeInLength;
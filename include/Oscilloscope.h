@@ -27,16 +27,11 @@
 
 #include <QWidget>
 #include <QPixmap>
+#include <memory>
 
+#include "AudioTap.h"
 #include "LmmsTypes.h"
 
-namespace lmms
-{
-
-class SampleFrame;
-
-}
-
 namespace lmms::gui
 {
 
@@ -72,10 +67,6 @@ protected:
 	void paintEvent( QPaintEvent * _pe ) override;
 	void mousePressEvent( QMouseEvent * _me ) override;
 
-
-protected slots:
-	void updateAudioBuffer(const lmms::SampleFrame* buffer);
-
 private:
 	bool clips(float level) const;
 
@@ -85,6 +76,8 @@ private:
 
 	SampleFrame* m_buffer;
 	bool m_active;
+	//! Reads the engine output while the oscilloscope is active
+	std::unique_ptr<AudioTap::Subscriber> m_subscriber;
 
 	QColor m_leftChannelColor;
 	QColor m_rightChannelColor;
@@ -27,17 +27,23 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 
 #include <hiir/PolyphaseIir2Designer.h>
 
 #ifdef __SSE2__
+#include <hiir/Downsampler2x4Sse.h>
 #include <hiir/Downsampler2xSse.h>
+#include <hiir/Upsampler2x4Sse.h>
 #include <hiir/Upsampler2xSse.h>
 #else
 #include <hiir/Downsampler2xFpu.h>
 #include <hiir/Upsampler2xFpu.h>
 #endif
 
+#include "LmmsTypes.h"
+#include "SampleFrame.h"
+
 
 inline constexpr float HIIR_DEFAULT_PASSBAND = 19600;
 inline constexpr int HIIR_DEFAULT_MAX_COEFS = 8;
@@ -243,6 +249,229 @@ private:
 };
 
 
+namespace detail
+{
+
+#ifdef __SSE2__
+//! Left and right channel in the lower two lanes
+using StereoLanes = __m128;
+
+template<int Coefs> using StereoUpsampler2x = hiir::Upsampler2x4Sse<Coefs>;
+template<int Coefs> using StereoDownsampler2x = hiir::Downsampler2x4Sse<Coefs>;
+
+inline StereoLanes toLanes(const SampleFrame& frame)
+{
+	return _mm_setr_ps(frame.left(), frame.right(), 0.f, 0.f);
+}
+
+inline SampleFrame fromLanes(StereoLanes lanes)
+{
+	alignas(16) std::array<float, 4> values;
+	_mm_store_ps(values.data(), lanes);
+	return {values[0], values[1]};
+}
+#else
+using StereoLanes = SampleFrame;
+
+//! Same interface as the SIMD filters, one filter per channel
+template<int Coefs>
+class StereoUpsampler2x
+{
+public:
+	void set_coefs(const double coefs[]) { for (auto& filter : m_filters) { filter.set_coefs(coefs); } }
+	void clear_buffers() { for (auto& filter : m_filters) { filter.clear_buffers(); } }
+
+	void process_sample(StereoLanes& out0, StereoLanes& out1, StereoLanes in)
+	{
+		for (int ch = 0; ch < 2; ++ch) { m_filters[ch].process_sample(out0[ch], out1[ch], in[ch]); }
+	}
+
+private:
+	std::array<hiir::Upsampler2xFpu<Coefs>, 2> m_filters;
+};
+
+template<int Coefs>
+class StereoDownsampler2x
+{
+public:
+	void set_coefs(const double coefs[]) { for (auto& filter : m_filters) { filter.set_coefs(coefs); } }
+	void clear_buffers() { for (auto& filter : m_filters) { filter.clear_buffers(); } }
+
+	StereoLanes process_sample(StereoLanes in0, StereoLanes in1)
+	{
+		auto out = StereoLanes{};
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			const float in[2] = {in0[ch], in1[ch]};
+			out[ch] = m_filters[ch].process_sample(in);
+		}
+		return out;
+	}
+
+private:
+	std::array<hiir::Downsampler2xFpu<Coefs>, 2> m_filters;
+};
+
+inline StereoLanes toLanes(const SampleFrame& frame) { return frame; }
+inline SampleFrame fromLanes(StereoLanes lanes) { return lanes; }
+#endif
+
+} // namespace detail
+
+
+/**
+	Runs a stereo process at 2 ^ stages times the sample rate, e.g. to keep a
+	nonlinear effect from aliasing. Both channels go through one cascade of
+	halfband filters, in the lanes of a SIMD vector where available.
+
+	An effect calls process() from its processImpl(), or upsample() and
+	downsample() around its own per frame loop, and reports latency() as the
+	delay it adds.
+*/
+template<int MaxStages, int MaxCoefs = HIIR_DEFAULT_MAX_COEFS>
+class StereoOversampler
+{
+	static_assert(MaxStages >= 2);
+
+public:
+	static constexpr int MaxFactor = 1 << MaxStages;
+
+	void setup(int stages, float sampleRate, float passband = HIIR_DEFAULT_PASSBAND)
+	{
+		assert(stages >= 0 && stages <= MaxStages);
+		m_stages = stages;
+
+		// every stage halves the transition band of the previous one
+		float bw = 0.5f - passband / sampleRate;
+		m_latency = 0.f;
+		for (int stage = 0; stage < m_stages; ++stage)
+		{
+			float delay = 0.f;
+			if (stage == 0) { delay = design(m_upFirst, m_downFirst, s_firstCoefCount, bw); }
+			else if (stage == 1) { delay = design(m_upSecond, m_downSecond, s_secondCoefCount, bw); }
+			else { delay = design(m_upRest[stage - 2], m_downRest[stage - 2], s_restCoefCount, bw); }
+
+			// once for each direction, at 2 ^ stage times the sample rate, but the
+			// downsampler aligns its output with the later one of its two inputs
+			m_latency += (2.f * delay - 0.5f) / (1 << stage);
+			bw = (bw + 0.5f) * 0.5f;
+		}
+	}
+
+	//! Silences the filters
+	void reset()
+	{
+		m_upFirst.clear_buffers();
+		m_downFirst.clear_buffers();
+		m_upSecond.clear_buffers();
+		m_downSecond.clear_buffers();
+		for (auto& filter : m_upRest) { filter.clear_buffers(); }
+		for (auto& filter : m_downRest) { filter.clear_buffers(); }
+	}
+
+	int stages() const { return m_stages; }
+	int factor() const { return 1 << m_stages; }
+
+	//! Delay of upsampling and downsampling at low frequencies, in frames at the original rate
+	float latency() const { return m_latency; }
+
+	//! Writes factor() frames for @p in to @p out
+	void upsample(const SampleFrame& in, SampleFrame* out)
+	{
+		// every stage doubles the frames. The filters keep state, so they have
+		// to see their inputs oldest first, which are copied aside for that
+		m_lanes[0] = detail::toLanes(in);
+		for (int stage = 0; stage < m_stages; ++stage)
+		{
+			const int count = 1 << stage;
+			std::copy(m_lanes, m_lanes + count, m_stageInput);
+			for (int i = 0; i < count; ++i)
+			{
+				const detail::StereoLanes lanes = m_stageInput[i];
+				if (stage == 0) { m_upFirst.process_sample(m_lanes[2 * i], m_lanes[2 * i + 1], lanes); }
+				else if (stage == 1) { m_upSecond.process_sample(m_lanes[2 * i], m_lanes[2 * i + 1], lanes); }
+				else { m_upRest[stage - 2].process_sample(m_lanes[2 * i], m_lanes[2 * i + 1], lanes); }
+			}
+		}
+
+		for (int i = 0; i < factor(); ++i) { out[i] = detail::fromLanes(m_lanes[i]); }
+	}
+
+	//! Returns the frame for the factor() frames at @p in
+	SampleFrame downsample(const SampleFrame* in)
+	{
+		for (int i = 0; i < factor(); ++i) { m_lanes[i] = detail::toLanes(in[i]); }
+
+		for (int stage = m_stages - 1; stage >= 0; --stage)
+		{
+			for (int i = 0; i < 1 << stage; ++i)
+			{
+				if (stage == 0) { m_lanes[i] = m_downFirst.process_sample(m_lanes[2 * i], m_lanes[2 * i + 1]); }
+				else if (stage == 1) { m_lanes[i] = m_downSecond.process_sample(m_lanes[2 * i], m_lanes[2 * i + 1]); }
+				else { m_lanes[i] = m_downRest[stage - 2].process_sample(m_lanes[2 * i], m_lanes[2 * i + 1]); }
+			}
+		}
+
+		return detail::fromLanes(m_lanes[0]);
+	}
+
+	/**
+		Upsamples every frame of @p buf, calls @p process with the factor() frames
+		and the index of the frame in @p buf, and replaces the frame with the
+		downsampled result.
+	*/
+	template<typename Process>
+	void process(SampleFrame* buf, fpp_t frames, Process&& process)
+	{
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			upsample(buf[f], m_frames.data());
+			process(m_frames.data(), f);
+			buf[f] = downsample(m_frames.data());
+		}
+	}
+
+private:
+	static constexpr int s_firstCoefCount = MaxCoefs;
+	static constexpr int s_secondCoefCount = std::max(MaxCoefs / 2, 2);
+	static constexpr int s_restCoefCount = std::max(MaxCoefs / 4, 2);
+
+	//! Sets up both filters of a stage and returns their group delay at low frequencies,
+	//! in samples at the lower rate
+	template<typename Up, typename Down>
+	static float design(Up& up, Down& down, int count, float bw)
+	{
+		auto coefs = std::array<double, MaxCoefs>{};
+		hiir::PolyphaseIir2Designer::compute_coefs_spec_order_tbw(coefs.data(), count, bw);
+		up.set_coefs(coefs.data());
+		up.clear_buffers();
+		down.set_coefs(coefs.data());
+		down.clear_buffers();
+
+		// Each coefficient is a first order allpass (a + z^-1) / (1 + a z^-1) in one of
+		// the two paths, delaying low frequencies by (1 - a) / (1 + a). The odd path is
+		// half a sample late, and the output is the average of both paths.
+		double delay = 0.5;
+		for (int i = 0; i < count; ++i) { delay += (1 - coefs[i]) / (1 + coefs[i]); }
+		return static_cast<float>(delay * 0.5);
+	}
+
+	detail::StereoUpsampler2x<s_firstCoefCount> m_upFirst;
+	detail::StereoUpsampler2x<s_secondCoefCount> m_upSecond;
+	std::array<detail::StereoUpsampler2x<s_restCoefCount>, MaxStages - 2> m_upRest;
+	detail::StereoDownsampler2x<s_firstCoefCount> m_downFirst;
+	detail::StereoDownsampler2x<s_secondCoefCount> m_downSecond;
+	std::array<detail::StereoDownsampler2x<s_restCoefCount>, MaxStages - 2> m_downRest;
+
+	detail::StereoLanes m_lanes[MaxFactor]; // std::array would warn about ignoring the attributes of __m128
+	detail::StereoLanes m_stageInput[MaxFactor / 2];
+	std::array<SampleFrame, MaxFactor> m_frames;
+
+	int m_stages = 0;
+	float m_latency = 0.f;
+};
+
+
 } // namespace lmms
 
 #endif // LMMS_OVERSAMPLING_HELPERS_H
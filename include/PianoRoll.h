@@ -29,6 +29,7 @@
 
 #include <QWidget>
 
+#include <span>
 #include <vector>
 
 #include "Editor.h"
@@ -158,6 +159,13 @@ public:
 
 	int quantization() const;
 
+public slots:
+	//! Repaints everything, including the grid and notes that paintEvent() caches
+	//! for the repaints that only the keys or the position line need. Called
+	//! after anything that changes how the notes look, update() is enough
+	//! for the rest.
+	void invalidateStaticLayer();
+
 protected:
 	enum class QuantizeAction
 	{
@@ -192,6 +200,8 @@ protected:
 	void drawNoteRect( QPainter & p, int x, int y,
 					int  width, const Note * n, const QColor & noteCol, const QColor & noteTextColor,
 					const QColor & selCol, const int noteOpc, const bool borderless, bool drawNoteName );
+	//! Draws the visible notes, their volume or panning bars and the clip bounds
+	void drawNotes(QPainter& p, bool drawNoteNames);
 	void removeSelection();
 	void selectAll();
 	NoteVector getSelectedNotes() const;
@@ -454,6 +464,52 @@ private:
 	void copyToClipboard(const NoteVector & notes ) const;
 
 	void drawDetuningInfo( QPainter & _p, const Note * _n, int _x, int _y ) const;
+
+	//! Notes sorted by position, to find the ones in a time range without
+	//! looking at all notes of the clip
+	class NoteIndex
+	{
+	public:
+		void build(const NoteVector& notes);
+
+		//! Returns all notes in the range from @p begin to @p end in ticks,
+		//! and maybe some more
+		std::span<const Note* const> notesIn(int begin, int end) const;
+
+	private:
+		std::vector<const Note*> m_notes;
+		std::vector<int> m_maxEnd; //!< Latest end of all notes up to the same index
+	};
+
+	//! What the cached grid and notes depend on, besides the notes themselves
+	struct StaticLayerState
+	{
+		QSize size;
+		qreal devicePixelRatio = 0;
+		int position = 0;
+		int startKey = 0;
+		int ppb = 0;
+		int keyLineHeight = 0;
+		int notesEditHeight = 0;
+		int timeSigNumerator = 0;
+		int timeSigDenominator = 0;
+		bool drawNoteNames = false;
+
+		bool operator==(const StaticLayerState&) const = default;
+	};
+
+	//! Grid and notes, drawn again when invalidateStaticLayer() is called or the view changes
+	QPixmap m_staticLayer;
+	StaticLayerState m_staticLayerState;
+	bool m_staticLayerOutdated = true;
+	NoteIndex m_noteIndex;
+	NoteIndex m_ghostNoteIndex;
+	//! Set when notes are added, removed, moved or resized, see notesChanged()
+	bool m_noteIndexOutdated = true;
+
+	//! Rebuilds the note indices before the next paint, and redraws the notes
+	void notesChanged();
+
 	bool mouseOverNote();
 	Note * noteUnderMouse();
 
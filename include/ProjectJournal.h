@@ -56,6 +56,11 @@ public:
 
 	void addJournalCheckPoint( JournallingObject *jo );
 
+	//! Check points added until the matching endCheckPointGroup() are
+	//! undone and redone as a single step. Groups may be nested.
+	void beginCheckPointGroup();
+	void endCheckPointGroup();
+
 	bool isJournalling() const
 	{
 		return m_journalling;
@@ -104,13 +109,17 @@ private:
 
 	struct CheckPoint
 	{
-		CheckPoint( jo_id_t initID = 0, const DataFile& initData = DataFile( DataFile::Type::JournalData ) ) :
+		CheckPoint( jo_id_t initID = 0, const DataFile& initData = DataFile( DataFile::Type::JournalData ),
+			int initGroup = 0 ) :
 			joID( initID ),
-			data( initData )
+			data( initData ),
+			group( initGroup )
 		{
 		}
 		jo_id_t joID;
 		DataFile data;
+		//! Check points sharing a non-zero group are undone together
+		int group;
 	} ;
 	using CheckPointStack = QStack<CheckPoint>;
 
@@ -121,6 +130,10 @@ private:
 
 	bool m_journalling;
 
+	int m_groupDepth = 0;
+	int m_currentGroup = 0;
+	int m_lastGroup = 0;
+
 } ;
 
 
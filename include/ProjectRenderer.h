@@ -67,6 +67,12 @@ public:
 		return m_fileDev != nullptr;
 	}
 
+	//! Frames written to the file, valid once the thread has finished
+	f_cnt_t framesRendered() const
+	{
+		return m_framesRendered;
+	}
+
 	static ExportFileFormat getFileFormatFromExtension(
 							const QString & _ext );
 
@@ -92,6 +98,7 @@ private:
 
 	volatile int m_progress;
 	volatile bool m_abort;
+	f_cnt_t m_framesRendered;
 
 } ;
 
@@ -29,6 +29,7 @@
 #include <QProcess>
 #include <QRecursiveMutex>
 
+#include "AudioBufferView.h"
 #include "RemotePluginBase.h"
 #include "SharedMemory.h"
 #include "LmmsTypes.h"
@@ -99,6 +100,10 @@ public:
 	bool processMessage( const message & _m ) override;
 
 	bool process( const SampleFrame* _in_buf, SampleFrame* _out_buf );
+	//! Same as above for planar buffers, saves the (de)interleaving if the
+	//! plugin uses split channels
+	bool process(PlanarBufferView<const float, DEFAULT_CHANNELS> in,
+		PlanarBufferView<float, DEFAULT_CHANNELS> out);
 
 	void processMidiEvent( const MidiEvent&, const f_cnt_t _offset );
 
@@ -156,6 +161,10 @@ protected:
 	bool m_failed;
 private:
 	void resizeSharedProcessingMemory();
+	//! Whether the shared memory is set up, fetches messages until it is
+	bool readyToProcess();
+	//! Runs one period on the current shared memory, returns whether there is output
+	bool runProcessing(bool wantOutput);
 
 
 	QProcess m_process;
@@ -52,6 +52,9 @@ public:
 
 	void abortProcessing();
 
+	/// Frames written by all renderers that have finished so far
+	f_cnt_t framesRendered() const { return m_framesRendered; }
+
 signals:
 	void progressChanged( int );
 	void finished();
@@ -74,6 +77,8 @@ private:
 
 	std::vector<Track*> m_tracksToRender;
 	std::vector<Track*> m_unmuted;
+
+	f_cnt_t m_framesRendered = 0;
 } ;
 
 
@@ -25,6 +25,8 @@
 #ifndef LMMS_GUI_SAMPLE_CLIP_VIEW_H
 #define LMMS_GUI_SAMPLE_CLIP_VIEW_H
 
+#include <optional>
+
 #include "ClipView.h"
 
 #include "SampleThumbnail.h"
@@ -64,10 +66,35 @@ protected:
 
 
 private:
+	//! What the waveform layer was rendered for
+	struct WaveformKey
+	{
+		float pixelsPerBar = 0.f;
+		int height = 0;
+		int revision = -1;
+		QRect sampleRect;
+		QSize size;
+		float amplification = 1.f;
+		bool reversed = false;
+
+		bool operator==(const WaveformKey&) const = default;
+	};
+
+	void renderWaveform(const WaveformKey& key, const SampleThumbnail::VisualizeParameters& parameters);
+	void drawWaveform(QPainter& p, const WaveformKey& key, const QColor& color) const;
+
 	SampleClip * m_clip;
 	SampleThumbnail m_sampleThumbnail;
 	QPixmap m_paintPixmap;
 	long m_paintPixmapXPosition;
+
+	//! Bumped when the sample or its thumbnails change
+	int m_waveformRevision = 0;
+	//! The waveform in a single color, tinted when the clip is painted
+	QPixmap m_waveform;
+	WaveformKey m_waveformKey;
+	//! The newest waveform being rendered on the thread pool
+	std::optional<WaveformKey> m_pendingWaveformKey;
 } ;
 
 
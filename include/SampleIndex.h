@@ -0,0 +1,196 @@
+/*
+ * SampleIndex.h - persistent index of the files in the sample directories
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SAMPLE_INDEX_H
+#define LMMS_SAMPLE_INDEX_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+/**
+	Index of everything below the sample directories, so that the agent tools
+	and the file browser search don't have to walk the filesystem on every
+	lookup.
+
+	The index is loaded from disk on startup and refreshed on a thread of its
+	own, so that it never holds up the ThreadPool: a listing pass first, after
+	which the index is ready, then an analysis pass that decodes new audio
+	files for their length, loudness and tempo. The roots and their top level
+	directories are watched while LMMS runs, and one that changes is rescanned
+	with everything below it, before the analysis continues. Changes deeper
+	down are picked up by the scan on the next start.
+*/
+class LMMS_EXPORT SampleIndex : public QObject
+{
+	Q_OBJECT
+public:
+	struct Entry
+	{
+		QString path;
+		QString name;
+		//! Directory relative to the root it was found in, e.g. "drums/kicks"
+		QString category;
+		qint64 size = 0;
+		qint64 modified = 0; //!< Milliseconds since epoch
+		bool isDir = false;
+		bool hidden = false;
+
+		//! Audio features below are only valid once the file was analysed
+		bool analysed = false;
+		float duration = 0.f; //!< Seconds, 0 if the file could not be decoded
+		int sampleRate = 0;
+		float peak = 0.f; //!< dBFS
+		float loudness = 0.f; //!< RMS level in dBFS
+		float bpm = 0.f; //!< 0 if no tempo was found
+	};
+
+	struct Query
+	{
+		//! Case-insensitive prefix of the file name
+		QString prefix;
+		//! Case-insensitive substrings that must all occur in the file name
+		QStringList tokens;
+		//! Only entries in this category or below it
+		QString category;
+		//! Only entries below this directory
+		QString directory;
+		//! Patterns like "*.wav", empty matches every file
+		QStringList extensions;
+		bool files = true;
+		bool directories = false;
+		bool hidden = false;
+
+		// Entries that weren't analysed (yet) never match a feature filter
+		float minDuration = 0.f;
+		float maxDuration = std::numeric_limits<float>::infinity();
+		float minBpm = 0.f;
+		float maxBpm = std::numeric_limits<float>::infinity();
+		float minLoudness = -std::numeric_limits<float>::infinity();
+		float maxLoudness = std::numeric_limits<float>::infinity();
+
+		//! Maximum number of results, 0 for no limit
+		std::size_t limit = 0;
+	};
+
+	struct Category
+	{
+		QString name;
+		//! The top level directory, in the first root that has it
+		QString path;
+		//! Audio files below it in all roots
+		int fileCount = 0;
+	};
+
+	//! Indexes everything below @p roots and keeps the index in @p cacheFile between sessions
+	SampleIndex(const QStringList& roots, const QString& cacheFile, QObject* parent = nullptr);
+	//! Waits for running scans and saves the index
+	~SampleIndex() override;
+
+	SampleIndex(const SampleIndex&) = delete;
+	SampleIndex& operator=(const SampleIndex&) = delete;
+
+	const QStringList& roots() const { return m_roots; }
+
+	//! True once all roots were listed, or loaded from the cache
+	bool isReady() const { return m_ready.load(std::memory_order_acquire); }
+	void waitUntilReady() const;
+
+	//! True if everything below @p path is in the index
+	bool covers(const QString& path) const;
+
+	//! Entries matching @p query, sorted by name
+	std::vector<Entry> find(const Query& query) const;
+
+	//! Top level directories of all roots, sorted by name
+	std::vector<Category> categories() const;
+
+	//! Queues a rescan of @p dir and everything below it
+	void rescan(const QString& dir);
+
+	static bool isAudioFile(const QString& fileName);
+
+signals:
+	//! Emitted from a worker thread after a scan changed the index
+	void updated();
+
+private:
+	struct Item
+	{
+		QString key; //!< Lower case name, the sort key
+		Entry entry;
+	};
+
+	void processQueue();
+	void list(const QString& dir, const QString& root, bool hidden, std::vector<Entry>& entries,
+		QStringList& dirs, QStringList& visited) const;
+	void merge(const QString& dir, std::vector<Entry> entries);
+	//! Analyses items until all are, returns false if stopped or interrupted by a rescan
+	bool analyse();
+	static void analyse(Entry& entry);
+	static bool lessThan(const Item& a, const Item& b);
+	void setItems(std::vector<Item> items);
+	//! True for the roots and their top level directories, watching every directory would exhaust the system's
+	//! watch limit on large libraries
+	bool isWatched(const QString& dir) const;
+	QString rootOf(const QString& path) const;
+
+	bool load();
+	bool save();
+
+	const QStringList m_roots;
+	const QString m_cacheFile;
+
+	mutable std::shared_mutex m_itemsMutex;
+	std::vector<Item> m_items;
+	std::atomic<bool> m_dirty = false;
+
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCond;
+	QStringList m_pending;
+	std::atomic<bool> m_stop = false;
+	std::thread m_thread;
+
+	std::atomic<bool> m_ready = false;
+	mutable std::mutex m_readyMutex;
+	mutable std::condition_variable m_readyCond;
+
+	QFileSystemWatcher m_watcher;
+};
+
+
+} // namespace lmms
+
+#endif // LMMS_SAMPLE_INDEX_H
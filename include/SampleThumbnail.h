@@ -26,9 +26,13 @@
 #ifndef LMMS_SAMPLE_THUMBNAIL_H
 #define LMMS_SAMPLE_THUMBNAIL_H
 
-#include <QDateTime>
+#include <QFile>
 #include <QRect>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <span>
 
 #include "lmms_export.h"
 #include "SampleBuffer.h"
@@ -50,6 +54,9 @@ class Sample;
    Given that we are dealing with far less data to generate
    the visualization however (i.e., we are not reading from original sample data when drawing), this provides a
    significant performance boost that wouldn't be possible otherwise.
+
+   Thumbnails of long samples are generated on the thread pool and stored in a peak cache file, so opening the
+   same file again only maps that file. Until they are ready, a flat line is drawn instead of the waveform.
  */
 class LMMS_EXPORT SampleThumbnail
 {
@@ -71,9 +78,23 @@ public:
 	};
 
 	SampleThumbnail() = default;
-	SampleThumbnail(const Sample& sample);
+
+	/**
+	   Gets the thumbnails of @p sample, generating them in the background if nobody did yet.
+
+	   @param onReady Called on the GUI thread once the thumbnails are ready, e.g. to repaint. Not called if they
+	   are ready right away.
+	 */
+	SampleThumbnail(const Sample& sample, std::function<void()> onReady = {});
+
+	//! Returns true once visualize() draws the waveform instead of a placeholder.
+	bool ready() const { return !m_thumbnails || m_thumbnails->ready; }
+
 	void visualize(VisualizeParameters parameters, QPainter& painter) const;
 
+	//! Increase whenever the layout of peak cache files changes.
+	static constexpr std::uint32_t PeakCacheVersion = 1;
+
 private:
 	class Thumbnail
 	{
@@ -103,42 +124,52 @@ private:
 
 		Thumbnail() = default;
 		Thumbnail(std::vector<Peak> peaks, double samplesPerPeak);
+		//! Uses peaks owned by somebody else, e.g. a mapped peak cache file.
+		Thumbnail(std::span<const Peak> peaks, double samplesPerPeak);
 		Thumbnail(const float* buffer, size_t size, size_t width);
 
+		// Moving keeps the storage, and with it m_peaks, valid
+		Thumbnail(Thumbnail&&) noexcept = default;
+		Thumbnail& operator=(Thumbnail&&) noexcept = default;
+
 		Thumbnail zoomOut(float factor) const;
 
-		Peak* data() { return m_peaks.data(); }
-		Peak& operator[](size_t index) { return m_peaks[index]; }
+		//! Returns the peak of all samples in [begin, end).
+		static Peak peakOf(const float* begin, const float* end);
+
+		const Peak* data() const { return m_peaks.data(); }
 		const Peak& operator[](size_t index) const { return m_peaks[index]; }
 
 		int width() const { return m_peaks.size(); }
 		double samplesPerPeak() const { return m_samplesPerPeak; }
 
 	private:
-		std::vector<Peak> m_peaks;
+		std::vector<Peak> m_storage;
+		std::span<const Peak> m_peaks;
 		double m_samplesPerPeak = 0.0;
 	};
 
-	struct SampleThumbnailEntry
+	//! The thumbnails of a sample, shared by everybody showing the same file.
+	struct Thumbnails
 	{
-		QString filePath;
-		QDateTime lastModified;
-
-		friend bool operator==(const SampleThumbnailEntry& first, const SampleThumbnailEntry& second)
-		{
-			return first.filePath == second.filePath && first.lastModified == second.lastModified;
-		}
+		std::vector<Thumbnail> levels; //!< From the finest to the coarsest. Written once, before `ready` is set.
+		std::unique_ptr<QFile> peakCache; //!< The mapped file `levels` point into, if it was loaded from disk.
+		QString peakCachePath; //!< Empty if the thumbnails aren't stored on disk.
+		qint64 lastModified = 0;
+
+		std::atomic<bool> ready = false;
+		std::mutex mutex;
+		std::vector<std::function<void()>> onReady; //!< Guarded by `mutex`.
 	};
 
-	struct Hash
-	{
-		std::size_t operator()(const SampleThumbnailEntry& entry) const noexcept { return qHash(entry.filePath); }
-	};
+	static void start(std::shared_ptr<Thumbnails> thumbnails, std::shared_ptr<const SampleBuffer> buffer);
+	static void generate(Thumbnails& thumbnails, const SampleBuffer& buffer);
+	static void publish(Thumbnails& thumbnails);
+	static bool loadPeakCache(Thumbnails& thumbnails, const SampleBuffer& buffer);
+	static void savePeakCache(const Thumbnails& thumbnails, const SampleBuffer& buffer);
 
-	using ThumbnailCache = std::vector<Thumbnail>;
-	std::shared_ptr<ThumbnailCache> m_thumbnailCache = std::make_shared<ThumbnailCache>();
+	std::shared_ptr<Thumbnails> m_thumbnails;
 	std::shared_ptr<const SampleBuffer> m_buffer = SampleBuffer::emptyBuffer();
-	inline static std::unordered_map<SampleThumbnailEntry, std::shared_ptr<ThumbnailCache>, Hash> s_sampleThumbnailCacheMap;
 };
 
 } // namespace lmms
@@ -0,0 +1,101 @@
+/*
+ * SharedFileCache.h - share objects loaded from the same file
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SHARED_FILE_CACHE_H
+#define LMMS_SHARED_FILE_CACHE_H
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QString>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace lmms
+{
+
+/**
+	Keeps one instance of an object loaded from a file, e.g. a sound font,
+	for everybody who asks for the same file, so big files are loaded and
+	held in memory only once.
+
+	The cache only holds weak references: an object is destroyed as soon as
+	its last user releases it, and loaded again when needed again. A file
+	that changed on disk since it was loaded is loaded again, too.
+*/
+template<typename T>
+class SharedFileCache
+{
+public:
+	/**
+		Returns the object loaded from @p path, calling @p load with the
+		absolute path of the file if nobody uses one yet.
+
+		@param load Returns something convertible to std::shared_ptr<T>,
+			nullptr if loading failed. Exceptions are passed on.
+	*/
+	template<typename Load>
+	std::shared_ptr<T> get(const QString& path, Load&& load)
+	{
+		const auto info = QFileInfo{path};
+		const QString canonical = info.canonicalFilePath();
+		const auto key = Key{canonical.isEmpty() ? info.absoluteFilePath() : canonical,
+			info.lastModified().toMSecsSinceEpoch()};
+
+		const auto lock = std::lock_guard{m_mutex};
+		removeExpired();
+
+		if (const auto it = m_entries.find(key); it != m_entries.end())
+		{
+			if (auto object = it->second.lock()) { return object; }
+		}
+
+		auto object = std::shared_ptr<T>{load(key.first)};
+		if (object) { m_entries[key] = object; }
+		return object;
+	}
+
+	//! Number of files that are loaded right now
+	std::size_t size()
+	{
+		const auto lock = std::lock_guard{m_mutex};
+		removeExpired();
+		return m_entries.size();
+	}
+
+private:
+	//! Path and modification time
+	using Key = std::pair<QString, qint64>;
+
+	void removeExpired()
+	{
+		std::erase_if(m_entries, [](const auto& entry) { return entry.second.expired(); });
+	}
+
+	std::map<Key, std::weak_ptr<T>> m_entries;
+	std::mutex m_mutex;
+};
+
+} // namespace lmms
+
+#endif // LMMS_SHARED_FILE_CACHE_H
@@ -27,7 +27,10 @@
 
 #include <array>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include <QPointer>
 #include <QString>
 #include <QHash>  // IWYU pragma: keep
 
@@ -291,7 +294,7 @@ public:
 	}
 
 	//TODO: Add Q_DECL_OVERRIDE when Qt4 is dropped
-	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const override;
+	AutomatedCurveMap automatedCurvesAt(TimePos time, int clipNum = -1) const override;
 
 	// file management
 	void createNewProject();
@@ -448,6 +451,8 @@ private:
 	void restoreKeymapStates(const QDomElement &element);
 
 	void processAutomations(const TrackList& tracks, TimePos timeStart, fpp_t frames);
+	//! Passes the sample-exact automation of @p frames frames to the automated models
+	void renderAutomations(f_cnt_t frameOffsetInPeriod, double frameOffsetInTick, f_cnt_t frames);
 	void processMetronome(size_t bufferOffset);
 
 	void setModified(bool value);
@@ -513,6 +518,8 @@ private:
 	std::shared_ptr<Keymap> m_keymaps[MaxKeymapCount];
 
 	AutomatedValueMap m_oldAutomatedValues;
+	//! The curves the automated models follow during the current tick
+	std::vector<std::pair<QPointer<AutomatableModel>, AutomationCurvePosition>> m_automatedCurves;
 
 	Metronome m_metronome;
 
@@ -0,0 +1,62 @@
+/*
+ * SseParser.h - incremental parser for server-sent event streams
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef LMMS_SSE_PARSER_H
+#define LMMS_SSE_PARSER_H
+
+#include <QByteArray>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+/**
+	Splits a text/event-stream into the data of its events as bytes arrive.
+
+	Received bytes are appended to one buffer and consumed through a read
+	cursor, the consumed prefix is only dropped once it makes up most of the
+	buffer. Feeding a stream therefore takes linear time no matter how the
+	network splits it. Lines may end in \n, \r\n or \r; comments and fields
+	other than data are skipped.
+*/
+class LMMS_EXPORT SseParser
+{
+public:
+	void feed(const QByteArray& bytes);
+
+	/**
+		Extracts the next complete event.
+		@param data receives the event's data lines, joined by \n
+		@return false if more bytes are needed
+	*/
+	bool next(QByteArray& data);
+
+	void reset();
+
+private:
+	//! Returns the end of the line starting at the cursor, or -1 if it's incomplete
+	int lineEnd();
+
+	QByteArray m_buffer;
+	int m_cursor = 0;
+	//! Everything before this has been searched for a line break
+	int m_scanned = 0;
+	//! Data of the event that is being parsed
+	QByteArray m_data;
+	bool m_hasData = false;
+	//! A \r at the end of the buffer might be followed by a \n
+	bool m_skipLineFeed = false;
+};
+
+} // namespace lmms
+
+#endif // LMMS_SSE_PARSER_H
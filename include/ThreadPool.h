@@ -36,9 +36,11 @@
 #include <mutex>
 #include <thread>
 
+#include "lmms_export.h"
+
 namespace lmms {
 //! A thread pool that can be used for asynchronous processing.
-class ThreadPool
+class LMMS_EXPORT ThreadPool
 {
 public:
 	//! Destroys the `ThreadPool` object.
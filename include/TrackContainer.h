@@ -28,6 +28,7 @@
 
 #include <QReadWriteLock>
 
+#include "AutomationCurve.h"
 #include "Track.h"
 #include "JournallingObject.h"
 
@@ -95,13 +96,17 @@ public:
 		return m_TrackContainerType;
 	}
 
-	virtual AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+	//! Values of all models automated at @p time
+	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+
+	//! Curves of all models automated at @p time, and where on them the models are
+	virtual AutomatedCurveMap automatedCurvesAt(TimePos time, int clipNum = -1) const;
 
 signals:
 	void trackAdded( lmms::Track * _track );
 
 protected:
-	static AutomatedValueMap automatedValuesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
+	static AutomatedCurveMap automatedCurvesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
 
 	mutable QReadWriteLock m_tracksMutex;
 
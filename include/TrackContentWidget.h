@@ -25,6 +25,8 @@
 #ifndef LMMS_GUI_TRACK_CONTENT_WIDGET_H
 #define LMMS_GUI_TRACK_CONTENT_WIDGET_H
 
+#include <optional>
+
 #include <QWidget>
 
 #include "JournallingObject.h"
@@ -161,7 +163,20 @@ private:
 	using clipViewVector = QVector<ClipView*>;
 	clipViewVector m_clipViews;
 
+	//! What the background tile was drawn for, it is only redrawn when this changes
+	struct BackgroundKey
+	{
+		int pixelsPerBar;
+		int height;
+		float coarseGridResolution;
+		float fineGridResolution;
+
+		bool operator==(const BackgroundKey&) const = default;
+	};
+
 	QPixmap m_background;
+	//! Reset by the qproperty setters, the tile depends on the theme too
+	std::optional<BackgroundKey> m_backgroundKey;
 
 	// qproperty fields
 	QBrush m_darkerColor;
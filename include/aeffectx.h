@@ -244,8 +244,10 @@ public:
 	// Fill somewhere 28-2b
 	void *ptr1;
 	void *ptr2;
-	// Zeroes 2c-2f 30-33 34-37 38-3b
-	char empty3[4 + 4 + 4];
+	// Frames of latency 30-33
+	int32_t initialDelay;
+	// Zeroes 34-37 38-3b
+	char empty3[4 + 4];
 	// 1.0f 3c-3f
 	float unknown_float;
 	// An object? pointer 40-43
@@ -28,6 +28,7 @@
 
 #include "lmms_export.h"
 
+#include <string>
 #include <vector>
 #include <fftw3.h>
 
@@ -106,6 +107,34 @@ int LMMS_EXPORT compressbands(const float * _absspec_buffer, float * _compressed
 			int _num_old, int _num_new, int _bottom, int _top);
 
 
+/**	Shared FFTW plans.
+ *	Plans are created once per transform size and buffer alignment for the
+ *	whole process and cached; planning is serialized, so this is safe to call
+ *	from any thread. The returned plan belongs to the cache and must not be
+ *	destroyed. Run it on your own buffers with fftwf_execute_dft_r2c() or
+ *	fftwf_execute_dft_c2r(); the buffers must be aligned like the ones passed
+ *	here, which is always the case for buffers from fftwf_malloc().
+ *
+ *	@return the plan, or nullptr if FFTW could not create one
+ */
+fftwf_plan LMMS_EXPORT sharedPlanR2C(unsigned int size, const float *in, const fftwf_complex *out);
+fftwf_plan LMMS_EXPORT sharedPlanC2R(unsigned int size, const fftwf_complex *in, const float *out);
+
+
+/**	Destroy all shared plans. Only call this at shutdown, when no plan is in use anymore.
+ */
+void LMMS_EXPORT destroySharedPlans();
+
+
+/**	Import/export FFTW wisdom, so FFTW_MEASURE planning is instant after the
+ *	first run. Saving is skipped if no new plans were measured.
+ *
+ *	@return true on success
+ */
+bool LMMS_EXPORT loadFFTWisdom(const std::string &path);
+bool LMMS_EXPORT saveFFTWisdom(const std::string &path);
+
+
 } // namespace lmms
 
 #endif // LMMS_FFT_HELPERS_H
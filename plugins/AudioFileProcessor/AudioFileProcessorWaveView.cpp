@@ -33,6 +33,7 @@
 
 #include <QPainter>
 #include <QMouseEvent>
+#include <QPointer>
 
 #include <algorithm>
 
@@ -77,6 +78,7 @@ AudioFileProcessorWaveView::AudioFileProcessorWaveView(QWidget* parent, int w, i
 	m_last_from(0),
 	m_last_to(0),
 	m_last_amp(0),
+	m_last_thumbnailReady(false),
 	m_startKnob(start),
 	m_endKnob(end),
 	m_loopKnob(loop),
@@ -333,7 +335,8 @@ void AudioFileProcessorWaveView::updateGraph()
 	{
 		reverse();
 	}
-	else if (m_last_from == m_from && m_last_to == m_to && m_sample->amplification() == m_last_amp)
+	else if (m_last_from == m_from && m_last_to == m_to && m_sample->amplification() == m_last_amp
+		&& m_last_thumbnailReady == m_sampleThumbnail.ready())
 	{
 		return;
 	}
@@ -346,7 +349,10 @@ void AudioFileProcessorWaveView::updateGraph()
 	QPainter p(&m_graph);
 	p.setPen(QColor(255, 255, 255));
 
-	m_sampleThumbnail = SampleThumbnail{*m_sample};
+	m_sampleThumbnail = SampleThumbnail{*m_sample, [view = QPointer{this}] {
+		if (view) { view->update(); }
+	}};
+	m_last_thumbnailReady = m_sampleThumbnail.ready();
 
 	const auto param = SampleThumbnail::VisualizeParameters{
 		.sampleRect = m_graph.rect(),
@@ -130,6 +130,7 @@ private:
 	int m_last_from;
 	int m_last_to;
 	float m_last_amp;
+	bool m_last_thumbnailReady;
 	knob* m_startKnob;
 	knob* m_endKnob;
 	knob* m_loopKnob;
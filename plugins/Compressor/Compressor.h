@@ -47,6 +47,12 @@ public:
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 	void processBypassedImpl() override;
 
+	//! Lookahead always delays by its longest length, the knob only moves the sidechain
+	f_cnt_t latency() const override
+	{
+		return m_compressorControls.m_lookaheadModel.value() ? m_lookBufLength : 0;
+	}
+
 	EffectControls* controls() override
 	{
 		return &m_compressorControls;
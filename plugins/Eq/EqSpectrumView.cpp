@@ -46,7 +46,7 @@ EqAnalyser::EqAnalyser() :
 	using namespace std::numbers;
 	m_inProgress=false;
 	m_specBuf = ( fftwf_complex * ) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
-	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
+	m_fftPlan = sharedPlanR2C( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf );
 
 	//initialize Blackman-Harris window, constants taken from
 	//https://en.wikipedia.org/wiki/Window_function#A_list_of_window_functions
@@ -69,7 +69,6 @@ EqAnalyser::EqAnalyser() :
 
 EqAnalyser::~EqAnalyser()
 {
-	fftwf_destroy_plan( m_fftPlan );
 	fftwf_free( m_specBuf );
 }
 
@@ -113,7 +112,7 @@ void EqAnalyser::analyze( SampleFrame* buf, const fpp_t frames )
 			m_buffer[i] = m_buffer[i] * m_fftWindow[i];
 		}
 
-		fftwf_execute( m_fftPlan );
+		fftwf_execute_dft_r2c( m_fftPlan, m_buffer, m_specBuf );
 		absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
 
 		compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
@@ -30,6 +30,7 @@
 
 #include "GigPlayer.h"
 
+#include <algorithm>
 #include <cstring>
 #include <QDebug>
 #include <QLayout>
@@ -48,6 +49,7 @@
 #include "NotePlayHandle.h"
 #include "PathUtil.h"
 #include "Sample.h"
+#include "SharedFileCache.h"
 #include "Song.h"
 
 #include "PatchesDialog.h"
@@ -78,6 +80,63 @@ Plugin::Descriptor PLUGIN_EXPORT gigplayer_plugin_descriptor =
 
 }
 
+
+
+
+std::vector<gig::Sample*> GigInstance::useSamples( const std::vector<gig::Region*>& regions )
+{
+	std::vector<gig::Sample*> samples;
+	for( gig::Region* pRegion : regions )
+	{
+		for( uint32_t i = 0; i < pRegion->DimensionRegions; ++i )
+		{
+			gig::Sample* pSample = pRegion->pDimensionRegions[i]->pSample;
+			if( pSample != nullptr && pSample->SamplesTotal != 0 )
+			{
+				samples.push_back( pSample );
+			}
+		}
+	}
+	std::sort( samples.begin(), samples.end() );
+	samples.erase( std::unique( samples.begin(), samples.end() ), samples.end() );
+
+	for( gig::Sample* pSample : samples )
+	{
+		if( m_sampleUsers[pSample]++ == 0 )
+		{
+			try
+			{
+				pSample->LoadSampleData();
+			}
+			catch( ... )
+			{
+				// plays as silence
+			}
+		}
+	}
+
+	return samples;
+}
+
+
+
+
+void GigInstance::releaseSamples( const std::vector<gig::Sample*>& samples )
+{
+	for( gig::Sample* pSample : samples )
+	{
+		auto users = m_sampleUsers.find( pSample );
+		if( --users->second == 0 )
+		{
+			pSample->ReleaseSampleData();
+			m_sampleUsers.erase( users );
+		}
+	}
+}
+
+
+
+
 GigInstrument::GigInstrument(InstrumentTrack* _instrument_track)
 	: Instrument(_instrument_track, &gigplayer_plugin_descriptor, nullptr, Flag::IsSingleStreamed | Flag::IsNotBendable)
 	, m_instance(nullptr)
@@ -186,14 +245,21 @@ void GigInstrument::freeInstance()
 
 	if( m_instance != nullptr )
 	{
-		delete m_instance;
-		m_instance = nullptr;
+		const std::shared_ptr<GigInstance> instance = std::move( m_instance );
 
 		// If we're changing instruments, we got to make sure that we
 		// remove all pointers to the old samples and don't try accessing
 		// that instrument again
 		m_instrument = nullptr;
+		m_regions.clear();
 		m_notes.clear();
+
+		notesLock.unlock();
+		synthLock.unlock();
+
+		QMutexLocker instanceLocker( &instance->mutex );
+		instance->releaseSamples( m_samples );
+		m_samples.clear();
 	}
 }
 
@@ -212,7 +278,11 @@ void GigInstrument::openFile( const QString & _gigFile, bool updateTrackName )
 
 		try
 		{
-			m_instance = new GigInstance( PathUtil::toAbsolute( _gigFile ) );
+			// Instruments using the same file share it
+			static auto s_instances = SharedFileCache<GigInstance>{};
+			m_instance = s_instances.get( PathUtil::toAbsolute( _gigFile ), []( const QString& path ) {
+				return std::make_shared<GigInstance>( path );
+			} );
 			m_filename = PathUtil::toShortestRelative( _gigFile );
 		}
 		catch( ... )
@@ -257,6 +327,7 @@ QString GigInstrument::getCurrentPatchName()
 	int iBankSelected = m_bankNum.value();
 	int iProgSelected = m_patchNum.value();
 
+	QMutexLocker instanceLocker( &m_instance->mutex );
 	gig::Instrument * pInstrument = m_instance->gig.GetFirstInstrument();
 
 	while( pInstrument != nullptr )
@@ -521,6 +592,22 @@ void GigInstrument::loadSample( GigSample& sample, SampleFrame* sampleData, f_cn
 	unsigned long allocationsize = samples * sample.sample->FrameSize;
 	int8_t buffer[allocationsize];
 
+	// The sample was loaded into memory by GigInstance::useSamples(), reading
+	// it from the file would need the read position kept in the shared file
+	const gig::buffer_t cache = sample.sample->GetCache();
+	const auto cachedFrames = static_cast<f_cnt_t>( cache.Size / sample.sample->FrameSize );
+
+	// Copies up to count frames from pos on, returns how many there were
+	const auto read = [&]( f_cnt_t pos, f_cnt_t count, int8_t* dest ) -> f_cnt_t
+	{
+		const f_cnt_t available = pos < cachedFrames ? std::min( count, cachedFrames - pos ) : 0;
+		std::memcpy( dest, static_cast<const int8_t*>( cache.pStart ) + pos * sample.sample->FrameSize,
+				available * sample.sample->FrameSize );
+		return available;
+	};
+
+	f_cnt_t totalreadsamples = 0;
+
 	// Load the sample in different ways depending on if we're looping or not
 	if( loop == true && ( sample.pos >= loopStart || sample.pos + samples > loopStart ) )
 	{
@@ -535,39 +622,30 @@ void GigInstrument::loadSample( GigSample& sample, SampleFrame* sampleData, f_cn
 			// TODO: also implement loop_type_backward support
 		}
 
-		sample.sample->SetPos( sample.pos );
-
 		// Load the samples (based on gig::Sample::ReadAndLoop) even around the end
 		// of a loop boundary wrapping to the beginning of the loop region
-		long samplestoread = samples;
-		long samplestoloopend = 0;
-		long readsamples = 0;
-		long totalreadsamples = 0;
-		long loopEnd = loopStart + loopLength;
+		f_cnt_t pos = sample.pos;
+		f_cnt_t readsamples = 0;
+		const f_cnt_t loopEnd = loopStart + loopLength;
 
 		do
 		{
-			samplestoloopend = loopEnd - sample.sample->GetPos();
-			readsamples = sample.sample->Read( &buffer[totalreadsamples * sample.sample->FrameSize],
-					std::min( samplestoread, samplestoloopend ) );
-			samplestoread -= readsamples;
+			const f_cnt_t samplestoloopend = loopEnd - pos;
+			readsamples = read( pos, std::min( samples - totalreadsamples, samplestoloopend ),
+					&buffer[totalreadsamples * sample.sample->FrameSize] );
 			totalreadsamples += readsamples;
-
-			if( readsamples >= samplestoloopend )
-			{
-				sample.sample->SetPos( loopStart );
-			}
+			pos = readsamples >= samplestoloopend ? loopStart : pos + readsamples;
 		}
-		while( samplestoread > 0 && readsamples > 0 );
+		while( totalreadsamples < samples && readsamples > 0 );
 	}
 	else
 	{
-		sample.sample->SetPos( sample.pos );
-
-		unsigned long size = sample.sample->Read( &buffer, samples ) * sample.sample->FrameSize;
-		std::memset( (int8_t*) &buffer + size, 0, allocationsize - size );
+		totalreadsamples = read( sample.pos, samples, buffer );
 	}
 
+	std::memset( &buffer[totalreadsamples * sample.sample->FrameSize], 0,
+			allocationsize - totalreadsamples * sample.sample->FrameSize );
+
 	// Convert from 16 or 24 bit into 32-bit float
 	if( sample.sample->BitDepth == 24 ) // 24 bit
 	{
@@ -695,8 +773,9 @@ gui::PluginView* GigInstrument::instantiateView( QWidget * _parent )
 // Add the desired samples (either the normal samples or the release samples)
 // to the GigNote
 //
-// Note: not thread safe since libgig stores current region position data in
-// the instrument object
+// Note: libgig stores current region position data in the instrument object,
+// which is shared with other instruments using the same file, so the regions
+// are taken from m_regions
 void GigInstrument::addSamples( GigNote & gignote, bool wantReleaseSample )
 {
 	// Change key dimension, e.g. change samples based on what key is pressed
@@ -711,9 +790,7 @@ void GigInstrument::addSamples( GigNote & gignote, bool wantReleaseSample )
 					m_instrument->DimensionKeyRange.low + 1 );
 	}
 
-	gig::Region* pRegion = m_instrument->GetFirstRegion();
-
-	while( pRegion != nullptr )
+	for( gig::Region* pRegion : m_regions )
 	{
 		Dimension dim = getDimensions( pRegion, gignote.velocity, wantReleaseSample );
 		gig::DimensionRegion * pDimRegion = pRegion->GetDimensionRegionByValue( dim.DimValues );
@@ -755,8 +832,6 @@ void GigInstrument::addSamples( GigNote & gignote, bool wantReleaseSample )
 				gignote.samples.emplace_back(pSample, pDimRegion, attenuation, AudioResampler::Mode::Linear, gignote.frequency);
 			}
 		}
-
-		pRegion = m_instrument->GetNextRegion();
 	}
 }
 
@@ -850,10 +925,11 @@ void GigInstrument::getInstrument()
 	int iBankSelected = m_bankNum.value();
 	int iProgSelected = m_patchNum.value();
 
-	QMutexLocker locker( &m_synthMutex );
-
+	// Only this thread changes m_instance, and the samples are loaded before
+	// playback is locked
 	if( m_instance != nullptr )
 	{
+		QMutexLocker instanceLocker( &m_instance->mutex );
 		gig::Instrument * pInstrument = m_instance->gig.GetFirstInstrument();
 
 		while( pInstrument != nullptr )
@@ -869,7 +945,29 @@ void GigInstrument::getInstrument()
 			pInstrument = m_instance->gig.GetNextInstrument();
 		}
 
+		if( pInstrument == m_instrument )
+		{
+			return;
+		}
+
+		std::vector<gig::Region*> regions;
+		for( gig::Region* pRegion = pInstrument != nullptr ? pInstrument->GetFirstRegion() : nullptr;
+				pRegion != nullptr; pRegion = pInstrument->GetNextRegion() )
+		{
+			regions.push_back( pRegion );
+		}
+		std::vector<gig::Sample*> samples = m_instance->useSamples( regions );
+
+		QMutexLocker locker( &m_synthMutex );
+		QMutexLocker notesLocker( &m_notesMutex );
+
+		// The notes may play samples that are freed now
+		m_notes.clear();
+		m_instance->releaseSamples( m_samples );
+
 		m_instrument = pInstrument;
+		m_regions = std::move( regions );
+		m_samples = std::move( samples );
 	}
 }
 
@@ -1065,7 +1163,7 @@ void GigInstrumentView::showPatchDialog()
 {
 	auto k = castModel<GigInstrument>();
 	PatchesDialog pd( this );
-	pd.setup( k->m_instance, 1, k->instrumentTrack()->name(), &k->m_bankNum, &k->m_patchNum, m_patchLabel );
+	pd.setup( k->m_instance.get(), 1, k->instrumentTrack()->name(), &k->m_bankNum, &k->m_patchNum, m_patchLabel );
 	pd.exec();
 }
 
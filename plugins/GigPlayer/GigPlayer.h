@@ -27,6 +27,9 @@
 #ifndef GIG_PLAYER_H
 #define GIG_PLAYER_H
 
+#include <map>
+#include <memory>
+#include <vector>
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
@@ -69,7 +72,7 @@ struct GIGPluginData
 
 
 
-// Load a GIG file using libgig
+// Load a GIG file using libgig, shared by all instruments using the file
 class GigInstance
 {
 public:
@@ -83,6 +86,21 @@ private:
 
 public:
 	gig::File gig;
+
+	// libgig keeps the read positions of the samples and the instrument
+	// iterator in the file, lock this while using them. Only the GUI thread
+	// does, playback reads the samples loaded by useSamples().
+	QMutex mutex;
+
+	// Loads the samples of the regions into memory, unless another
+	// instrument already did, and returns them. mutex must be held.
+	std::vector<gig::Sample*> useSamples( const std::vector<gig::Region*>& regions );
+	// Frees the samples once no instrument uses them anymore. mutex must be held.
+	void releaseSamples( const std::vector<gig::Sample*>& samples );
+
+private:
+	// Number of instruments using each loaded sample
+	std::map<gig::Sample*, int> m_sampleUsers;
 } ;
 
 
@@ -275,8 +293,12 @@ public slots:
 
 private:
 	// The GIG file and instrument we're using
-	GigInstance * m_instance;
+	std::shared_ptr<GigInstance> m_instance;
 	gig::Instrument * m_instrument;
+	// The regions of m_instrument, since iterating them changes the shared file
+	std::vector<gig::Region*> m_regions;
+	// The samples of m_regions, which stay in memory while we use them
+	std::vector<gig::Sample*> m_samples;
 
 	// Part of the UI
 	QString m_filename;
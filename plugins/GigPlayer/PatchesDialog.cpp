@@ -143,6 +143,7 @@ void PatchesDialog::setup( GigInstance * pSynth, int iChan,
 	int iBankDefault = -1;
 	int iProgDefault = -1;
 
+	QMutexLocker synthLocker( &m_pSynth->mutex );
 	gig::Instrument * pInstrument = m_pSynth->gig.GetFirstInstrument();
 
 	while( pInstrument )
@@ -341,6 +342,7 @@ void PatchesDialog::bankChanged()
 	m_progListView->clear();
 	QTreeWidgetItem * pProgItem = nullptr;
 
+	QMutexLocker synthLocker( &m_pSynth->mutex );
 	gig::Instrument * pInstrument = m_pSynth->gig.GetFirstInstrument();
 
 	while( pInstrument )
@@ -125,19 +125,20 @@ Effect::ProcessStatus GranularPitchShifterEffect::processImpl(SampleFrame* buf,
 				speed[1] / m_speed[1]
 			};
 			
-			for (int i = 0; i < m_grainCount; ++i)
+			for (int j = 0; j < 2; ++j)
 			{
-				for (int j = 0; j < 2; ++j)
+				for (int i = 0; i < m_grains.count; ++i)
 				{
-					m_grains[i].grainSpeed[j] *= ratio[j];
+					double& grainSpeed = m_grains.grainSpeed[j][i];
+					grainSpeed *= ratio[j];
 					
 					// we unfortunately need to do extra stuff to ensure these don't shoot past the write index...
-					if (m_grains[i].grainSpeed[j] > 1)
+					if (grainSpeed > 1)
 					{
-						double distance = m_writePoint - m_grains[i].readPoint[j] - SafetyLatency;
+						double distance = m_writePoint - m_grains.readPoint[j][i] - SafetyLatency;
 						if (distance <= 0) { distance += m_ringBufLength; }
-						double grainSpeedRequired = ((m_grains[i].grainSpeed[j] - 1.) / distance) * (1. - m_grains[i].phase);
-						m_grains[i].phaseSpeed[j] = std::max(m_grains[i].phaseSpeed[j], grainSpeedRequired);
+						double grainSpeedRequired = ((grainSpeed - 1.) / distance) * (1. - m_grains.phase[i]);
+						m_grains.phaseSpeed[j][i] = std::max(m_grains.phaseSpeed[j][i], grainSpeedRequired);
 					}
 				}
 			}
@@ -175,32 +176,49 @@ Effect::ProcessStatus GranularPitchShifterEffect::processImpl(SampleFrame* buf,
 				if (readPoint[i] < 0) { readPoint[i] += m_ringBufLength; }
 			}
 			const double phaseInc = 1. / sizeSamples;
-			m_grains.push_back(Grain(grainSpeed * m_speed[0], grainSpeed * m_speed[1], phaseInc, phaseInc, readPoint[0], readPoint[1]));
-			++m_grainCount;
+			// skipped in the unlikely case that all grains are in use
+			if (!m_grains.full())
+			{
+				m_grains.add(grainSpeed * m_speed[0], grainSpeed * m_speed[1], phaseInc, phaseInc, readPoint[0], readPoint[1]);
+			}
 		}
 		
-		for (int i = 0; i < m_grainCount; ++i)
+		for (int i = 0; i < m_grains.count; ++i)
 		{
-			m_grains[i].phase += std::max(m_grains[i].phaseSpeed[0], m_grains[i].phaseSpeed[1]);
-			if (m_grains[i].phase >= 1)
+			m_grains.phase[i] += std::max(m_grains.phaseSpeed[0][i], m_grains.phaseSpeed[1][i]);
+			if (m_grains.phase[i] >= 1)
 			{
 				// grain is done, delete it
-				std::swap(m_grains[i], m_grains[m_grainCount-1]);
-				m_grains.pop_back();
+				m_grains.remove(i);
 				--i;
-				--m_grainCount;
-				continue;
 			}
-			
-			m_grains[i].readPoint[0] += m_grains[i].grainSpeed[0];
-			m_grains[i].readPoint[1] += m_grains[i].grainSpeed[1];
-			if (m_grains[i].readPoint[0] >= m_ringBufLength) { m_grains[i].readPoint[0] -= m_ringBufLength; }
-			if (m_grains[i].readPoint[1] >= m_ringBufLength) { m_grains[i].readPoint[1] -= m_ringBufLength; }
-			
-			const float fadePos = std::clamp((-std::abs(-2.f * static_cast<float>(m_grains[i].phase) + 1.f) + 0.5f) * fadeLength + 0.5f, 0.f, 1.f);
-			const float windowVal = cosHalfWindowApprox(fadePos, shapeK);
-			s[0] += getHermiteSample(m_grains[i].readPoint[0], 0) * windowVal;
-			s[1] += getHermiteSample(m_grains[i].readPoint[1], 1) * windowVal;
+		}
+		
+		// the remaining grains are all processed the same way, one property at a time
+		const int grainCount = m_grains.count;
+		for (int j = 0; j < 2; ++j)
+		{
+			auto& readPoint = m_grains.readPoint[j];
+			const auto& grainSpeed = m_grains.grainSpeed[j];
+			for (int i = 0; i < grainCount; ++i)
+			{
+				readPoint[i] += grainSpeed[i];
+				readPoint[i] -= readPoint[i] >= m_ringBufLength ? m_ringBufLength : 0;
+			}
+		}
+		
+		for (int i = 0; i < grainCount; ++i)
+		{
+			const float fadePos = std::clamp((-std::abs(-2.f * static_cast<float>(m_grains.phase[i]) + 1.f) + 0.5f) * fadeLength + 0.5f, 0.f, 1.f);
+			m_grains.window[i] = cosHalfWindowApprox(fadePos, shapeK);
+		}
+		
+		for (int j = 0; j < 2; ++j)
+		{
+			for (int i = 0; i < grainCount; ++i)
+			{
+				s[j] += getHermiteSample(m_grains.readPoint[j][i], j) * m_grains.window[i];
+			}
 		}
 		
 		// note that adding two signals together, when uncorrelated, results in a signal power multiplication of sqrt(2), not 2
@@ -265,9 +283,7 @@ void GranularPitchShifterEffect::changeSampleRate()
 	
 	m_updatePitches = true;
 	
-	m_grains.clear();
-	m_grainCount = 0;
-	m_grains.reserve(8);// arbitrary
+	m_grains.count = 0;
 	
 	m_dcCoeff = std::exp(-2 * std::numbers::pi_v<float> * DcRemovalHz / m_sampleRate);
 
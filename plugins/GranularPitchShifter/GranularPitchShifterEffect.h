@@ -25,6 +25,7 @@
 #ifndef LMMS_GRANULAR_PITCH_SHIFTER_EFFECT_H
 #define LMMS_GRANULAR_PITCH_SHIFTER_EFFECT_H
 
+#include <algorithm>
 #include <numbers>
 
 #include "Effect.h"
@@ -42,6 +43,8 @@ constexpr float RangeSeconds[5] = {5, 10, 40, 40, 120};
 constexpr float DcRemovalHz = 7.f;
 constexpr float SatuSafeVol = 16.f;
 constexpr float SatuStrength = 0.001f;
+// at most about 4 * density grains overlap, more only when the size is automated quickly
+constexpr int MaxGrains = 512;
 
 
 class GranularPitchShifterEffect : public Effect
@@ -52,6 +55,13 @@ public:
 
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 
+	//! Grains read this far behind the input without pitch shifting, shifting up reads further back
+	f_cnt_t latency() const override
+	{
+		const auto minLatency = static_cast<int>(m_granularpitchshifterControls.m_minLatencyModel.value() * m_sampleRate);
+		return std::max(minLatency, SafetyLatency);
+	}
+
 	EffectControls* controls() override
 	{
 		return &m_granularpitchshifterControls;
@@ -139,24 +149,49 @@ private:
 		}
 	};
 
-	struct Grain
+	//! All grains, one array per property and channel so the loops over them
+	//! vectorize. The active grains are the first `count` ones, a finished
+	//! grain is replaced with the last one. Never allocates.
+	struct GrainPool
 	{
-		Grain(double grainSpeedL, double grainSpeedR, double phaseSpeedL, double phaseSpeedR, double readPointL, double readPointR) :
-			readPoint{readPointL, readPointR},
-			phaseSpeed{phaseSpeedL, phaseSpeedR},
-			grainSpeed{grainSpeedL, grainSpeedR},
-			phase{0}
-		{}
-		std::array<double, 2> readPoint;
-		std::array<double, 2> phaseSpeed;
-		std::array<double, 2> grainSpeed;
-		double phase;
+		std::array<std::array<double, MaxGrains>, 2> readPoint;
+		std::array<std::array<double, MaxGrains>, 2> phaseSpeed;
+		std::array<std::array<double, MaxGrains>, 2> grainSpeed;
+		std::array<double, MaxGrains> phase;
+		std::array<float, MaxGrains> window;
+		int count = 0;
+
+		bool full() const { return count == MaxGrains; }
+
+		void add(double grainSpeedL, double grainSpeedR, double phaseSpeedL, double phaseSpeedR, double readPointL, double readPointR)
+		{
+			readPoint[0][count] = readPointL;
+			readPoint[1][count] = readPointR;
+			phaseSpeed[0][count] = phaseSpeedL;
+			phaseSpeed[1][count] = phaseSpeedR;
+			grainSpeed[0][count] = grainSpeedL;
+			grainSpeed[1][count] = grainSpeedR;
+			phase[count] = 0;
+			++count;
+		}
+
+		void remove(int i)
+		{
+			--count;
+			for (int ch = 0; ch < 2; ++ch)
+			{
+				readPoint[ch][i] = readPoint[ch][count];
+				phaseSpeed[ch][i] = phaseSpeed[ch][count];
+				grainSpeed[ch][i] = grainSpeed[ch][count];
+			}
+			phase[i] = phase[count];
+		}
 	};
 	
 	GranularPitchShifterControls m_granularpitchshifterControls;
 	
 	std::vector<std::array<float, 2>> m_ringBuf;
-	std::vector<Grain> m_grains;
+	GrainPool m_grains;
 
 	std::array<PrefilterLowpass, 2> m_prefilter;
 	std::array<double, 2> m_speed = {1, 1};
@@ -170,7 +205,6 @@ private:
 
 	int m_ringBufLength = 0;
 	int m_writePoint = 0;
-	int m_grainCount = 0;
 	int m_timeSinceLastGrain = 999999999;
 
 	double m_oldGlide = -1;
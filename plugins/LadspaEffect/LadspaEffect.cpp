@@ -26,6 +26,7 @@
 
 #include <QVarLengthArray>
 #include <QMessageBox>
+#include <algorithm>
 
 #include "LadspaEffect.h"
 #include "DataFile.h"
@@ -126,6 +127,46 @@ void LadspaEffect::changeSampleRate()
 
 
 Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t frames)
+{
+	return process(frames,
+		[&](ch_cnt_t channel, LADSPA_Data* dst) {
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				dst[frame] = buf[frame][channel];
+			}
+		},
+		[&](ch_cnt_t channel, const LADSPA_Data* src, float d, float w) {
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				buf[frame][channel] = d * buf[frame][channel] + w * src[frame];
+			}
+		});
+}
+
+
+
+
+Effect::ProcessStatus LadspaEffect::processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS> buf)
+{
+	const fpp_t frames = buf.frames();
+	return process(frames,
+		[&](ch_cnt_t channel, LADSPA_Data* dst) {
+			std::copy_n(buf.bufferPtr(channel), frames, dst);
+		},
+		[&](ch_cnt_t channel, const LADSPA_Data* src, float d, float w) {
+			float* out = buf.bufferPtr(channel);
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				out[frame] = d * out[frame] + w * src[frame];
+			}
+		});
+}
+
+
+
+
+template<class ReadChannel, class MixChannel>
+Effect::ProcessStatus LadspaEffect::process(fpp_t frames, ReadChannel readChannel, MixChannel mixChannel)
 {
 	m_pluginMutex.lock();
 	if (!isOkay() || dontRun() || !isEnabled() || !isRunning())
@@ -145,10 +186,7 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 			switch( pp->rate )
 			{
 				case BufferRate::ChannelIn:
-					for (fpp_t frame = 0; frame < frames; ++frame)
-					{
-						pp->buffer[frame] = buf[frame][channel];
-					}
+					readChannel(channel, pp->buffer);
 					++channel;
 					break;
 				case BufferRate::AudioRateInput:
@@ -215,10 +253,7 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 				case BufferRate::ControlRateInput:
 					break;
 				case BufferRate::ChannelOut:
-					for (fpp_t frame = 0; frame < frames; ++frame)
-					{
-						buf[frame][channel] = d * buf[frame][channel] + w * pp->buffer[frame];
-					}
+					mixChannel(channel, pp->buffer, d, w);
 					++channel;
 					break;
 				case BufferRate::AudioRateOutput:
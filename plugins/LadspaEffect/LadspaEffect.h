@@ -48,6 +48,13 @@ public:
 	~LadspaEffect() override;
 
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS> buf) override;
+
+	//! LADSPA ports are planar, so consecutive LADSPA effects skip the interleaving
+	bool processesPlanar() const override
+	{
+		return true;
+	}
 
 	void setControl( int _control, LADSPA_Data _data );
 
@@ -74,6 +81,14 @@ private:
 	void pluginInstantiation();
 	void pluginDestruction();
 
+	/**
+	 * Runs the plugin for both buffer layouts: @p readChannel(channel, dst) copies
+	 * one input channel into a port buffer, @p mixChannel(channel, src, dry, wet)
+	 * mixes a port buffer into one output channel.
+	 */
+	template<class ReadChannel, class MixChannel>
+	ProcessStatus process(fpp_t frames, ReadChannel readChannel, MixChannel mixChannel);
+
 	static sample_rate_t maxSamplerate( const QString & _name );
 
 	QMutex m_pluginMutex;
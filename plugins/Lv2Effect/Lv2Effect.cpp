@@ -61,7 +61,8 @@ Plugin::Descriptor PLUGIN_EXPORT lv2effect_plugin_descriptor =
 Lv2Effect::Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key *key) :
 	Effect(&lv2effect_plugin_descriptor, parent, key),
 	m_controls(this, key->attributes["uri"]),
-	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod())
+	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod()),
+	m_tmpPlanarSmps(Engine::audioEngine()->framesPerPeriod() * DEFAULT_CHANNELS)
 {
 }
 
@@ -97,6 +98,45 @@ Effect::ProcessStatus Lv2Effect::processImpl(SampleFrame* buf, const fpp_t frame
 
 
 
+Effect::ProcessStatus Lv2Effect::processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS> buf)
+{
+	const fpp_t frames = buf.frames();
+	Q_ASSERT(frames <= static_cast<fpp_t>(m_tmpOutputSmps.size()));
+
+	float* tmpChannels[DEFAULT_CHANNELS];
+	for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		tmpChannels[ch] = m_tmpPlanarSmps.data() + ch * frames;
+	}
+	const auto tmp = PlanarBufferView<float, DEFAULT_CHANNELS>{tmpChannels, frames};
+
+	m_controls.copyBuffersFromLmms(buf);
+	m_controls.copyModelsFromLmms();
+
+	m_controls.run(frames);
+
+	m_controls.copyModelsToLmms();
+	m_controls.copyBuffersToLmms(tmp);
+
+	bool corrupt = wetLevel() < 0; // #3261 - if w < 0, bash w := 0, d := 1
+	const float d = corrupt ? 1 : dryLevel();
+	const float w = corrupt ? 0 : wetLevel();
+	for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		float* out = buf.bufferPtr(ch);
+		const float* wet = tmp.bufferPtr(ch);
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			out[f] = d * out[f] + w * wet[f];
+		}
+	}
+
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
 extern "C"
 {
 
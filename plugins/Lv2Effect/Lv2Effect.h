@@ -43,6 +43,8 @@ public:
 	Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key* _key);
 
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS> buf) override;
+	bool processesPlanar() const override { return true; }
 
 	EffectControls* controls() override { return &m_controls; }
 
@@ -52,6 +54,8 @@ public:
 private:
 	Lv2FxControls m_controls;
 	std::vector<SampleFrame> m_tmpOutputSmps;
+	//! Output of the planar path, one channel after another
+	std::vector<float> m_tmpPlanarSmps;
 };
 
 
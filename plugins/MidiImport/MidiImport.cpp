@@ -25,12 +25,17 @@
 
 #include <QDir>
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QMessageBox>
 #include <QProgressDialog>
 
+#include <algorithm>
+#include <future>
+#include <optional>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
 #include "MidiImport.h"
 #include "TrackContainer.h"
@@ -44,6 +49,7 @@
 #include "MainWindow.h"
 #include "TimePos.h"
 #include "Song.h"
+#include "ThreadPool.h"
 
 #include "plugin_export.h"
 
@@ -141,6 +147,9 @@ public:
 	AutomationTrack* at = nullptr;
 	AutomationClip* ap = nullptr;
 	TimePos lastPos = 0;
+	//! Values of the current clip, relative to its start. Put in one go since
+	//! controllers can send thousands of them
+	std::vector<std::pair<TimePos, float>> values;
 
 	smfMidiCC& create(TrackContainer* tc, QString tn)
 	{
@@ -159,6 +168,7 @@ public:
 
 	void clear()
 	{
+		flush();
 		at = nullptr;
 		ap = nullptr;
 		lastPos = 0;
@@ -169,17 +179,27 @@ public:
 	{
 		if (!ap || time > lastPos + DefaultTicksPerBar)
 		{
+			flush();
 			TimePos pPos = TimePos(time.getBar(), 0);
 			ap = dynamic_cast<AutomationClip*>(at->createClip(pPos));
 			ap->addObject(objModel);
 		}
 
 		lastPos = time;
-		time = time - ap->startPosition();
-		ap->putValue(time, value, false);
-		ap->changeLength(TimePos(time.getBar() + 1, 0));
+		values.emplace_back(time - ap->startPosition(), value);
 		return *this;
 	}
+
+
+	//! Puts the collected values into the current clip
+	void flush()
+	{
+		if (!ap || values.empty()) { return; }
+
+		ap->putValues(values);
+		ap->changeLength(TimePos(values.back().first.getBar() + 1, 0));
+		values.clear();
+	}
 };
 
 
@@ -194,6 +214,18 @@ public:
 	bool isSF2 = false;
 	bool hasNotes = false;
 	QString trackName;
+	//! Collected during import and distributed over the clips in one go
+	std::vector<Note> notes;
+
+	//! A program or bank change, applied by loadInstrument()
+	struct InstrumentChange
+	{
+		bool bank;
+		double time;
+		double value;
+		QString trackName;
+	};
+	std::vector<InstrumentChange> instrumentChanges;
 
 	smfMidiChannel* create(TrackContainer* tc, QString tn)
 	{
@@ -201,21 +233,6 @@ public:
 			// Keep LMMS responsive
 			qApp->processEvents();
 			it = dynamic_cast<InstrumentTrack*>(Track::create(Track::Type::Instrument, tc));
-
-#ifdef LMMS_HAVE_FLUIDSYNTH
-			it_inst = it->loadInstrument("sf2player");
-
-			if (it_inst)
-			{
-				isSF2 = true;
-				it_inst->loadFile(ConfigManager::inst()->sf2File());
-				it_inst->childModel("bank")->setValue(0);
-				it_inst->childModel("patch")->setValue(0);
-			}
-			else { it_inst = it->loadInstrument("patman"); }
-#else
-			it_inst = it->loadInstrument("patman");
-#endif
 			trackName = tn;
 			if (trackName != "") { it->setName(tn); }
 			// General MIDI default
@@ -227,10 +244,80 @@ public:
 	}
 
 
+	/**
+		Loads the channel's instrument and applies its program and bank
+		changes. Only done once all tracks are built, since loading the
+		SoundFont takes a while.
+	*/
+	void loadInstrument(TrackContainer* tc)
+	{
+#ifdef LMMS_HAVE_FLUIDSYNTH
+		it_inst = it->loadInstrument("sf2player");
+
+		if (it_inst)
+		{
+			isSF2 = true;
+			it_inst->loadFile(ConfigManager::inst()->sf2File());
+			it_inst->childModel("bank")->setValue(0);
+			it_inst->childModel("patch")->setValue(0);
+		}
+		else { it_inst = it->loadInstrument("patman"); }
+#else
+		it_inst = it->loadInstrument("patman");
+#endif
+		if (!it_inst) { return; }
+
+		if (!isSF2)
+		{
+			// patman can only play one patch, the last program change wins
+			const auto program = std::find_if(instrumentChanges.rbegin(), instrumentChanges.rend(),
+				[](const InstrumentChange& change) { return !change.bank; });
+			if (program == instrumentChanges.rend()) { return; }
+
+			const QString num = QString::number(static_cast<int>(program->value));
+			const QString filter = QString().fill('0', 3 - num.length()) + num + "*.pat";
+			const QString dir = "/usr/share/midi/"
+					"freepats/Tone_000/";
+			const QStringList files = QDir(dir).
+			entryList(QStringList(filter));
+			if (!files.empty())
+			{
+				it_inst->loadFile(dir + files.front());
+			}
+			return;
+		}
+
+		auto programs = smfMidiCC{};
+		auto banks = smfMidiCC{};
+		for (const auto& change : instrumentChanges)
+		{
+			AutomatableModel* objModel = it_inst->childModel(change.bank ? "bank" : "patch");
+			if (change.bank)
+			{
+				printf("BANK SELECT %f %d\n", change.value / 127, static_cast<int>(change.value));
+				if (change.time == 0)
+				{
+					objModel->setInitValue(change.value);
+					continue;
+				}
+			}
+
+			auto& automation = change.bank ? banks : programs;
+			if (automation.at == nullptr) {
+				automation.create(tc, change.trackName + " > " + objModel->displayName());
+			}
+			automation.putValue(change.time, objModel, change.value);
+		}
+		programs.flush();
+		banks.flush();
+		instrumentChanges.clear();
+	}
+
+
 	void addNote(Note& n)
 	{
 		if (!p) { p = dynamic_cast<MidiClip*>(it->createClip(0)); }
-		p->addNote(n, false);
+		notes.push_back(n);
 		hasNotes = true;
 	}
 
@@ -238,22 +325,28 @@ public:
 	void splitMidiClips()
 	{
 		MidiClip* newMidiClip = nullptr;
+		std::optional<MidiClip::NoteBatch> batch;
 		TimePos lastEnd(0);
 
-		p->rearrangeAllNotes();
-		for (auto n : p->notes())
+		std::stable_sort(notes.begin(), notes.end(),
+			[](const Note& a, const Note& b) { return Note::lessThan(&a, &b); });
+		for (const auto& n : notes)
 		{
-			if (!newMidiClip || n->pos() > lastEnd + DefaultTicksPerBar)
+			if (!newMidiClip || n.pos() > lastEnd + DefaultTicksPerBar)
 			{
-				TimePos pPos = TimePos(n->pos().getBar(), 0);
+				TimePos pPos = TimePos(n.pos().getBar(), 0);
 				newMidiClip = dynamic_cast<MidiClip*>(it->createClip(pPos));
+				// commits the notes of the previous clip
+				batch.emplace(newMidiClip, false);
 			}
-			lastEnd = n->pos() + n->length();
+			lastEnd = n.pos() + n.length();
 
-			Note newNote(*n);
-			newNote.setPos(n->pos(newMidiClip->startPosition()));
-			newMidiClip->addNote(newNote, false);
+			Note newNote(n);
+			newNote.setPos(n.pos(newMidiClip->startPosition()));
+			batch->addNote(newNote, false);
 		}
+		batch.reset();
+		notes.clear();
 
 		delete p;
 		p = nullptr;
@@ -261,6 +354,131 @@ public:
 };
 
 
+namespace
+{
+
+//! An event the import handles, taken out of portsmf's structures so the
+//! tracks of the file can be looked at in parallel
+struct ImportEvent
+{
+	enum class Type
+	{
+		Note,
+		Program,
+		Controller
+	};
+
+	Type type;
+	long channel;
+	double time; //!< In ticks
+	int number; //!< Key, program or controller, 128 for pitch bend
+	tick_t length = 0; //!< Of notes
+	double value = 0; //!< Volume of notes, value of controllers
+	QString trackName; //!< Name of the track at the time of the event
+};
+
+
+/**
+	Converts the events of @p trk. Doesn't touch anything but @p trk, so
+	this can run on any thread.
+
+	@param trackName Used until the track sets its own name
+*/
+std::vector<ImportEvent> scanTrack(Alg_track_ptr trk, bool firstTrack, QString trackName, double ticksPerBeat)
+{
+	auto events = std::vector<ImportEvent>{};
+	events.reserve(trk->length());
+
+	for (int e = 0; e < trk->length(); ++e)
+	{
+		Alg_event_ptr evt = (*trk)[e];
+
+		if (evt->chan == -1)
+		{
+			bool handled = false;
+			if (evt->is_update())
+			{
+				QString attr = evt->get_attribute();
+				// seqnames is a track0 identifier (see allegro code)
+				if (attr == (firstTrack ? "seqnames" : "tracknames")
+					&& evt->get_update_type() == 's')
+				{
+					trackName = evt->get_string_value();
+					handled = true;
+				}
+			}
+			if (!handled) {
+				// Write debug output, in one go since other tracks print at the same time
+				auto message = QString{"MISSING GLOBAL HANDLER\n\tChn: %1, Type Code: %2, Time: %3"}
+					.arg(evt->chan).arg(static_cast<int>(evt->get_type_code())).arg(evt->time);
+				if (evt->is_update())
+				{
+					message += QString{", Update Type: %1"}.arg(evt->get_attribute());
+					if (evt->get_update_type() == 'a') {
+						message += QString{", Atom: %1"}.arg(evt->get_atom_value());
+					}
+				}
+				printf("%s\n", qPrintable(message));
+			}
+		}
+		else if (evt->is_note())
+		{
+			auto noteEvt = dynamic_cast<Alg_note_ptr>(evt);
+			tick_t ticks = noteEvt->get_duration() * ticksPerBeat;
+			events.push_back({
+				.type = ImportEvent::Type::Note,
+				.channel = evt->chan,
+				.time = noteEvt->get_start_time() * ticksPerBeat,
+				.number = static_cast<int>(noteEvt->get_identifier()),
+				.length = ticks < 1 ? 1 : ticks,
+				// Map from MIDI velocity to LMMS volume
+				.value = noteEvt->get_loud() * (200.f / 127.f),
+				.trackName = trackName
+			});
+		}
+		else if (evt->is_update())
+		{
+			double time = evt->time*ticksPerBeat;
+			QString update(evt->get_attribute());
+
+			if (update == "programi")
+			{
+				events.push_back({
+					.type = ImportEvent::Type::Program,
+					.channel = evt->chan,
+					.time = time,
+					.number = static_cast<int>(evt->get_integer_value()),
+					.trackName = trackName
+				});
+			}
+			else if (update.startsWith("control") || update == "bendr")
+			{
+				int ccid = update.mid(7, update.length() - 8).toInt();
+				if (update == "bendr") { ccid = 128; }
+				if (ccid <= 128)
+				{
+					events.push_back({
+						.type = ImportEvent::Type::Controller,
+						.channel = evt->chan,
+						.time = time,
+						.number = ccid,
+						.value = evt->get_real_value(),
+						.trackName = trackName
+					});
+				}
+			}
+			else {
+				printf("Unhandled update: %ld %d %f %s\n",
+					evt->chan, evt->get_type_code(), evt->time, evt->get_attribute());
+			}
+		}
+	}
+	return events;
+}
+
+} // namespace
+
+
 bool MidiImport::readSMF(TrackContainer* tc)
 {
 	constexpr int MIDI_CC_COUNT = 128 + 1; // 0-127 (128) + pitch bend
@@ -273,19 +491,33 @@ bool MidiImport::readSMF(TrackContainer* tc)
 
 	pd.setValue(0);
 
+	auto timer = QElapsedTimer{};
+	timer.start();
+
 	std::istringstream stream(readAllData().toStdString());
 	auto seq = new Alg_seq(stream, true);
 	seq->convert_to_beats();
 
+	const qint64 parseTime = timer.restart();
 	pd.setMaximum(seq->tracks() + preTrackSteps);
 	pd.setValue(1);
 
+	// TODO: adjust these to Time.Sig changes
+	double beatsPerBar = 4;
+	double ticksPerBeat = DefaultTicksPerBar / beatsPerBar;
+
+	// Convert the events of all tracks in parallel first. Creating the tracks,
+	// instruments and clips from them has to happen in the main thread.
+	auto scannedTracks = std::vector<std::future<std::vector<ImportEvent>>>{};
+	for (int t = 0; t < seq->tracks(); ++t)
+	{
+		scannedTracks.push_back(ThreadPool::instance().enqueue(scanTrack,
+			seq->track(t), t == 0, QString(tr("Track") + " %1").arg(t), ticksPerBeat));
+	}
+
 	// 128 CC + Pitch Bend
 	auto ccs = std::array<smfMidiCC, MIDI_CC_COUNT>{};
 
-	// channel to CC object for program changes
-	std::unordered_map<long, smfMidiCC> pcs;
-
 	// channels can be set out of 256 range
 	// using unordered_map should fix most invalid loads and crashes while loading
 	std::unordered_map<long, smfMidiChannel> chs;
@@ -303,10 +535,6 @@ bool MidiImport::readSMF(TrackContainer* tc)
 	timeSigDenominatorPat->setDisplayName(tr("Denominator"));
 	timeSigDenominatorPat->addObject(&timeSigMM.denominatorModel());
 
-	// TODO: adjust these to Time.Sig changes
-	double beatsPerBar = 4;
-	double ticksPerBeat = DefaultTicksPerBar / beatsPerBar;
-
 	// Time-sig changes
 	Alg_time_sigs* timeSigs = &seq->time_sig;
 	for (int s = 0; s < timeSigs->length(); ++s)
@@ -332,17 +560,19 @@ bool MidiImport::readSMF(TrackContainer* tc)
 		tap->clear();
 		Alg_time_map* timeMap = seq->get_time_map();
 		Alg_beats& beats = timeMap->beats;
+		auto tempos = std::vector<std::pair<TimePos, float>>{};
 		for (int i = 0; i < beats.len - 1; ++i)
 		{
 			Alg_beat_ptr b = &(beats[i]);
 			double tempo = (beats[i + 1].beat - b->beat) / (beats[i + 1].time - beats[i].time);
-			tap->putValue(b->beat * ticksPerBeat, tempo * 60.0);
+			tempos.emplace_back(b->beat * ticksPerBeat, tempo * 60.0);
 		}
 		if (timeMap->last_tempo_flag)
 		{
 			Alg_beat_ptr b = &beats[beats.len - 1];
-			tap->putValue(b->beat * ticksPerBeat, timeMap->last_tempo * 60.0);
+			tempos.emplace_back(b->beat * ticksPerBeat, timeMap->last_tempo * 60.0);
 		}
+		tap->putValues(tempos);
 	}
 
 	// Update the tempo to avoid crash when playing a project imported
@@ -361,178 +591,95 @@ bool MidiImport::readSMF(TrackContainer* tc)
 		}
 	}
 
+	auto events = std::vector<std::vector<ImportEvent>>{};
+	events.reserve(scannedTracks.size());
+	for (auto& track : scannedTracks) { events.push_back(track.get()); }
+	delete seq;
+	const qint64 scanTime = timer.restart();
+
 	// Tracks
-	for (int t = 0; t < seq->tracks(); ++t)
+	for (std::size_t t = 0; t < events.size(); ++t)
 	{
-		QString trackName = QString(tr("Track") + " %1").arg(t);
-		Alg_track_ptr trk = seq->track(t);
 		pd.setValue(t + preTrackSteps);
 
 		for (auto& cc : ccs) { cc.clear(); }
 
-		// Now look at events
-		for (int e = 0; e < trk->length(); ++e)
+		for (const auto& evt : events[t])
 		{
-			Alg_event_ptr evt = (*trk)[e];
+			smfMidiChannel* ch = chs[evt.channel].create(tc, evt.trackName);
+			const QString& trackName = evt.trackName;
+			double time = evt.time;
 
-			if (evt->chan == -1)
+			if (evt.type == ImportEvent::Type::Note)
 			{
-				bool handled = false;
-				if (evt->is_update())
-				{
-					QString attr = evt->get_attribute();
-					// seqnames is a track0 identifier (see allegro code)
-					if (attr == (t == 0 ? "seqnames" : "tracknames")
-						&& evt->get_update_type() == 's')
-					{
-						trackName = evt->get_string_value();
-						handled = true;
-					}
-				}
-				if (!handled) {
-					// Write debug output
-					printf("MISSING GLOBAL HANDLER\n");
-					printf("\tChn: %ld, Type Code: %d, Time: %f", evt->chan, evt->get_type_code(), evt->time);
-					if (evt->is_update())
-					{
-						printf(", Update Type: %s", evt->get_attribute());
-						if (evt->get_update_type() == 'a') {
-							printf(", Atom: %s", evt->get_atom_value());
-						}
-					}
-					printf("\n");
-				}
+				Note n(evt.length, static_cast<tick_t>(evt.time), evt.number, evt.value);
+				ch->addNote(n);
 			}
-			else if (evt->is_note())
+			else if (evt.type == ImportEvent::Type::Program)
 			{
-				smfMidiChannel* ch = chs[evt->chan].create(tc, trackName);
-				auto noteEvt = dynamic_cast<Alg_note_ptr>(evt);
-				tick_t ticks = noteEvt->get_duration() * ticksPerBeat;
-				Note n(
-					ticks < 1 ? 1 : ticks,
-					noteEvt->get_start_time() * ticksPerBeat,
-					noteEvt->get_identifier(),
-					// Map from MIDI velocity to LMMS volume
-					noteEvt->get_loud() * (200.f / 127.f)
-				);
-				ch->addNote(n);
+				ch->instrumentChanges.push_back({false, time, static_cast<double>(evt.number), trackName});
 			}
-			else if (evt->is_update())
+			else if (evt.type == ImportEvent::Type::Controller)
 			{
-				smfMidiChannel* ch = chs[evt->chan].create(tc, trackName);
+				const int ccid = evt.number;
+				double cc = evt.value;
+				AutomatableModel* objModel = nullptr;
 
-				double time = evt->time*ticksPerBeat;
-				QString update(evt->get_attribute());
+				switch (ccid)
+				{
+					case 0:
+						ch->instrumentChanges.push_back({true, time, cc * 127.0f, trackName});
+						break;
+
+					case 7:
+						objModel = ch->it->volumeModel();
+						cc *= 100.0f;
+						break;
+
+					case 10:
+						objModel = ch->it->panningModel();
+						cc = cc * 200.f - 100.0f;
+						break;
+
+					case 128:
+						objModel = ch->it->pitchModel();
+						cc = cc * 100.0f;
+						break;
+
+					default:
+						//TODO: something useful for other CCs
+						break;
+				}
 
-				if (update == "programi")
+				if (objModel)
 				{
-					const auto prog = evt->get_integer_value();
-					if (ch->isSF2)
+					if (time == 0 && objModel)
 					{
-						auto& pc = pcs[evt->chan];
-						AutomatableModel* objModel = ch->it_inst->childModel("patch");
-						if (pc.at == nullptr) {
-							pc.create(tc, trackName + " > " + objModel->displayName());
-						}
-						pc.putValue(time, objModel, prog);
+						objModel->setInitValue(cc);
 					}
 					else
 					{
-						const QString num = QString::number(prog);
-						const QString filter = QString().fill('0', 3 - num.length()) + num + "*.pat";
-						const QString dir = "/usr/share/midi/"
-								"freepats/Tone_000/";
-						const QStringList files = QDir(dir).
-						entryList(QStringList(filter));
-						if (ch->it_inst && !files.empty())
-						{
-							ch->it_inst->loadFile(dir + files.front());
-						}
-					}
-				}
-				else if (update.startsWith("control") || update == "bendr")
-				{
-					int ccid = update.mid(7, update.length() - 8).toInt();
-					if (update == "bendr") { ccid = 128; }
-					if (ccid <= 128)
-					{
-						double cc = evt->get_real_value();
-						AutomatableModel* objModel = nullptr;
-
-						switch (ccid)
-						{
-							case 0:
-								if (ch->isSF2 && ch->it_inst)
-								{
-									objModel = ch->it_inst->childModel("bank");
-									printf("BANK SELECT %f %d\n", cc, static_cast<int>(cc * 127));
-									cc *= 127.0f;
-								}
-								break;
-
-							case 7:
-								objModel = ch->it->volumeModel();
-								cc *= 100.0f;
-								break;
-
-							case 10:
-								objModel = ch->it->panningModel();
-								cc = cc * 200.f - 100.0f;
-								break;
-
-							case 128:
-								objModel = ch->it->pitchModel();
-								cc = cc * 100.0f;
-								break;
-
-							default:
-								//TODO: something useful for other CCs
-								break;
-						}
-
-						if (objModel)
-						{
-							if (time == 0 && objModel)
-							{
-								objModel->setInitValue(cc);
-							}
-							else
-							{
-								if (ccs[ccid].at == nullptr) {
-									ccs[ccid].create(tc, trackName + " > " +
-										// This is inside if (objModel), so objModel should never be nullptr
-										// (objModel != nullptr ? objModel->displayName() : QString("CC %1").arg(ccid))
-										objModel->displayName()
-									);
-								}
-								ccs[ccid].putValue(time, objModel, cc);
-							}
+						if (ccs[ccid].at == nullptr) {
+							ccs[ccid].create(tc, trackName + " > " +
+								// This is inside if (objModel), so objModel should never be nullptr
+								// (objModel != nullptr ? objModel->displayName() : QString("CC %1").arg(ccid))
+								objModel->displayName()
+							);
 						}
+						ccs[ccid].putValue(time, objModel, cc);
 					}
 				}
-				else {
-					printf("Unhandled update: %ld %d %f %s\n",
-						evt->chan, evt->get_type_code(), evt->time, evt->get_attribute());
-				}
 			}
 		}
 	}
 
-	delete seq;
+	for (auto& cc : ccs) { cc.flush(); }
 
 	for (auto& c: chs)
 	{
-		if (c.second.hasNotes)
-		{
-			c.second.splitMidiClips();
-		}
-		else if (c.second.it)
-		{
-			printf(" Should remove empty track\n");
-			// must delete trackView first - but where is it?
-			//tc->removeTrack(chs[c].it);
-			//it->deleteLater();
-		}
+		c.second.loadInstrument(tc);
+		// Channels with only controllers or programs keep their default clip
+		if (c.second.hasNotes) { c.second.splitMidiClips(); }
 		// Set channel 10 to drums as per General MIDI's orders
 		if (c.first % 16l == 9 /* channel 10 */
 			&& c.second.hasNotes && c.second.it_inst && c.second.isSF2)
@@ -542,6 +689,9 @@ bool MidiImport::readSMF(TrackContainer* tc)
 		}
 	}
 
+	qDebug("MidiImport: parsed in %lld ms, converted %zu tracks in %lld ms, created tracks and clips in %lld ms",
+		parseTime, events.size(), scanTime, timer.elapsed());
+
 	return true;
 }
 
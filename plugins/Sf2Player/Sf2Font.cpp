@@ -0,0 +1,162 @@
+/*
+ * Sf2Font.cpp - a soundfont shared by all Sf2Player instances
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Sf2Font.h"
+
+#include <QString>
+#include <mutex>
+
+#include "SharedFileCache.h"
+#include "fluidsynthshims.h"
+
+#if FLUIDSYNTH_VERSION_MAJOR >= 2
+
+namespace lmms
+{
+
+
+namespace
+{
+
+//! Owns the shared soundfonts, it never plays
+struct FontLibrary
+{
+	FontLibrary() :
+		settings(new_fluid_settings())
+	{
+		fluid_settings_setint(settings, "synth.polyphony", 1);
+		synth = new_fluid_synth(settings);
+	}
+
+	~FontLibrary()
+	{
+		delete_fluid_synth(synth);
+		delete_fluid_settings(settings);
+	}
+
+	fluid_settings_t* settings;
+	fluid_synth_t* synth;
+	std::mutex mutex;
+};
+
+FontLibrary& library()
+{
+	static auto s_library = FontLibrary{};
+	return s_library;
+}
+
+SharedFileCache<Sf2Font>& cache()
+{
+	static auto s_cache = SharedFileCache<Sf2Font>{};
+	return s_cache;
+}
+
+
+// Callbacks of the soundfonts from createSfont(), which forward everything
+// to the shared soundfont
+std::shared_ptr<Sf2Font>& sharedFont(fluid_sfont_t* sfont)
+{
+	return *static_cast<std::shared_ptr<Sf2Font>*>(fluid_sfont_get_data(sfont));
+}
+
+const char* getName(fluid_sfont_t* sfont)
+{
+	return fluid_sfont_get_name(sharedFont(sfont)->sfont());
+}
+
+fluid_preset_t* getPreset(fluid_sfont_t* sfont, int bank, int prenum)
+{
+	return fluid_sfont_get_preset(sharedFont(sfont)->sfont(), bank, prenum);
+}
+
+void iterationStart(fluid_sfont_t* sfont)
+{
+	fluid_sfont_iteration_start(sharedFont(sfont)->sfont());
+}
+
+fluid_preset_t* iterationNext(fluid_sfont_t* sfont)
+{
+	return fluid_sfont_iteration_next(sharedFont(sfont)->sfont());
+}
+
+int freeSfont(fluid_sfont_t* sfont)
+{
+	delete &sharedFont(sfont);
+	delete_fluid_sfont(sfont);
+	return 0;
+}
+
+} // namespace
+
+
+
+
+std::shared_ptr<Sf2Font> Sf2Font::load(const QString& file)
+{
+	return cache().get(file, [](const QString& path) -> std::shared_ptr<Sf2Font>
+	{
+		const QByteArray fileName = path.toLocal8Bit();
+		if (!fluid_is_soundfont(fileName.constData())) { return nullptr; }
+
+		auto& lib = library();
+		const auto lock = std::lock_guard{lib.mutex};
+		const int id = fluid_synth_sfload(lib.synth, fileName.constData(), false);
+		fluid_sfont_t* sfont = id >= 0 ? fluid_synth_get_sfont_by_id(lib.synth, id) : nullptr;
+		if (sfont == nullptr) { return nullptr; }
+
+		return std::make_shared<Sf2Font>(sfont, id);
+	});
+}
+
+
+
+
+Sf2Font::Sf2Font(fluid_sfont_t* sfont, int id) :
+	m_sfont(sfont),
+	m_id(id)
+{
+}
+
+
+
+
+Sf2Font::~Sf2Font()
+{
+	auto& lib = library();
+	const auto lock = std::lock_guard{lib.mutex};
+	fluid_synth_sfunload(lib.synth, m_id, false);
+}
+
+
+
+
+fluid_sfont_t* Sf2Font::createSfont(std::shared_ptr<Sf2Font> font)
+{
+	fluid_sfont_t* sfont = new_fluid_sfont(getName, getPreset, iterationStart, iterationNext, freeSfont);
+	fluid_sfont_set_data(sfont, new std::shared_ptr<Sf2Font>(std::move(font)));
+	return sfont;
+}
+
+
+} // namespace lmms
+
+#endif // FLUIDSYNTH_VERSION_MAJOR >= 2
@@ -0,0 +1,86 @@
+/*
+ * Sf2Font.h - a soundfont shared by all Sf2Player instances
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SF2_FONT_H
+#define LMMS_SF2_FONT_H
+
+#include <fluidsynth/types.h>
+#include <memory>
+#include <mutex>
+
+class QString;
+
+namespace lmms
+{
+
+/**
+	A soundfont file that is loaded once for all Sf2Instruments using it.
+
+	FluidSynth ties every soundfont to the synth that loaded it, so the
+	presets and samples live in a hidden synth, and each instrument's synth
+	gets a lightweight soundfont from createSfont() that hands out those
+	presets. Only available with FluidSynth 2.
+
+	The font is unloaded when the last instrument releases it, which has to
+	happen on the GUI thread, after the instrument reset the presets of its
+	synth and stopped its voices.
+*/
+class Sf2Font
+{
+public:
+	//! Returns the soundfont loaded from @p file, nullptr if it can't be loaded
+	static std::shared_ptr<Sf2Font> load(const QString& file);
+
+	Sf2Font(fluid_sfont_t* sfont, int id);
+	~Sf2Font();
+
+	Sf2Font(const Sf2Font&) = delete;
+	Sf2Font& operator=(const Sf2Font&) = delete;
+
+	/**
+		Creates a soundfont for fluid_synth_add_sfont() that serves the presets
+		of @p font and keeps it alive. The synth frees it when it's unloaded.
+
+		Voices and channels of the synth still use the presets after that, so
+		the caller must hold @p font until it reset the synth.
+	*/
+	static fluid_sfont_t* createSfont(std::shared_ptr<Sf2Font> font);
+
+	fluid_sfont_t* sfont() const { return m_sfont; }
+
+	/**
+		Every synth using the font changes the reference counts of its
+		presets and samples when voices start and stop, and FluidSynth doesn't
+		synchronize them. So calls on such a synth that may start, stop or
+		render voices, or select presets, must hold this lock.
+	*/
+	std::mutex& voiceMutex() { return m_voiceMutex; }
+
+private:
+	fluid_sfont_t* m_sfont;
+	int m_id;
+	std::mutex m_voiceMutex;
+};
+
+} // namespace lmms
+
+#endif // LMMS_SF2_FONT_H
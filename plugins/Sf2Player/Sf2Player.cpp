@@ -41,6 +41,7 @@
 #include "NotePlayHandle.h"
 #include "PathUtil.h"
 #include "PixmapButton.h"
+#include "Sf2Font.h"
 #include "Song.h"
 #include "fluidsynthshims.h"
 
@@ -323,8 +324,13 @@ void Sf2Instrument::loadFile( const QString & _file )
 				iBank += iBankOff;
 #endif
 
-				::fluid_synth_bank_select( m_synth, 1, iBank );
-				::fluid_synth_program_change( m_synth, 1, iProg );
+				m_synthMutex.lock();
+				{
+					const auto fontLock = lockSharedFont();
+					::fluid_synth_bank_select( m_synth, 1, iBank );
+					::fluid_synth_program_change( m_synth, 1, iProg );
+				}
+				m_synthMutex.unlock();
 				m_bankNum.setValue( iBank );
 				m_patchNum.setValue ( iProg );
 				break;
@@ -366,8 +372,19 @@ void Sf2Instrument::freeFont()
 
 	if (m_font != nullptr)
 	{
+		auto fontLock = lockSharedFont();
 		fluid_synth_sfunload(m_synth, m_fontId, true);
 		m_font = nullptr;
+
+		if (m_sharedFont)
+		{
+			// the unload reset the channel presets, but voices may
+			// still play samples of the shared font
+			fluid_synth_all_sounds_off(m_synth, -1);
+			fontLock.unlock();
+			// if this was the last instrument using the font, it's unloaded here
+			m_sharedFont.reset();
+		}
 	}
 
 	m_synthMutex.unlock();
@@ -375,6 +392,14 @@ void Sf2Instrument::freeFont()
 
 
 
+std::unique_lock<std::mutex> Sf2Instrument::lockSharedFont()
+{
+	if (!m_sharedFont) { return {}; }
+	return std::unique_lock{m_sharedFont->voiceMutex()};
+}
+
+
+
 void Sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 {
 	emit fileLoading();
@@ -389,6 +414,15 @@ void Sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 	m_synthMutex.lock();
 
 	bool loaded = false;
+#if FLUIDSYNTH_VERSION_MAJOR >= 2
+	// share the presets and samples with other instruments using this file
+	if ((m_sharedFont = Sf2Font::load(PathUtil::toAbsolute(_sf2File))))
+	{
+		m_font = Sf2Font::createSfont(m_sharedFont);
+		m_fontId = fluid_synth_add_sfont(m_synth, m_font);
+		loaded = true;
+	}
+#else
 	if (fluid_is_soundfont(sf2Ascii))
 	{
 		m_fontId = fluid_synth_sfload(m_synth, sf2Ascii, true);
@@ -400,6 +434,7 @@ void Sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 			loaded = true;
 		}
 	}
+#endif
 
 	if (!loaded)
 	{
@@ -436,6 +471,8 @@ void Sf2Instrument::updatePatch()
 {
 	if( m_bankNum.value() >= 0 && m_patchNum.value() >= 0 )
 	{
+		const auto guard = std::lock_guard{m_synthMutex};
+		const auto fontLock = lockSharedFont();
 		fluid_synth_program_select( m_synth, m_channel, m_fontId,
 				m_bankNum.value(), m_patchNum.value() );
 	}
@@ -593,8 +630,11 @@ void Sf2Instrument::reloadSynth()
 	{
 		// Now, delete the old one and replace
 		m_synthMutex.lock();
-		fluid_synth_remove_sfont( m_synth, m_font );
-		delete_fluid_synth( m_synth );
+		{
+			const auto fontLock = lockSharedFont();
+			fluid_synth_remove_sfont( m_synth, m_font );
+			delete_fluid_synth( m_synth );
+		}
 
 		// New synth
 		m_synth = new_fluid_synth( m_settings );
@@ -720,7 +760,10 @@ void Sf2Instrument::noteOn( Sf2PluginData * n )
 	const auto voices = static_cast<fluid_voice_t**>(_alloca(poly * sizeof(fluid_voice_t*)));
 #endif
 
-	fluid_synth_noteon( m_synth, m_channel, n->midiNote, n->lastVelocity );
+	{
+		const auto fontLock = lockSharedFont();
+		fluid_synth_noteon( m_synth, m_channel, n->midiNote, n->lastVelocity );
+	}
 
 	// Get any new voices and store them in the plugin data
 	fluid_synth_get_voicelist(m_synth, voices, poly, -1);
@@ -775,7 +818,10 @@ void Sf2Instrument::noteOff( Sf2PluginData * n )
 	if( notes <= 0 )
 	{
 		m_synthMutex.lock();
-		fluid_synth_noteoff( m_synth, m_channel, n->midiNote );
+		{
+			const auto fontLock = lockSharedFont();
+			fluid_synth_noteoff( m_synth, m_channel, n->midiNote );
+		}
 		m_synthMutex.unlock();
 	}
 }
@@ -870,6 +916,8 @@ void Sf2Instrument::play( SampleFrame* _working_buffer )
 void Sf2Instrument::renderFrames( f_cnt_t frames, SampleFrame* buf )
 {
 	const auto guard = std::lock_guard{m_synthMutex};
+	// finished voices release their samples while rendering
+	const auto fontLock = lockSharedFont();
 
 	fluid_synth_get_gain(m_synth); // This flushes voice updates as a side effect
 
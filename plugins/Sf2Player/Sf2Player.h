@@ -29,6 +29,8 @@
 
 #include <array>
 #include <fluidsynth/types.h>
+#include <memory>
+#include <mutex>
 #include <QMutex>
 #include <samplerate.h>
 
@@ -46,6 +48,7 @@ namespace lmms
 
 
 struct Sf2PluginData;
+class Sf2Font;
 class NotePlayHandle;
 
 namespace gui
@@ -114,6 +117,10 @@ private:
 	fluid_synth_t* m_synth;
 
 	fluid_sfont_t* m_font;
+	//! The soundfont m_font forwards to, if it's shared with other instruments
+	std::shared_ptr<Sf2Font> m_sharedFont;
+	//! Locks Sf2Font::voiceMutex() of m_sharedFont if there is one, m_synthMutex must be held
+	std::unique_lock<std::mutex> lockSharedFont();
 
 	int m_fontId;
 	QString m_filename;
@@ -143,31 +143,22 @@ Effect::ProcessStatus SlewDistortion::processImpl(SampleFrame* buf, const fpp_t
 		m_trueBias2 = m_biasInterpCoef * m_trueBias2 + (1.f - m_biasInterpCoef) * bias2;
 		const __m128 bias = _mm_set_ps(m_trueBias2, m_trueBias2, m_trueBias1, m_trueBias1);
 
-		if (oversampleVal > 1)
-		{
-			m_upsampler[0].processSample(m_overOuts[0].data(), buf[f][0]);
-			m_upsampler[1].processSample(m_overOuts[1].data(), buf[f][1]);
-		}
-		else
-		{
-			m_overOuts[0][0] = buf[f][0];
-			m_overOuts[1][0] = buf[f][1];
-		}
+		m_oversampler.upsample(buf[f], m_overOuts.data());
 
 		for (int overSamp = 0; overSamp < oversampleVal; ++overSamp)
 		{
 			alignas(16) std::array<float, 4> inArr = {0};
 			if (multiband)
 			{
-				inArr[0] = m_hp.update(m_overOuts[0][overSamp], 0);
-				inArr[1] = m_hp.update(m_overOuts[1][overSamp], 1);
-				inArr[2] = m_lp.update(m_overOuts[0][overSamp], 0);
-				inArr[3] = m_lp.update(m_overOuts[1][overSamp], 1);
+				inArr[0] = m_hp.update(m_overOuts[overSamp][0], 0);
+				inArr[1] = m_hp.update(m_overOuts[overSamp][1], 1);
+				inArr[2] = m_lp.update(m_overOuts[overSamp][0], 0);
+				inArr[3] = m_lp.update(m_overOuts[overSamp][1], 1);
 			}
 			else
 			{
-				inArr[0] = m_overOuts[0][overSamp];
-				inArr[1] = m_overOuts[1][overSamp];
+				inArr[0] = m_overOuts[overSamp][0];
+				inArr[1] = m_overOuts[overSamp][1];
 				inArr[2] = 0;
 				inArr[3] = 0;
 			}
@@ -410,21 +401,11 @@ Effect::ProcessStatus SlewDistortion::processImpl(SampleFrame* buf, const fpp_t
 			alignas(16) std::array<float, 4> outArr;
 			_mm_store_ps(&outArr[0], outFinal);
 
-			m_overOuts[0][overSamp] = outArr[0] + outArr[2];
-			m_overOuts[1][overSamp] = outArr[1] + outArr[3];
+			m_overOuts[overSamp][0] = outArr[0] + outArr[2];
+			m_overOuts[overSamp][1] = outArr[1] + outArr[3];
 		}
 
-		std::array<float, 2> s;
-		if (oversampleVal > 1)
-		{
-			s[0] = m_downsampler[0].processSample(m_overOuts[0].data());
-			s[1] = m_downsampler[1].processSample(m_overOuts[1].data());
-		}
-		else
-		{
-			s[0] = m_overOuts[0][0];
-			s[1] = m_overOuts[1][0];
-		}
+		const SampleFrame s = m_oversampler.downsample(m_overOuts.data());
 
 		buf[f][0] = d * buf[f][0] + w * s[0];
 		buf[f][1] = d * buf[f][1] + w * s[1];
@@ -516,30 +497,21 @@ Effect::ProcessStatus SlewDistortion::processImpl(SampleFrame* buf, const fpp_t
 		m_trueBias2 = m_biasInterpCoef * m_trueBias2 + (1.f - m_biasInterpCoef) * bias2;
 		const std::array<float, 4> bias = {m_trueBias1, m_trueBias1, m_trueBias2, m_trueBias2};
 		
-		if (oversampleVal > 1)
-		{
-			m_upsampler[0].processSample(m_overOuts[0].data(), buf[f][0]);
-			m_upsampler[1].processSample(m_overOuts[1].data(), buf[f][1]);
-		}
-		else
-		{
-			m_overOuts[0][0] = buf[f][0];
-			m_overOuts[1][0] = buf[f][1];
-		}
+		m_oversampler.upsample(buf[f], m_overOuts.data());
 		
 		for (int overSamp = 0; overSamp < oversampleVal; ++overSamp)
 		{
 			if (multiband)
 			{
-				in[0] = m_hp.update(m_overOuts[0][overSamp], 0);
-				in[1] = m_hp.update(m_overOuts[1][overSamp], 1);
-				in[2] = m_lp.update(m_overOuts[0][overSamp], 0);
-				in[3] = m_lp.update(m_overOuts[1][overSamp], 1);
+				in[0] = m_hp.update(m_overOuts[overSamp][0], 0);
+				in[1] = m_hp.update(m_overOuts[overSamp][1], 1);
+				in[2] = m_lp.update(m_overOuts[overSamp][0], 0);
+				in[3] = m_lp.update(m_overOuts[overSamp][1], 1);
 			}
 			else
 			{
-				in[0] = m_overOuts[0][overSamp];
-				in[1] = m_overOuts[1][overSamp];
+				in[0] = m_overOuts[overSamp][0];
+				in[1] = m_overOuts[overSamp][1];
 				in[2] = 0;
 				in[3] = 0;
 			}
@@ -647,21 +619,11 @@ Effect::ProcessStatus SlewDistortion::processImpl(SampleFrame* buf, const fpp_t
 			m_outPeakDisplay[2] = std::max(m_outPeakDisplay[2], std::abs(out[2]));
 			m_outPeakDisplay[3] = std::max(m_outPeakDisplay[3], std::abs(out[3]));
 			
-			m_overOuts[0][overSamp] = out[0] + out[2];
-			m_overOuts[1][overSamp] = out[1] + out[3];
+			m_overOuts[overSamp][0] = out[0] + out[2];
+			m_overOuts[overSamp][1] = out[1] + out[3];
 		}
 		
-		std::array<float, 2> s;
-		if (oversampleVal > 1)
-		{
-			s[0] = m_downsampler[0].processSample(m_overOuts[0].data());
-			s[1] = m_downsampler[1].processSample(m_overOuts[1].data());
-		}
-		else
-		{
-			s[0] = m_overOuts[0][0];
-			s[1] = m_overOuts[1][0];
-		}
+		const SampleFrame s = m_oversampler.downsample(m_overOuts.data());
 		
 		buf[f][0] = d * buf[f][0] + w * s[0];
 		buf[f][1] = d * buf[f][1] + w * s[1];
@@ -678,11 +640,7 @@ void SlewDistortion::changeSampleRate()
 	const int oversampleVal = 1 << oversampleStages;
 	float sampleRateOver = m_sampleRate * oversampleVal;
 	
-	for (int i = 0; i < 2; ++i)
-	{
-		m_upsampler[i].setup(oversampleStages, m_sampleRate);
-		m_downsampler[i].setup(oversampleStages, m_sampleRate);
-	}
+	m_oversampler.setup(oversampleStages, m_sampleRate);
 	
 	m_lp.setSampleRate(sampleRateOver);
 	m_lp.setLowpass(m_slewdistortionControls.m_splitModel.value());
@@ -702,7 +660,7 @@ void SlewDistortion::changeSampleRate()
 	std::fill(std::begin(m_inEnv), std::end(m_inEnv), 0.0f);
 	std::fill(std::begin(m_outEnv), std::end(m_outEnv), 0.0f);
 	std::fill(std::begin(m_outPeakDisplay), std::end(m_outPeakDisplay), 0.0f);
-	for (auto& subArray : m_overOuts) {std::fill(subArray.begin(), subArray.end(), 0.0f);}
+	m_overOuts.fill(SampleFrame{});
 	
 	m_biasInterpCoef = std::exp(-1 / (0.01f * m_sampleRate));
 }
@@ -45,6 +45,11 @@ public:
 	~SlewDistortion() override = default;
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 
+	f_cnt_t latency() const override
+	{
+		return static_cast<f_cnt_t>(std::lround(m_oversampler.latency()));
+	}
+
 	EffectControls* controls() override
 	{
 		return &m_slewdistortionControls;
@@ -63,7 +68,7 @@ private:
 	alignas(16) std::array<float, 4> m_inEnv = {0};
 	alignas(16) std::array<float, 4> m_outEnv = {0};
 	alignas(16) std::array<float, 4> m_outPeakDisplay = {0};
-	alignas(16) std::array<std::array<float, 1 << SLEWDIST_MAX_OVERSAMPLE_STAGES>, 2> m_overOuts = {{0}};
+	std::array<SampleFrame, 1 << SLEWDIST_MAX_OVERSAMPLE_STAGES> m_overOuts = {};
 	
 	float m_sampleRate = 44100.f;
 	
@@ -74,8 +79,7 @@ private:
 	float m_trueBias1 = 0;
 	float m_trueBias2 = 0;
 	
-	std::array<Upsampler<SLEWDIST_MAX_OVERSAMPLE_STAGES>, 2> m_upsampler;
-	std::array<Downsampler<SLEWDIST_MAX_OVERSAMPLE_STAGES>, 2> m_downsampler;
+	StereoOversampler<SLEWDIST_MAX_OVERSAMPLE_STAGES> m_oversampler;
 	
 	StereoLinkwitzRiley m_lp;
 	StereoLinkwitzRiley m_hp;
@@ -35,6 +35,7 @@
 #include "SlicerTView.h"
 #include "Song.h"
 #include "embed.h"
+#include "fft_helpers.h"
 #include "interpolation.h"
 #include "plugin_export.h"
 
@@ -181,7 +182,7 @@ void SlicerT::findSlices()
 	std::vector<float> fftIn(windowSize, 0);
 	std::array<fftwf_complex, windowSize> fftOut;
 
-	fftwf_plan fftPlan = fftwf_plan_dft_r2c_1d(windowSize, fftIn.data(), fftOut.data(), FFTW_MEASURE);
+	fftwf_plan fftPlan = sharedPlanR2C(windowSize, fftIn.data(), fftOut.data());
 
 	int lastPoint = -minDist - 1; // to always store 0 first
 	float spectralFlux = 0;
@@ -191,7 +192,7 @@ void SlicerT::findSlices()
 	{
 		// fft
 		std::copy_n(singleChannel.data() + i, windowSize, fftIn.data());
-		fftwf_execute(fftPlan);
+		fftwf_execute_dft_r2c(fftPlan, fftIn.data(), fftOut.data());
 
 		// calculate spectral flux in regard to last window
 		for (int j = 0; j < windowSize / 2; j++) // only use niquistic frequencies
@@ -28,6 +28,7 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
+#include <QPointer>
 
 #include "DeprecationHelper.h"
 #include "SampleThumbnail.h"
@@ -119,7 +120,9 @@ void SlicerTWaveform::drawSeekerWaveform()
 
 	const auto& sample = m_slicerTParent->m_originalSample;
 
-	m_sampleThumbnail = SampleThumbnail{sample};
+	m_sampleThumbnail = SampleThumbnail{sample, [view = QPointer{this}] {
+		if (view) { view->updateUI(); }
+	}};
 
 	const auto param = SampleThumbnail::VisualizeParameters{
 		.sampleRect = m_seekerWaveform.rect(),
@@ -187,7 +190,9 @@ void SlicerTWaveform::drawEditorWaveform()
 
 	const auto& sample = m_slicerTParent->m_originalSample;
 
-	m_sampleThumbnail = SampleThumbnail{sample};
+	m_sampleThumbnail = SampleThumbnail{sample, [view = QPointer{this}] {
+		if (view) { view->updateUI(); }
+	}};
 
 	const auto param = SampleThumbnail::VisualizeParameters{
 		.sampleRect = QRect(0, zoomOffset, m_editorWidth, static_cast<long>(m_zoomLevel * m_editorHeight)),
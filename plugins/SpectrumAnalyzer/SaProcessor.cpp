@@ -68,8 +68,8 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 	m_filteredBufferR.resize(m_fftBlockSize, 0);
 	m_spectrumL = (fftwf_complex *) fftwf_malloc(binCount() * sizeof (fftwf_complex));
 	m_spectrumR = (fftwf_complex *) fftwf_malloc(binCount() * sizeof (fftwf_complex));
-	m_fftPlanL = fftwf_plan_dft_r2c_1d(m_fftBlockSize, m_filteredBufferL.data(), m_spectrumL, FFTW_MEASURE);
-	m_fftPlanR = fftwf_plan_dft_r2c_1d(m_fftBlockSize, m_filteredBufferR.data(), m_spectrumR, FFTW_MEASURE);
+	m_fftPlanL = sharedPlanR2C(m_fftBlockSize, m_filteredBufferL.data(), m_spectrumL);
+	m_fftPlanR = sharedPlanR2C(m_fftBlockSize, m_filteredBufferR.data(), m_spectrumR);
 
 	m_absSpectrumL.resize(binCount(), 0);
 	m_absSpectrumR.resize(binCount(), 0);
@@ -84,8 +84,7 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 
 SaProcessor::~SaProcessor()
 {
-	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
-	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
+	// FFT plans are shared and owned by fft_helpers
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
 	if (m_spectrumR != nullptr) {fftwf_free(m_spectrumR);}
 
@@ -176,14 +175,14 @@ void SaProcessor::analyze(LocklessRingBuffer<SampleFrame> &ring_buffer)
 
 				// Run FFT on left channel, convert the result to absolute magnitude
 				// spectrum and normalize it.
-				fftwf_execute(m_fftPlanL);
+				fftwf_execute_dft_r2c(m_fftPlanL, m_filteredBufferL.data(), m_spectrumL);
 				absspec(m_spectrumL, m_absSpectrumL.data(), binCount());
 				normalize(m_absSpectrumL, m_normSpectrumL, m_inBlockSize);
 
 				// repeat analysis for right channel if stereo processing is enabled
 				if (stereo)
 				{
-					fftwf_execute(m_fftPlanR);
+					fftwf_execute_dft_r2c(m_fftPlanR, m_filteredBufferR.data(), m_spectrumR);
 					absspec(m_spectrumR, m_absSpectrumR.data(), binCount());
 					normalize(m_absSpectrumR, m_normSpectrumR, m_inBlockSize);
 				}
@@ -389,9 +388,7 @@ void SaProcessor::reallocateBuffers()
 	QMutexLocker reloc_lock(&m_reallocationAccess);
 	QMutexLocker data_lock(&m_dataAccess);
 
-	// destroy old FFT plan and free the result buffer
-	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
-	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
+	// free the result buffer (FFT plans are shared and owned by fft_helpers)
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
 	if (m_spectrumR != nullptr) {fftwf_free(m_spectrumR);}
 
@@ -404,8 +401,8 @@ void SaProcessor::reallocateBuffers()
 	m_filteredBufferR.resize(new_fft_size, 0);
 	m_spectrumL = (fftwf_complex *) fftwf_malloc(new_bins * sizeof (fftwf_complex));
 	m_spectrumR = (fftwf_complex *) fftwf_malloc(new_bins * sizeof (fftwf_complex));
-	m_fftPlanL = fftwf_plan_dft_r2c_1d(new_fft_size, m_filteredBufferL.data(), m_spectrumL, FFTW_MEASURE);
-	m_fftPlanR = fftwf_plan_dft_r2c_1d(new_fft_size, m_filteredBufferR.data(), m_spectrumR, FFTW_MEASURE);
+	m_fftPlanL = sharedPlanR2C(new_fft_size, m_filteredBufferL.data(), m_spectrumL);
+	m_fftPlanR = sharedPlanR2C(new_fft_size, m_filteredBufferR.data(), m_spectrumR);
 
 	if (m_fftPlanL == nullptr || m_fftPlanR == nullptr)
 	{
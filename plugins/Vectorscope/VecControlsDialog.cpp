@@ -47,7 +47,7 @@ VecControlsDialog::VecControlsDialog(VecControls *controls) :
 	setLayout(master_layout);
 
 	// Visualizer widget
-	auto display = new VectorView(controls, m_controls->m_effect->getBuffer(), this);
+	auto display = new VectorView(controls, &m_controls->m_effect->tap(), this);
 	master_layout->addWidget(display);
 
 	auto controlLayout = new QHBoxLayout();
@@ -39,11 +39,11 @@ namespace lmms::gui
 {
 
 
-VectorView::VectorView(VecControls* controls, LocklessRingBuffer<SampleFrame>* inputBuffer, QWidget* parent) :
+VectorView::VectorView(VecControls* controls, const AudioTap* tap, QWidget* parent) :
 	QWidget(parent),
 	m_controls(controls),
-	m_inputBuffer(inputBuffer),
-	m_bufferReader(*inputBuffer),
+	m_tap(tap),
+	m_frames(tap->scopeFrames()),
 	m_zoom(1.f),
 	m_zoomTimestamp(0)
 {
@@ -103,12 +103,11 @@ void VectorView::paintEvent(QPaintEvent *event)
 	painter.setTransform(tracePaintingTransform);
 
 	// Get new samples from the lockless input FIFO buffer
-	const auto inBuffer = m_bufferReader.read_max(m_inputBuffer->capacity());
-	const std::size_t frameCount = inBuffer.size();
+	const std::size_t frameCount = m_subscriber ? m_subscriber->read(m_frames.data(), m_frames.size()) : 0;
 
 	for (std::size_t frame = 0; frame < frameCount; ++frame)
 	{
-		auto sampleFrame = inBuffer[frame];
+		auto sampleFrame = m_frames[frame];
 
 		if (logScale)
 		{
@@ -225,6 +224,21 @@ void VectorView::periodicUpdate()
 }
 
 
+// Only ask the effect for data while it can be displayed
+void VectorView::showEvent(QShowEvent *event)
+{
+	m_subscriber = std::make_unique<AudioTap::Subscriber>(*m_tap, true);
+	QWidget::showEvent(event);
+}
+
+
+void VectorView::hideEvent(QHideEvent *event)
+{
+	m_subscriber.reset();
+	QWidget::hideEvent(event);
+}
+
+
 // Allow to change color on double-click.
 // More of an Easter egg, to avoid cluttering the interface with non-essential functionality.
 void VectorView::mouseDoubleClickEvent(QMouseEvent *event)
@@ -25,13 +25,14 @@
 #define VECTORVIEW_H
 
 #include <QWidget>
+#include <memory>
+#include <vector>
 
-#include "LocklessRingBuffer.h"
+#include "AudioTap.h"
 
 namespace lmms
 {
 class VecControls;
-class SampleFrame;
 }
 
 //#define VEC_DEBUG
@@ -45,7 +46,7 @@ class VectorView : public QWidget
 {
 	Q_OBJECT
 public:
-	VectorView(VecControls* controls, LocklessRingBuffer<SampleFrame>* inputBuffer, QWidget* parent = nullptr);
+	VectorView(VecControls* controls, const AudioTap* tap, QWidget* parent = nullptr);
 	~VectorView() override = default;
 
 	QSize sizeHint() const override {return QSize(300, 300);}
@@ -56,6 +57,8 @@ public:
 
 protected:
 	void paintEvent(QPaintEvent *event) override;
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
 	void mouseDoubleClickEvent(QMouseEvent *event) override;
 	void wheelEvent(QWheelEvent *event) override;
 
@@ -68,8 +71,10 @@ private:
 private:
 	VecControls *m_controls;
 
-	LocklessRingBuffer<SampleFrame> *m_inputBuffer;
-	LocklessRingBufferReader<SampleFrame> m_bufferReader;
+	const AudioTap *m_tap;
+	// only subscribed while visible, so the effect doesn't feed a hidden view
+	std::unique_ptr<AudioTap::Subscriber> m_subscriber;
+	std::vector<SampleFrame> m_frames;
 
 	float m_zoom;
 
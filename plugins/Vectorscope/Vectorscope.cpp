@@ -52,7 +52,7 @@ Vectorscope::Vectorscope(Model *parent, const Plugin::Descriptor::SubPluginFeatu
 	m_controls(this),
 	// Buffer is sized to cover 4* the current maximum LMMS audio buffer size,
 	// so that it has some reserve space in case GUI thresd is busy.
-	m_inputBuffer(4 * m_maxBufferSize)
+	m_tap(4 * m_maxBufferSize)
 {
 }
 
@@ -60,13 +60,10 @@ Vectorscope::Vectorscope(Model *parent, const Plugin::Descriptor::SubPluginFeatu
 // Take audio data and store them for processing and display in the GUI thread.
 Effect::ProcessStatus Vectorscope::processImpl(SampleFrame* buf, const fpp_t frames)
 {
-	// Skip processing if the controls dialog isn't visible, it would only waste CPU cycles.
-	if (m_controls.isViewVisible())
-	{
-		// To avoid processing spikes on audio thread, data are stored in
-		// a lockless ringbuffer and processed in a separate thread.
-		m_inputBuffer.write(buf, frames);
-	}
+	// To avoid processing spikes on audio thread, data are stored in a lockless
+	// ringbuffer and processed in the GUI thread. The tap does nothing unless the
+	// view is shown.
+	m_tap.process(buf, frames);
 
 	return ProcessStatus::Continue;
 }
@@ -25,7 +25,7 @@
 #define VECTORSCOPE_H
 
 #include "Effect.h"
-#include "LocklessRingBuffer.h"
+#include "AudioTap.h"
 #include "VecControls.h"
 
 namespace lmms
@@ -42,14 +42,14 @@ public:
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 
 	EffectControls *controls() override {return &m_controls;}
-	LocklessRingBuffer<SampleFrame> *getBuffer() {return &m_inputBuffer;}
+	const AudioTap& tap() const {return m_tap;}
 
 private:
 	VecControls m_controls;
 
 	// Maximum LMMS buffer size (hard coded, the actual constant is hard to get)
 	const unsigned int m_maxBufferSize = 4096;
-	LocklessRingBuffer<SampleFrame> m_inputBuffer;
+	AudioTap m_tap;
 };
 
 
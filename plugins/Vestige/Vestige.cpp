@@ -389,6 +389,8 @@ void VestigeInstrument::loadFile( const QString & _file )
 		instrumentTrack()->setName( m_plugin->name() );
 	}
 
+	m_latency = m_plugin->latency();
+
 	m_pluginMutex.unlock();
 
 	emit dataChanged();
@@ -475,6 +477,7 @@ void VestigeInstrument::closePlugin( void )
 	m_pluginMutex.lock();
 	delete m_plugin;
 	m_plugin = nullptr;
+	m_latency = 0;
 	m_pluginMutex.unlock();
 }
 
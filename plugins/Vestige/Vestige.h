@@ -28,6 +28,7 @@
 
 
 #include <QMutex>
+#include <atomic>
 
 #include "Instrument.h"
 #include "InstrumentView.h"
@@ -71,6 +72,11 @@ public:
 
 	virtual bool handleMidiEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset = 0 );
 
+	virtual f_cnt_t latency() const
+	{
+		return m_latency;
+	}
+
 	virtual gui::PluginView* instantiateView( QWidget * _parent );
 
 protected slots:
@@ -84,6 +90,8 @@ private:
 
 	VstPlugin * m_plugin;
 	QMutex m_pluginMutex;
+	// of the loaded plugin, kept here so the audio thread doesn't need the lock
+	std::atomic<f_cnt_t> m_latency = 0;
 
 	QString m_pluginDLL;
 	QMdiSubWindow * m_subWindow;
@@ -78,15 +78,18 @@ public:
 		constexpr auto octave = std::array{0.25f, 0.5f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
 		assert(harm < octave.size());
 
+		// steps per sample, twice the length at the base sample rate
+		const int steps = 2 * oversample / static_cast<int>(m_sampleRate / Engine::audioEngine()->baseSampleRate());
+
 		m_strings[id] = VibratingString{m_pitch * octave[harm], pick, pickup, impulse, m_bufferLength,
-			m_sampleRate, oversample, randomize, stringLoss, detune, state};
+			m_sampleRate, steps, randomize, stringLoss, detune, state};
 
 		m_exists[id] = true;
 	}
 
 	bool exists(int id) const { return m_exists[id]; }
 
-	sample_t getStringSample(int id) { return m_strings[id].nextSample(); }
+	void processString(int id, sample_t* out, fpp_t frames) { m_strings[id].process(out, frames); }
 
 private:
 	const float m_pitch;
@@ -237,16 +240,26 @@ void Vibed::playNote(NotePlayHandle* n, SampleFrame* workingBuffer)
 	{
 		workingBuffer[i][0] = 0.0f;
 		workingBuffer[i][1] = 0.0f;
-		for (int str = 0; str < s_stringCount; ++str)
+	}
+
+	// One string at a time over the whole period, which keeps its delay lines in the cache.
+	// Stepping the strings together as SIMD lanes measured slower, see VibratingStringTest:
+	// every lane reads its delay lines at its own index, so only the filter vectorizes.
+	std::array<sample_t, MAXIMUM_BUFFER_SIZE> stringBuffer;
+	for (int str = 0; str < s_stringCount; ++str)
+	{
+		if (!ps->exists(str)) { continue; }
+
+		ps->processString(str, stringBuffer.data(), frames);
+
+		// pan: 0 -> left, 1 -> right
+		const float pan = (m_panModels[str]->value() + 1) / 2.0f;
+		const float volume = m_volumeModels[str]->value();
+		for (fpp_t i = 0; i < frames; ++i)
 		{
-			if (ps->exists(str))
-			{
-				// pan: 0 -> left, 1 -> right
-				const float pan = (m_panModels[str]->value() + 1) / 2.0f;
-				const sample_t sample = ps->getStringSample(str) * m_volumeModels[str]->value() / 100.0f;
-				workingBuffer[i][0] += (1.0f - pan) * sample;
-				workingBuffer[i][1] += pan * sample;
-			}
+			const sample_t sample = stringBuffer[i] * volume / 100.0f;
+			workingBuffer[i + offset][0] += (1.0f - pan) * sample;
+			workingBuffer[i + offset][1] += pan * sample;
 		}
 	}
 }
@@ -24,8 +24,6 @@
 
 #include "VibratingString.h"
 #include "interpolation.h"
-#include "AudioEngine.h"
-#include "Engine.h"
 #include "LmmsTypes.h"
 
 #include <algorithm>
@@ -37,12 +35,11 @@ namespace lmms
 
 VibratingString::VibratingString(float pitch, float pick, float pickup, const float* impulse, int len,
 	sample_rate_t sampleRate, int oversample, float randomize, float stringLoss, float detune, bool state) :
-	m_oversample{2 * oversample / static_cast<int>(sampleRate / Engine::audioEngine()->baseSampleRate())},
+	m_oversample{oversample},
 	m_randomize{randomize},
 	m_stringLoss{1.0f - stringLoss},
 	m_choice{static_cast<int>(m_oversample * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX))},
-	m_state{0.1f},
-	m_outsamp{std::make_unique<sample_t[]>(m_oversample)}
+	m_state{0.1f}
 {
 	int stringLength = static_cast<int>(m_oversample * sampleRate / pitch) + 1;
 	stringLength += static_cast<int>(stringLength * -detune);
@@ -94,6 +91,63 @@ std::unique_ptr<VibratingString::DelayLine> VibratingString::initDelayLine(int l
 	return dl;
 }
 
+void VibratingString::process(sample_t* out, fpp_t frames)
+{
+	/*
+	 * The wave travels to the right in the "from bridge" delay line and to
+	 * the left in the "to bridge" delay line. Position 0 of both is at their
+	 * current index, positions increase to the right.
+	 */
+	sample_t* const fromBridge = m_fromBridge->data.get();
+	sample_t* const toBridge = m_toBridge->data.get();
+	const int fromLength = m_fromBridge->length;
+	const int toLength = m_toBridge->length;
+	int fromIndex = static_cast<int>(m_fromBridge->pointer - fromBridge);
+	int toIndex = static_cast<int>(m_toBridge->pointer - toBridge);
+	// local copies, the compiler can't know the delay lines don't overlap them
+	const float stringLoss = m_stringLoss;
+	float state = m_state;
+
+	const auto access = [](const sample_t* delayLine, int length, int position)
+	{
+		while (position < 0) { position += length; }
+		while (position >= length) { position -= length; }
+		return delayLine[position];
+	};
+
+	const auto step = [&]
+	{
+		// Sample traveling into "bridge"
+		const sample_t ym0 = access(toBridge, toLength, toIndex + 1);
+		// Sample to "nut"
+		const sample_t ypM = access(fromBridge, fromLength, fromIndex + fromLength - 2);
+
+		// The wave moves one sample to the right, the "bridge-reflected"
+		// sample becomes the new position 0
+		if (--fromIndex < 0) { fromIndex = fromLength - 1; }
+		state = (state + ym0) * 0.5;
+		fromBridge[fromIndex] = -state * stringLoss;
+
+		// The "nut-reflected" sample goes to position 0, then the wave moves
+		// one sample to the left, turning it into the last position
+		toBridge[toIndex] = -ypM * stringLoss;
+		if (++toIndex >= toLength) { toIndex = 0; }
+	};
+
+	for (fpp_t frame = 0; frame < frames; ++frame)
+	{
+		// Only the output at the pickup position of one oversampled step is used
+		for (int i = 0; i < m_choice; ++i) { step(); }
+		out[frame] = access(fromBridge, fromLength, fromIndex + m_pickupLoc)
+			+ access(toBridge, toLength, toIndex + m_pickupLoc);
+		for (int i = m_choice; i < m_oversample; ++i) { step(); }
+	}
+
+	m_fromBridge->pointer = fromBridge + fromIndex;
+	m_toBridge->pointer = toBridge + toIndex;
+	m_state = state;
+}
+
 void VibratingString::resample(const float* src, f_cnt_t srcFrames, f_cnt_t dstFrames)
 {
 	for (f_cnt_t frame = 0; frame < dstFrames; ++frame)
@@ -38,6 +38,7 @@ class VibratingString
 {
 public:
 	VibratingString() = default;
+	//! @param oversample Steps of the string per output sample
 	VibratingString(float pitch, float pick, float pickup, const float* impulse, int len,
 		sample_rate_t sampleRate, int oversample, float randomize, float stringLoss, float detune, bool state);
 	~VibratingString() = default;
@@ -47,29 +48,8 @@ public:
 	VibratingString(VibratingString&&) noexcept = delete;
 	VibratingString& operator=(VibratingString&&) noexcept = default;
 
-	sample_t nextSample()
-	{
-		for (int i = 0; i < m_oversample; ++i)
-		{
-			// Output at pickup position
-			m_outsamp[i] = fromBridgeAccess(m_fromBridge.get(), m_pickupLoc);
-			m_outsamp[i] += toBridgeAccess(m_toBridge.get(), m_pickupLoc);
-
-			// Sample traveling into "bridge"
-			sample_t ym0 = toBridgeAccess(m_toBridge.get(), 1);
-			// Sample to "nut"
-			sample_t ypM = fromBridgeAccess(m_fromBridge.get(), m_fromBridge->length - 2);
-
-			// String state update
-
-			// Decrement pointer and then update
-			fromBridgeUpdate(m_fromBridge.get(), -bridgeReflection(ym0));
-			// Update and then increment pointer
-			toBridgeUpdate(m_toBridge.get(), -ypM);
-		}
-
-		return m_outsamp[m_choice];
-	}
+	//! Writes the next @p frames samples of the string to @p out
+	void process(sample_t* out, fpp_t frames);
 
 private:
 	struct DelayLine
@@ -91,8 +71,6 @@ private:
 	int m_choice;
 	float m_state;
 
-	std::unique_ptr<sample_t[]> m_outsamp;
-
 	std::unique_ptr<DelayLine> initDelayLine(int len);
 	void resample(const float* src, f_cnt_t srcFrames, f_cnt_t dstFrames);
 
@@ -140,107 +118,6 @@ private:
 			}
 		}
 	}
-
-	/**
-	 * toBridgeUpdate(dl, insamp);
-	 * Places "nut-reflected" sample from upper delay-line into
-	 * current lower delay-line pointer position (which represents
-	 * x = 0 position). The pointer is then incremented (i.e. the
-	 * wave travels one sample to the left), turning the previous
-	 * position into an "effective" x = L position for the next
-	 * iteration.
-	 */
-	void toBridgeUpdate(DelayLine* dl, sample_t insamp)
-	{
-		sample_t* ptr = dl->pointer;
-		*ptr = insamp * m_stringLoss;
-		++ptr;
-		if (ptr > dl->end)
-		{
-			ptr = dl->data.get();
-		}
-		dl->pointer = ptr;
-	}
-
-	/**
-	 * fromBridgeUpdate(dl, insamp);
-	 * Decrements current upper delay-line pointer position (i.e.
-	 * the wave travels one sample to the right), moving it to the
-	 * "effective" x = 0 position for the next iteration. The
-	 * "bridge-reflected" sample from lower delay-line is then placed
-	 * into this position.
-	 */
-	void fromBridgeUpdate(DelayLine* dl, sample_t insamp)
-	{
-		sample_t* ptr = dl->pointer;
-		--ptr;
-		if (ptr < dl->data.get())
-		{
-			ptr = dl->end;
-		}
-		*ptr = insamp * m_stringLoss;
-		dl->pointer = ptr;
-	}
-
-	/**
-	 * dlAccess(dl, position);
-	 * Returns sample "position" samples into delay-line's past.
-	 * Position "0" points to the most recently inserted sample.
-	 */
-	static sample_t dlAccess(DelayLine* dl, int position)
-	{
-		sample_t* outpos = dl->pointer + position;
-		while (outpos < dl->data.get())
-		{
-			outpos += dl->length;
-		}
-		while (outpos > dl->end)
-		{
-			outpos -= dl->length;
-		}
-		return *outpos;
-	}
-
-	/*
-	 * Right-going delay line:
-	 * -->---->---->---
-	 * x=0
-	 * (pointer)
-	 * Left-going delay line:
-	 * --<----<----<---
-	 * x=0
-	 * (pointer)
-	 */
-
-	/**
-	 * fromBridgeAccess(dl, position);
-	 * Returns spatial sample at position "position", where position zero
-	 * is equal to the current upper delay-line pointer position (x = 0).
-	 * In a right-going delay-line, position increases to the right, and
-	 * delay increases to the right => left = past and right = future.
-	 */
-	static sample_t fromBridgeAccess(DelayLine* dl, int position)
-	{
-		return dlAccess(dl, position);
-	}
-
-	/**
-	 * toBridgeAccess(dl, position);
-	 * Returns spatial sample at position "position", where position zero
-	 * is equal to the current lower delay-line pointer position (x = 0).
-	 * In a left-going delay-line, position increases to the right, and
-	 * delay DEcreases to the right => left = future and right = past.
-	 */
-	static sample_t toBridgeAccess(DelayLine* dl, int position)
-	{
-		return dlAccess(dl, position);
-	}
-
-	sample_t bridgeReflection(sample_t insamp)
-	{
-		m_state = (m_state + insamp) * 0.5;
-		return m_state;
-	}
 };
 
 
@@ -750,6 +750,7 @@ void RemoteVstPlugin::init( const std::string & _plugin_file )
 	sendMessage( message( IdVstPluginName ).addString( pluginName() ) );
 	debugMessage( std::string("plugin name: ") + pluginName() + "\n" );
 	sendMessage( message( IdVstPluginVersion ).addInt( pluginVersion() ) );
+	sendMessage( message( IdVstPluginLatency ).addInt( m_plugin->initialDelay ) );
 	sendMessage( message( IdVstPluginVendorString ).
 					addString( pluginVendorString() ) );
 	sendMessage( message( IdVstPluginProductString ).
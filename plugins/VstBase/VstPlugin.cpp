@@ -26,6 +26,8 @@
 
 #include "communication.h"
 
+#include <algorithm>
+
 #include <QtEndian>
 #include <QDebug>
 #include <QDir>
@@ -128,6 +130,7 @@ VstPlugin::VstPlugin( const QString & _plugin ) :
 			? ConfigManager::inst()->vstEmbedMethod()
 			: "headless" ),
 	m_version( 0 ),
+	m_latency( 0 ),
 	m_currentProgram()
 {
 	setSplittedChannels( true );
@@ -436,6 +439,10 @@ bool VstPlugin::processMessage( const message & _m )
 			m_version = _m.getInt();
 			break;
 
+		case IdVstPluginLatency:
+			m_latency = std::max(_m.getInt(), 0);
+			break;
+
 		case IdVstPluginVendorString:
 			m_vendorString = _m.getQString();
 			break;
@@ -70,6 +70,12 @@ public:
 	{
 		return m_version;
 	}
+
+	//! Frames by which the plugin's output lags behind, as it reported when loading
+	inline int latency() const
+	{
+		return m_latency;
+	}
 	
 	inline const QString & vendorString() const
 	{
@@ -156,6 +162,7 @@ private:
 
 	QString m_name;
 	int m_version;
+	int m_latency;
 	QString m_vendorString;
 	QString m_productString;
 	QString m_currentProgramName;
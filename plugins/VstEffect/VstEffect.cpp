@@ -25,6 +25,8 @@
 
 #include "VstEffect.h"
 
+#include <algorithm>
+
 #include "GuiApplication.h"
 #include "Song.h"
 #include "TextFloat.h"
@@ -105,6 +107,53 @@ Effect::ProcessStatus VstEffect::processImpl(SampleFrame* buf, const fpp_t frame
 
 
 
+Effect::ProcessStatus VstEffect::processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS> buf)
+{
+	assert(m_plugin != nullptr);
+	static thread_local auto tempBuf = std::array<std::array<float, MAXIMUM_BUFFER_SIZE>, DEFAULT_CHANNELS>();
+
+	const fpp_t frames = buf.frames();
+	float* tempChannels[DEFAULT_CHANNELS];
+	for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		std::copy_n(buf.bufferPtr(ch), frames, tempBuf[ch].data());
+		tempChannels[ch] = tempBuf[ch].data();
+	}
+	const auto temp = PlanarBufferView<float, DEFAULT_CHANNELS>{tempChannels, frames};
+
+	if (m_pluginMutex.tryLock(Engine::getSong()->isExporting() ? -1 : 0))
+	{
+		m_plugin->process(temp, temp);
+		m_pluginMutex.unlock();
+	}
+
+	const float w = wetLevel();
+	const float d = dryLevel();
+	for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		float* out = buf.bufferPtr(ch);
+		const float* wet = temp.bufferPtr(ch);
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			out[f] = w * wet[f] + d * out[f];
+		}
+	}
+
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
+f_cnt_t VstEffect::latency() const
+{
+	// the plugin is only loaded by the constructor
+	return m_plugin ? m_plugin->latency() : 0;
+}
+
+
+
+
 bool VstEffect::openPlugin(const QString& plugin)
 {
 	gui::TextFloat* tf = nullptr;
@@ -46,6 +46,9 @@ public:
 	~VstEffect() override = default;
 
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processPlanarImpl(PlanarBufferView<float, DEFAULT_CHANNELS> buf) override;
+	bool processesPlanar() const override { return true; }
+	f_cnt_t latency() const override;
 
 	EffectControls * controls() override
 	{
@@ -0,0 +1,613 @@
+/*
+ * ExprBlock.cpp - block evaluator for Xpressive expressions
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ExprBlock.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+namespace lmms
+{
+
+namespace
+{
+
+// The scalar functions mirror the definitions in exprtk, so that both
+// paths give the same results
+
+float add(float a, float b) { return a + b; }
+float sub(float a, float b) { return a - b; }
+float mul(float a, float b) { return a * b; }
+float div(float a, float b) { return a / b; }
+float mod(float a, float b) { return std::fmod(a, b); }
+float pow(float a, float b) { return std::pow(a, b); }
+float neg(float a) { return -a; }
+
+float less(float a, float b) { return a < b ? 1.f : 0.f; }
+float lessEqual(float a, float b) { return a <= b ? 1.f : 0.f; }
+float greater(float a, float b) { return a > b ? 1.f : 0.f; }
+float greaterEqual(float a, float b) { return a >= b ? 1.f : 0.f; }
+float equal(float a, float b) { return a == b ? 1.f : 0.f; }
+float notEqual(float a, float b) { return a != b ? 1.f : 0.f; }
+
+float abs(float x) { return std::abs(x); }
+float sin(float x) { return std::sin(x); }
+float cos(float x) { return std::cos(x); }
+float tan(float x) { return std::tan(x); }
+float cot(float x) { return 1.f / std::tan(x); }
+float asin(float x) { return std::asin(x); }
+float acos(float x) { return std::acos(x); }
+float atan(float x) { return std::atan(x); }
+float sinh(float x) { return std::sinh(x); }
+float cosh(float x) { return std::cosh(x); }
+float tanh(float x) { return std::tanh(x); }
+float asinh(float x) { return std::asinh(x); }
+float acosh(float x) { return std::acosh(x); }
+float atanh(float x) { return std::atanh(x); }
+float exp(float x) { return std::exp(x); }
+float log(float x) { return std::log(x); }
+float log2(float x) { return std::log2(x); }
+float log10(float x) { return std::log10(x); }
+float sqrt(float x) { return std::sqrt(x); }
+float floor(float x) { return std::floor(x); }
+float ceil(float x) { return std::ceil(x); }
+float round(float x) { return x < 0 ? std::ceil(x - 0.5f) : std::floor(x + 0.5f); }
+float trunc(float x) { return static_cast<float>(static_cast<long long>(x)); }
+float frac(float x) { return x - static_cast<long long>(x); }
+float sgn(float x) { return x > 0 ? 1.f : (x < 0 ? -1.f : 0.f); }
+
+float sinc(float x)
+{
+	return std::abs(x) >= std::numeric_limits<float>::epsilon() ? std::sin(x) / x : 1.f;
+}
+
+float atan2(float y, float x) { return std::atan2(y, x); }
+float hypot(float x, float y) { return std::sqrt(x * x + y * y); }
+float logn(float x, float n) { return std::log(x) / std::log(n); }
+float min(float a, float b) { return std::min(a, b); }
+float max(float a, float b) { return std::max(a, b); }
+float clamp(float lo, float x, float hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+std::string lowercase(std::string name)
+{
+	std::transform(name.begin(), name.end(), name.begin(),
+		[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return name;
+}
+
+//! Bitwise, so that NaN and -0 get their own register
+bool sameConstant(float a, float b)
+{
+	return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+void broadcastKernel(const ExprBlock::Instruction& in, std::size_t frames)
+{
+	std::fill(in.dst, in.dst + frames, *static_cast<const float*>(in.context));
+}
+
+//! Same as IntegrateFunction: yields the sum of all previous frames
+void integrateKernel(const ExprBlock::Instruction& in, std::size_t frames)
+{
+	const auto sampleRate = *static_cast<const unsigned int*>(in.context);
+	const float* x = in.args[0];
+	double sum = *in.accumulator;
+	for (std::size_t i = 0; i < frames; ++i)
+	{
+		const float value = x[i];
+		in.dst[i] = static_cast<float>(sum) / sampleRate;
+		sum += value;
+	}
+	*in.accumulator = sum;
+}
+
+} // namespace
+
+
+
+
+class ExprBlock::Parser
+{
+public:
+	Parser(ExprBlock& block, const std::string& text) :
+		m_block(block),
+		m_text(text)
+	{
+	}
+
+	bool parse(Operand& result)
+	{
+		result = parseComparison();
+		skipSpace();
+		return !m_failed && m_pos == m_text.size();
+	}
+
+private:
+	Operand parseComparison()
+	{
+		auto lhs = parseAdditive();
+		while (!m_failed)
+		{
+			Kernel kernel = nullptr;
+			if (accept("<=")) { kernel = &binaryKernel<lessEqual>; }
+			else if (accept(">=")) { kernel = &binaryKernel<greaterEqual>; }
+			else if (accept("==")) { kernel = &binaryKernel<equal>; }
+			else if (accept("!=") || accept("<>")) { kernel = &binaryKernel<notEqual>; }
+			else if (accept("<")) { kernel = &binaryKernel<less>; }
+			else if (accept(">")) { kernel = &binaryKernel<greater>; }
+			else if (accept("=")) { kernel = &binaryKernel<equal>; }
+			else { break; }
+
+			lhs = m_block.emit(kernel, {lhs, parseAdditive()});
+		}
+		return lhs;
+	}
+
+	Operand parseAdditive()
+	{
+		auto lhs = parseMultiplicative();
+		while (!m_failed)
+		{
+			if (accept("+")) { lhs = m_block.emit(&binaryKernel<add>, {lhs, parseMultiplicative()}); }
+			else if (accept("-")) { lhs = m_block.emit(&binaryKernel<sub>, {lhs, parseMultiplicative()}); }
+			else { break; }
+		}
+		return lhs;
+	}
+
+	Operand parseMultiplicative()
+	{
+		auto lhs = parseUnary();
+		while (!m_failed)
+		{
+			if (accept("*")) { lhs = m_block.emit(&binaryKernel<mul>, {lhs, parseUnary()}); }
+			else if (accept("/")) { lhs = m_block.emit(&binaryKernel<div>, {lhs, parseUnary()}); }
+			else if (accept("%")) { lhs = m_block.emit(&binaryKernel<mod>, {lhs, parseUnary()}); }
+			else { break; }
+		}
+		return lhs;
+	}
+
+	Operand parseUnary()
+	{
+		if (accept("-"))
+		{
+			++m_unaryDepth;
+			const auto operand = parseUnary();
+			--m_unaryDepth;
+			return m_block.emit(&unaryKernel<neg>, {operand});
+		}
+		if (accept("+")) { return parseUnary(); }
+		return parsePower();
+	}
+
+	Operand parsePower()
+	{
+		const auto base = parsePrimary();
+		if (!accept("^")) { return base; }
+
+		// how exprtk binds -x^y and x^y^z is left to exprtk
+		if (m_unaryDepth > 0) { return fail(); }
+		const auto exponent = parsePrimary();
+		if (peek('^')) { return fail(); }
+		return m_block.emit(&binaryKernel<pow>, {base, exponent});
+	}
+
+	Operand parsePrimary()
+	{
+		skipSpace();
+		if (m_failed || m_pos >= m_text.size()) { return fail(); }
+
+		if (accept("("))
+		{
+			const int unaryDepth = m_unaryDepth;
+			m_unaryDepth = 0;
+			const auto operand = parseComparison();
+			m_unaryDepth = unaryDepth;
+			return accept(")") ? operand : fail();
+		}
+
+		const char c = m_text[m_pos];
+		if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') { return parseNumber(); }
+
+		if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+		{
+			const auto name = parseIdentifier();
+			return accept("(") ? parseCall(name) : parseSymbol(name);
+		}
+
+		return fail();
+	}
+
+	Operand parseNumber()
+	{
+		const auto isDigit = [this] {
+			return m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]));
+		};
+		const std::size_t begin = m_pos;
+		while (isDigit()) { ++m_pos; }
+		if (m_pos < m_text.size() && m_text[m_pos] == '.') { ++m_pos; }
+		while (isDigit()) { ++m_pos; }
+		if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E'))
+		{
+			++m_pos;
+			if (m_pos < m_text.size() && (m_text[m_pos] == '+' || m_text[m_pos] == '-')) { ++m_pos; }
+			if (!isDigit()) { return fail(); }
+			while (isDigit()) { ++m_pos; }
+		}
+
+		// not strtof(), the decimal separator must not depend on the user's locale
+		std::istringstream stream(m_text.substr(begin, m_pos - begin));
+		stream.imbue(std::locale::classic());
+		float value = 0;
+		if (!(stream >> value)) { return fail(); }
+		return Operand{Operand::Kind::Constant, value};
+	}
+
+	Operand parseSymbol(const std::string& name)
+	{
+		if (const auto it = m_block.m_constants.find(name); it != m_block.m_constants.end())
+		{
+			return Operand{Operand::Kind::Constant, it->second};
+		}
+		if (const auto it = m_block.m_inputs.find(name); it != m_block.m_inputs.end())
+		{
+			return Operand{Operand::Kind::Input, 0, -1, it->second};
+		}
+		if (m_block.m_variables.count(name)) { return m_block.variable(name); }
+		return fail();
+	}
+
+	Operand parseCall(const std::string& name)
+	{
+		std::vector<Operand> args;
+		if (!accept(")"))
+		{
+			const int unaryDepth = m_unaryDepth;
+			m_unaryDepth = 0;
+			do { args.push_back(parseComparison()); } while (!m_failed && accept(","));
+			m_unaryDepth = unaryDepth;
+			if (!accept(")")) { return fail(); }
+		}
+		if (m_failed || args.empty()) { return fail(); }
+
+		if (name == "min" || name == "max" || name == "sum" || name == "avg")
+		{
+			const Kernel kernel = name == "min" ? &binaryKernel<min>
+				: name == "max" ? &binaryKernel<max>
+				: &binaryKernel<add>;
+			auto result = args[0];
+			for (std::size_t i = 1; i < args.size(); ++i) { result = m_block.emit(kernel, {result, args[i]}); }
+			if (name == "avg")
+			{
+				const auto count = Operand{Operand::Kind::Constant, static_cast<float>(args.size())};
+				result = m_block.emit(&binaryKernel<div>, {result, count});
+			}
+			return result;
+		}
+
+		if (name == "integrate" && m_block.m_sampleRate > 0 && args.size() == 1)
+		{
+			const auto accumulator = static_cast<int>(m_block.m_accumulators.size());
+			m_block.m_accumulators.push_back(0.0);
+			return m_block.emit(&integrateKernel, args, &m_block.m_sampleRate, false, accumulator);
+		}
+
+		const auto it = m_block.m_functions.find(name);
+		if (it == m_block.m_functions.end() || it->second.arity != static_cast<int>(args.size())) { return fail(); }
+		const auto& function = it->second;
+		return m_block.emit(function.kernel, args, function.context, function.pure);
+	}
+
+	std::string parseIdentifier()
+	{
+		std::string name;
+		while (m_pos < m_text.size())
+		{
+			const auto c = static_cast<unsigned char>(m_text[m_pos]);
+			if (!std::isalnum(c) && c != '_') { break; }
+			// symbols are case insensitive in exprtk
+			name += static_cast<char>(std::tolower(c));
+			++m_pos;
+		}
+		return name;
+	}
+
+	void skipSpace()
+	{
+		while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) { ++m_pos; }
+	}
+
+	bool peek(char c)
+	{
+		skipSpace();
+		return m_pos < m_text.size() && m_text[m_pos] == c;
+	}
+
+	bool accept(const char* token)
+	{
+		skipSpace();
+		const auto length = std::strlen(token);
+		if (m_text.compare(m_pos, length, token) != 0) { return false; }
+		m_pos += length;
+		return true;
+	}
+
+	Operand fail()
+	{
+		m_failed = true;
+		return Operand{};
+	}
+
+	ExprBlock& m_block;
+	const std::string& m_text;
+	std::size_t m_pos = 0;
+	int m_unaryDepth = 0;
+	bool m_failed = false;
+};
+
+
+
+
+ExprBlock::ExprBlock()
+{
+	const auto addUnary = [this](const char* name, Kernel kernel) { addFunction(name, 1, kernel); };
+	addUnary("abs", &unaryKernel<abs>);
+	addUnary("sin", &unaryKernel<sin>);
+	addUnary("cos", &unaryKernel<cos>);
+	addUnary("tan", &unaryKernel<tan>);
+	addUnary("cot", &unaryKernel<cot>);
+	addUnary("asin", &unaryKernel<asin>);
+	addUnary("acos", &unaryKernel<acos>);
+	addUnary("atan", &unaryKernel<atan>);
+	addUnary("sinh", &unaryKernel<sinh>);
+	addUnary("cosh", &unaryKernel<cosh>);
+	addUnary("tanh", &unaryKernel<tanh>);
+	addUnary("asinh", &unaryKernel<asinh>);
+	addUnary("acosh", &unaryKernel<acosh>);
+	addUnary("atanh", &unaryKernel<atanh>);
+	addUnary("sinc", &unaryKernel<sinc>);
+	addUnary("exp", &unaryKernel<exp>);
+	addUnary("log", &unaryKernel<log>);
+	addUnary("log2", &unaryKernel<log2>);
+	addUnary("log10", &unaryKernel<log10>);
+	addUnary("sqrt", &unaryKernel<sqrt>);
+	addUnary("floor", &unaryKernel<floor>);
+	addUnary("ceil", &unaryKernel<ceil>);
+	addUnary("round", &unaryKernel<round>);
+	addUnary("trunc", &unaryKernel<trunc>);
+	addUnary("frac", &unaryKernel<frac>);
+	addUnary("sgn", &unaryKernel<sgn>);
+
+	addFunction("atan2", 2, &binaryKernel<atan2>);
+	addFunction("hypot", 2, &binaryKernel<hypot>);
+	addFunction("logn", 2, &binaryKernel<logn>);
+	addFunction("pow", 2, &binaryKernel<pow>);
+	addFunction("mod", 2, &binaryKernel<mod>);
+	addFunction("clamp", 3, &ternaryKernel<clamp>);
+}
+
+
+
+
+void ExprBlock::addFunction(const std::string& name, int arity, Kernel kernel, const void* context, bool pure)
+{
+	m_functions[lowercase(name)] = Function{arity, kernel, context, pure};
+}
+
+
+
+
+void ExprBlock::addConstant(const std::string& name, float value)
+{
+	m_constants[lowercase(name)] = value;
+}
+
+
+
+
+void ExprBlock::addVariable(const std::string& name, const float* value)
+{
+	m_variables[lowercase(name)] = value;
+}
+
+
+
+
+void ExprBlock::addInput(const std::string& name, const float* values)
+{
+	m_inputs[lowercase(name)] = values;
+}
+
+
+
+
+void ExprBlock::setIntegrate(unsigned int sampleRate)
+{
+	m_sampleRate = sampleRate;
+}
+
+
+
+
+bool ExprBlock::compile(const std::string& expression)
+{
+	m_pending.clear();
+	m_registerUsed.clear();
+	m_variableRegisters.clear();
+	m_constantPool.clear();
+	m_program.clear();
+	m_accumulators.clear();
+	m_output = nullptr;
+
+	m_valid = Parser(*this, expression).parse(m_result);
+	if (!m_valid) { return false; }
+
+	// every constant that is used as a kernel argument needs a register
+	for (const auto& pending : m_pending)
+	{
+		for (std::size_t i = 0; i < pending.argCount; ++i)
+		{
+			const auto& arg = pending.args[i];
+			if (arg.kind != Operand::Kind::Constant) { continue; }
+			if (std::none_of(m_constantPool.begin(), m_constantPool.end(),
+				[&arg](float value) { return sameConstant(value, arg.value); }))
+			{
+				m_constantPool.push_back(arg.value);
+			}
+		}
+	}
+
+	m_registers.assign((m_registerUsed.size() + m_constantPool.size()) * BlockSize, 0.f);
+	for (std::size_t i = 0; i < m_constantPool.size(); ++i)
+	{
+		float* data = registerData(m_registerUsed.size() + i);
+		std::fill(data, data + BlockSize, m_constantPool[i]);
+	}
+
+	m_program.reserve(m_pending.size());
+	for (const auto& pending : m_pending)
+	{
+		auto& instruction = m_program.emplace_back();
+		instruction.kernel = pending.kernel;
+		instruction.dst = registerData(pending.dst);
+		instruction.args = {};
+		for (std::size_t i = 0; i < pending.argCount; ++i) { instruction.args[i] = resolve(pending.args[i]); }
+		instruction.context = pending.context;
+		instruction.accumulator = pending.accumulator >= 0 ? &m_accumulators[pending.accumulator] : nullptr;
+	}
+	if (m_result.kind != Operand::Kind::Constant) { m_output = resolve(m_result); }
+
+	m_pending.clear();
+	return true;
+}
+
+
+
+
+void ExprBlock::evaluate(float* out, std::size_t frames)
+{
+	for (const auto& instruction : m_program)
+	{
+		instruction.kernel(instruction, frames);
+	}
+
+	if (m_output) { std::copy(m_output, m_output + frames, out); }
+	else { std::fill(out, out + frames, m_result.value); }
+}
+
+
+
+
+ExprBlock::Operand ExprBlock::emit(Kernel kernel, const std::vector<Operand>& args, const void* context,
+	bool pure, int accumulator)
+{
+	const bool constant = std::all_of(args.begin(), args.end(),
+		[](const Operand& arg) { return arg.kind == Operand::Kind::Constant; });
+	if (pure && constant)
+	{
+		// fold it, like exprtk does
+		std::array<float, 3> values = {};
+		float result = 0;
+		for (std::size_t i = 0; i < args.size(); ++i) { values[i] = args[i].value; }
+		const auto instruction = Instruction{kernel, &result, {&values[0], &values[1], &values[2]}, context, nullptr};
+		kernel(instruction, 1);
+		return Operand{Operand::Kind::Constant, result};
+	}
+
+	// releasing the arguments first lets the result overwrite one of them,
+	// all kernels read a frame's arguments before writing its result
+	for (const auto& arg : args) { release(arg); }
+
+	auto pending = PendingInstruction{kernel, allocateRegister(), {}, args.size(), context, accumulator};
+	std::copy(args.begin(), args.end(), pending.args.begin());
+	m_pending.push_back(pending);
+	return Operand{Operand::Kind::Register, 0, pending.dst};
+}
+
+
+
+
+ExprBlock::Operand ExprBlock::variable(const std::string& name)
+{
+	auto it = m_variableRegisters.find(name);
+	if (it == m_variableRegisters.end())
+	{
+		const int reg = allocateRegister();
+		it = m_variableRegisters.emplace(name, reg).first;
+		m_pending.push_back(PendingInstruction{&broadcastKernel, reg, {}, 0, m_variables[name], -1});
+	}
+	return Operand{Operand::Kind::Variable, 0, it->second};
+}
+
+
+
+
+int ExprBlock::allocateRegister()
+{
+	const auto it = std::find(m_registerUsed.begin(), m_registerUsed.end(), false);
+	if (it != m_registerUsed.end())
+	{
+		*it = true;
+		return static_cast<int>(it - m_registerUsed.begin());
+	}
+	m_registerUsed.push_back(true);
+	return static_cast<int>(m_registerUsed.size() - 1);
+}
+
+
+
+
+void ExprBlock::release(const Operand& operand)
+{
+	if (operand.kind == Operand::Kind::Register) { m_registerUsed[operand.reg] = false; }
+}
+
+
+
+
+const float* ExprBlock::resolve(const Operand& operand)
+{
+	switch (operand.kind)
+	{
+	case Operand::Kind::Register:
+	case Operand::Kind::Variable:
+		return registerData(operand.reg);
+	case Operand::Kind::Input:
+		return operand.input;
+	case Operand::Kind::Constant:
+	default:
+	{
+		const auto it = std::find_if(m_constantPool.begin(), m_constantPool.end(),
+			[&operand](float value) { return sameConstant(value, operand.value); });
+		return registerData(m_registerUsed.size() + (it - m_constantPool.begin()));
+	}
+	}
+}
+
+
+} // namespace lmms
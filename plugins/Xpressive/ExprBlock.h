@@ -0,0 +1,175 @@
+/*
+ * ExprBlock.h - block evaluator for Xpressive expressions
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef EXPRBLOCK_H
+#define EXPRBLOCK_H
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace lmms
+{
+
+
+/**
+	Compiles an Xpressive expression into a flat list of instructions that
+	each process a whole block of frames, instead of walking the expression
+	tree once per frame like exprtk does.
+
+	Only the subset of the exprtk language that Xpressive patches normally
+	use is understood. compile() returns false for anything else (and for
+	stateful functions like last() and rand()), in which case the caller
+	keeps using the per-sample exprtk path.
+*/
+class ExprBlock
+{
+public:
+	//! Maximum number of frames per evaluate() call
+	static constexpr std::size_t BlockSize = 64;
+
+	struct Instruction;
+	using Kernel = void (*)(const Instruction&, std::size_t frames);
+
+	ExprBlock();
+	//! Compiled instructions point into the block's own registers
+	ExprBlock(const ExprBlock&) = delete;
+	ExprBlock& operator=(const ExprBlock&) = delete;
+
+	struct Instruction
+	{
+		Kernel kernel;
+		float* dst;
+		std::array<const float*, 3> args;
+		//! Function specific data, e.g. the wave of W1
+		const void* context;
+		//! Running sum of integrate()
+		double* accumulator;
+	};
+
+	//! Kernel applying \p F to each frame
+	template<float (*F)(float)>
+	static void unaryKernel(const Instruction& in, std::size_t frames)
+	{
+		const float* a = in.args[0];
+		for (std::size_t i = 0; i < frames; ++i) { in.dst[i] = F(a[i]); }
+	}
+
+	template<float (*F)(float, float)>
+	static void binaryKernel(const Instruction& in, std::size_t frames)
+	{
+		const float* a = in.args[0];
+		const float* b = in.args[1];
+		for (std::size_t i = 0; i < frames; ++i) { in.dst[i] = F(a[i], b[i]); }
+	}
+
+	template<float (*F)(float, float, float)>
+	static void ternaryKernel(const Instruction& in, std::size_t frames)
+	{
+		const float* a = in.args[0];
+		const float* b = in.args[1];
+		const float* c = in.args[2];
+		for (std::size_t i = 0; i < frames; ++i) { in.dst[i] = F(a[i], b[i], c[i]); }
+	}
+
+	//! Function arguments are always evaluated for the whole block, kernels
+	//! just map them to dst. \p pure functions of constants are folded.
+	void addFunction(const std::string& name, int arity, Kernel kernel, const void* context = nullptr, bool pure = true);
+	void addConstant(const std::string& name, float value);
+	//! Variable that is read once per block
+	void addVariable(const std::string& name, const float* value);
+	//! Variable with one value per frame, \p values must hold BlockSize floats
+	void addInput(const std::string& name, const float* values);
+	void setIntegrate(unsigned int sampleRate);
+
+	bool compile(const std::string& expression);
+	bool isValid() const { return m_valid; }
+
+	//! Evaluates the next \p frames (at most BlockSize) into \p out
+	void evaluate(float* out, std::size_t frames);
+
+private:
+	struct Operand
+	{
+		//! Variable registers are filled once per block and never reused
+		enum class Kind { Constant, Register, Variable, Input };
+		Kind kind = Kind::Constant;
+		float value = 0;
+		int reg = -1;
+		const float* input = nullptr;
+	};
+
+	struct PendingInstruction
+	{
+		Kernel kernel;
+		int dst;
+		std::array<Operand, 3> args;
+		std::size_t argCount;
+		const void* context;
+		int accumulator;
+	};
+
+	struct Function
+	{
+		int arity;
+		Kernel kernel;
+		const void* context;
+		bool pure;
+	};
+
+	class Parser;
+
+	Operand emit(Kernel kernel, const std::vector<Operand>& args, const void* context = nullptr,
+		bool pure = true, int accumulator = -1);
+	Operand variable(const std::string& name);
+	int allocateRegister();
+	void release(const Operand& operand);
+	const float* resolve(const Operand& operand);
+	float* registerData(std::size_t index) { return m_registers.data() + index * BlockSize; }
+
+	std::map<std::string, Function> m_functions;
+	std::map<std::string, float> m_constants;
+	std::map<std::string, const float*> m_variables;
+	std::map<std::string, const float*> m_inputs;
+	unsigned int m_sampleRate = 0;
+
+	// compiler state
+	std::vector<PendingInstruction> m_pending;
+	std::vector<bool> m_registerUsed;
+	std::map<std::string, int> m_variableRegisters;
+	std::vector<float> m_constantPool;
+
+	// compiled program
+	std::vector<Instruction> m_program;
+	std::vector<float> m_registers;
+	std::vector<double> m_accumulators;
+	Operand m_result;
+	const float* m_output = nullptr;
+	bool m_valid = false;
+};
+
+
+} // namespace lmms
+
+#endif
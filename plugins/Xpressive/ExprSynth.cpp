@@ -25,7 +25,9 @@
 
 #include "ExprSynth.h"
 
+#include <algorithm>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <cmath>
 #include <random>
@@ -197,6 +199,10 @@ struct WaveValueFunction : public exprtk::ifunction<T>
 	{}
 
 	inline T operator()(const T& index) override
+	{
+		return value(index);
+	}
+	inline T value(const T& index) const
 	{
 		return m_vec[(int) ( positiveFraction(index) * m_size )];
 	}
@@ -215,6 +221,10 @@ struct WaveValueFunctionInterpolate : public exprtk::ifunction<T>
 	{}
 
 	inline T operator()(const T& index) override
+	{
+		return value(index);
+	}
+	inline T value(const T& index) const
 	{
 		const T x = positiveFraction(index) * m_size;
 		const int ix = (int)x;
@@ -331,6 +341,11 @@ struct RandomVectorSeedFunction : public exprtk::ifunction<float>
 	}
 
 	inline float operator()(const float& index,const float& seed) override
+	{
+		return randsv(index, seed);
+	}
+
+	static inline float randsv(float index, float seed)
 	{
 		const int irseed = seed < 0 || std::isnan(seed) || std::isinf(seed) ? 0 : static_cast<int>(seed);
 		return randv(index, irseed);
@@ -357,6 +372,25 @@ struct RandomVectorFunction : public exprtk::ifunction<float>
 	const unsigned int m_rseed;
 };
 
+static void randv_kernel(const ExprBlock::Instruction& in, std::size_t frames)
+{
+	const int seed = static_cast<const RandomVectorFunction*>(in.context)->m_rseed;
+	for (std::size_t i = 0; i < frames; ++i)
+	{
+		in.dst[i] = RandomVectorSeedFunction::randv(in.args[0][i], seed);
+	}
+}
+
+template <typename WaveFunction>
+static void wave_kernel(const ExprBlock::Instruction& in, std::size_t frames)
+{
+	const auto wave = static_cast<const WaveFunction*>(in.context);
+	for (std::size_t i = 0; i < frames; ++i)
+	{
+		in.dst[i] = wave->value(in.args[0][i]);
+	}
+}
+
 namespace SimpleRandom {
 	std::mt19937 generator (17);  // mt19937 is a standard mersenne_twister_engine
 	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
@@ -397,6 +431,7 @@ public:
 
 	symbol_table_t m_symbol_table;
 	expression_t m_expression;
+	ExprBlock m_block;
 	std::string m_expression_string;
 	std::vector<WaveValueFunction<float>* > m_cyclics;
 	std::vector<WaveValueFunctionInterpolate<float>* > m_cyclics_interp;
@@ -527,6 +562,7 @@ static freefunc1<float,harmonic_semitone,true> harmonic_semitone_func;
 ExprFront::ExprFront(const char * expr, int last_func_samples)
 {
 	m_valid = false;
+	m_blockValid = false;
 	try
 	{
 		m_data = new ExprFrontData(last_func_samples);
@@ -536,7 +572,8 @@ ExprFront::ExprFront(const char * expr, int last_func_samples)
 
 		m_data->m_symbol_table.add_constant("e", std::numbers::e_v<float>);
 
-		m_data->m_symbol_table.add_constant("seed", SimpleRandom::generator() & max_float_integer_mask);
+		const float seed = SimpleRandom::generator() & max_float_integer_mask;
+		m_data->m_symbol_table.add_constant("seed", seed);
 
 		m_data->m_symbol_table.add_function("sinew", sin_wave_func);
 		m_data->m_symbol_table.add_function("squarew", square_wave_func);
@@ -552,6 +589,24 @@ ExprFront::ExprFront(const char * expr, int last_func_samples)
 		m_data->m_symbol_table.add_function("randv", m_data->m_rand_vec);
 		m_data->m_symbol_table.add_function("randsv", randsv_func);
 		m_data->m_symbol_table.add_function("last", m_data->m_last_func);
+
+		// rand and last depend on the order of evaluation, they are left to exprtk
+		ExprBlock& block = m_data->m_block;
+		block.addConstant("pi", std::numbers::pi_v<float>);
+		block.addConstant("e", std::numbers::e_v<float>);
+		block.addConstant("seed", seed);
+		block.addFunction("sinew", 1, &ExprBlock::unaryKernel<&sin_wave::process>);
+		block.addFunction("squarew", 1, &ExprBlock::unaryKernel<&square_wave::process>);
+		block.addFunction("trianglew", 1, &ExprBlock::unaryKernel<&triangle_wave::process>);
+		block.addFunction("saww", 1, &ExprBlock::unaryKernel<&saw_wave::process>);
+		block.addFunction("moogsaww", 1, &ExprBlock::unaryKernel<&moogsaw_wave::process>);
+		block.addFunction("moogw", 1, &ExprBlock::unaryKernel<&moog_wave::process>);
+		block.addFunction("expw", 1, &ExprBlock::unaryKernel<&exp_wave::process>);
+		block.addFunction("expnw", 1, &ExprBlock::unaryKernel<&exp2_wave::process>);
+		block.addFunction("cent", 1, &ExprBlock::unaryKernel<&harmonic_cent::process>);
+		block.addFunction("semitone", 1, &ExprBlock::unaryKernel<&harmonic_semitone::process>);
+		block.addFunction("randv", 1, &randv_kernel, &m_data->m_rand_vec);
+		block.addFunction("randsv", 2, &ExprBlock::binaryKernel<&RandomVectorSeedFunction::randsv>);
 	}
 	catch(...)
 	{
@@ -583,6 +638,7 @@ bool ExprFront::compile()
 		parser_t parser(sstore);
 
 		m_valid=parser.compile(m_data->m_expression_string, m_data->m_expression);
+		m_blockValid = m_valid && m_data->m_block.compile(m_data->m_expression_string);
 	}
 	catch(...)
 	{
@@ -606,10 +662,29 @@ float ExprFront::evaluate()
 	return 0;
 
 }
+void ExprFront::evaluateBlock(float* out, std::size_t frames)
+{
+	m_data->m_block.evaluate(out, frames);
+}
 bool ExprFront::add_variable(const char* name, float& ref)
 {
 	try
 	{
+		m_data->m_block.addVariable(name, &ref);
+		return m_data->m_symbol_table.add_variable(name, ref);
+	}
+	catch(...)
+	{
+		WARN_EXPRTK;
+	}
+	return false;
+}
+
+bool ExprFront::add_frame_variable(const char* name, float& ref, const float* frames)
+{
+	try
+	{
+		m_data->m_block.addInput(name, frames);
 		return m_data->m_symbol_table.add_variable(name, ref);
 	}
 	catch(...)
@@ -623,6 +698,7 @@ bool ExprFront::add_constant(const char* name, float ref)
 {
 	try
 	{
+		m_data->m_block.addConstant(name, ref);
 		return m_data->m_symbol_table.add_constant(name, ref);
 	}
 	catch(...)
@@ -640,12 +716,14 @@ bool ExprFront::add_cyclic_vector(const char* name, const float* data, size_t le
 		{
 			auto wvf = new WaveValueFunctionInterpolate<float>(data, length);
 			m_data->m_cyclics_interp.push_back(wvf);
+			m_data->m_block.addFunction(name, 1, &wave_kernel<WaveValueFunctionInterpolate<float>>, wvf, false);
 			return m_data->m_symbol_table.add_function(name, *wvf);
 		}
 		else
 		{
 			auto wvf = new WaveValueFunction<float>(data, length);
 			m_data->m_cyclics.push_back(wvf);
+			m_data->m_block.addFunction(name, 1, &wave_kernel<WaveValueFunction<float>>, wvf, false);
 			return m_data->m_symbol_table.add_function(name, *wvf);
 		}
 	}
@@ -676,6 +754,7 @@ size_t find_occurances(const std::string& haystack, const char* const needle)
 
 void ExprFront::setIntegrate(const unsigned int* const frameCounter, const unsigned int sample_rate)
 {
+	m_data->m_block.setIntegrate(sample_rate);
 	if (m_data->m_integ_func == nullptr)
 	{
 		const unsigned int ointeg = find_occurances(m_data->m_expression_string,"integrate");
@@ -721,10 +800,10 @@ ExprSynth::ExprSynth(const WaveSample *gW1, const WaveSample *gW2, const WaveSam
 		e->add_cyclic_vector("W1", m_W1->m_samples,m_W1->m_length, m_W1->m_interpolate);
 		e->add_cyclic_vector("W2", m_W2->m_samples,m_W2->m_length, m_W2->m_interpolate);
 		e->add_cyclic_vector("W3", m_W3->m_samples,m_W3->m_length, m_W3->m_interpolate);
-		e->add_variable("t", m_note_sample_sec);
-		e->add_variable("f", m_frequency);
-		e->add_variable("rel",m_released);
-		e->add_variable("trel",m_note_rel_sec);
+		e->add_frame_variable("t", m_note_sample_sec, m_block_t.data());
+		e->add_frame_variable("f", m_frequency, m_block_f.data());
+		e->add_frame_variable("rel", m_released, m_block_rel.data());
+		e->add_frame_variable("trel", m_note_rel_sec, m_block_trel.data());
 		e->setIntegrate(&m_note_sample,m_sample_rate);
 		e->compile();
 	};
@@ -755,35 +834,31 @@ void ExprSynth::renderOutput(fpp_t frames, SampleFrame* buf)
 		{
 			return;
 		}
-		float o1 = 0, o2 = 0;
-		float pn1 = m_pan1->value() * 0.5;
-		float pn2 = m_pan2->value() * 0.5;
+		std::array<float, ExprBlock::BlockSize> o1 = {}, o2 = {};
+		const float pn1 = m_pan1->value() * 0.5;
+		const float pn2 = m_pan2->value() * 0.5;
 		const float new_freq = m_nph->frequency();
 		const float freq_inc = (new_freq - m_frequency) / frames;
 		const bool is_released = m_nph->isReleased();
 
-		expression_t *o1_rawExpr = &(m_exprO1->getData()->m_expression);
-		expression_t *o2_rawExpr = &(m_exprO2->getData()->m_expression);
-		LastSampleFunction<float> * last_func1 = &m_exprO1->getData()->m_last_func;
-		LastSampleFunction<float> * last_func2 = &m_exprO2->getData()->m_last_func;
 		if (is_released && m_note_rel_sample == 0)
 		{
 			m_note_rel_sample = m_note_sample;
 		}
-		if (o1_valid && o2_valid)
+		for (fpp_t offset = 0; offset < frames; offset += ExprBlock::BlockSize)
 		{
-			for (fpp_t frame = 0; frame < frames ; ++frame)
+			const fpp_t block_frames = std::min<fpp_t>(frames - offset, ExprBlock::BlockSize);
+			// the values the variables take in each frame of this block
+			for (fpp_t frame = 0; frame < block_frames; ++frame)
 			{
 				if (is_released && m_released < 1)
 				{
 					m_released = fmin(m_released+m_rel_inc, 1);
 				}
-				o1 = o1_rawExpr->value();
-				o2 = o2_rawExpr->value();
-				last_func1->setLastSample(o1);//put result in the circular buffer for the "last" function.
-				last_func2->setLastSample(o2);
-				buf[frame][0] = (-pn1 + 0.5) * o1 + (-pn2 + 0.5) * o2;
-				buf[frame][1] = ( pn1 + 0.5) * o1 + ( pn2 + 0.5) * o2;
+				m_block_t[frame] = m_note_sample_sec;
+				m_block_f[frame] = m_frequency;
+				m_block_rel[frame] = m_released;
+				m_block_trel[frame] = m_note_rel_sec;
 				m_note_sample++;
 				m_note_sample_sec = m_note_sample / (float)m_sample_rate;
 				if (is_released)
@@ -792,33 +867,13 @@ void ExprSynth::renderOutput(fpp_t frames, SampleFrame* buf)
 				}
 				m_frequency += freq_inc;
 			}
-		}
-		else
-		{
 
-			if (o2_valid)
+			if (o1_valid) { evaluate(m_exprO1, o1.data(), block_frames); }
+			if (o2_valid) { evaluate(m_exprO2, o2.data(), block_frames); }
+			for (fpp_t frame = 0; frame < block_frames; ++frame)
 			{
-				o1_rawExpr = o2_rawExpr;
-				last_func1 = last_func2;
-				pn1 = pn2;
-			}
-			for (fpp_t frame = 0; frame < frames ; ++frame)
-			{
-				if (is_released && m_released < 1)
-				{
-					m_released = fmin(m_released+m_rel_inc, 1);
-				}
-				o1 = o1_rawExpr->value();
-				last_func1->setLastSample(o1);
-				buf[frame][0] = (-pn1 + 0.5) * o1;
-				buf[frame][1] = ( pn1 + 0.5) * o1;
-				m_note_sample++;
-				m_note_sample_sec = m_note_sample / (float)m_sample_rate;
-				if (is_released)
-				{
-					m_note_rel_sec = (m_note_sample - m_note_rel_sample) / (float)m_sample_rate;
-				}
-				m_frequency += freq_inc;
+				buf[offset + frame][0] = (-pn1 + 0.5) * o1[frame] + (-pn2 + 0.5) * o2[frame];
+				buf[offset + frame][1] = ( pn1 + 0.5) * o1[frame] + ( pn2 + 0.5) * o2[frame];
 			}
 		}
 		m_frequency = new_freq;
@@ -829,5 +884,39 @@ void ExprSynth::renderOutput(fpp_t frames, SampleFrame* buf)
 	}
 }
 
+void ExprSynth::evaluate(ExprFront* expr, float* out, fpp_t frames)
+{
+	if (expr->hasBlockProgram())
+	{
+		expr->evaluateBlock(out, frames);
+	}
+	else
+	{
+		evaluatePerSample(expr, out, frames);
+	}
+}
+
+void ExprSynth::evaluatePerSample(ExprFront* expr, float* out, fpp_t frames)
+{
+	expression_t* raw_expr = &expr->getData()->m_expression;
+	LastSampleFunction<float>* last_func = &expr->getData()->m_last_func;
+
+	// point the exprtk variables at each frame, the integrate function
+	// watches m_note_sample to find out when a new frame starts
+	const auto state = std::tuple(m_note_sample, m_note_sample_sec, m_frequency, m_released, m_note_rel_sec);
+	const unsigned int first_sample = m_note_sample - frames;
+	for (fpp_t frame = 0; frame < frames; ++frame)
+	{
+		m_note_sample = first_sample + frame;
+		m_note_sample_sec = m_block_t[frame];
+		m_frequency = m_block_f[frame];
+		m_released = m_block_rel[frame];
+		m_note_rel_sec = m_block_trel[frame];
+		out[frame] = raw_expr->value();
+		last_func->setLastSample(out[frame]);//put result in the circular buffer for the "last" function.
+	}
+	std::tie(m_note_sample, m_note_sample_sec, m_frequency, m_released, m_note_rel_sec) = state;
+}
+
 
 } // namespace lmms
@@ -25,9 +25,11 @@
 #ifndef EXPRSYNTH_H
 #define EXPRSYNTH_H
 
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include "ExprBlock.h"
 #include "Graph.h"
 
 namespace lmms
@@ -50,13 +52,19 @@ public:
 	inline bool isValid() { return m_valid; }
 	float evaluate();
 	bool add_variable(const char* name, float & ref);
+	//! exprtk reads \p ref, the block evaluator reads one value per frame from \p frames
+	bool add_frame_variable(const char* name, float& ref, const float* frames);
 	bool add_constant(const char* name, float  ref);
 	bool add_cyclic_vector(const char* name, const float* data, size_t length, bool interp = false);
 	void setIntegrate(const unsigned int* frameCounter, unsigned int sample_rate);
 	ExprFrontData* getData() { return m_data; }
+	//! Whether the expression can be evaluated a block at a time
+	inline bool hasBlockProgram() { return m_blockValid; }
+	void evaluateBlock(float* out, std::size_t frames);
 private:
 	ExprFrontData *m_data;
 	bool m_valid;
+	bool m_blockValid;
 	
 	static const int max_float_integer_mask=(1<<(std::numeric_limits<float>::digits))-1;
 
@@ -103,6 +111,9 @@ public:
 
 
 private:
+	void evaluate(ExprFront* expr, float* out, fpp_t frames);
+	void evaluatePerSample(ExprFront* expr, float* out, fpp_t frames);
+
 	ExprFront *m_exprO1, *m_exprO2;
 	const WaveSample *m_W1, *m_W2, *m_W3;
 	unsigned int m_note_sample;
@@ -117,6 +128,12 @@ private:
 	float m_rel_transition;
 	float m_rel_inc;
 
+	// t, f, rel and trel for each frame of the current block
+	std::array<float, ExprBlock::BlockSize> m_block_t;
+	std::array<float, ExprBlock::BlockSize> m_block_f;
+	std::array<float, ExprBlock::BlockSize> m_block_rel;
+	std::array<float, ExprBlock::BlockSize> m_block_trel;
+
 } ;
 
 
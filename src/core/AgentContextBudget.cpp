@@ -0,0 +1,233 @@
+/*
+ * AgentContextBudget.cpp - keeps agent requests within a token budget
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ */
+
+#include "AgentContextBudget.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+
+namespace lmms
+{
+
+//! Length of the result excerpt in a summary
+static constexpr int SummaryChars = 160;
+
+//! Tool results of the current turn get this short when even dropping
+//! every earlier turn isn't enough
+static constexpr int MinToolResultChars = 1000;
+
+namespace
+{
+
+QJsonValue shorten(const QJsonValue& value, int maxItems)
+{
+	if (value.isArray())
+	{
+		const QJsonArray array = value.toArray();
+		QJsonArray result;
+		for (int i = 0; i < std::min<int>(array.size(), maxItems); ++i)
+		{
+			result.append(shorten(array[i], maxItems));
+		}
+		if (array.size() > maxItems)
+		{
+			result.append(QString("... %1 more items").arg(array.size() - maxItems));
+		}
+		return result;
+	}
+
+	if (value.isObject())
+	{
+		const QJsonObject object = value.toObject();
+		QJsonObject result;
+		for (auto it = object.begin(); it != object.end(); ++it)
+		{
+			result[it.key()] = shorten(it.value(), maxItems);
+		}
+		return result;
+	}
+
+	return value;
+}
+
+QString toCompactJson(const QJsonValue& value)
+{
+	const QJsonDocument doc = value.isArray() ? QJsonDocument(value.toArray()) : QJsonDocument(value.toObject());
+	return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+}
+
+QString cut(const QString& text, int maxChars)
+{
+	if (text.size() <= maxChars) { return text; }
+	return text.left(maxChars) + QString("... [%1 more characters]").arg(text.size() - maxChars);
+}
+
+QJsonObject toJson(const ChatMessage& msg, const QString& content)
+{
+	QJsonObject jsonMsg;
+	jsonMsg["role"] = msg.role;
+	jsonMsg["content"] = content;
+
+	if (msg.role == "tool")
+	{
+		jsonMsg["tool_call_id"] = msg.toolCallId;
+	}
+	else if (msg.role == "assistant" && !msg.toolCalls.isEmpty())
+	{
+		jsonMsg["tool_calls"] = msg.toolCalls;
+	}
+	return jsonMsg;
+}
+
+int messageTokens(const QJsonObject& jsonMsg)
+{
+	return AgentContextBudget::estimateTokens(QString::fromUtf8(QJsonDocument(jsonMsg).toJson(QJsonDocument::Compact)));
+}
+
+} // namespace
+
+AgentContextBudget::AgentContextBudget(int maxTokens)
+	: m_maxTokens(maxTokens)
+{
+}
+
+int AgentContextBudget::estimateTokens(const QString& text)
+{
+	return (text.toUtf8().size() + 3) / 4;
+}
+
+QJsonArray AgentContextBudget::buildMessages(const QString& systemPrompt, const std::vector<ChatMessage>& history,
+	int reservedTokens) const
+{
+	// the current turn starts with the latest user message
+	size_t currentTurn = 0;
+	for (size_t i = history.size(); i > 0; --i)
+	{
+		if (history[i - 1].role == "user")
+		{
+			currentTurn = i - 1;
+			break;
+		}
+	}
+
+	const auto build = [&](int maxToolResultChars) {
+		std::vector<QJsonObject> messages;
+		messages.reserve(history.size());
+		for (size_t i = 0; i < history.size(); ++i)
+		{
+			const ChatMessage& msg = history[i];
+			QString content = msg.content;
+			if (msg.role == "tool")
+			{
+				content = i < currentTurn
+					? summarizeToolResult(msg.name, content)
+					: truncateToolResult(content, maxToolResultChars);
+			}
+			messages.push_back(toJson(msg, content));
+		}
+		return messages;
+	};
+
+	QJsonObject systemMsg;
+	systemMsg["role"] = "system";
+	systemMsg["content"] = systemPrompt;
+
+	const int budget = m_maxTokens - reservedTokens - messageTokens(systemMsg);
+	std::vector<QJsonObject> messages = build(MaxToolResultChars);
+
+	std::vector<int> tokens;
+	int total = 0;
+	for (const QJsonObject& msg : messages)
+	{
+		tokens.push_back(messageTokens(msg));
+		total += tokens.back();
+	}
+
+	// drop the oldest turns as a whole, tool results must follow their calls
+	size_t first = 0;
+	while (total > budget && first < currentTurn)
+	{
+		do
+		{
+			total -= tokens[first];
+			++first;
+		}
+		while (first < currentTurn && history[first].role != "user");
+	}
+
+	if (total > budget)
+	{
+		messages = build(MinToolResultChars);
+	}
+
+	QJsonArray result;
+	result.append(systemMsg);
+	for (size_t i = first; i < messages.size(); ++i)
+	{
+		result.append(messages[i]);
+	}
+	return result;
+}
+
+QString AgentContextBudget::truncateToolResult(const QString& result, int maxChars)
+{
+	if (result.size() <= maxChars) { return result; }
+
+	const QJsonDocument doc = QJsonDocument::fromJson(result.toUtf8());
+	if (doc.isNull())
+	{
+		return cut(result, maxChars);
+	}
+
+	const QJsonValue value = doc.isArray() ? QJsonValue(doc.array()) : QJsonValue(doc.object());
+	for (int maxItems = 64; maxItems > 0; maxItems /= 2)
+	{
+		const QString shortened = toCompactJson(shorten(value, maxItems));
+		if (shortened.size() <= maxChars) { return shortened; }
+	}
+
+	// long strings rather than long arrays
+	return cut(toCompactJson(shorten(value, 1)), maxChars);
+}
+
+QString AgentContextBudget::summarizeToolResult(const QString& toolName, const QString& result)
+{
+	const QJsonDocument doc = QJsonDocument::fromJson(result.toUtf8());
+	if (!doc.isObject())
+	{
+		return QString("[earlier %1 result] %2").arg(toolName, cut(result, SummaryChars));
+	}
+
+	// scalars are kept, arrays and objects only by their size
+	QStringList fields;
+	const QJsonObject object = doc.object();
+	for (auto it = object.begin(); it != object.end(); ++it)
+	{
+		const QJsonValue& value = it.value();
+		if (value.isArray())
+		{
+			fields << QString("%1: [%2 items]").arg(it.key()).arg(value.toArray().size());
+		}
+		else if (value.isObject())
+		{
+			fields << QString("%1: {%2 fields}").arg(it.key()).arg(value.toObject().size());
+		}
+		else
+		{
+			fields << QString("%1: %2").arg(it.key(), value.toVariant().toString());
+		}
+	}
+	return QString("[earlier %1 result] %2").arg(toolName, cut(fields.join(", "), SummaryChars));
+}
+
+} // namespace lmms
@@ -11,11 +11,19 @@
 
 #include "AgentManager.h"
 #include "AgentTools.h"
+#include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "Engine.h"
+#include "ProjectJournal.h"
 #include "Song.h"
+#include "ThreadPool.h"
 
+#include <QDebug>
+#include <QElapsedTimer>
 #include <QJsonDocument>
+#include <algorithm>
+#include <future>
+#include <optional>
 #include <QNetworkRequest>
 #include <QUrl>
 
@@ -40,11 +48,12 @@ AgentManager::AgentManager()
 	, m_model("anthropic/claude-4-5-sonnet")
 	, m_isProcessing(false)
 	, m_tools(std::make_unique<AgentTools>(this))
-	, m_currentToolCallIndex(0)
 	, m_currentReply(nullptr)
 	, m_isStreaming(false)
 {
 	m_apiKey = ConfigManager::inst()->value("agent", "apikey");
+	// lets a local mock server stand in for openrouter
+	m_apiUrl = ConfigManager::inst()->value("agent", "apiurl", OPENROUTER_API_URL);
 
 	// default model, need to try gemini 3
 	m_model = ConfigManager::inst()->value("agent", "model", "anthropic/claude-4-5-sonnet");
@@ -114,7 +123,6 @@ void AgentManager::clearHistory()
 	
 	m_conversationHistory.clear();
 	m_pendingToolCalls.clear();
-	m_currentToolCallIndex = 0;
 }
 
 void AgentManager::cancelCurrentRequest()
@@ -128,10 +136,7 @@ void AgentManager::cancelCurrentRequest()
 	}
 	
 	m_isStreaming = false;
-	m_streamBuffer.clear();
-	m_accumulatedContent.clear();
-	m_accumulatedThinking.clear();
-	m_accumulatedToolCalls = QJsonArray();
+	resetStreamingState();
 	
 	if (m_isProcessing)
 	{
@@ -163,63 +168,74 @@ QJsonObject AgentManager::buildRequestPayload() const
 	payload["model"] = m_model;
 	payload["stream"] = true;
 	
-	QJsonArray messages;
-	
-	QJsonObject systemMsg;
-	systemMsg["role"] = "system";
-	systemMsg["content"] = systemPrompt();
-	messages.append(systemMsg);
-	
-	// add convo to payload
-	for (const auto& msg : m_conversationHistory)
+	// only the tools that matter for the latest request, plus the ones already used in this turn
+	QString request;
+	for (auto it = m_conversationHistory.rbegin(); it != m_conversationHistory.rend(); ++it)
 	{
-		QJsonObject jsonMsg;
-		jsonMsg["role"] = msg.role;
-		
-		if (msg.role == "tool")
+		if (it->role == "user")
 		{
-			jsonMsg["tool_call_id"] = msg.toolCallId;
-			jsonMsg["content"] = msg.content;
+			request = it->content;
+			break;
 		}
-		else if (msg.role == "assistant" && !msg.toolCalls.isEmpty())
+	}
+	const QJsonArray tools = m_tools->getToolDefinitions(request, toolsOfCurrentTurn());
+	
+	const int toolTokens = AgentContextBudget::estimateTokens(
+		QString::fromUtf8(QJsonDocument(tools).toJson(QJsonDocument::Compact)));
+	const int responseTokens = ConfigManager::inst()->value("agent", "responsetokens", "4096").toInt();
+	const AgentContextBudget budget(ConfigManager::inst()->value("agent", "contextbudget", "32000").toInt());
+	
+	payload["messages"] = budget.buildMessages(systemPrompt(), m_conversationHistory, toolTokens + responseTokens);
+	payload["tools"] = tools;
+	
+	return payload;
+}
+
+QStringList AgentManager::toolsOfCurrentTurn() const
+{
+	QStringList tools;
+	for (auto it = m_conversationHistory.rbegin(); it != m_conversationHistory.rend() && it->role != "user"; ++it)
+	{
+		if (it->role == "tool" && !tools.contains(it->name))
 		{
-			jsonMsg["content"] = msg.content;
-			jsonMsg["tool_calls"] = msg.toolCalls;
+			tools << it->name;
 		}
-		else
+		if (it->role == "tool" && it->name == "request_tools")
 		{
-			jsonMsg["content"] = msg.content;
+			// the tools the model asked for stay available for the rest of the turn
+			const QJsonArray requested = QJsonDocument::fromJson(it->content.toUtf8()).object()["tools"].toArray();
+			for (const QJsonValue& tool : requested)
+			{
+				tools << tool.toString();
+			}
 		}
-		
-		messages.append(jsonMsg);
 	}
-	
-	payload["messages"] = messages;
-	payload["tools"] = m_tools->getToolDefinitions();
-	
-	return payload;
+	return tools;
 }
 
 void AgentManager::sendApiRequest()
 {
-	QUrl url(OPENROUTER_API_URL);
+	QUrl url(m_apiUrl);
 	QNetworkRequest request(url);
 	request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 	request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
 	request.setRawHeader("HTTP-Referer", "https://lmms.io");
 	request.setRawHeader("X-Title", "LMMS AI Producer");
 	
-	// Reset streaming state
-	m_streamBuffer.clear();
-	m_accumulatedContent.clear();
-	m_accumulatedThinking.clear();
-	m_accumulatedToolCalls = QJsonArray();
+	resetStreamingState();
 	m_isStreaming = true;
 	
-	QJsonObject payload = buildRequestPayload();
-	QJsonDocument doc(payload);
+	const QJsonObject payload = buildRequestPayload();
+	const QByteArray data = QJsonDocument(payload).toJson(QJsonDocument::Compact);
 	
-	m_currentReply = m_networkManager->post(request, doc.toJson());
+	RequestStats stats;
+	stats.payloadBytes = data.size();
+	stats.estimatedTokens = (data.size() + 3) / 4;
+	stats.toolCount = payload["tools"].toArray().size();
+	m_requestStats.push_back(stats);
+	m_requestTimer.start();
+	
+	m_currentReply = m_networkManager->post(request, data);
 	
 	// Connect streaming signals
 	connect(m_currentReply, &QNetworkReply::readyRead, 
@@ -261,33 +277,22 @@ void AgentManager::onStreamingReadyRead()
 {
 	if (!m_currentReply) return;
 	
-	QByteArray data = m_currentReply->readAll();
-	m_streamBuffer += QString::fromUtf8(data);
+	m_sseParser.feed(m_currentReply->readAll());
 	
 	// process sse format: data: {...}\n\n
-	while (true)
+	while (m_sseParser.next(m_eventData))
 	{
-		int dataIndex = m_streamBuffer.indexOf("data: ");
-		if (dataIndex == -1) break;
-		
-		int endIndex = m_streamBuffer.indexOf("\n", dataIndex);
-		if (endIndex == -1) break; //wait for more data
-		
-		QString line = m_streamBuffer.mid(dataIndex + 6, endIndex - dataIndex - 6).trimmed();
-		m_streamBuffer = m_streamBuffer.mid(endIndex + 1);
-		
-		if (line.isEmpty()) continue;
-		if (line == "[DONE]") 
+		if (m_eventData.isEmpty()) continue;
+		if (m_eventData == "[DONE]")
 		{
 			emit streamingFinished();
 			continue;
 		}
 		
-		QJsonDocument doc = QJsonDocument::fromJson(line.toUtf8());
+		QJsonDocument doc = QJsonDocument::fromJson(m_eventData);
 		if (doc.isNull() || !doc.isObject()) continue;
 		
-		QJsonObject chunk = doc.object();
-		processStreamingChunk(chunk);
+		processStreamingChunk(doc.object());
 	}
 }
 
@@ -309,17 +314,25 @@ void AgentManager::onStreamingFinished()
 	m_currentReply->deleteLater();
 	m_currentReply = nullptr;
 	m_isStreaming = false;
+
+	if (!m_requestStats.empty())
+	{
+		const RequestStats& stats = m_requestStats.back();
+		qDebug("Agent request: %d bytes, ~%d tokens, %d tools, first token after %lld ms, done after %lld ms",
+			stats.payloadBytes, stats.estimatedTokens, stats.toolCount,
+			static_cast<long long>(stats.timeToFirstTokenMs), static_cast<long long>(m_requestTimer.elapsed()));
+	}
 	
 	// check if we have tool calls to process
-	if (!m_accumulatedToolCalls.isEmpty())
+	if (!m_toolCallBuilders.empty())
 	{
 		ChatMessage assistantMsg;
 		assistantMsg.role = "assistant";
 		assistantMsg.content = m_accumulatedContent;
-		assistantMsg.toolCalls = m_accumulatedToolCalls;
+		assistantMsg.toolCalls = accumulatedToolCalls();
 		m_conversationHistory.push_back(assistantMsg);
 		
-		handleToolCalls(m_accumulatedToolCalls);
+		handleToolCalls(assistantMsg.toolCalls);
 	}
 	else if (!m_accumulatedContent.isEmpty())
 	{
@@ -355,6 +368,13 @@ void AgentManager::processStreamingChunk(const QJsonObject& chunk)
 	QJsonObject choice = choices[0].toObject();
 	QJsonObject delta = choice["delta"].toObject();
 	
+	if (!m_requestStats.empty() && m_requestStats.back().timeToFirstTokenMs < 0
+		&& (delta.contains("content") || delta.contains("reasoning") || delta.contains("thinking")
+			|| delta.contains("tool_calls")))
+	{
+		m_requestStats.back().timeToFirstTokenMs = m_requestTimer.elapsed();
+	}
+	
 	if (delta.contains("content"))
 	{
 		QString contentChunk = delta["content"].toString();
@@ -378,54 +398,56 @@ void AgentManager::processStreamingChunk(const QJsonObject& chunk)
 	
 	if (delta.contains("tool_calls"))
 	{
-		QJsonArray toolCallsArray = delta["tool_calls"].toArray();
+		// only the builder of each call is touched, its json is assembled
+		// once the stream is complete
+		const QJsonArray toolCallsArray = delta["tool_calls"].toArray();
 		for (const QJsonValue& tcValue : toolCallsArray)
 		{
-			QJsonObject tc = tcValue.toObject();
-			int index = tc["index"].toInt();
-			while (m_accumulatedToolCalls.size() <= index)
-			{
-				QJsonObject emptyTc;
-				emptyTc["id"] = "";
-				QJsonObject emptyFunc;
-				emptyFunc["name"] = "";
-				emptyFunc["arguments"] = "";
-				emptyTc["function"] = emptyFunc;
-				m_accumulatedToolCalls.append(emptyTc);
-			}
-			
-			QJsonObject existingTc = m_accumulatedToolCalls[index].toObject();
-			
-			if (tc.contains("id") && !tc["id"].toString().isEmpty())
+			const QJsonObject tc = tcValue.toObject();
+			const int index = tc["index"].toInt();
+			if (index < 0) continue;
+			if (m_toolCallBuilders.size() <= static_cast<size_t>(index))
 			{
-				existingTc["id"] = tc["id"].toString();
+				m_toolCallBuilders.resize(index + 1);
 			}
+			ToolCallBuilder& builder = m_toolCallBuilders[index];
 			
-			if (tc.contains("function"))
-			{
-				QJsonObject funcDelta = tc["function"].toObject();
-				QJsonObject existingFunc = existingTc["function"].toObject();
-				
-				if (funcDelta.contains("name") && !funcDelta["name"].toString().isEmpty())
-				{
-					existingFunc["name"] = funcDelta["name"].toString();
-				}
-				
-				if (funcDelta.contains("arguments"))
-				{
-					QString existingArgs = existingFunc["arguments"].toString();
-					existingArgs += funcDelta["arguments"].toString();
-					existingFunc["arguments"] = existingArgs;
-				}
-				
-				existingTc["function"] = existingFunc;
-			}
+			const QString id = tc["id"].toString();
+			if (!id.isEmpty()) builder.id = id;
 			
-			m_accumulatedToolCalls[index] = existingTc;
+			const QJsonObject funcDelta = tc["function"].toObject();
+			const QString name = funcDelta["name"].toString();
+			if (!name.isEmpty()) builder.name = name;
+			builder.arguments += funcDelta["arguments"].toString();
 		}
 	}
 }
 
+void AgentManager::resetStreamingState()
+{
+	m_sseParser.reset();
+	m_accumulatedContent.clear();
+	m_accumulatedThinking.clear();
+	m_toolCallBuilders.clear();
+}
+
+QJsonArray AgentManager::accumulatedToolCalls() const
+{
+	QJsonArray toolCalls;
+	for (const ToolCallBuilder& builder : m_toolCallBuilders)
+	{
+		QJsonObject function;
+		function["name"] = builder.name;
+		function["arguments"] = builder.arguments;
+		
+		QJsonObject tc;
+		tc["id"] = builder.id;
+		tc["function"] = function;
+		toolCalls.append(tc);
+	}
+	return toolCalls;
+}
+
 void AgentManager::processApiResponse(const QJsonObject& response)
 {
 	if (response.contains("error"))
@@ -482,7 +504,6 @@ void AgentManager::processApiResponse(const QJsonObject& response)
 void AgentManager::handleToolCalls(const QJsonArray& toolCalls)
 {
 	m_pendingToolCalls.clear();
-	m_currentToolCallIndex = 0;
 
 	for (const QJsonValue& tcValue : toolCalls)
 	{
@@ -500,39 +521,113 @@ void AgentManager::handleToolCalls(const QJsonArray& toolCalls)
 		m_pendingToolCalls.push_back(toolCall);
 	}
 	
-	if (!m_pendingToolCalls.empty())
+	if (m_pendingToolCalls.empty())
+	{
+		return;
+	}
+
+	// the edits of a turn stall the audio thread once and are undone in a single step, so the
+	// engine lock is held from the first to the last edit, also for the calls between them
+	size_t lastMutating = m_pendingToolCalls.size();
+	for (size_t i = 0; i < m_pendingToolCalls.size(); ++i)
+	{
+		if (m_tools->toolAccess(m_pendingToolCalls[i].name) == ToolAccess::Mutating) { lastMutating = i; }
+	}
+
+	std::optional<AudioEngine::RequestChangesGuard> guard;
+	Engine::projectJournal()->beginCheckPointGroup();
+
+	// consecutive read-only calls run together, everything in the order the model made the calls
+	size_t begin = 0;
+	while (begin < m_pendingToolCalls.size())
 	{
-		executeToolCall(m_pendingToolCalls[0]);
+		ToolAccess access = m_tools->toolAccess(m_pendingToolCalls[begin].name);
+		size_t end = begin + 1;
+		while (access == ToolAccess::ReadOnly && end < m_pendingToolCalls.size()
+			&& m_tools->toolAccess(m_pendingToolCalls[end].name) == access)
+		{
+			++end;
+		}
+
+		if (access == ToolAccess::Mutating && !guard)
+		{
+			guard.emplace(Engine::audioEngine()->requestChangesGuard());
+		}
+		executeToolCalls(begin, end, access);
+		if (end > lastMutating) { guard.reset(); }
+
+		begin = end;
 	}
+
+	Engine::projectJournal()->endCheckPointGroup();
+
+	m_pendingToolCalls.clear();
+	sendApiRequest();
 }
 
-void AgentManager::executeToolCall(const ToolCall& toolCall)
+void AgentManager::executeToolCalls(size_t begin, size_t end, ToolAccess access)
 {
-	emit toolCallStarted(toolCall.name, toolCall.arguments);
-	ToolResult result = m_tools->executeTool(toolCall.name, toolCall.arguments);
-	
-	// add tool result to convo
-	ChatMessage toolMsg;
-	toolMsg.role = "tool";
-	toolMsg.toolCallId = toolCall.id;
-	toolMsg.name = toolCall.name;
-	toolMsg.content = result.success ? result.result : result.error;
-	m_conversationHistory.push_back(toolMsg);
-	
-	emit toolCallCompleted(toolCall.name, result.success ? result.result : result.error);
+	for (size_t i = begin; i < end; ++i)
+	{
+		emit toolCallStarted(m_pendingToolCalls[i].name, m_pendingToolCalls[i].arguments);
+	}
 
-	m_currentToolCallIndex++;
-	if (m_currentToolCallIndex < m_pendingToolCalls.size())
+	std::vector<ToolRun> runs(end - begin);
+	if (access == ToolAccess::ReadOnly)
 	{
-		executeToolCall(m_pendingToolCalls[m_currentToolCallIndex]);
+		// this thread takes the first call itself and waits for the others. Nothing changes the
+		// project meanwhile, it is only edited on this thread.
+		std::vector<std::future<ToolRun>> futures;
+		for (size_t i = begin + 1; i < end; ++i)
+		{
+			futures.push_back(ThreadPool::instance().enqueue([this, i] { return runTool(m_pendingToolCalls[i]); }));
+		}
+		runs[0] = runTool(m_pendingToolCalls[begin]);
+		for (size_t i = 0; i < futures.size(); ++i)
+		{
+			runs[i + 1] = futures[i].get();
+		}
 	}
 	else
 	{
-		m_pendingToolCalls.clear();
-		m_currentToolCallIndex = 0;
-		sendApiRequest();
+		for (size_t i = begin; i < end; ++i)
+		{
+			runs[i - begin] = runTool(m_pendingToolCalls[i]);
+		}
+	}
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		const ToolCall& toolCall = m_pendingToolCalls[i];
+		const ToolRun& run = runs[i - begin];
+
+		ToolLatency& latency = m_toolLatencies[toolCall.name];
+		latency.calls++;
+		latency.totalUs += run.elapsedUs;
+		latency.maxUs = std::max(latency.maxUs, run.elapsedUs);
+		qDebug("Agent tool %s: %lld us (%d calls, average %lld us, max %lld us)", qUtf8Printable(toolCall.name),
+			static_cast<long long>(run.elapsedUs), latency.calls,
+			static_cast<long long>(latency.totalUs / latency.calls), static_cast<long long>(latency.maxUs));
+
+		// add tool result to convo
+		ChatMessage toolMsg;
+		toolMsg.role = "tool";
+		toolMsg.toolCallId = toolCall.id;
+		toolMsg.name = toolCall.name;
+		toolMsg.content = run.result.success ? run.result.result : run.result.error;
+		m_conversationHistory.push_back(toolMsg);
+
+		emit toolCallCompleted(toolCall.name, toolMsg.content);
 	}
 }
 
+AgentManager::ToolRun AgentManager::runTool(const ToolCall& toolCall)
+{
+	QElapsedTimer timer;
+	timer.start();
+	ToolResult result = m_tools->executeTool(toolCall.name, toolCall.arguments);
+	return {result, timer.nsecsElapsed() / 1000};
+}
+
 } // namespace lmms
 
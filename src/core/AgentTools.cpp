@@ -18,14 +18,52 @@
 #include "MidiClip.h"
 #include "Note.h"
 #include "PatternStore.h"
+#include "SampleDecoder.h"
+#include "SampleIndex.h"
 
-#include <QDir>
-#include <QDirIterator>
 #include <QJsonDocument>
+#include <QRegularExpression>
+#include <algorithm>
 
 namespace lmms
 {
 
+namespace
+{
+
+struct ToolGroup
+{
+	QString name;
+	QStringList keywords;
+	QStringList tools;
+};
+
+// cheap tools the model needs for almost anything, always sent
+const QStringList& coreTools()
+{
+	static const QStringList tools = {"list_tracks", "get_project_info", "get_tempo", "set_tempo",
+		"add_instrument_track", "add_sample_track", "request_tools"};
+	return tools;
+}
+
+// keywords are matched against the start of the words of a request
+const std::vector<ToolGroup>& toolGroups()
+{
+	static const std::vector<ToolGroup> groups = {
+		{"tracks", {"track", "instrument", "synth", "mute", "unmute", "solo", "rename", "name", "remove", "delete"},
+			{"set_track_name", "set_track_muted"}},
+		{"samples", {"sample", "drum", "kick", "snare", "hat", "clap", "perc", "loop", "sound"},
+			{"list_samples", "get_sample_categories"}},
+		{"notes", {"note", "melod", "chord", "pattern", "beat", "bass", "lead", "arp", "riff", "rhythm", "groove",
+			"clear", "compose", "write"},
+			{"add_notes_to_track", "get_track_notes", "clear_track_notes"}},
+		{"playback", {"play", "stop", "listen", "start", "pause"}, {"play_project", "stop_project"}},
+	};
+	return groups;
+}
+
+} // namespace
+
 AgentTools::AgentTools(QObject* parent)
 	: QObject(parent)
 {
@@ -37,12 +75,14 @@ AgentTools::~AgentTools() = default;
 void AgentTools::registerTool(const QString& name,
 							  const QString& description,
 							  const QJsonObject& parameters,
-							  ToolFunction function)
+							  ToolFunction function,
+							  ToolAccess access)
 {
 	ToolDefinition def;
 	def.name = name;
 	def.description = description;
 	def.parameters = parameters;
+	def.access = access;
 	
 	m_toolDefinitions[name] = def;
 	m_toolFunctions[name] = function;
@@ -59,7 +99,8 @@ void AgentTools::initializeTools()
 			{"properties", QJsonObject{}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return getTempo(args); }
+		[this](const QJsonObject& args) { return getTempo(args); },
+		ToolAccess::ReadOnly
 	);
 	
 	registerTool(
@@ -89,7 +130,8 @@ void AgentTools::initializeTools()
 			{"properties", QJsonObject{}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return listTracks(args); }
+		[this](const QJsonObject& args) { return listTracks(args); },
+		ToolAccess::ReadOnly
 	);
 	
 	registerTool(
@@ -171,7 +213,7 @@ void AgentTools::initializeTools()
 	// SAMPLE TOOLS
 	registerTool(
 		"list_samples",
-		"List available audio samples, optionally filtered by category or search term",
+		"List available audio samples, optionally filtered by category, search term, length or tempo",
 		QJsonObject{
 			{"type", "object"},
 			{"properties", QJsonObject{
@@ -183,6 +225,22 @@ void AgentTools::initializeTools()
 					{"type", "string"},
 					{"description", "Search term to filter sample names"}
 				}},
+				{"min_duration", QJsonObject{
+					{"type", "number"},
+					{"description", "Minimum sample length in seconds"}
+				}},
+				{"max_duration", QJsonObject{
+					{"type", "number"},
+					{"description", "Maximum sample length in seconds"}
+				}},
+				{"min_bpm", QJsonObject{
+					{"type", "number"},
+					{"description", "Minimum tempo of loops"}
+				}},
+				{"max_bpm", QJsonObject{
+					{"type", "number"},
+					{"description", "Maximum tempo of loops"}
+				}},
 				{"limit", QJsonObject{
 					{"type", "integer"},
 					{"description", "Maximum number of samples to return (default 20)"}
@@ -190,7 +248,8 @@ void AgentTools::initializeTools()
 			}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return listSamples(args); }
+		[this](const QJsonObject& args) { return listSamples(args); },
+		ToolAccess::ReadOnly
 	);
 	
 	registerTool(
@@ -201,7 +260,8 @@ void AgentTools::initializeTools()
 			{"properties", QJsonObject{}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return getSampleCategories(args); }
+		[this](const QJsonObject& args) { return getSampleCategories(args); },
+		ToolAccess::ReadOnly
 	);
 	
 	// NOTE/PATTERN TOOLS
@@ -264,7 +324,8 @@ void AgentTools::initializeTools()
 			}},
 			{"required", QJsonArray{"track_index"}}
 		},
-		[this](const QJsonObject& args) { return getTrackNotes(args); }
+		[this](const QJsonObject& args) { return getTrackNotes(args); },
+		ToolAccess::ReadOnly
 	);
 	
 	registerTool(
@@ -292,7 +353,8 @@ void AgentTools::initializeTools()
 			{"properties", QJsonObject{}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return getProjectInfo(args); }
+		[this](const QJsonObject& args) { return getProjectInfo(args); },
+		ToolAccess::ReadOnly
 	);
 	
 	registerTool(
@@ -303,7 +365,8 @@ void AgentTools::initializeTools()
 			{"properties", QJsonObject{}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return playProject(args); }
+		[this](const QJsonObject& args) { return playProject(args); },
+		ToolAccess::Standalone
 	);
 	
 	registerTool(
@@ -314,16 +377,64 @@ void AgentTools::initializeTools()
 			{"properties", QJsonObject{}},
 			{"required", QJsonArray{}}
 		},
-		[this](const QJsonObject& args) { return stopProject(args); }
+		[this](const QJsonObject& args) { return stopProject(args); },
+		ToolAccess::Standalone
+	);
+
+	// only the tools matching the user's message are sent, this gets the others
+	QJsonArray groupNames;
+	QStringList groupDescriptions;
+	for (const ToolGroup& group : toolGroups())
+	{
+		groupNames.append(group.name);
+		groupDescriptions << QString("%1 (%2)").arg(group.name, group.tools.join(", "));
+	}
+	registerTool(
+		"request_tools",
+		"Make a group of tools available for the rest of this request, if a tool you need is missing. "
+		"Groups: " + groupDescriptions.join("; "),
+		QJsonObject{
+			{"type", "object"},
+			{"properties", QJsonObject{
+				{"group", QJsonObject{
+					{"type", "string"},
+					{"enum", groupNames},
+					{"description", "Name of the group"}
+				}}
+			}},
+			{"required", QJsonArray{"group"}}
+		},
+		[this](const QJsonObject& args) { return requestTools(args); },
+		ToolAccess::ReadOnly
 	);
 }
 
-QJsonArray AgentTools::getToolDefinitions() const
+QJsonArray AgentTools::getToolDefinitions(const QString& request, const QStringList& alsoInclude) const
 {
+	QStringList relevant = coreTools();
+	relevant += alsoInclude;
+
+	bool matched = false;
+	const QStringList words = request.toLower().split(QRegularExpression("[^a-z0-9]+"), Qt::SkipEmptyParts);
+	for (const ToolGroup& group : toolGroups())
+	{
+		const bool mentioned = std::any_of(words.begin(), words.end(), [&](const QString& word) {
+			return std::any_of(group.keywords.begin(), group.keywords.end(),
+				[&](const QString& keyword) { return word.startsWith(keyword); });
+		});
+		if (mentioned)
+		{
+			relevant += group.tools;
+			matched = true;
+		}
+	}
+
 	QJsonArray tools;
 	
 	for (const auto& [name, def] : m_toolDefinitions)
 	{
+		if (matched && !relevant.contains(name)) { continue; }
+
 		QJsonObject tool;
 		tool["type"] = "function";
 		
@@ -344,6 +455,13 @@ bool AgentTools::hasTool(const QString& name) const
 	return m_toolFunctions.find(name) != m_toolFunctions.end();
 }
 
+ToolAccess AgentTools::toolAccess(const QString& name) const
+{
+	auto it = m_toolDefinitions.find(name);
+	// nothing is known about what an unknown tool touches
+	return it != m_toolDefinitions.end() ? it->second.access : ToolAccess::Standalone;
+}
+
 ToolResult AgentTools::executeTool(const QString& name, const QJsonObject& args)
 {
 	auto it = m_toolFunctions.find(name);
@@ -639,59 +757,55 @@ ToolResult AgentTools::setTrackMuted(const QJsonObject& args)
 // SAMPLE TOOL IMPLEMENTATIONS
 ToolResult AgentTools::listSamples(const QJsonObject& args)
 {
-	QString category = args["category"].toString();
-	QString search = args["search"].toString().toLower();
+	SampleIndex* index = Engine::sampleIndex();
+	if (!index)
+	{
+		return {false, "", "Sample library is not available"};
+	}
+
 	int limit = args.contains("limit") ? args["limit"].toInt() : 20;
-	
-	// get samples dirs
-	QStringList sampleDirs;
-	sampleDirs << ConfigManager::inst()->factorySamplesDir();
-	sampleDirs << ConfigManager::inst()->userSamplesDir();
-	
+
+	SampleIndex::Query query;
+	query.category = args["category"].toString();
+	query.tokens = args["search"].toString().split(' ', Qt::SkipEmptyParts);
+	query.minDuration = args["min_duration"].toDouble(query.minDuration);
+	query.maxDuration = args["max_duration"].toDouble(query.maxDuration);
+	query.minBpm = args["min_bpm"].toDouble(query.minBpm);
+	query.maxBpm = args["max_bpm"].toDouble(query.maxBpm);
+	query.limit = std::max(limit, 0);
+
+	for (const auto& type : SampleDecoder::supportedAudioTypes())
+	{
+		query.extensions << "*." + QString::fromStdString(type.extension);
+	}
+
+	// tools run on the gui thread, so they answer with what was indexed so far
+	const bool indexed = index->isReady();
+
 	QJsonArray samplesArray;
-	int count = 0;
-	
-	for (const QString& baseDir : sampleDirs)
+	for (const SampleIndex::Entry& entry : index->find(query))
 	{
-		QString searchDir = baseDir;
-		if (!category.isEmpty())
+		QJsonObject sample;
+		sample["name"] = entry.name;
+		sample["path"] = entry.path;
+		if (!entry.category.isEmpty())
 		{
-			searchDir = baseDir + category + "/";
+			sample["category"] = entry.category;
 		}
-		
-		QDirIterator it(searchDir, 
-			QStringList() << "*.wav" << "*.ogg" << "*.mp3" << "*.flac" << "*.ds",
-			QDir::Files, 
-			QDirIterator::Subdirectories);
-		
-		while (it.hasNext() && count < limit)
+		if (entry.analysed && entry.duration > 0)
 		{
-			QString filePath = it.next();
-			QString fileName = it.fileName();
-			
-			if (!search.isEmpty() && !fileName.toLower().contains(search))
+			sample["duration"] = entry.duration;
+			sample["sample_rate"] = entry.sampleRate;
+			sample["loudness_db"] = entry.loudness;
+			if (entry.bpm > 0)
 			{
-				continue;
+				sample["bpm"] = entry.bpm;
 			}
-			
-			QJsonObject sample;
-			sample["name"] = fileName;
-			sample["path"] = filePath;
-			
-
-			QString relativePath = filePath;
-			relativePath.remove(baseDir);
-			int slashIndex = relativePath.lastIndexOf('/');
-			if (slashIndex > 0)
-			{
-				sample["category"] = relativePath.left(slashIndex);
-			}
-			
-			samplesArray.append(sample);
-			count++;
 		}
+		samplesArray.append(sample);
 	}
-	
+
+	int count = samplesArray.size();
 	QJsonObject result;
 	result["samples"] = samplesArray;
 	result["count"] = count;
@@ -699,6 +813,10 @@ ToolResult AgentTools::listSamples(const QJsonObject& args)
 	{
 		result["note"] = QString("Results limited to %1. Use filters to narrow down.").arg(limit);
 	}
+	if (!indexed)
+	{
+		result["indexing"] = QString("The sample library is still being indexed, search again later for more results.");
+	}
 	
 	return {true, QJsonDocument(result).toJson(QJsonDocument::Compact), ""};
 }
@@ -706,47 +824,54 @@ ToolResult AgentTools::listSamples(const QJsonObject& args)
 ToolResult AgentTools::getSampleCategories(const QJsonObject& args)
 {
 	Q_UNUSED(args)
-	
+
+	SampleIndex* index = Engine::sampleIndex();
+	if (!index)
+	{
+		return {false, "", "Sample library is not available"};
+	}
+	const bool indexed = index->isReady();
+
 	QJsonArray categoriesArray;
-	QStringList seenCategories;
-	
-	QStringList sampleDirs;
-	sampleDirs << ConfigManager::inst()->factorySamplesDir();
-	sampleDirs << ConfigManager::inst()->userSamplesDir();
-	
-	for (const QString& baseDir : sampleDirs)
+	for (const SampleIndex::Category& category : index->categories())
 	{
-		QDir dir(baseDir);
-		if (!dir.exists()) continue;
-		
-		QStringList subdirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-		for (const QString& subdir : subdirs)
-		{
-			if (!seenCategories.contains(subdir))
-			{
-				seenCategories << subdir;
-				QDir catDir(baseDir + subdir);
-				int fileCount = catDir.entryList(
-					QStringList() << "*.wav" << "*.ogg" << "*.mp3" << "*.flac" << "*.ds",
-					QDir::Files
-				).count();
-				
-				QJsonObject cat;
-				cat["name"] = subdir;
-				cat["path"] = baseDir + subdir;
-				cat["file_count"] = fileCount;
-				categoriesArray.append(cat);
-			}
-		}
+		QJsonObject cat;
+		cat["name"] = category.name;
+		cat["path"] = category.path;
+		cat["file_count"] = category.fileCount;
+		categoriesArray.append(cat);
 	}
 	
 	QJsonObject result;
 	result["categories"] = categoriesArray;
 	result["count"] = categoriesArray.size();
+	if (!indexed)
+	{
+		result["indexing"] = QString("The sample library is still being indexed, file counts may be incomplete.");
+	}
 	
 	return {true, QJsonDocument(result).toJson(QJsonDocument::Compact), ""};
 }
 
+ToolResult AgentTools::requestTools(const QJsonObject& args)
+{
+	const QString name = args["group"].toString();
+	const auto& groups = toolGroups();
+	auto group = std::find_if(groups.begin(), groups.end(), [&](const ToolGroup& g) { return g.name == name; });
+	if (group == groups.end())
+	{
+		return {false, "", QString("Unknown tool group: %1").arg(name)};
+	}
+
+	// AgentManager sends these along with the next requests of the turn
+	QJsonObject result;
+	result["group"] = name;
+	result["tools"] = QJsonArray::fromStringList(group->tools);
+	result["message"] = QString("The tools of group '%1' are available now").arg(name);
+
+	return {true, QJsonDocument(result).toJson(QJsonDocument::Compact), ""};
+}
+
 // NOTE/PATTERN TOOL IMPLEMENTATIONS
 ToolResult AgentTools::addNotesToTrack(const QJsonObject& args)
 {
@@ -809,6 +934,7 @@ ToolResult AgentTools::addNotesToTrack(const QJsonObject& args)
 	}
 	
 	int notesAdded = 0;
+	MidiClip::NoteBatch batch(clip);
 	for (const QJsonValue& noteVal : notesArray)
 	{
 		QJsonObject noteObj = noteVal.toObject();
@@ -827,11 +953,10 @@ ToolResult AgentTools::addNotesToTrack(const QJsonObject& args)
 		// Create and add note
 		Note note(TimePos(length), TimePos(position), key, 
 				  static_cast<volume_t>(volume), DefaultPanning);
-		clip->addNote(note, false);
+		batch.addNote(note, false);
 		notesAdded++;
 	}
-	
-	clip->updateLength();
+	batch.commit();
 	
 	QJsonObject result;
 	result["success"] = true;
@@ -106,6 +106,13 @@ bool AudioBusHandle::processEffects()
 }
 
 
+f_cnt_t AudioBusHandle::latency() const
+{
+	const f_cnt_t effectsLatency = m_effects ? m_effects->latency() : 0;
+	return m_sourceLatency.load(std::memory_order_relaxed) + effectsLatency;
+}
+
+
 void AudioBusHandle::doProcessing()
 {
 	if (m_mutedModel && m_mutedModel->value())
@@ -225,7 +232,9 @@ void AudioBusHandle::doProcessing()
 
 	// handle effects
 	const bool anyOutputAfterEffects = processEffects();
-	if (anyOutputAfterEffects || m_bufferUsage)
+
+	// line up with slower tracks, this may still output audio after the input went silent
+	if (m_compensator.process(m_buffer, fpp, anyOutputAfterEffects || m_bufferUsage))
 	{
 		Engine::mixer()->mixToChannel(m_buffer, m_nextMixerChannel);	// send output to mixer
 																		// TODO: improve the flow here - convert to pull model
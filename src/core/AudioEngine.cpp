@@ -58,6 +58,7 @@
 #include "MidiApple.h"
 #include "MidiDummy.h"
 
+#include "AudioResampler.h"
 #include "BufferManager.h"
 
 namespace lmms
@@ -67,6 +68,8 @@ using LocklessListElement = LocklessList<PlayHandle*>::Element;
 
 static thread_local bool s_renderingThread = false;
 
+static constexpr std::size_t ResamplerStatesReserved = 32;
+
 
 
 
@@ -132,6 +135,8 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 
 	// now that framesPerPeriod is fixed initialize global BufferManager
 	BufferManager::init( m_framesPerPeriod );
+	// sample play handles are created on the audio thread, have their resamplers ready
+	AudioResampler::reserveStates(AudioResampler::Mode::Linear, DEFAULT_CHANNELS, ResamplerStatesReserved);
 
 	m_outputBufferRead = std::make_unique<SampleFrame[]>(m_framesPerPeriod);
 	m_outputBufferWrite = std::make_unique<SampleFrame[]>(m_framesPerPeriod);
@@ -179,6 +184,8 @@ AudioEngine::~AudioEngine()
 	{
 		delete[] input;
 	}
+
+	BufferManager::destroy();
 }
 
 
@@ -315,6 +322,10 @@ void AudioEngine::renderStageNoteSetup()
 	Mixer * mixer = Engine::mixer();
 	mixer->prepareMasterMix();
 
+	// dispatch MIDI input received during the last period, so it is
+	// applied sample-accurately by this period's play handles
+	m_midiClient->processQueuedInEvents(m_framesPerPeriod, outputSampleRate());
+
 	// create play-handles for new notes, samples etc.
 	Engine::getSong()->processNextBuffer();
 
@@ -344,6 +355,9 @@ void AudioEngine::renderStageEffects()
 {
 	AudioEngineProfiler::Probe profilerProbe(m_profiler, AudioEngineProfiler::DetailType::Effects);
 
+	// the tracks are delayed as they mix into their channels, so line them up first
+	Engine::mixer()->compensateLatency(m_audioBusHandles);
+
 	// STAGE 2: process effects of all instrument- and sampletracks
 	AudioEngineWorkerThread::fillJobQueue(m_audioBusHandles);
 	AudioEngineWorkerThread::startAndWaitForJobs();
@@ -386,7 +400,7 @@ void AudioEngine::renderStageMix()
 
 	MixHelpers::multiply(m_outputBufferWrite.get(), m_masterGain, m_framesPerPeriod);
 
-	emit nextAudioBuffer(m_outputBufferRead.get());
+	m_outputTap.process(m_outputBufferWrite.get(), m_framesPerPeriod);
 
 	// and trigger LFOs
 	EnvelopeAndLfoParameters::instances()->trigger();
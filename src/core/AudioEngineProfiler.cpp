@@ -59,6 +59,14 @@ void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPe
 		m_detailLoad[i].store(newLoad * 0.05f + oldLoad * 0.95f, std::memory_order_relaxed);
 	}
 
+	++m_totals.periods;
+	m_totals.frames += framesPerPeriod;
+	m_totals.periodTime += periodElapsed;
+	for (std::size_t i = 0; i < DetailCount; i++)
+	{
+		m_totals.detailTime[i] += m_detailTime[i];
+	}
+
 	if( m_outputFile.isOpen() )
 	{
 		m_outputFile.write( QString( "%1\n" ).arg( periodElapsed ).toLatin1() );
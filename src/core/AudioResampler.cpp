@@ -24,6 +24,8 @@
 
 #include "AudioResampler.h"
 
+#include <array>
+#include <atomic>
 #include <samplerate.h>
 #include <stdexcept>
 
@@ -49,15 +51,70 @@ constexpr auto converterType(AudioResampler::Mode mode) -> int
 		throw std::invalid_argument{"Invalid interpolation mode"};
 	}
 }
+
+constexpr auto ModeCount = static_cast<std::size_t>(AudioResampler::Mode::SincBest) + 1;
+constexpr auto MaxPooledChannels = ch_cnt_t{2};
+constexpr auto StatePoolSize = std::size_t{64};
+
+//! Free states of one mode and channel count. Slots are claimed by swapping
+//! the pointer out, so there is no ABA problem like with a linked free list.
+using StatePool = std::array<std::atomic<SRC_STATE*>, StatePoolSize>;
+std::array<std::array<StatePool, MaxPooledChannels>, ModeCount> s_statePools = {};
+
+auto statePool(AudioResampler::Mode mode, ch_cnt_t channels) -> StatePool*
+{
+	if (channels == 0 || channels > MaxPooledChannels) { return nullptr; }
+	return &s_statePools[static_cast<std::size_t>(mode)][channels - 1];
+}
+
+auto takeState(StatePool& pool) -> SRC_STATE*
+{
+	for (auto& slot : pool)
+	{
+		if (!slot.load(std::memory_order_relaxed)) { continue; }
+		if (const auto state = slot.exchange(nullptr, std::memory_order_acquire)) { return state; }
+	}
+	return nullptr;
+}
+
+auto putState(StatePool& pool, SRC_STATE* state) -> bool
+{
+	for (auto& slot : pool)
+	{
+		auto expected = static_cast<SRC_STATE*>(nullptr);
+		if (slot.compare_exchange_strong(expected, state, std::memory_order_release, std::memory_order_relaxed))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+auto newState(AudioResampler::Mode mode, ch_cnt_t channels) -> SRC_STATE*
+{
+	if (channels == 0) { throw std::logic_error{"Invalid channel count"}; }
+
+	auto error = 0;
+	const auto state = src_new(converterType(mode), channels, &error);
+	if (!state) { throw std::runtime_error{src_strerror(error)}; }
+	return state;
+}
+
+auto acquireState(AudioResampler::Mode mode, ch_cnt_t channels) -> SRC_STATE*
+{
+	if (const auto pool = statePool(mode, channels))
+	{
+		if (const auto state = takeState(*pool)) { return state; }
+	}
+	return newState(mode, channels);
+}
 } // namespace
 
 AudioResampler::AudioResampler(Mode mode, ch_cnt_t channels)
-	: m_state{src_new(converterType(mode), channels, &m_error)}
+	: m_state{acquireState(mode, channels), StateDeleter{mode, channels}}
 	, m_mode{mode}
 	, m_channels{channels}
 {
-	if (channels <= 0) { throw std::logic_error{"Invalid channel count"}; }
-	if (!m_state) { throw std::runtime_error{src_strerror(m_error)}; }
 }
 
 auto AudioResampler::process(InterleavedBufferView<const float> input, InterleavedBufferView<float> output) -> Result
@@ -94,9 +151,29 @@ void AudioResampler::reset()
 	}
 }
 
+void AudioResampler::reserveStates(Mode mode, ch_cnt_t channels, std::size_t count)
+{
+	const auto pool = statePool(mode, channels);
+	if (!pool) { return; }
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto state = newState(mode, channels);
+		if (!putState(*pool, state))
+		{
+			src_delete(state);
+			return;
+		}
+	}
+}
+
 void AudioResampler::StateDeleter::operator()(void* state)
 {
-	src_delete(static_cast<SRC_STATE*>(state));
+	const auto srcState = static_cast<SRC_STATE*>(state);
+	const auto pool = statePool(mode, channels);
+	// a reset state is as good as a new one
+	if (pool && src_reset(srcState) == 0 && putState(*pool, srcState)) { return; }
+	src_delete(srcState);
 }
 
 } // namespace lmms
@@ -0,0 +1,189 @@
+/*
+ * AudioTap.cpp - lock-free metering and scope data for GUI consumers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioTap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lmms
+{
+
+AudioTap::State::State(std::size_t scopeFrames) :
+	levels(LevelsCapacity),
+	scopeFrames(scopeFrames)
+{
+}
+
+
+
+
+AudioTap::AudioTap(std::size_t scopeFrames) :
+	m_state(std::make_shared<State>(scopeFrames))
+{
+}
+
+
+
+
+void AudioTap::process(const SampleFrame* buffer, fpp_t frames, float gain)
+{
+	State& state = *m_state;
+
+	if (state.levelSubscribers.load(std::memory_order_acquire) > 0)
+	{
+		Levels levels;
+		if (buffer != nullptr && frames > 0)
+		{
+			float sumLeft = 0.f;
+			float sumRight = 0.f;
+			for (fpp_t f = 0; f < frames; ++f)
+			{
+				const float left = buffer[f].left();
+				const float right = buffer[f].right();
+				levels.peakLeft = std::max(levels.peakLeft, std::abs(left));
+				levels.peakRight = std::max(levels.peakRight, std::abs(right));
+				sumLeft += left * left;
+				sumRight += right * right;
+			}
+			levels.peakLeft *= gain;
+			levels.peakRight *= gain;
+			levels.rmsLeft = std::sqrt(sumLeft / frames) * gain;
+			levels.rmsRight = std::sqrt(sumRight / frames) * gain;
+		}
+		// a full ring means the readers are busy, they'll catch up with later periods
+		state.levels.write(&levels, 1);
+	}
+
+	// the scope ring exists once the counter was incremented
+	if (buffer != nullptr && state.scopeSubscribers.load(std::memory_order_acquire) > 0)
+	{
+		state.scope->write(buffer, frames);
+	}
+}
+
+
+
+
+bool AudioTap::watched() const
+{
+	return m_state->levelSubscribers.load(std::memory_order_relaxed) > 0
+		|| m_state->scopeSubscribers.load(std::memory_order_relaxed) > 0;
+}
+
+
+
+
+AudioTap::Subscriber::Subscriber(const AudioTap& tap, bool scope) :
+	m_state(tap.m_state),
+	m_scope(scope)
+{
+	if (m_scope)
+	{
+		{
+			const auto lock = std::lock_guard{m_state->scopeMutex};
+			if (!m_state->scope)
+			{
+				m_state->scope = std::make_unique<LocklessRingBuffer<SampleFrame>>(m_state->scopeFrames);
+			}
+		}
+		m_scopeReader.emplace(*m_state->scope);
+		m_state->scopeSubscribers.fetch_add(1, std::memory_order_release);
+	}
+	else
+	{
+		m_levelsReader.emplace(m_state->levels);
+		m_state->levelSubscribers.fetch_add(1, std::memory_order_release);
+	}
+}
+
+
+
+
+AudioTap::Subscriber::~Subscriber()
+{
+	auto& subscribers = m_scope ? m_state->scopeSubscribers : m_state->levelSubscribers;
+	subscribers.fetch_sub(1, std::memory_order_release);
+}
+
+
+
+
+std::optional<AudioTap::Levels> AudioTap::Subscriber::levels()
+{
+	if (!m_levelsReader || m_levelsReader->empty()) { return std::nullopt; }
+
+	const auto periods = m_levelsReader->read_max(LevelsCapacity);
+	if (periods.size() == 0) { return std::nullopt; }
+
+	Levels result;
+	for (std::size_t i = 0; i < periods.size(); ++i)
+	{
+		const Levels& levels = periods[i];
+		result.peakLeft = std::max(result.peakLeft, levels.peakLeft);
+		result.peakRight = std::max(result.peakRight, levels.peakRight);
+		result.rmsLeft += levels.rmsLeft * levels.rmsLeft;
+		result.rmsRight += levels.rmsRight * levels.rmsRight;
+	}
+	result.rmsLeft = std::sqrt(result.rmsLeft / periods.size());
+	result.rmsRight = std::sqrt(result.rmsRight / periods.size());
+	return result;
+}
+
+
+
+
+std::size_t AudioTap::Subscriber::read(SampleFrame* dest, std::size_t maxFrames)
+{
+	if (!m_scopeReader || m_scopeReader->empty()) { return 0; }
+
+	const auto frames = m_scopeReader->read_max(m_state->scopeFrames);
+	const std::size_t count = std::min(frames.size(), maxFrames);
+	const std::size_t skipped = frames.size() - count;
+	for (std::size_t f = 0; f < count; ++f)
+	{
+		dest[f] = frames[skipped + f];
+	}
+	return count;
+}
+
+
+
+
+std::size_t AudioTap::Subscriber::updateWindow(SampleFrame* window, std::size_t frames)
+{
+	if (!m_scopeReader || m_scopeReader->empty()) { return 0; }
+
+	const auto input = m_scopeReader->read_max(m_state->scopeFrames);
+	const std::size_t count = std::min(input.size(), frames);
+	const std::size_t skipped = input.size() - count;
+
+	std::copy(window + count, window + frames, window);
+	for (std::size_t f = 0; f < count; ++f)
+	{
+		window[frames - count + f] = input[skipped + f];
+	}
+	return count;
+}
+
+
+} // namespace lmms
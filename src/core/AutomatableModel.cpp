@@ -25,6 +25,7 @@
 #include "AutomatableModel.h"
 
 #include <QRegularExpression>
+#include <algorithm>
 
 #include "lmms_math.h"
 
@@ -38,7 +39,7 @@
 namespace lmms
 {
 
-long AutomatableModel::s_periodCounter = 0;
+std::atomic<long> AutomatableModel::s_periodCounter = 0;
 
 
 
@@ -56,9 +57,14 @@ AutomatableModel::AutomatableModel(
 	m_setValueDepth( 0 ),
 	m_hasStrictStepSize( false ),
 	m_controllerConnection( nullptr ),
-	m_valueBuffer( static_cast<int>( Engine::audioEngine()->framesPerPeriod() ) ),
-	m_lastUpdatedPeriod( -1 ),
-	m_hasSampleExactData(false),
+	m_valueBuffers{ValueBuffer(static_cast<int>(Engine::audioEngine()->framesPerPeriod())),
+		ValueBuffer(static_cast<int>(Engine::audioEngine()->framesPerPeriod()))},
+	m_backBuffer(0),
+	m_claimedPeriod(-1),
+	m_publishedPeriod(-1),
+	m_publishedBuffer(nullptr),
+	m_automatedPeriod(-1),
+	m_automatedFrames(0),
 	m_useControllerValue(true)
 
 {
@@ -82,8 +88,6 @@ AutomatableModel::~AutomatableModel()
 		delete m_controllerConnection;
 	}
 
-	m_valueBuffer.clear();
-
 	emit destroyed( id() );
 }
 
@@ -394,6 +398,46 @@ void AutomatableModel::setAutomatedValue( const float value )
 
 
 
+void AutomatableModel::setAutomatedValues(const float* values, f_cnt_t offset, f_cnt_t frames)
+{
+	const long period = s_periodCounter.load(std::memory_order_relaxed);
+	const auto length = static_cast<f_cnt_t>(m_valueBuffers[0].length());
+	if (offset >= length || frames == 0) { return; }
+	frames = std::min(frames, length - offset);
+
+	if (m_automationBuffer.size() != length)
+	{
+		m_automationBuffer.resize(length);
+	}
+
+	float* buffer = m_automationBuffer.values();
+	if (m_automatedPeriod != period)
+	{
+		// automation started within this period, keep the current value until then
+		std::fill_n(buffer, offset, m_value);
+		m_automatedPeriod = period;
+	}
+
+	for (f_cnt_t frame = 0; frame < frames; ++frame)
+	{
+		buffer[offset + frame] = fittedValue(scaledValue(values[frame]));
+	}
+	m_automatedFrames = offset + frames;
+
+	++m_setValueDepth;
+	for (const auto& linkedModel : m_linkedModels)
+	{
+		if (!linkedModel->controllerConnection() && linkedModel->m_setValueDepth < 1)
+		{
+			linkedModel->setAutomatedValues(values, offset, frames);
+		}
+	}
+	--m_setValueDepth;
+}
+
+
+
+
 void AutomatableModel::setRange( const float min, const float max,
 							const float step )
 {
@@ -591,15 +635,49 @@ float AutomatableModel::controllerValue( int frameOffset ) const
 
 ValueBuffer * AutomatableModel::valueBuffer()
 {
-	QMutexLocker m( &m_valueBufferMutex );
+	const long period = s_periodCounter.load(std::memory_order_relaxed);
+
 	// if we've already calculated the valuebuffer this period, return the cached buffer
-	if( m_lastUpdatedPeriod == s_periodCounter )
+	if (m_publishedPeriod.load(std::memory_order_acquire) == period)
+	{
+		return m_publishedBuffer.load(std::memory_order_relaxed);
+	}
+
+	long claimed = m_claimedPeriod.load(std::memory_order_relaxed);
+	while (claimed < period)
 	{
-		return m_hasSampleExactData
-			? &m_valueBuffer
-			: nullptr;
+		if (m_claimedPeriod.compare_exchange_weak(claimed, period, std::memory_order_acquire))
+		{
+			ValueBuffer* vb = computeValueBuffer(m_valueBuffers[m_backBuffer]);
+			if (vb) { m_backBuffer ^= 1; }
+			m_publishedBuffer.store(vb, std::memory_order_release);
+			m_publishedPeriod.store(period, std::memory_order_release);
+			return vb;
+		}
+	}
+
+	// another thread is computing this period's buffer right now - this is
+	// only a few hundred floats, so spin briefly, but never stall the audio
+	// thread on a computing thread that got preempted
+	constexpr int MaxSpins = 1000;
+	for (int spin = 0; spin < MaxSpins; ++spin)
+	{
+		if (m_publishedPeriod.load(std::memory_order_acquire) == period)
+		{
+			return m_publishedBuffer.load(std::memory_order_relaxed);
+		}
 	}
 
+	// Either this period's buffer after all, or the previous period's one.
+	// That one stays intact, this period is computed into the other buffer.
+	return m_publishedBuffer.load(std::memory_order_acquire);
+}
+
+
+
+
+ValueBuffer* AutomatableModel::computeValueBuffer(ValueBuffer& target)
+{
 	float val = m_value; // make sure our m_value doesn't change midway
 
 	if (m_controllerConnection && m_useControllerValue && m_controllerConnection->getController()->isSampleExact())
@@ -608,32 +686,40 @@ ValueBuffer * AutomatableModel::valueBuffer()
 		if( vb )
 		{
 			float * values = vb->values();
-			float * nvalues = m_valueBuffer.values();
+			float * nvalues = target.values();
 			switch( m_scaleType )
 			{
 			case ScaleType::Linear:
-				for( int i = 0; i < m_valueBuffer.length(); i++ )
+				for( int i = 0; i < target.length(); i++ )
 				{
 					nvalues[i] = minValue<float>() + ( range() * values[i] );
 				}
 				break;
 			case ScaleType::Logarithmic:
-				for( int i = 0; i < m_valueBuffer.length(); i++ )
+				for( int i = 0; i < target.length(); i++ )
 				{
 					nvalues[i] = logToLinearScale( values[i] );
 				}
 				break;
 			default:
-				qFatal("AutomatableModel::valueBuffer() "
+				qFatal("AutomatableModel::computeValueBuffer() "
 					"lacks implementation for a scale type");
 				break;
 			}
-			m_lastUpdatedPeriod = s_periodCounter;
-			m_hasSampleExactData = true;
-			return &m_valueBuffer;
+			return &target;
 		}
 	}
 
+	if (m_automatedPeriod == s_periodCounter.load(std::memory_order_relaxed))
+	{
+		// sample-exact automation, holding its last value if the clip ended during this period
+		const float* values = m_automationBuffer.values();
+		std::copy_n(values, m_automatedFrames, target.values());
+		std::fill(target.values() + m_automatedFrames, target.values() + target.length(), values[m_automatedFrames - 1]);
+		m_oldValue = val;
+		return &target;
+	}
+
 	if (!m_controllerConnection)
 	{
 		AutomatableModel* lm = nullptr;
@@ -646,30 +732,24 @@ ValueBuffer * AutomatableModel::valueBuffer()
 		{
 			auto vb = lm->valueBuffer();
 			float * values = vb->values();
-			float * nvalues = m_valueBuffer.values();
+			float * nvalues = target.values();
 			for (int i = 0; i < vb->length(); i++)
 			{
 				nvalues[i] = fittedValue(values[i]);
 			}
-			m_lastUpdatedPeriod = s_periodCounter;
-			m_hasSampleExactData = true;
-			return &m_valueBuffer;
+			return &target;
 		}
 	}
 
 	if( m_oldValue != val )
 	{
-		m_valueBuffer.interpolate( m_oldValue, val );
+		target.interpolate( m_oldValue, val );
 		m_oldValue = val;
-		m_lastUpdatedPeriod = s_periodCounter;
-		m_hasSampleExactData = true;
-		return &m_valueBuffer;
+		return &target;
 	}
 
 	// if we have no sample-exact source for a ValueBuffer, return NULL to signify that no data is available at the moment
 	// in which case the recipient knows to use the static value() instead
-	m_lastUpdatedPeriod = s_periodCounter;
-	m_hasSampleExactData = false;
 	return nullptr;
 }
 
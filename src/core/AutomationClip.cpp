@@ -26,6 +26,10 @@
 
 #include "AutomationClip.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "AutomationNode.h"
 #include "AutomationClipView.h"
 #include "AutomationTrack.h"
@@ -56,6 +60,7 @@ AutomationClip::AutomationClip( AutomationTrack * _auto_track ) :
 	m_lastRecordedValue( 0 )
 {
 	changeLength( TimePos( 1, 0 ) );
+	updateCurve();
 }
 
 
@@ -83,6 +88,7 @@ AutomationClip::AutomationClip( const AutomationClip & _clip_to_copy ) :
 		// Sets the node's clip to this one
 		m_timeMap[POS(it)].setClip(this);
 	}
+	updateCurve();
 }
 
 bool AutomationClip::addObject( AutomatableModel * _obj, bool _search_dup )
@@ -125,6 +131,7 @@ void AutomationClip::setProgressionType(
 		_new_progression_type == ProgressionType::CubicHermite )
 	{
 		m_progressionType = _new_progression_type;
+		updateCurve();
 		emit dataChanged();
 	}
 }
@@ -142,6 +149,7 @@ void AutomationClip::setTension( QString _new_tension )
 	if( ok && nt > -0.01 && nt < 1.01 )
 	{
 		m_tension = nt;
+		updateCurve();
 	}
 }
 
@@ -261,6 +269,97 @@ TimePos AutomationClip::putValue(
 
 
 
+namespace
+{
+
+//! Differences too small to tell from float rounding
+constexpr float RoundingError = 1e-6f;
+
+//! Indices of the values that keep the curve within @p tolerance of all values
+std::vector<std::size_t> significantValues(std::span<const std::pair<TimePos, float>> values,
+	float tolerance, bool interpolated)
+{
+	auto kept = std::vector<std::size_t>{};
+	if (values.empty()) { return kept; }
+
+	const float reach = tolerance + RoundingError;
+	constexpr auto Infinity = std::numeric_limits<float>::infinity();
+
+	// Slopes of the lines from the last kept value that pass all values since
+	// within tolerance, narrowed by each value, so each value is looked at once
+	float minSlope = -Infinity;
+	float maxSlope = Infinity;
+
+	kept.push_back(0);
+	for (std::size_t i = 1; i + 1 < values.size(); ++i)
+	{
+		const auto& [anchorTime, anchorValue] = values[kept.back()];
+		if (!interpolated)
+		{
+			// The value is held until the next node, so it only matters if it changes
+			if (std::abs(values[i].second - anchorValue) > reach) { kept.push_back(i); }
+			continue;
+		}
+
+		const int distance = values[i].first - anchorTime;
+		if (distance != 0)
+		{
+			const float below = (values[i].second - reach - anchorValue) / distance;
+			const float above = (values[i].second + reach - anchorValue) / distance;
+			minSlope = std::max(minSlope, std::min(below, above));
+			maxSlope = std::min(maxSlope, std::max(below, above));
+		}
+		else if (std::abs(values[i].second - anchorValue) > reach)
+		{
+			// No line through the last kept value passes a different value at the same time
+			minSlope = Infinity;
+			maxSlope = -Infinity;
+		}
+
+		// Value i is needed if the line from the last kept value to the next one misses
+		// any value in between. Cubic Hermite curves are treated as lines, too.
+		const auto& [nextTime, nextValue] = values[i + 1];
+		const float slope = (nextValue - anchorValue) / std::max(nextTime - anchorTime, 1);
+		if (slope < minSlope || slope > maxSlope)
+		{
+			kept.push_back(i);
+			minSlope = -Infinity;
+			maxSlope = Infinity;
+		}
+	}
+	if (values.size() > 1) { kept.push_back(values.size() - 1); }
+
+	return kept;
+}
+
+} // namespace
+
+
+
+
+void AutomationClip::putValues(std::span<const std::pair<TimePos, float>> values, float tolerance)
+{
+	QMutexLocker m(&m_clipMutex);
+
+	cleanObjects();
+
+	const bool interpolated = m_progressionType != ProgressionType::Discrete;
+	for (const auto index : significantValues(values, tolerance, interpolated))
+	{
+		const auto time = std::max(TimePos(0), values[index].first);
+		m_timeMap[time] = AutomationNode(this, values[index].second, time);
+	}
+
+	generateTangents();
+
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
 /**
  * @brief Puts an automation node on the timeMap with the given inValue
  *        and outValue.
@@ -529,6 +628,7 @@ TimePos AutomationClip::setDragValue(
 			it.value().setInTangent(m_dragInTan);
 			it.value().setOutTangent(m_dragOutTan);
 			it.value().setLockedTangents(true);
+			updateCurve();
 		}
 	}
 
@@ -553,39 +653,59 @@ void AutomationClip::applyDragValue()
 
 float AutomationClip::valueAt( const TimePos & _time ) const
 {
-	QMutexLocker m(&m_clipMutex);
+	return curve()->valueAt(_time);
+}
 
-	if( m_timeMap.isEmpty() )
-	{
-		return 0;
-	}
 
-	// If we have a node at that time, just return its value
-	if (m_timeMap.contains(_time))
-	{
-		// When the time is exactly the node's time, we want the inValue
-		return m_timeMap[_time].getInValue();
-	}
 
-	// lowerBound returns next value with equal or greater key. Since we already
-	// checked if the key contains a node, we know the returned node has a greater
-	// key than _time. Therefore we take the previous element to calculate the current value
-	timeMap::const_iterator v = m_timeMap.lowerBound(_time);
 
-	if( v == m_timeMap.begin() )
-	{
-		return 0;
-	}
+std::shared_ptr<const AutomationCurve> AutomationClip::curve() const
+{
+	return std::atomic_load(&m_curve);
+}
+
 
-	const auto pv = std::prev(v);
 
-	if( v == m_timeMap.end() )
+
+void AutomationClip::updateCurve()
+{
+	QMutexLocker m(&m_clipMutex);
+
+	auto segments = std::vector<AutomationCurve::Segment>{};
+	segments.reserve(m_timeMap.size());
+
+	for (auto it = m_timeMap.cbegin(); it != m_timeMap.cend(); ++it)
 	{
-		// When the time is after the last node, we want the outValue of it
-		return OUTVAL(pv);
+		// Discrete, and after the last node: the outValue until the next node
+		auto segment = AutomationCurve::Segment{POS(it), 0.f, INVAL(it), {OUTVAL(it), 0.f, 0.f, 0.f}};
+
+		const auto nit = std::next(it);
+		if (nit != m_timeMap.cend())
+		{
+			const int length = POS(nit) - POS(it);
+			segment.inverseLength = 1.f / length;
+
+			auto& c = segment.coefficients;
+			if (m_progressionType == ProgressionType::Linear)
+			{
+				c[1] = INVAL(nit) - OUTVAL(it);
+			}
+			else if (m_progressionType == ProgressionType::CubicHermite)
+			{
+				// The Cubic Hermite spline of valueAt(), expanded into powers of t
+				const float p0 = OUTVAL(it);
+				const float p1 = INVAL(nit);
+				const float m1 = OUTTAN(it) * length * m_tension;
+				const float m2 = INTAN(nit) * length * m_tension;
+				c = {p0, m1, -3 * p0 - 2 * m1 + 3 * p1 - m2, 2 * p0 + m1 - 2 * p1 + m2};
+			}
+		}
+
+		segments.push_back(segment);
 	}
 
-	return valueAt(pv, _time - POS(pv));
+	std::atomic_store(&m_curve, std::shared_ptr<const AutomationCurve>{
+		std::make_shared<AutomationCurve>(std::move(segments))});
 }
 
 
@@ -896,6 +1016,7 @@ void AutomationClip::loadSettings( const QDomElement & _this )
 	}
 
 	if (shouldGenerateTangents) { generateTangents(); }
+	updateCurve();
 }
 
 
@@ -1080,6 +1201,7 @@ void AutomationClip::clear()
 	QMutexLocker m(&m_clipMutex);
 
 	m_timeMap.clear();
+	updateCurve();
 
 	emit dataChanged();
 }
@@ -1205,6 +1327,8 @@ void AutomationClip::generateTangents(timeMap::iterator it, int numToGenerate)
 			}
 		}
 	}
+
+	updateCurve();
 }
 
 std::vector<Track*> AutomationClip::combineAllTracks()
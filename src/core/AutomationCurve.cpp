@@ -0,0 +1,84 @@
+/*
+ * AutomationCurve.cpp - automation nodes compiled for fast playback
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AutomationCurve.h"
+
+#include <algorithm>
+
+namespace lmms
+{
+
+AutomationCurve::AutomationCurve(std::vector<Segment> segments) :
+	m_segments(std::move(segments))
+{
+}
+
+
+
+
+float AutomationCurve::valueAt(double tick) const
+{
+	return valueBefore(segmentAfter(tick), tick);
+}
+
+
+
+
+void AutomationCurve::render(double tick, double ticksPerFrame, float* out, std::size_t frames) const
+{
+	auto next = segmentAfter(tick);
+	for (std::size_t frame = 0; frame < frames; ++frame)
+	{
+		const double position = tick + frame * ticksPerFrame;
+		while (next != m_segments.end() && position >= next->start) { ++next; }
+		out[frame] = valueBefore(next, position);
+	}
+}
+
+
+
+
+AutomationCurve::Iterator AutomationCurve::segmentAfter(double tick) const
+{
+	return std::upper_bound(m_segments.begin(), m_segments.end(), tick,
+		[](double t, const Segment& segment) { return t < segment.start; });
+}
+
+
+
+
+float AutomationCurve::valueBefore(Iterator next, double tick) const
+{
+	// before the first node
+	if (next == m_segments.begin()) { return 0; }
+
+	const Segment& segment = *std::prev(next);
+	const double offset = tick - segment.start;
+	if (offset == 0) { return segment.inValue; }
+
+	const float t = static_cast<float>(offset) * segment.inverseLength;
+	const auto& c = segment.coefficients;
+	return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+}
+
+
+} // namespace lmms
@@ -26,30 +26,273 @@
 
 #include "BufferManager.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "LmmsSemaphore.h"
 #include "SampleFrame.h"
 
 
 namespace lmms
 {
 
+namespace
+{
+
+constexpr std::size_t CacheLineSize = 64;
+constexpr std::size_t BuffersPerSlab = 128;
+constexpr std::size_t MaxSlabs = 64;
+constexpr std::size_t InitialSlabs = 2;
+//! The pool grows once fewer buffers than this are left
+constexpr std::size_t LowWaterMark = BuffersPerSlab / 2;
+
+
+class Slab
+{
+public:
+	explicit Slab(fpp_t frames) :
+		m_frames(frames),
+		m_stride((frames * sizeof(SampleFrame) + CacheLineSize - 1) / CacheLineSize * CacheLineSize),
+		m_data(static_cast<std::byte*>(::operator new(m_stride * BuffersPerSlab, std::align_val_t{CacheLineSize})))
+	{
+		for (std::size_t i = 0; i < BuffersPerSlab; ++i)
+		{
+			std::uninitialized_default_construct_n(buffer(i), m_frames);
+		}
+	}
+
+	~Slab()
+	{
+		::operator delete(m_data, std::align_val_t{CacheLineSize});
+	}
+
+	SampleFrame* tryAcquire()
+	{
+		for (std::size_t word = 0; word < m_used.size(); ++word)
+		{
+			auto used = m_used[word].load(std::memory_order_relaxed);
+			while (used != ~std::uint64_t{0})
+			{
+				const auto bit = std::countr_one(used);
+				if (m_used[word].compare_exchange_weak(used, used | std::uint64_t{1} << bit,
+					std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return buffer(word * 64 + bit);
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	bool owns(const SampleFrame* buf) const
+	{
+		const auto bytes = reinterpret_cast<const std::byte*>(buf);
+		return bytes >= m_data && bytes < m_data + m_stride * BuffersPerSlab;
+	}
+
+	void release(const SampleFrame* buf)
+	{
+		const auto index = static_cast<std::size_t>(reinterpret_cast<const std::byte*>(buf) - m_data) / m_stride;
+		m_used[index / 64].fetch_and(~(std::uint64_t{1} << index % 64), std::memory_order_release);
+	}
+
+	fpp_t frames() const { return m_frames; }
+
+private:
+	SampleFrame* buffer(std::size_t index)
+	{
+		return reinterpret_cast<SampleFrame*>(m_data + index * m_stride);
+	}
+
+	const fpp_t m_frames;
+	const std::size_t m_stride;
+	std::byte* const m_data;
+	std::array<std::atomic<std::uint64_t>, BuffersPerSlab / 64> m_used = {};
+};
+
+
+// Slabs are only ever added, and live until the program exits, so that
+// buffers outliving the audio engine can still be released
+std::array<std::unique_ptr<Slab>, MaxSlabs> s_slabOwners;
+std::array<std::atomic<Slab*>, MaxSlabs> s_slabs = {};
+std::atomic_size_t s_slabCount = 0;
+//! Slabs made for the current period size, the others only take back their buffers
+std::atomic_size_t s_usableSlabs = 0;
+
+std::atomic_size_t s_inUse = 0;
+std::atomic_size_t s_highWaterMark = 0;
+std::atomic_size_t s_heapAllocations = 0;
+
+//! Set by the first acquire() that finds the pool low, until the grower has seen it
+std::atomic_bool s_growRequested = false;
+std::atomic_bool s_growerQuit = false;
+//! Posting doesn't block, so the audio thread can wake the grower
+Semaphore s_growerWakeup{0};
+std::thread s_grower;
+
+//! A std::thread that is still running when it is destroyed terminates the program
+struct GrowerGuard
+{
+	~GrowerGuard() { BufferManager::destroy(); }
+} s_growerGuard;
+
+
+//! Only called by init() before the grower starts, and by the grower
+void addSlab(fpp_t frames)
+{
+	const auto count = s_slabCount.load(std::memory_order_relaxed);
+	if (count == MaxSlabs) { return; }
+
+	s_slabOwners[count] = std::make_unique<Slab>(frames);
+	s_slabs[count].store(s_slabOwners[count].get(), std::memory_order_relaxed);
+	s_slabCount.store(count + 1, std::memory_order_release);
+	s_usableSlabs.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+bool poolLow(std::size_t inUse)
+{
+	return inUse + LowWaterMark > s_usableSlabs.load(std::memory_order_relaxed) * BuffersPerSlab;
+}
+
+
+void growLoop(fpp_t frames)
+{
+	while (true)
+	{
+		s_growerWakeup.wait();
+		if (s_growerQuit) { return; }
+
+		// Clearing the flag acquires the s_inUse increment of the request it
+		// clears. Requests after this post again, the semaphore counts them.
+		if (!s_growRequested.exchange(false, std::memory_order_acquire)) { continue; }
+		// requests that came in while the last slabs were added may be satisfied already
+		while (s_slabCount < MaxSlabs && poolLow(s_inUse))
+		{
+			addSlab(frames);
+		}
+	}
+}
+
+
+//! Wakes the grower without blocking, only the first call until it has woken up posts
+void requestGrowth()
+{
+	if (!s_growRequested.exchange(true, std::memory_order_release))
+	{
+		s_growerWakeup.post();
+	}
+}
+
+
+void onAcquired()
+{
+	const auto inUse = s_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+	if (poolLow(inUse)) { requestGrowth(); }
+
+	auto highWaterMark = s_highWaterMark.load(std::memory_order_relaxed);
+	while (inUse > highWaterMark
+		&& !s_highWaterMark.compare_exchange_weak(highWaterMark, inUse, std::memory_order_relaxed)) {}
+}
+
+} // namespace
+
+
 fpp_t BufferManager::s_framesPerPeriod;
 
 void BufferManager::init( fpp_t fpp )
 {
+	destroy();
 	s_framesPerPeriod = fpp;
+
+	// Slabs can't be freed while buffers from them may be out, so the ones
+	// too small for the new period size are kept, but no longer count
+	const auto count = s_slabCount.load();
+	s_usableSlabs = static_cast<std::size_t>(std::count_if(s_slabs.begin(), s_slabs.begin() + count,
+		[fpp](const auto& slab) { return slab.load()->frames() >= fpp; }));
+	while (s_usableSlabs < InitialSlabs && s_slabCount < MaxSlabs)
+	{
+		addSlab(fpp);
+	}
+
+	s_growerQuit = false;
+	s_growRequested = false;
+	s_grower = std::thread(growLoop, fpp);
 }
 
 
+
+
+void BufferManager::destroy()
+{
+	if (!s_grower.joinable()) { return; }
+
+	s_growerQuit = true;
+	s_growerWakeup.post();
+	s_grower.join();
+}
+
+
+
+
 SampleFrame* BufferManager::acquire()
 {
+	onAcquired();
+
+	const auto count = s_slabCount.load(std::memory_order_acquire);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto slab = s_slabs[i].load(std::memory_order_relaxed);
+		// slabs made for a smaller period size are of no use anymore
+		if (slab->frames() < s_framesPerPeriod) { continue; }
+		if (const auto buf = slab->tryAcquire()) { return buf; }
+	}
+
+	requestGrowth();
+	s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
 	return new SampleFrame[s_framesPerPeriod];
 }
 
 
 
+
 void BufferManager::release( SampleFrame* buf )
 {
+	if (!buf) { return; }
+	s_inUse.fetch_sub(1, std::memory_order_relaxed);
+
+	const auto count = s_slabCount.load(std::memory_order_acquire);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto slab = s_slabs[i].load(std::memory_order_relaxed);
+		if (slab->owns(buf))
+		{
+			// hand out silence, like a freshly allocated buffer
+			zeroSampleFrames(buf, slab->frames());
+			slab->release(buf);
+			return;
+		}
+	}
 	delete[] buf;
 }
 
+
+
+
+BufferManager::Stats BufferManager::stats()
+{
+	return {
+		s_usableSlabs.load() * BuffersPerSlab,
+		s_inUse.load(),
+		s_highWaterMark.load(),
+		s_heapAllocations.load()
+	};
+}
+
 } // namespace lmms
@@ -27,6 +27,7 @@
 #include <QApplication>
 #include <QDir>
 #include <QDomElement>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QTextStream>
@@ -227,6 +228,19 @@ bool ConfigManager::hasWorkingDir() const
 }
 
 
+QString ConfigManager::fftwWisdomFile() const
+{
+	return QFileInfo(m_lmmsRcFile).absolutePath() + "/.lmms-fftw-wisdom";
+}
+
+
+QString ConfigManager::sampleIndexFile() const
+{
+	return QFileInfo(m_lmmsRcFile).absolutePath() + "/.lmms-sample-index";
+}
+
+
+
 void ConfigManager::setWorkingDir(const QString & workingDir)
 {
 	m_workingDir = ensureTrailingSlash(QDir::cleanPath(workingDir));
@@ -24,6 +24,7 @@
  */
 
 #include <QDomElement>
+#include <cmath>
 
 #include "Effect.h"
 #include "EffectChain.h"
@@ -93,7 +94,7 @@ void Effect::loadSettings( const QDomElement & _this )
 
 bool Effect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 {
-	if (!isOkay() || dontRun() || !isEnabled() || !isRunning())
+	if (!isProcessing())
 	{
 		processBypassedImpl();
 		return false;
@@ -119,6 +120,34 @@ bool Effect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 
 
 
+bool Effect::processAudioBuffer(PlanarBufferView<float, DEFAULT_CHANNELS> buf)
+{
+	if (!isProcessing())
+	{
+		processBypassedImpl();
+		return false;
+	}
+
+	const auto status = processPlanarImpl(buf);
+	switch (status)
+	{
+		case ProcessStatus::Continue:
+			break;
+		case ProcessStatus::ContinueIfNotQuiet:
+			handleAutoQuit(buf);
+			break;
+		case ProcessStatus::Sleep:
+			return false;
+		default:
+			break;
+	}
+
+	return isRunning();
+}
+
+
+
+
 Effect * Effect::instantiate( const QString& pluginName,
 				Model * _parent,
 				Descriptor::SubPluginFeatures::Key * _key )
@@ -142,6 +171,32 @@ Effect * Effect::instantiate( const QString& pluginName,
 
 
 
+/*
+ * In the past, the RMS was calculated then compared with a threshold of 10^(-10).
+ * Now we use a different algorithm to determine whether a buffer is non-quiet, so
+ * a new threshold is needed for the best compatibility. The following is how it's derived.
+ *
+ * Old method:
+ * RMS = average (L^2 + R^2) across stereo buffer.
+ * RMS threshold = 10^(-10)
+ *
+ * So for a single channel, it would be:
+ * RMS/2 = average M^2 across single channel buffer.
+ * RMS/2 threshold = 5^(-11)
+ *
+ * The new algorithm for determining whether a buffer is non-silent compares M with the threshold,
+ * not M^2, so the square root of M^2's threshold should give us the most compatible threshold for
+ * the new algorithm:
+ *
+ * (RMS/2)^0.5 = (5^(-11))^0.5 = 0.0001431 (approx.)
+ *
+ * In practice though, the exact value shouldn't really matter so long as it's sufficiently small.
+ */
+static constexpr auto AutoQuitThreshold = 0.0001431f;
+
+
+
+
 void Effect::handleAutoQuit(std::span<const SampleFrame> output)
 {
 	if (!m_autoQuitEnabled)
@@ -149,43 +204,59 @@ void Effect::handleAutoQuit(std::span<const SampleFrame> output)
 		return;
 	}
 
-	/*
-	 * In the past, the RMS was calculated then compared with a threshold of 10^(-10).
-	 * Now we use a different algorithm to determine whether a buffer is non-quiet, so
-	 * a new threshold is needed for the best compatibility. The following is how it's derived.
-	 *
-	 * Old method:
-	 * RMS = average (L^2 + R^2) across stereo buffer.
-	 * RMS threshold = 10^(-10)
-	 *
-	 * So for a single channel, it would be:
-	 * RMS/2 = average M^2 across single channel buffer.
-	 * RMS/2 threshold = 5^(-11)
-	 *
-	 * The new algorithm for determining whether a buffer is non-silent compares M with the threshold,
-	 * not M^2, so the square root of M^2's threshold should give us the most compatible threshold for
-	 * the new algorithm:
-	 *
-	 * (RMS/2)^0.5 = (5^(-11))^0.5 = 0.0001431 (approx.)
-	 *
-	 * In practice though, the exact value shouldn't really matter so long as it's sufficiently small.
-	 */
-	static constexpr auto threshold = 0.0001431f;
-
 	// Check whether we need to continue processing input. Restart the
 	// counter if the threshold has been exceeded.
 
 	for (const SampleFrame& frame : output)
 	{
 		const auto abs = frame.abs();
-		if (abs.left() >= threshold || abs.right() >= threshold)
+		if (abs.left() >= AutoQuitThreshold || abs.right() >= AutoQuitThreshold)
 		{
 			// The output buffer is not quiet
-			m_quietBufferCount = 0;
+			updateAutoQuit(false);
 			return;
 		}
 	}
 
+	updateAutoQuit(true);
+}
+
+
+
+
+void Effect::handleAutoQuit(PlanarBufferView<const float, DEFAULT_CHANNELS> output)
+{
+	if (!m_autoQuitEnabled)
+	{
+		return;
+	}
+
+	for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		for (const float sample : output.buffer(ch))
+		{
+			if (std::abs(sample) >= AutoQuitThreshold)
+			{
+				updateAutoQuit(false);
+				return;
+			}
+		}
+	}
+
+	updateAutoQuit(true);
+}
+
+
+
+
+void Effect::updateAutoQuit(bool quiet)
+{
+	if (!quiet)
+	{
+		m_quietBufferCount = 0;
+		return;
+	}
+
 	// The output buffer is quiet, so check if auto-quit should be activated yet
 	if (++m_quietBufferCount > timeout())
 	{
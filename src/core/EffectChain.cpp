@@ -39,7 +39,8 @@ namespace lmms
 EffectChain::EffectChain( Model * _parent ) :
 	Model( _parent ),
 	SerializingObject(),
-	m_enabledModel( false, nullptr, tr( "Effects enabled" ) )
+	m_enabledModel( false, nullptr, tr( "Effects enabled" ) ),
+	m_planarChannels{m_planarBuffer[0].data(), m_planarBuffer[1].data()}
 {
 }
 
@@ -193,22 +194,72 @@ bool EffectChain::processAudioBuffer( SampleFrame* _buf, const fpp_t _frames, bo
 
 	MixHelpers::sanitize( _buf, _frames );
 
+	assert(_frames <= DEFAULT_BUFFER_SIZE);
+	const auto planarBuf = PlanarBufferView<float, DEFAULT_CHANNELS>{m_planarChannels.data(), _frames};
+	// whether the current signal is in planarBuf instead of _buf
+	bool planar = false;
+
 	bool moreEffects = false;
 	for (const auto& effect : m_effects)
 	{
-		if (hasInputNoise || effect->isRunning())
+		if (!hasInputNoise && !effect->isRunning()) { continue; }
+
+		// only convert for effects that are going to process, consecutive
+		// planar effects share the planar buffer
+		if (effect->processesPlanar() && (planar || effect->isProcessing()))
+		{
+			if (!planar)
+			{
+				MixHelpers::deinterleave(planarBuf, _buf);
+				planar = true;
+			}
+			moreEffects |= effect->processAudioBuffer(planarBuf);
+			MixHelpers::sanitize(planarBuf);
+		}
+		else
 		{
+			if (planar && effect->isProcessing())
+			{
+				MixHelpers::interleave(_buf, planarBuf);
+				planar = false;
+			}
+			// bypassed effects don't touch the buffer, wherever the signal is
 			moreEffects |= effect->processAudioBuffer(_buf, _frames);
-			MixHelpers::sanitize(_buf, _frames);
+			if (!planar) { MixHelpers::sanitize(_buf, _frames); }
 		}
 	}
 
+	if (planar)
+	{
+		MixHelpers::interleave(_buf, planarBuf);
+	}
+
 	return moreEffects;
 }
 
 
 
 
+f_cnt_t EffectChain::latency() const
+{
+	if (!m_enabledModel.value()) { return 0; }
+
+	// effects that are asleep still count, so the latency doesn't change
+	// whenever they wake up
+	f_cnt_t frames = 0;
+	for (const auto& effect : m_effects)
+	{
+		if (effect->isOkay() && !effect->dontRun() && effect->isEnabled())
+		{
+			frames += effect->latency();
+		}
+	}
+	return frames;
+}
+
+
+
+
 void EffectChain::startRunning()
 {
 	if( m_enabledModel.value() == false )
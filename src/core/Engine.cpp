@@ -33,9 +33,11 @@
 #include "Plugin.h"
 #include "PresetPreviewPlayHandle.h"
 #include "ProjectJournal.h"
+#include "SampleIndex.h"
 #include "Song.h"
 #include "BandLimitedWave.h"
 #include "Oscillator.h"
+#include "fft_helpers.h"
 
 namespace lmms
 {
@@ -50,6 +52,7 @@ ProjectJournal * Engine::s_projectJournal = nullptr;
 Lv2Manager * Engine::s_lv2Manager = nullptr;
 #endif
 Ladspa2LMMS * Engine::s_ladspaManager = nullptr;
+SampleIndex* Engine::s_sampleIndex = nullptr;
 void* Engine::s_dndPluginKey = nullptr;
 
 
@@ -59,6 +62,9 @@ void Engine::init( bool renderOnly )
 {
 	Engine *engine = inst();
 
+	// reuse FFT plans measured in earlier sessions
+	loadFFTWisdom(ConfigManager::inst()->fftwWisdomFile().toStdString());
+
 	emit engine->initProgress(tr("Generating wavetables"));
 	// generate (load from file) bandlimited wavetables
 	BandLimitedWave::generateWaves();
@@ -78,6 +84,13 @@ void Engine::init( bool renderOnly )
 #endif
 	s_ladspaManager = new Ladspa2LMMS;
 
+	if (!renderOnly)
+	{
+		const auto config = ConfigManager::inst();
+		s_sampleIndex = new SampleIndex({config->userSamplesDir(), config->factorySamplesDir()},
+			config->sampleIndexFile());
+	}
+
 	s_projectJournal->setJournalling( true );
 
 	emit engine->initProgress(tr("Opening audio and midi devices"));
@@ -110,17 +123,21 @@ void Engine::destroy()
 	deleteHelper( &s_lv2Manager );
 #endif
 	deleteHelper( &s_ladspaManager );
+	deleteHelper(&s_sampleIndex);
 
 	//delete ConfigManager::inst();
 	deleteHelper( &s_projectJournal );
 
 	deleteHelper( &s_song );
 
+	saveFFTWisdom(ConfigManager::inst()->fftwWisdomFile().toStdString());
+
 	delete ConfigManager::inst();
 
 	// The oscillator FFT plans remain throughout the application lifecycle
 	// due to being expensive to create, and being used whenever a userwave form is changed
 	Oscillator::destroyFFTPlans();
+	destroySharedPlans();
 }
 
 
@@ -22,7 +22,7 @@
  *
  */
 
-#include <QVarLengthArray>
+#include <array>
 #include <QDomElement>
 
 #include "InstrumentSoundShaping.h"
@@ -39,7 +39,19 @@ namespace lmms
 
 const float CUT_FREQ_MULTIPLIER = 6000.0f;
 const float RES_MULTIPLIER = 2.0f;
-const float RES_PRECISION = 1000.0f;
+//! number of frames between filter coefficient computations
+const fpp_t FILTER_CONTROL_INTERVAL = 16;
+//! voices per track that get their filter state without allocating
+const std::size_t FILTER_POOL_SIZE = 64;
+
+struct InstrumentSoundShaping::ControlBuffers
+{
+	std::array<float, MAXIMUM_BUFFER_SIZE> cutoff;
+	std::array<float, MAXIMUM_BUFFER_SIZE> resonance;
+	std::array<float, MAXIMUM_BUFFER_SIZE> volume;
+};
+
+thread_local InstrumentSoundShaping::ControlBuffers InstrumentSoundShaping::s_controlBuffers;
 
 
 InstrumentSoundShaping::InstrumentSoundShaping(
@@ -52,7 +64,8 @@ InstrumentSoundShaping::InstrumentSoundShaping(
 	m_filterEnabledModel( false, this ),
 	m_filterModel( this, tr( "Filter type" ) ),
 	m_filterCutModel( 14000.0, 1.0, 14000.0, 1.0, this, tr( "Cutoff frequency" ) ),
-	m_filterResModel(0.5f, BasicFilters<>::minQ(), 10.f, 0.01f, this, tr("Q/Resonance"))
+	m_filterResModel(0.5f, BasicFilters<>::minQ(), 10.f, 0.01f, this, tr("Q/Resonance")),
+	m_filterPool(FILTER_POOL_SIZE)
 {
 	m_volumeParameters.setDisplayName(tr("Volume"));
 	m_cutoffParameters.setDisplayName(tr("Cutoff frequency"));
@@ -118,12 +131,6 @@ void InstrumentSoundShaping::processAudioBuffer( SampleFrame* buffer,
 		envReleaseBegin += frames;
 	}
 
-	// because of optimizations, there's special code for several cases:
-	// 	- cut- and res-lfo/envelope active
-	// 	- cut-lfo/envelope active
-	// 	- res-lfo/envelope active
-	//	- no lfo/envelope active but filter is used
-
 	// only use filter, if it is really needed
 
 	auto& cutoffParameters = getCutoffParameters();
@@ -131,24 +138,24 @@ void InstrumentSoundShaping::processAudioBuffer( SampleFrame* buffer,
 
 	if( m_filterEnabledModel.value() )
 	{
-		QVarLengthArray<float> cutBuffer(frames);
-		QVarLengthArray<float> resBuffer(frames);
-
-		int old_filter_cut = 0;
-		int old_filter_res = 0;
+		auto& cutBuffer = s_controlBuffers.cutoff;
+		auto& resBuffer = s_controlBuffers.resonance;
 
 		if( n->m_filter == nullptr )
 		{
-			n->m_filter = std::make_unique<BasicFilters<>>( Engine::audioEngine()->outputSampleRate() );
+			n->m_filter = m_filterPool.acquire( Engine::audioEngine()->outputSampleRate() );
 		}
 		n->m_filter->setFilterType( static_cast<BasicFilters<>::FilterType>(m_filterModel.value()) );
 
-		if (cutoffParameters.isUsed())
+		const bool cutUsed = cutoffParameters.isUsed();
+		const bool resUsed = resonanceParameters.isUsed();
+
+		if (cutUsed)
 		{
 			cutoffParameters.fillLevel(cutBuffer.data(), envTotalFrames, envReleaseBegin, frames);
 		}
 
-		if (resonanceParameters.isUsed())
+		if (resUsed)
 		{
 			resonanceParameters.fillLevel(resBuffer.data(), envTotalFrames, envReleaseBegin, frames);
 		}
@@ -156,77 +163,34 @@ void InstrumentSoundShaping::processAudioBuffer( SampleFrame* buffer,
 		const float fcv = m_filterCutModel.value();
 		const float frv = m_filterResModel.value();
 
-		if (cutoffParameters.isUsed() && resonanceParameters.isUsed())
+		// envelopes and LFOs are slow compared to the sample rate, so only the
+		// frames the filter ramps between are converted to cutoff and resonance
+		const auto toControlValues = [&](fpp_t frame)
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				const float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
-
-				const float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
-
-				if( static_cast<int>( new_cut_val ) != old_filter_cut ||
-					static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
-				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, new_res_val );
-					old_filter_cut = static_cast<int>( new_cut_val );
-					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
-				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if (cutoffParameters.isUsed())
+			cutBuffer[frame] = cutUsed
+				? EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) * CUT_FREQ_MULTIPLIER + fcv
+				: fcv;
+			resBuffer[frame] = resUsed
+				? frv + RES_MULTIPLIER * resBuffer[frame]
+				: frv;
+		};
+		for( fpp_t frame = 0; frame < frames; frame += FILTER_CONTROL_INTERVAL )
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
-
-				if( static_cast<int>( new_cut_val ) != old_filter_cut )
-				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, frv );
-					old_filter_cut = static_cast<int>( new_cut_val );
-				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
+			toControlValues( frame );
 		}
-		else if(resonanceParameters.isUsed() )
+		if( frames > 0 && ( frames - 1 ) % FILTER_CONTROL_INTERVAL != 0 )
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
-
-				if( static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
-				{
-					n->m_filter->calcFilterCoeffs( fcv, new_res_val );
-					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
-				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
+			toControlValues( frames - 1 );
 		}
-		else
-		{
-			n->m_filter->calcFilterCoeffs( fcv, frv );
 
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
+		applyFilter( *n->m_filter, buffer, frames, cutBuffer.data(), resBuffer.data() );
 	}
 
 	auto& volumeParameters = getVolumeParameters();
 
 	if (volumeParameters.isUsed())
 	{
-		QVarLengthArray<float> volBuffer(frames);
+		auto& volBuffer = s_controlBuffers.volume;
 		volumeParameters.fillLevel(volBuffer.data(), envTotalFrames, envReleaseBegin, frames);
 
 		for( fpp_t frame = 0; frame < frames; ++frame )
@@ -256,6 +220,37 @@ void InstrumentSoundShaping::processAudioBuffer( SampleFrame* buffer,
 
 
 
+void InstrumentSoundShaping::applyFilter(BasicFilters<>& filter, SampleFrame* buffer, const fpp_t frames,
+	const float* cutoff, const float* resonance)
+{
+	if( frames == 0 ) { return; }
+
+	filter.calcFilterCoeffs( cutoff[0], resonance[0] );
+
+	for( fpp_t blockStart = 0; blockStart < frames; blockStart += FILTER_CONTROL_INTERVAL )
+	{
+		const fpp_t blockEnd = std::min<fpp_t>( blockStart + FILTER_CONTROL_INTERVAL, frames );
+
+		// ramp the coefficients towards the start of the next block, so they
+		// don't step audibly at the block boundaries
+		const fpp_t target = std::min<fpp_t>( blockEnd, frames - 1 );
+		if( cutoff[target] != cutoff[blockStart] || resonance[target] != resonance[blockStart] )
+		{
+			filter.rampFilterCoeffs( cutoff[target], resonance[target], target - blockStart );
+		}
+
+		for( fpp_t frame = blockStart; frame < blockEnd; ++frame )
+		{
+			buffer[frame][0] = filter.update( buffer[frame][0], 0 );
+			buffer[frame][1] = filter.update( buffer[frame][1], 1 );
+			filter.stepFilterCoeffs();
+		}
+	}
+}
+
+
+
+
 f_cnt_t InstrumentSoundShaping::envFrames( const bool _only_vol ) const
 {
 	f_cnt_t ret_val = getVolumeParameters().PAHD_Frames();
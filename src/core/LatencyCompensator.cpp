@@ -0,0 +1,107 @@
+/*
+ * LatencyCompensator.cpp - delays a signal path to line it up with slower ones
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LatencyCompensator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace lmms
+{
+
+bool LatencyCompensator::setDelay(f_cnt_t frames)
+{
+	m_wantedDelay.store(frames, std::memory_order_relaxed);
+
+	const auto capacity = static_cast<f_cnt_t>(m_buffer.size());
+	const bool fits = frames == 0 || frames < capacity;
+	if (!fits) { frames = capacity > 0 ? capacity - 1 : 0; }
+	if (frames == m_delay) { return fits; }
+
+	const f_cnt_t delayed = m_delay;
+	if (frames > delayed)
+	{
+		// the frames older than the old delay come out first, they are stale,
+		// or were never written if there was no delay
+		for (f_cnt_t f = delayed + 1; f <= frames; ++f)
+		{
+			m_buffer[(m_write - f) & (capacity - 1)] = SampleFrame{};
+		}
+		if (m_pending > 0) { m_pending += frames - delayed; }
+	}
+	else
+	{
+		m_pending -= std::min(m_pending, delayed - frames);
+	}
+	m_delay = frames;
+	return fits;
+}
+
+
+
+
+std::vector<SampleFrame> LatencyCompensator::allocate() const
+{
+	const auto wanted = m_wantedDelay.load(std::memory_order_relaxed);
+	if (wanted == 0 || wanted < m_buffer.size()) { return {}; }
+	return std::vector<SampleFrame>(std::bit_ceil(wanted + 1));
+}
+
+
+
+
+void LatencyCompensator::adopt(std::vector<SampleFrame>& buffer)
+{
+	if (buffer.size() <= m_buffer.size()) { return; }
+
+	// the delayed audio ends before m_write in the old buffer, and before 0 in the new one
+	for (f_cnt_t f = 1; f <= m_delay; ++f)
+	{
+		buffer[buffer.size() - f] = m_buffer[(m_write - f) & (m_buffer.size() - 1)];
+	}
+	m_buffer.swap(buffer);
+	m_write = 0;
+}
+
+
+
+
+bool LatencyCompensator::process(SampleFrame* buf, fpp_t frames, bool hasInput)
+{
+	if (m_delay == 0) { return hasInput; }
+
+	if (hasInput) { m_pending = m_delay + frames; }
+	else if (m_pending == 0) { return false; }
+	else { zeroSampleFrames(buf, frames); }
+
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		m_buffer[m_write] = buf[f];
+		buf[f] = m_buffer[(m_write - m_delay) & (m_buffer.size() - 1)];
+		m_write = (m_write + 1) & (m_buffer.size() - 1);
+	}
+
+	m_pending -= std::min(m_pending, static_cast<f_cnt_t>(frames));
+	return true;
+}
+
+} // namespace lmms
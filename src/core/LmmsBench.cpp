@@ -0,0 +1,351 @@
+/*
+ * LmmsBench.cpp - renders projects headlessly and reports how fast that was
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "lmmsconfig.h"
+
+#include "denormals.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <sys/resource.h>
+
+#include "AudioEngine.h"
+#include "ConfigManager.h"
+#include "Engine.h"
+#include "MixHelpers.h"
+#include "NotePlayHandle.h"
+#include "OutputSettings.h"
+#include "ProjectRenderer.h"
+#include "RenderManager.h"
+#include "Song.h"
+
+
+// Count every allocation of the process, including the ones of plugins
+static std::atomic<std::uint64_t> s_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) { return ptr; }
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+
+namespace lmms
+{
+
+namespace
+{
+
+constexpr sample_rate_t SampleRate = 44100;
+
+//! Numbers compared against a baseline, and whether higher numbers are worse
+constexpr struct { const char* key; bool higherIsWorse; } ComparedMetrics[] = {
+	{"loadMs", true},
+	{"realtimeFactor", false},
+	{"renderAllocations", true},
+	{"peakRssKiB", true},
+};
+
+
+int usage(const char* error = nullptr)
+{
+	if (error) { std::fprintf(stderr, "%s\n\n", error); }
+	std::fprintf(error ? stderr : stdout,
+		"Usage: lmms-bench [options...] [<project>...]\n\n"
+		"Renders each project and reports load time, realtime factor, CPU load per\n"
+		"processing stage, peak memory and allocation counts as JSON.\n"
+		"Without projects, all demo projects are rendered.\n\n"
+		"  -o, --output <file>        Write the report to <file> instead of stdout\n"
+		"  -c, --compare <baseline>   Compare with an earlier report and fail if a\n"
+		"                             project got slower or bigger\n"
+		"  -t, --tolerance <percent>  Allowed change before --compare fails, default 10\n"
+		"  -h, --help                 Show this usage information and exit\n");
+	return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+//! Highest resident memory of the process so far
+std::uint64_t peakRssKiB()
+{
+	auto usage = rusage{};
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef LMMS_BUILD_APPLE
+	return usage.ru_maxrss / 1024; // bytes
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+
+QJsonObject benchmark(const QString& project, const QDir& renderDir)
+{
+	auto result = QJsonObject{{"project", QFileInfo(project).fileName()}};
+	Song* song = Engine::getSong();
+	AudioEngineProfiler& profiler = Engine::audioEngine()->profiler();
+
+	auto timer = QElapsedTimer{};
+	timer.start();
+	const auto allocationsBeforeLoad = s_allocations.load();
+	song->loadProject(project);
+	result["loadMs"] = timer.nsecsElapsed() / 1e6;
+	result["loadAllocations"] = static_cast<qint64>(s_allocations.load() - allocationsBeforeLoad);
+
+	if (song->isEmpty())
+	{
+		result["error"] = "empty or broken project";
+		return result;
+	}
+
+	// the dummy device renders periods of its own, which mustn't end up in the totals
+	AudioEngine* audioEngine = Engine::audioEngine();
+	AudioDevice* dummy = audioEngine->audioDev();
+	audioEngine->stopProcessing();
+	profiler.resetTotals();
+
+	auto totals = AudioEngineProfiler::Totals{};
+	f_cnt_t frames = 0;
+	bool rendered = false;
+	const auto allocationsBeforeRender = s_allocations.load();
+	timer.restart();
+	{
+		const auto settings = OutputSettings{SampleRate, 160, OutputSettings::BitDepth::Depth16Bit};
+		auto manager = RenderManager{settings, ProjectRenderer::ExportFileFormat::Wave, renderDir.filePath("render.wav")};
+		auto loop = QEventLoop{};
+		// read the results before ~RenderManager starts the dummy device again
+		QObject::connect(&manager, &RenderManager::finished, &loop, [&] {
+			rendered = audioEngine->audioDev() != dummy;
+			totals = profiler.totals();
+			frames = manager.framesRendered();
+			loop.quit();
+		}, Qt::QueuedConnection);
+		manager.renderProject();
+		loop.exec();
+	}
+	const double renderSeconds = timer.nsecsElapsed() / 1e9;
+	result["renderAllocations"] = static_cast<qint64>(s_allocations.load() - allocationsBeforeRender);
+
+	if (!rendered)
+	{
+		// the file device never replaced the dummy, so nothing restarted it
+		audioEngine->startProcessing();
+		result["error"] = "rendering failed";
+		return result;
+	}
+
+	const double audioSeconds = static_cast<double>(frames) / SampleRate;
+	result["renderMs"] = renderSeconds * 1000;
+	result["audioSeconds"] = audioSeconds;
+	result["realtimeFactor"] = renderSeconds > 0 ? audioSeconds / renderSeconds : 0.;
+
+	// load relative to the time available in realtime, like the CPU meter shows
+	const auto load = [&](std::uint64_t microseconds) {
+		return audioSeconds > 0 ? 100. * microseconds / (audioSeconds * 1e6) : 0.;
+	};
+	using DetailType = AudioEngineProfiler::DetailType;
+	const auto detailLoad = [&](DetailType type) {
+		return load(totals.detailTime[static_cast<std::size_t>(type)]);
+	};
+	result["cpuLoad"] = QJsonObject{
+		{"total", load(totals.periodTime)},
+		{"noteSetup", detailLoad(DetailType::NoteSetup)},
+		{"instruments", detailLoad(DetailType::Instruments)},
+		{"effects", detailLoad(DetailType::Effects)},
+		{"mixing", detailLoad(DetailType::Mixing)},
+	};
+	result["peakRssKiB"] = static_cast<qint64>(peakRssKiB());
+
+	return result;
+}
+
+
+//! Prints the differences to @p baseline and returns the number of regressions
+int compare(const QJsonArray& projects, const QJsonArray& baseline, double tolerance)
+{
+	auto baselineByName = QHash<QString, QJsonObject>{};
+	for (const auto& entry : baseline)
+	{
+		baselineByName.insert(entry["project"].toString(), entry.toObject());
+	}
+
+	int regressions = 0;
+	for (const auto& entry : projects)
+	{
+		const QString name = entry["project"].toString();
+		const auto it = baselineByName.constFind(name);
+		if (it == baselineByName.constEnd())
+		{
+			std::fprintf(stderr, "%s: not in baseline\n", qPrintable(name));
+			continue;
+		}
+
+		for (const auto& metric : ComparedMetrics)
+		{
+			const double before = (*it)[metric.key].toDouble();
+			const double after = entry[metric.key].toDouble();
+			if (before <= 0) { continue; }
+
+			const double change = 100. * (after - before) / before;
+			const bool regressed = metric.higherIsWorse ? change > tolerance : change < -tolerance;
+			regressions += regressed;
+			std::fprintf(stderr, "%-50s %-18s %12.2f -> %12.2f (%+6.1f%%)%s\n", qPrintable(name), metric.key,
+				before, after, change, regressed ? "  REGRESSION" : "");
+		}
+	}
+	return regressions;
+}
+
+
+int run(const QStringList& arguments)
+{
+	auto projects = QStringList{};
+	QString output;
+	QString baselineFile;
+	double tolerance = 10;
+
+	for (int i = 1; i < arguments.size(); ++i)
+	{
+		const QString& arg = arguments[i];
+		const bool hasValue = i + 1 < arguments.size();
+		if (arg == "--help" || arg == "-h") { return usage(); }
+		else if (arg == "--output" || arg == "-o")
+		{
+			if (!hasValue) { return usage("No output file specified"); }
+			output = arguments[++i];
+		}
+		else if (arg == "--compare" || arg == "-c")
+		{
+			if (!hasValue) { return usage("No baseline specified"); }
+			baselineFile = arguments[++i];
+		}
+		else if (arg == "--tolerance" || arg == "-t")
+		{
+			bool ok = false;
+			tolerance = hasValue ? arguments[++i].toDouble(&ok) : 0;
+			if (!ok) { return usage("Invalid tolerance"); }
+		}
+		else if (arg.startsWith('-')) { return usage(qPrintable(QString{"Invalid option %1"}.arg(arg))); }
+		else { projects << arg; }
+	}
+
+	if (projects.isEmpty())
+	{
+		const auto demos = QDir{LMMS_BENCH_PROJECT_DIR};
+		for (const auto& file : demos.entryInfoList({"*.mmp", "*.mmpz"}, QDir::Files, QDir::Name))
+		{
+			projects << file.absoluteFilePath();
+		}
+	}
+
+	auto baseline = QJsonArray{};
+	if (!baselineFile.isEmpty())
+	{
+		auto file = QFile{baselineFile};
+		if (!file.open(QIODevice::ReadOnly)) { return usage("Baseline can't be read"); }
+		baseline = QJsonDocument::fromJson(file.readAll())["projects"].toArray();
+	}
+
+	// same settings on every machine, independent of the user's configuration
+	const auto tempDir = QTemporaryDir{};
+	if (!tempDir.isValid()) { return usage("No temporary directory available"); }
+	ConfigManager::inst()->loadConfigFile(QDir{tempDir.path()}.filePath("lmmsrc.xml"));
+	MixHelpers::setNaNHandler(true);
+
+	Engine::init(true);
+
+	auto results = QJsonArray{};
+	for (const auto& project : projects)
+	{
+		std::fprintf(stderr, "Rendering %s...\n", qPrintable(QFileInfo(project).fileName()));
+		results.append(benchmark(project, QDir{tempDir.path()}));
+	}
+
+	const auto report = QJsonObject{
+		{"sampleRate", static_cast<int>(SampleRate)},
+		{"framesPerPeriod", static_cast<int>(Engine::audioEngine()->framesPerPeriod())},
+		{"projects", results},
+	};
+
+	Engine::destroy();
+
+	const QByteArray json = QJsonDocument{report}.toJson();
+	if (output.isEmpty())
+	{
+		std::fwrite(json.constData(), 1, json.size(), stdout);
+	}
+	else
+	{
+		auto file = QFile{output};
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) { return usage("Output can't be written"); }
+		file.write(json);
+	}
+
+	if (!baselineFile.isEmpty() && compare(results, baseline, tolerance) > 0)
+	{
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+
+} // namespace lmms
+
+
+int main(int argc, char** argv)
+{
+	disable_denormals();
+
+	// the data the demo projects use, unless the user points somewhere else
+	if (!qEnvironmentVariableIsSet("LMMS_DATA_DIR"))
+	{
+		qputenv("LMMS_DATA_DIR", LMMS_BENCH_DATA_DIR);
+	}
+
+	auto app = QCoreApplication{argc, argv};
+	const int ret = lmms::run(app.arguments());
+	lmms::NotePlayHandleManager::free();
+	return ret;
+}
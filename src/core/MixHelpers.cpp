@@ -28,6 +28,7 @@
 #include <cstdio>
 #endif
 
+#include <algorithm>
 #include <cmath>
 
 #include "ValueBuffer.h"
@@ -124,6 +125,58 @@ bool sanitize( SampleFrame* src, int frames )
 }
 
 
+bool sanitize(PlanarBufferView<float, DEFAULT_CHANNELS> buffer)
+{
+	if (!useNaNHandler())
+	{
+		return false;
+	}
+
+	for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		for (sample_t& sample : buffer.buffer(ch))
+		{
+			if (std::isinf(sample) || std::isnan(sample))
+			{
+				// Clear the whole buffer if a problem is found
+				for (proc_ch_t c = 0; c < DEFAULT_CHANNELS; ++c)
+				{
+					std::fill_n(buffer.bufferPtr(c), buffer.frames(), 0.f);
+				}
+				return true;
+			}
+			sample = std::clamp(sample, sample_t(-1000.0), sample_t(1000.0));
+		}
+	}
+
+	return false;
+}
+
+
+void deinterleave(PlanarBufferView<float, DEFAULT_CHANNELS> dst, const SampleFrame* src)
+{
+	float* left = dst.bufferPtr<0>();
+	float* right = dst.bufferPtr<1>();
+	for (f_cnt_t f = 0; f < dst.frames(); ++f)
+	{
+		left[f] = src[f].left();
+		right[f] = src[f].right();
+	}
+}
+
+
+void interleave(SampleFrame* dst, PlanarBufferView<const float, DEFAULT_CHANNELS> src)
+{
+	const float* left = src.bufferPtr<0>();
+	const float* right = src.bufferPtr<1>();
+	for (f_cnt_t f = 0; f < src.frames(); ++f)
+	{
+		dst[f].setLeft(left[f]);
+		dst[f].setRight(right[f]);
+	}
+}
+
+
 struct AddOp
 {
 	void operator()( SampleFrame& dst, const SampleFrame& src ) const
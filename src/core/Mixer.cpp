@@ -23,7 +23,9 @@
  */
 
 #include <QDomElement>
+#include <algorithm>
 
+#include "AudioBusHandle.h"
 #include "AudioEngine.h"
 #include "AudioEngineWorkerThread.h"
 #include "Mixer.h"
@@ -61,8 +63,6 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_fxChain( nullptr ),
 	m_hasInput( false ),
 	m_stillRunning( false ),
-	m_peakLeft( 0.0f ),
-	m_peakRight( 0.0f ),
 	m_buffer( new SampleFrame[Engine::audioEngine()->framesPerPeriod()] ),
 	m_muteModel( false, _parent ),
 	m_soloModel( false, _parent ),
@@ -70,8 +70,12 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_name(),
 	m_lock(),
 	m_queued( false ),
+	m_inputLatency(0),
+	m_outputLatency(0),
 	m_dependenciesMet(0),
-	m_channelIndex(idx)
+	m_channelIndex(idx),
+	m_compensationBuffer(new SampleFrame[Engine::audioEngine()->framesPerPeriod()]),
+	m_latencyKnown(false)
 {
 	zeroSampleFrames(m_buffer, Engine::audioEngine()->framesPerPeriod());
 }
@@ -82,6 +86,7 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 MixerChannel::~MixerChannel()
 {
 	delete[] m_buffer;
+	delete[] m_compensationBuffer;
 }
 
 
@@ -173,8 +178,17 @@ void MixerChannel::doProcessing()
 			FloatModel * sendModel = senderRoute->amount();
 			if( ! sendModel ) qFatal( "Error: no send model found from %d to %d", senderRoute->senderIndex(), m_channelIndex );
 
-			if( sender->m_hasInput || sender->m_stillRunning )
+			// sends that have to wait for slower paths into this channel are
+			// mixed into a buffer of their own first and delayed there
+			LatencyCompensator* compensator = senderRoute->compensator();
+			const bool compensated = compensator->delay() > 0;
+			SampleFrame* dest = compensated ? m_compensationBuffer : m_buffer;
+			bool senderHasOutput = sender->m_hasInput || sender->m_stillRunning;
+
+			if( senderHasOutput )
 			{
+				if (compensated) { zeroSampleFrames(dest, fpp); }
+
 				// figure out if we're getting sample-exact input
 				ValueBuffer * sendBuf = sendModel->valueBuffer();
 				ValueBuffer * volBuf = sender->m_volumeModel.valueBuffer();
@@ -186,24 +200,32 @@ void MixerChannel::doProcessing()
 				if( ! volBuf && ! sendBuf ) // neither volume nor send has sample-exact data...
 				{
 					const float v = sender->m_volumeModel.value() * sendModel->value();
-					MixHelpers::addSanitizedMultiplied( m_buffer, ch_buf, v, fpp );
+					MixHelpers::addSanitizedMultiplied( dest, ch_buf, v, fpp );
 				}
 				else if( volBuf && sendBuf ) // both volume and send have sample-exact data
 				{
-					MixHelpers::addSanitizedMultipliedByBuffers( m_buffer, ch_buf, volBuf, sendBuf, fpp );
+					MixHelpers::addSanitizedMultipliedByBuffers( dest, ch_buf, volBuf, sendBuf, fpp );
 				}
 				else if( volBuf ) // volume has sample-exact data but send does not
 				{
 					const float v = sendModel->value();
-					MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, volBuf, fpp );
+					MixHelpers::addSanitizedMultipliedByBuffer( dest, ch_buf, v, volBuf, fpp );
 				}
 				else // vice versa
 				{
 					const float v = sender->m_volumeModel.value();
-					MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, sendBuf, fpp );
+					MixHelpers::addSanitizedMultipliedByBuffer( dest, ch_buf, v, sendBuf, fpp );
 				}
-				m_hasInput = true;
 			}
+
+			// the delayed audio keeps coming after the sender went silent
+			if (compensated)
+			{
+				senderHasOutput = compensator->process(dest, fpp, senderHasOutput);
+				if (senderHasOutput) { MixHelpers::add(m_buffer, dest, fpp); }
+			}
+
+			if (senderHasOutput) { m_hasInput = true; }
 		}
 
 
@@ -217,13 +239,11 @@ void MixerChannel::doProcessing()
 
 		m_stillRunning = m_fxChain.processAudioBuffer( m_buffer, fpp, m_hasInput );
 
-		SampleFrame peakSamples = getAbsPeakValues(m_buffer, fpp);
-		m_peakLeft = std::max(m_peakLeft, peakSamples[0] * v);
-		m_peakRight = std::max(m_peakRight, peakSamples[1] * v);
+		m_tap.process(m_buffer, fpp, v);
 	}
 	else
 	{
-		m_peakLeft = m_peakRight = 0.0f;
+		m_tap.process(nullptr, fpp);
 	}
 
 	// increment dependency counter of all receivers
@@ -663,6 +683,105 @@ void Mixer::prepareMasterMix()
 
 
 
+void Mixer::compensateLatency(const std::vector<AudioBusHandle*>& busHandles)
+{
+	for (MixerChannel* ch : m_mixerChannels)
+	{
+		ch->m_inputLatency = 0;
+		ch->m_latencyKnown = false;
+	}
+
+	// tracks are the first paths into the channels
+	for (const AudioBusHandle* busHandle : busHandles)
+	{
+		if (busHandle->nextMixerChannel() >= numChannels()) { continue; }
+		MixerChannel* ch = m_mixerChannels[busHandle->nextMixerChannel()];
+		ch->m_inputLatency = std::max(ch->m_inputLatency, busHandle->latency());
+	}
+
+	for (MixerChannel* ch : m_mixerChannels)
+	{
+		updateOutputLatency(ch);
+	}
+
+	// delay every path by what it lacks on the slowest path into the same channel
+	const f_cnt_t maxDelay = LatencyCompensator::maxDelay(Engine::audioEngine()->outputSampleRate());
+	bool fits = true;
+	for (AudioBusHandle* busHandle : busHandles)
+	{
+		if (busHandle->nextMixerChannel() >= numChannels()) { continue; }
+		const f_cnt_t target = m_mixerChannels[busHandle->nextMixerChannel()]->m_inputLatency;
+		// the effects may have changed since above, so don't rely on the track being faster
+		fits &= busHandle->setCompensation(std::min(target - std::min(target, busHandle->latency()), maxDelay));
+	}
+
+	for (MixerRoute* route : m_mixerRoutes)
+	{
+		const f_cnt_t delay = route->receiver()->m_inputLatency - route->sender()->m_outputLatency;
+		fits &= route->compensator()->setDelay(std::min(delay, maxDelay));
+	}
+
+	// this thread must not allocate, so larger buffers are made on the main thread
+	if (!fits && !m_growingCompensators.exchange(true))
+	{
+		QMetaObject::invokeMethod(this, &Mixer::growCompensators, Qt::QueuedConnection);
+	}
+}
+
+
+
+
+void Mixer::growCompensators()
+{
+	// the tracks and sends are only added and removed on this thread, so they
+	// can be looked at while the audio thread goes on
+	auto buffers = std::vector<std::pair<LatencyCompensator*, std::vector<SampleFrame>>>{};
+	const auto allocate = [&](LatencyCompensator* compensator) {
+		auto buffer = compensator->allocate();
+		if (!buffer.empty()) { buffers.emplace_back(compensator, std::move(buffer)); }
+	};
+	for (AudioBusHandle* busHandle : Engine::audioEngine()->audioBusHandles())
+	{
+		allocate(busHandle->compensator());
+	}
+	for (MixerRoute* route : m_mixerRoutes)
+	{
+		allocate(route->compensator());
+	}
+
+	{
+		const auto guard = Engine::audioEngine()->requestChangesGuard();
+		for (auto& [compensator, buffer] : buffers)
+		{
+			compensator->adopt(buffer);
+		}
+		m_growingCompensators = false;
+	}
+	// the old buffers are freed here, once the audio thread is running again
+}
+
+
+
+
+void Mixer::updateOutputLatency(MixerChannel* ch)
+{
+	if (ch->m_latencyKnown) { return; }
+
+	// there are no loops in the mixer, so this ends at the channels without receives
+	for (const MixerRoute* route : ch->m_receives)
+	{
+		MixerChannel* sender = route->sender();
+		updateOutputLatency(sender);
+		ch->m_inputLatency = std::max(ch->m_inputLatency, sender->m_outputLatency);
+	}
+
+	ch->m_outputLatency = ch->m_inputLatency + ch->m_fxChain.latency();
+	ch->m_latencyKnown = true;
+}
+
+
+
+
 void Mixer::masterMix( SampleFrame* _buf )
 {
 	const int fpp = Engine::audioEngine()->framesPerPeriod();
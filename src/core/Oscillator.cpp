@@ -183,7 +183,7 @@ void Oscillator::generateFromFFT(int bands, sample_t* table)
 		s_specBuf[i][1] = 0.0f;
 	}
 	//ifft
-	fftwf_execute(s_ifftPlan);
+	fftwf_execute_dft_c2r(s_ifftPlan, s_specBuf, s_sampleBuffer.data());
 	//normalize and copy to result buffer
 	normalize(s_sampleBuffer.data(), table, OscillatorConstants::WAVETABLE_LENGTH, 2*OscillatorConstants::WAVETABLE_LENGTH + 1);
 }
@@ -200,7 +200,7 @@ std::unique_ptr<OscillatorConstants::waveform_t> Oscillator::generateAntiAliasUs
 			s_sampleBuffer[j] = Oscillator::userWaveSample(
 				sampleBuffer, static_cast<float>(j) / OscillatorConstants::WAVETABLE_LENGTH);
 		}
-		fftwf_execute(s_fftPlan);
+		fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer.data(), s_specBuf);
 		Oscillator::generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), (*userAntiAliasWaveTable)[i].data());
 	}
 
@@ -223,8 +223,8 @@ std::array<float, OscillatorConstants::WAVETABLE_LENGTH> Oscillator::s_sampleBuf
 void Oscillator::createFFTPlans()
 {
 	Oscillator::s_specBuf = ( fftwf_complex * ) fftwf_malloc( ( OscillatorConstants::WAVETABLE_LENGTH * 2 + 1 ) * sizeof( fftwf_complex ) );
-	Oscillator::s_fftPlan = fftwf_plan_dft_r2c_1d(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer.data(), s_specBuf, FFTW_MEASURE );
-	Oscillator::s_ifftPlan = fftwf_plan_dft_c2r_1d(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer.data(), FFTW_MEASURE);
+	Oscillator::s_fftPlan = sharedPlanR2C(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer.data(), s_specBuf);
+	Oscillator::s_ifftPlan = sharedPlanC2R(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer.data());
 	// initialize s_specBuf content to zero, since the values are used in a condition inside generateFromFFT()
 	for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH * 2 + 1; i++)
 	{
@@ -235,8 +235,9 @@ void Oscillator::createFFTPlans()
 
 void Oscillator::destroyFFTPlans()
 {
-	fftwf_destroy_plan(s_fftPlan);
-	fftwf_destroy_plan(s_ifftPlan);
+	// the plans themselves are shared, see destroySharedPlans()
+	s_fftPlan = nullptr;
+	s_ifftPlan = nullptr;
 	fftwf_free(s_specBuf);
 }
 
@@ -283,7 +284,7 @@ void Oscillator::generateWaveTables()
 			{
 				Oscillator::s_sampleBuffer[i] = moogSawSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
-			fftwf_execute(s_fftPlan);
+			fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer.data(), s_specBuf);
 			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[static_cast<std::size_t>(WaveShape::MoogSaw) - FirstWaveShapeTable][i]);
 		}
 
@@ -294,7 +295,7 @@ void Oscillator::generateWaveTables()
 			{
 				s_sampleBuffer[i] = expSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
-			fftwf_execute(s_fftPlan);
+			fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer.data(), s_specBuf);
 			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[static_cast<std::size_t>(WaveShape::Exponential) - FirstWaveShapeTable][i]);
 		}
 	};
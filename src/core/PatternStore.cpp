@@ -216,19 +216,25 @@ void PatternStore::createClipsForPattern(int pattern)
 	}
 }
 
-AutomatedValueMap PatternStore::automatedValuesAt(TimePos time, int clipNum) const
+AutomatedCurveMap PatternStore::automatedCurvesAt(TimePos time, int clipNum) const
 {
 	Q_ASSERT(clipNum >= 0);
 	Q_ASSERT(time.getTicks() >= 0);
 
 	auto lengthBars = lengthOfPattern(clipNum);
 	auto lengthTicks = lengthBars * TimePos::ticksPerBar();
-	if (time > lengthTicks)
+	const bool ended = time > lengthTicks;
+	if (ended)
 	{
 		time = lengthTicks;
 	}
 
-	return TrackContainer::automatedValuesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	auto curves = TrackContainer::automatedCurvesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	if (ended)
+	{
+		for (auto& position : curves) { position.moving = false; }
+	}
+	return curves;
 }
 
 
@@ -40,6 +40,12 @@ static const int EO_ID_MSB = 1 << 23;
 
 const int ProjectJournal::MAX_UNDO_STATES = 100; // TODO: make this configurable in settings
 
+template<typename Stack>
+static bool continuesGroup(const Stack& checkPoints, int group)
+{
+	return group != 0 && !checkPoints.isEmpty() && checkPoints.top().group == group;
+}
+
 ProjectJournal::ProjectJournal() :
 	m_joIDs(),
 	m_undoCheckPoints(),
@@ -62,7 +68,7 @@ void ProjectJournal::undo()
 		{
 			DataFile curState( DataFile::Type::JournalData );
 			jo->saveState( curState, curState.content() );
-			m_redoCheckPoints.push( CheckPoint( c.joID, curState ) );
+			m_redoCheckPoints.push( CheckPoint( c.joID, curState, c.group ) );
 
 			bool prev = isJournalling();
 			setJournalling( false );
@@ -75,6 +81,7 @@ void ProjectJournal::undo()
 			{
 				AutomationClip::resolveAllIDs();
 			}
+			if (continuesGroup(m_undoCheckPoints, c.group)) { continue; }
 			break;
 		}
 	}
@@ -93,13 +100,14 @@ void ProjectJournal::redo()
 		{
 			DataFile curState( DataFile::Type::JournalData );
 			jo->saveState( curState, curState.content() );
-			m_undoCheckPoints.push( CheckPoint( c.joID, curState ) );
+			m_undoCheckPoints.push( CheckPoint( c.joID, curState, c.group ) );
 
 			bool prev = isJournalling();
 			setJournalling( false );
 			jo->restoreState( c.data.content().firstChildElement() );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
+			if (continuesGroup(m_redoCheckPoints, c.group)) { continue; }
 			break;
 		}
 	}
@@ -126,7 +134,7 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 		DataFile dataFile( DataFile::Type::JournalData );
 		jo->saveState( dataFile, dataFile.content() );
 
-		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile ) );
+		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile, m_currentGroup ) );
 		if( m_undoCheckPoints.size() > MAX_UNDO_STATES )
 		{
 			m_undoCheckPoints.remove( 0, m_undoCheckPoints.size() - MAX_UNDO_STATES );
@@ -137,6 +145,22 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 
 
 
+void ProjectJournal::beginCheckPointGroup()
+{
+	if (m_groupDepth++ == 0) { m_currentGroup = ++m_lastGroup; }
+}
+
+
+
+
+void ProjectJournal::endCheckPointGroup()
+{
+	if (m_groupDepth > 0 && --m_groupDepth == 0) { m_currentGroup = 0; }
+}
+
+
+
+
 jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 {
 	jo_id_t id;
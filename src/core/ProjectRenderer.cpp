@@ -81,6 +81,7 @@ ProjectRenderer::ProjectRenderer(
 	, m_fileDev(nullptr)
 	, m_progress(0)
 	, m_abort(false)
+	, m_framesRendered(0)
 {
 	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[static_cast<std::size_t>(exportFileFormat)].m_getDevInst;
 
@@ -160,6 +161,7 @@ void ProjectRenderer::run()
 	Engine::audioEngine()->nextBuffer();
 
 	m_progress = 0;
+	m_framesRendered = 0;
 
 	// Now start processing
 	Engine::audioEngine()->startProcessing(false);
@@ -168,6 +170,7 @@ void ProjectRenderer::run()
 	while (!Engine::getSong()->isExportDone() && !m_abort)
 	{
 		m_fileDev->processNextBuffer();
+		m_framesRendered += Engine::audioEngine()->framesPerPeriod();
 		const int nprog = Engine::getSong()->getExportProgress();
 		if (m_progress != nprog)
 		{
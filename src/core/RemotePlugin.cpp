@@ -38,6 +38,8 @@
 #include "MidiEvent.h"
 #include "Song.h"
 
+#include <algorithm>
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
@@ -327,16 +329,10 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 
 
 
-bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
+bool RemotePlugin::readyToProcess()
 {
-	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
-
 	if( m_failed || !isRunning() )
 	{
-		if( _out_buf != nullptr )
-		{
-			zeroSampleFrames(_out_buf, frames);
-		}
 		return false;
 	}
 
@@ -352,6 +348,40 @@ bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
 			fetchAndProcessAllMessages();
 			unlock();
 		}
+		return false;
+	}
+
+	return true;
+}
+
+
+
+
+bool RemotePlugin::runProcessing(bool wantOutput)
+{
+	lock();
+	sendMessage( IdStartProcessing );
+
+	if (m_failed || !wantOutput || m_outputCount == 0)
+	{
+		unlock();
+		return false;
+	}
+
+	waitForMessage( IdProcessingDone );
+	unlock();
+	return true;
+}
+
+
+
+
+bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
+{
+	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+
+	if (!readyToProcess())
+	{
 		if( _out_buf != nullptr )
 		{
 			zeroSampleFrames(_out_buf, frames);
@@ -394,18 +424,11 @@ bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
 		}
 	}
 
-	lock();
-	sendMessage( IdStartProcessing );
-
-	if( m_failed || _out_buf == nullptr || m_outputCount == 0 )
+	if (!runProcessing(_out_buf != nullptr))
 	{
-		unlock();
 		return false;
 	}
 
-	waitForMessage( IdProcessingDone );
-	unlock();
-
 	const ch_cnt_t outputs = std::min<ch_cnt_t>(m_outputCount,
 							DEFAULT_CHANNELS);
 	if( m_splitChannels )
@@ -446,6 +469,76 @@ bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
 
 
 
+bool RemotePlugin::process(PlanarBufferView<const float, DEFAULT_CHANNELS> in,
+	PlanarBufferView<float, DEFAULT_CHANNELS> out)
+{
+	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+
+	const auto zeroOutput = [&] {
+		for (proc_ch_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			std::fill_n(out.bufferPtr(ch), frames, 0.f);
+		}
+	};
+
+	if (!readyToProcess())
+	{
+		zeroOutput();
+		return false;
+	}
+
+	memset( m_audioBuffer.get(), 0, m_audioBufferSize );
+
+	const ch_cnt_t inputs = std::min<ch_cnt_t>(m_inputCount, DEFAULT_CHANNELS);
+	for (ch_cnt_t ch = 0; ch < inputs; ++ch)
+	{
+		const float* source = in.bufferPtr(ch);
+		if (m_splitChannels)
+		{
+			std::copy_n(source, frames, m_audioBuffer.get() + ch * frames);
+		}
+		else
+		{
+			auto o = (SampleFrame*)m_audioBuffer.get();
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				o[frame][ch] = source[frame];
+			}
+		}
+	}
+
+	if (!runProcessing(true))
+	{
+		return false;
+	}
+
+	// clear channels the plugin doesn't fill
+	zeroOutput();
+
+	const ch_cnt_t outputs = std::min<ch_cnt_t>(m_outputCount, DEFAULT_CHANNELS);
+	for (ch_cnt_t ch = 0; ch < outputs; ++ch)
+	{
+		float* target = out.bufferPtr(ch);
+		if (m_splitChannels)
+		{
+			std::copy_n(m_audioBuffer.get() + (m_inputCount + ch) * frames, frames, target);
+		}
+		else
+		{
+			auto o = (SampleFrame*)(m_audioBuffer.get() + m_inputCount * frames);
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				target[frame] = o[frame][ch];
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+
 void RemotePlugin::processMidiEvent( const MidiEvent & _e,
 							const f_cnt_t _offset )
 {
@@ -61,6 +61,7 @@ void RenderManager::abortProcessing()
 // Called to render each new track when rendering tracks individually.
 void RenderManager::renderNextTrack()
 {
+	if (m_activeRenderer) { m_framesRendered += m_activeRenderer->framesRendered(); }
 	m_activeRenderer.reset();
 
 	if (m_tracksToRender.empty())
@@ -0,0 +1,679 @@
+/*
+ * SampleIndex.cpp - persistent index of the files in the sample directories
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleIndex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+
+#include "SampleDecoder.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+constexpr quint32 CacheMagic = 0x4c534958; // "LSIX"
+constexpr quint32 CacheVersion = 1;
+
+//! Larger files are indexed, but not decoded for analysis
+constexpr qint64 MaxAnalysedSize = 64 * 1024 * 1024;
+//! Number of files analysed between two updates of the index
+constexpr std::size_t AnalysisBatchSize = 32;
+constexpr float SilenceDb = -120.f;
+
+QString cleanPath(const QString& path)
+{
+	return QDir::cleanPath(QDir::fromNativeSeparators(path));
+}
+
+bool isBelow(const QString& path, const QString& dir)
+{
+	if (dir.endsWith('/')) { return path.size() > dir.size() && path.startsWith(dir); }
+	return path.size() > dir.size() && path.startsWith(dir) && path[dir.size()] == '/';
+}
+
+float toDb(float amplitude)
+{
+	return amplitude > 0.f ? std::max(20.f * std::log10(amplitude), SilenceDb) : SilenceDb;
+}
+
+//! Loops are commonly tagged like "funky_beat_120bpm.wav"
+float bpmFromName(const QString& name)
+{
+	static const auto s_bpmRe
+		= QRegularExpression{R"((\d{2,3}(?:\.\d+)?)\s*-?\s*bpm)", QRegularExpression::CaseInsensitiveOption};
+
+	const auto match = s_bpmRe.match(name);
+	if (!match.hasMatch()) { return 0.f; }
+
+	const auto bpm = match.captured(1).toFloat();
+	return bpm >= 40.f && bpm <= 300.f ? bpm : 0.f;
+}
+
+//! Estimates the tempo of a loop from the autocorrelation of its onset strength
+float estimateBpm(const std::vector<SampleFrame>& data, int sampleRate)
+{
+	constexpr std::size_t Hop = 512;
+	constexpr float MinBpm = 70.f;
+	constexpr float MaxBpm = 180.f;
+	//! Normalized correlation below which the sample is considered not rhythmic
+	constexpr float MinCorrelation = 0.3f;
+
+	const auto hops = data.size() / Hop;
+	const auto hopRate = static_cast<float>(sampleRate) / Hop;
+	const auto minLag = std::max<std::size_t>(1, static_cast<std::size_t>(hopRate * 60.f / MaxBpm));
+	const auto maxLag = static_cast<std::size_t>(hopRate * 60.f / MinBpm) + 1;
+	if (maxLag + 1 >= hops / 2) { return 0.f; }
+
+	auto onsets = std::vector<float>(hops);
+	auto previous = 0.f;
+	for (std::size_t h = 0; h < hops; ++h)
+	{
+		auto energy = 0.f;
+		for (std::size_t i = h * Hop; i < (h + 1) * Hop; ++i) { energy += data[i].sumOfSquaredAmplitudes(); }
+
+		const auto level = std::log1p(energy);
+		onsets[h] = std::max(level - previous, 0.f);
+		previous = level;
+	}
+
+	const auto mean = std::accumulate(onsets.begin(), onsets.end(), 0.f) / hops;
+	for (auto& onset : onsets) { onset -= mean; }
+
+	const auto correlation = [&](std::size_t lag) {
+		auto sum = 0.f;
+		for (std::size_t h = lag; h < hops; ++h) { sum += onsets[h] * onsets[h - lag]; }
+		// compensate for the shrinking overlap
+		return sum * hops / (hops - lag);
+	};
+
+	const auto energy = correlation(0);
+	if (energy <= 0.f) { return 0.f; }
+
+	auto bestLag = std::size_t{0};
+	auto best = 0.f;
+	for (auto lag = minLag; lag <= maxLag; ++lag)
+	{
+		const auto c = correlation(lag);
+		if (c > best)
+		{
+			best = c;
+			bestLag = lag;
+		}
+	}
+	if (bestLag == 0 || best / energy < MinCorrelation) { return 0.f; }
+
+	// refine the peak between the hops
+	const auto before = correlation(bestLag - 1);
+	const auto after = correlation(bestLag + 1);
+	const auto curvature = before - 2.f * best + after;
+	const auto offset = curvature < 0.f ? 0.5f * (before - after) / curvature : 0.f;
+
+	const auto bpm = 60.f * hopRate / (bestLag + offset);
+	return std::round(bpm * 10.f) / 10.f;
+}
+
+QDataStream& operator<<(QDataStream& stream, const SampleIndex::Entry& entry)
+{
+	return stream << entry.path << entry.name << entry.category << entry.size << entry.modified << entry.isDir
+		<< entry.hidden << entry.analysed << entry.duration << entry.sampleRate << entry.peak << entry.loudness
+		<< entry.bpm;
+}
+
+QDataStream& operator>>(QDataStream& stream, SampleIndex::Entry& entry)
+{
+	return stream >> entry.path >> entry.name >> entry.category >> entry.size >> entry.modified >> entry.isDir
+		>> entry.hidden >> entry.analysed >> entry.duration >> entry.sampleRate >> entry.peak >> entry.loudness
+		>> entry.bpm;
+}
+
+} // namespace
+
+
+SampleIndex::SampleIndex(const QStringList& roots, const QString& cacheFile, QObject* parent) :
+	QObject(parent),
+	m_roots([&] {
+		auto cleaned = QStringList{};
+		for (const auto& root : roots)
+		{
+			if (!root.isEmpty() && !cleaned.contains(cleanPath(root))) { cleaned << cleanPath(root); }
+		}
+		return cleaned;
+	}()),
+	m_cacheFile(cacheFile)
+{
+	connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &SampleIndex::rescan);
+
+	if (load())
+	{
+		m_ready = true;
+		auto dirs = QStringList{m_roots};
+		for (const auto& item : m_items)
+		{
+			if (item.entry.isDir && isWatched(item.entry.path)) { dirs << item.entry.path; }
+		}
+		m_watcher.addPaths(dirs);
+	}
+
+	// the cache may be stale, so check it in the background either way
+	for (const auto& root : m_roots) { rescan(root); }
+	m_thread = std::thread{[this] { processQueue(); }};
+}
+
+
+
+
+SampleIndex::~SampleIndex()
+{
+	{
+		const auto lock = std::lock_guard{m_queueMutex};
+		m_stop = true;
+	}
+	m_queueCond.notify_all();
+	if (m_thread.joinable()) { m_thread.join(); }
+
+	save();
+}
+
+
+
+
+void SampleIndex::waitUntilReady() const
+{
+	auto lock = std::unique_lock{m_readyMutex};
+	m_readyCond.wait(lock, [this] { return isReady(); });
+}
+
+
+
+
+bool SampleIndex::covers(const QString& path) const
+{
+	const auto cleaned = cleanPath(path);
+	return std::any_of(m_roots.begin(), m_roots.end(),
+		[&](const QString& root) { return cleaned == root || isBelow(cleaned, root); });
+}
+
+
+
+
+std::vector<SampleIndex::Entry> SampleIndex::find(const Query& query) const
+{
+	const auto prefix = query.prefix.toLower();
+	auto tokens = QStringList{};
+	for (const auto& token : query.tokens) { tokens << token.toLower(); }
+
+	const auto suffixes = [&] {
+		auto result = QStringList{};
+		for (const auto& extension : query.extensions)
+		{
+			// "*.wav" -> ".wav"
+			result << extension.mid(extension.startsWith('*') ? 1 : 0).toLower();
+		}
+		return result;
+	}();
+
+	const auto directory = query.directory.isEmpty() ? QString{} : cleanPath(query.directory);
+
+	const auto filtersFeatures = query.minDuration > 0.f || std::isfinite(query.maxDuration) || query.minBpm > 0.f
+		|| std::isfinite(query.maxBpm) || std::isfinite(query.minLoudness) || std::isfinite(query.maxLoudness);
+
+	const auto matches = [&](const Item& item) {
+		const auto& entry = item.entry;
+		if (entry.isDir ? !query.directories : !query.files) { return false; }
+		if (entry.hidden && !query.hidden) { return false; }
+		if (!query.category.isEmpty() && entry.category != query.category
+			&& !entry.category.startsWith(query.category + '/'))
+		{
+			return false;
+		}
+		if (!directory.isEmpty() && !isBelow(entry.path, directory)) { return false; }
+		if (!std::all_of(tokens.begin(), tokens.end(), [&](const QString& token) { return item.key.contains(token); }))
+		{
+			return false;
+		}
+		if (!entry.isDir && !suffixes.isEmpty()
+			&& std::none_of(suffixes.begin(), suffixes.end(), [&](const QString& s) { return item.key.endsWith(s); }))
+		{
+			return false;
+		}
+		if (filtersFeatures)
+		{
+			if (!entry.analysed || entry.duration <= 0.f) { return false; }
+			if (entry.duration < query.minDuration || entry.duration > query.maxDuration) { return false; }
+			if ((query.minBpm > 0.f || std::isfinite(query.maxBpm))
+				&& (entry.bpm <= 0.f || entry.bpm < query.minBpm || entry.bpm > query.maxBpm))
+			{
+				return false;
+			}
+			if (entry.loudness < query.minLoudness || entry.loudness > query.maxLoudness) { return false; }
+		}
+		return true;
+	};
+
+	auto results = std::vector<Entry>{};
+	const auto lock = std::shared_lock{m_itemsMutex};
+
+	// items are sorted by key, so a prefix is a contiguous range
+	auto it = std::lower_bound(m_items.begin(), m_items.end(), prefix,
+		[](const Item& item, const QString& key) { return item.key < key; });
+	for (; it != m_items.end() && it->key.startsWith(prefix); ++it)
+	{
+		if (!matches(*it)) { continue; }
+
+		results.push_back(it->entry);
+		if (query.limit != 0 && results.size() >= query.limit) { break; }
+	}
+
+	return results;
+}
+
+
+
+
+std::vector<SampleIndex::Category> SampleIndex::categories() const
+{
+	auto result = std::vector<Category>{};
+	const auto lock = std::shared_lock{m_itemsMutex};
+
+	for (const auto& item : m_items)
+	{
+		const auto& entry = item.entry;
+		if (entry.hidden) { continue; }
+
+		const auto isTopLevelDir = entry.isDir && entry.category.isEmpty();
+		if (!isTopLevelDir && (entry.isDir || entry.category.isEmpty() || !isAudioFile(entry.name))) { continue; }
+
+		const auto name = isTopLevelDir ? entry.name : entry.category.section('/', 0, 0);
+		auto it = std::find_if(result.begin(), result.end(), [&](const auto& c) { return c.name == name; });
+		if (it == result.end()) { it = result.insert(result.end(), Category{name}); }
+
+		if (!isTopLevelDir) { ++it->fileCount; }
+		// a category in several roots is found in the first of them
+		else if (it->path.isEmpty() || m_roots.indexOf(rootOf(entry.path)) < m_roots.indexOf(rootOf(it->path)))
+		{
+			it->path = entry.path;
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const Category& a, const Category& b) { return a.name < b.name; });
+	return result;
+}
+
+
+
+
+void SampleIndex::rescan(const QString& dir)
+{
+	const auto cleaned = cleanPath(dir);
+	if (!covers(cleaned)) { return; }
+
+	{
+		const auto lock = std::lock_guard{m_queueMutex};
+		if (m_stop) { return; }
+
+		const auto queued = std::any_of(m_pending.begin(), m_pending.end(),
+			[&](const QString& pending) { return pending == cleaned || isBelow(cleaned, pending); });
+		if (queued) { return; }
+		m_pending << cleaned;
+	}
+	m_queueCond.notify_one();
+}
+
+
+
+
+bool SampleIndex::isAudioFile(const QString& fileName)
+{
+	const auto dot = fileName.lastIndexOf('.');
+	if (dot < 0) { return false; }
+
+	const auto suffix = fileName.mid(dot + 1).toLower().toStdString();
+	const auto& types = SampleDecoder::supportedAudioTypes();
+	return std::any_of(types.begin(), types.end(), [&](const auto& type) { return type.extension == suffix; });
+}
+
+
+
+
+void SampleIndex::processQueue()
+{
+	// the cache may hold files that weren't analysed yet
+	auto analysed = false;
+	while (true)
+	{
+		auto dir = QString{};
+		{
+			auto lock = std::unique_lock{m_queueMutex};
+			m_queueCond.wait(lock, [&] { return m_stop || !m_pending.isEmpty() || !analysed; });
+			if (m_stop) { return; }
+			if (!m_pending.isEmpty()) { dir = m_pending.takeFirst(); }
+		}
+
+		if (dir.isEmpty())
+		{
+			// everything has been listed, the slow part can start
+			if (!isReady())
+			{
+				{
+					const auto lock = std::lock_guard{m_readyMutex};
+					m_ready = true;
+				}
+				m_readyCond.notify_all();
+			}
+
+			analysed = analyse();
+			save();
+			continue;
+		}
+
+		auto entries = std::vector<Entry>{};
+		auto dirs = QStringList{};
+		auto visited = QStringList{};
+		const auto root = rootOf(dir);
+		const auto components = QDir{root}.relativeFilePath(dir).split('/');
+		const auto hidden = dir != root
+			&& std::any_of(components.begin(), components.end(), [](const QString& c) { return c.startsWith('.'); });
+		if (QFileInfo{dir}.isDir())
+		{
+			list(dir, root, hidden, entries, dirs, visited);
+			dirs << dir;
+		}
+		merge(dir, std::move(entries));
+		analysed = false;
+
+		dirs.erase(std::remove_if(dirs.begin(), dirs.end(), [this](const QString& d) { return !isWatched(d); }),
+			dirs.end());
+
+		// the watcher belongs to the main thread
+		QMetaObject::invokeMethod(this, [this, dirs] { m_watcher.addPaths(dirs); }, Qt::QueuedConnection);
+		emit updated();
+	}
+}
+
+
+
+
+void SampleIndex::list(const QString& dir, const QString& root, bool hidden, std::vector<Entry>& entries,
+	QStringList& dirs, QStringList& visited) const
+{
+	// don't follow symlinks in circles
+	const auto canonical = QFileInfo{dir}.canonicalFilePath();
+	if (visited.contains(canonical)) { return; }
+	visited << canonical;
+
+	const auto infos = QDir{dir}.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+	for (const auto& info : infos)
+	{
+		if (m_stop) { return; }
+
+		auto entry = Entry{};
+		entry.path = cleanPath(info.filePath());
+		entry.name = info.fileName();
+		entry.category = QFileInfo{QDir{root}.relativeFilePath(entry.path)}.path();
+		if (entry.category == ".") { entry.category.clear(); }
+		entry.size = info.isDir() ? 0 : info.size();
+		entry.modified = info.lastModified().toMSecsSinceEpoch();
+		entry.isDir = info.isDir();
+		entry.hidden = hidden || info.isHidden();
+		// there is nothing to analyse in other files
+		entry.analysed = entry.isDir || !isAudioFile(entry.name);
+		entries.push_back(entry);
+
+		if (entry.isDir)
+		{
+			dirs << entry.path;
+			list(entry.path, root, entry.hidden, entries, dirs, visited);
+		}
+	}
+}
+
+
+
+
+void SampleIndex::merge(const QString& dir, std::vector<Entry> entries)
+{
+	auto added = std::vector<Item>{};
+	added.reserve(entries.size());
+	auto items = std::vector<Item>{};
+	{
+		const auto lock = std::shared_lock{m_itemsMutex};
+
+		// keep what was analysed before, unless the file changed
+		auto previous = QHash<QString, const Entry*>{};
+		for (const auto& item : m_items)
+		{
+			if (isBelow(item.entry.path, dir)) { previous.insert(item.entry.path, &item.entry); }
+		}
+		for (auto& entry : entries)
+		{
+			const auto old = previous.value(entry.path);
+			if (old && old->analysed && old->size == entry.size && old->modified == entry.modified)
+			{
+				entry = *old;
+			}
+			auto key = entry.name.toLower();
+			added.push_back({std::move(key), std::move(entry)});
+		}
+		std::sort(added.begin(), added.end(), &SampleIndex::lessThan);
+
+		// the items that are kept are still sorted, so only the new ones need sorting
+		items.reserve(m_items.size() + added.size());
+		auto next = added.begin();
+		for (const auto& item : m_items)
+		{
+			if (isBelow(item.entry.path, dir)) { continue; }
+			for (; next != added.end() && lessThan(*next, item); ++next) { items.push_back(std::move(*next)); }
+			items.push_back(item);
+		}
+		std::move(next, added.end(), std::back_inserter(items));
+	}
+
+	const auto lock = std::unique_lock{m_itemsMutex};
+	m_items = std::move(items);
+	m_dirty = true;
+}
+
+
+
+
+bool SampleIndex::analyse()
+{
+	// only this thread changes the items, so their positions stay valid between two batches
+	auto next = std::size_t{0};
+	while (!m_stop)
+	{
+		{
+			// directories that changed are listed first, the analysis continues after them
+			const auto lock = std::lock_guard{m_queueMutex};
+			if (!m_pending.isEmpty()) { return false; }
+		}
+
+		auto batch = std::vector<std::pair<std::size_t, Entry>>{};
+		{
+			const auto lock = std::shared_lock{m_itemsMutex};
+			for (; next < m_items.size() && batch.size() < AnalysisBatchSize; ++next)
+			{
+				if (!m_items[next].entry.analysed) { batch.emplace_back(next, m_items[next].entry); }
+			}
+		}
+		if (batch.empty()) { return true; }
+
+		for (auto& [position, entry] : batch)
+		{
+			if (m_stop) { return false; }
+			analyse(entry);
+		}
+
+		{
+			const auto lock = std::unique_lock{m_itemsMutex};
+			for (auto& [position, entry] : batch) { m_items[position].entry = std::move(entry); }
+			m_dirty = true;
+		}
+		emit updated();
+	}
+	return false;
+}
+
+
+
+
+void SampleIndex::analyse(Entry& entry)
+{
+	entry.analysed = true;
+	if (entry.size > MaxAnalysedSize) { return; }
+
+	const auto decoded = SampleDecoder::decode(entry.path);
+	if (!decoded || decoded->data.empty() || decoded->sampleRate <= 0) { return; }
+
+	const auto& data = decoded->data;
+	auto peak = 0.f;
+	auto sum = 0.0;
+	for (const auto& frame : data)
+	{
+		peak = std::max({peak, std::abs(frame.left()), std::abs(frame.right())});
+		sum += frame.sumOfSquaredAmplitudes();
+	}
+
+	entry.sampleRate = decoded->sampleRate;
+	entry.duration = static_cast<float>(data.size()) / decoded->sampleRate;
+	entry.peak = toDb(peak);
+	entry.loudness = toDb(static_cast<float>(std::sqrt(sum / (2.0 * data.size()))));
+
+	// only loops have a meaningful tempo
+	constexpr float MinLoopLength = 1.5f;
+	constexpr float MaxLoopLength = 30.f;
+	entry.bpm = bpmFromName(entry.name);
+	if (entry.bpm == 0.f && entry.duration >= MinLoopLength && entry.duration <= MaxLoopLength)
+	{
+		entry.bpm = estimateBpm(data, decoded->sampleRate);
+	}
+}
+
+
+
+
+bool SampleIndex::lessThan(const Item& a, const Item& b)
+{
+	return a.key != b.key ? a.key < b.key : a.entry.path < b.entry.path;
+}
+
+
+
+
+void SampleIndex::setItems(std::vector<Item> items)
+{
+	std::sort(items.begin(), items.end(), &SampleIndex::lessThan);
+
+	const auto lock = std::unique_lock{m_itemsMutex};
+	m_items = std::move(items);
+	m_dirty = true;
+}
+
+
+
+
+bool SampleIndex::isWatched(const QString& dir) const
+{
+	return m_roots.contains(dir) || m_roots.contains(cleanPath(QFileInfo{dir}.path()));
+}
+
+
+
+
+QString SampleIndex::rootOf(const QString& path) const
+{
+	// prefer the innermost root if they are nested
+	auto result = QString{};
+	for (const auto& root : m_roots)
+	{
+		if ((path == root || isBelow(path, root)) && root.size() > result.size()) { result = root; }
+	}
+	return result;
+}
+
+
+
+
+bool SampleIndex::load()
+{
+	auto file = QFile{m_cacheFile};
+	if (m_cacheFile.isEmpty() || !file.open(QIODevice::ReadOnly)) { return false; }
+
+	auto stream = QDataStream{&file};
+	auto magic = quint32{0};
+	auto version = quint32{0};
+	auto roots = QStringList{};
+	auto count = quint32{0};
+	stream >> magic >> version >> roots >> count;
+	if (magic != CacheMagic || version != CacheVersion || roots != m_roots) { return false; }
+
+	auto items = std::vector<Item>{};
+	items.reserve(count);
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+	{
+		auto entry = Entry{};
+		stream >> entry;
+		auto key = entry.name.toLower();
+		items.push_back({std::move(key), std::move(entry)});
+	}
+	if (stream.status() != QDataStream::Ok) { return false; }
+
+	setItems(std::move(items));
+	m_dirty = false;
+	return true;
+}
+
+
+
+
+bool SampleIndex::save()
+{
+	const auto lock = std::shared_lock{m_itemsMutex};
+	if (!m_dirty || m_cacheFile.isEmpty()) { return true; }
+
+	auto file = QSaveFile{m_cacheFile};
+	if (!file.open(QIODevice::WriteOnly)) { return false; }
+
+	auto stream = QDataStream{&file};
+	stream << CacheMagic << CacheVersion << m_roots << static_cast<quint32>(m_items.size());
+	for (const auto& item : m_items) { stream << item.entry; }
+
+	if (!file.commit()) { return false; }
+	m_dirty = false;
+	return true;
+}
+
+
+} // namespace lmms
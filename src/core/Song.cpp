@@ -339,6 +339,8 @@ void Song::processNextBuffer()
 			}
 		}
 
+		renderAutomations(frameOffsetInPeriod, frameOffsetInTick, framesToPlay);
+
 		// Update frame counters
 		frameOffsetInPeriod += framesToPlay;
 		frameOffsetInTick += framesToPlay;
@@ -353,6 +355,7 @@ void Song::processNextBuffer()
 void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp_t)
 {
 	AutomatedValueMap values;
+	m_automatedCurves.clear();
 
 	QSet<const AutomatableModel*> recordedModels;
 
@@ -376,7 +379,11 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 		return;
 	}
 
-	values = container->automatedValuesAt(timeStart, clipNum);
+	const auto curves = container->automatedCurvesAt(timeStart, clipNum);
+	for (auto it = curves.begin(); it != curves.end(); ++it)
+	{
+		values[it.key()] = it.value().value();
+	}
 	const TrackList& tracks = container->tracks();
 
 	Track::clipVector clips;
@@ -426,6 +433,7 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 		if (! recordedModels.contains(it.key()))
 		{
 			it.key()->setAutomatedValue(it.value());
+			m_automatedCurves.emplace_back(it.key(), curves.value(it.key()));
 		}
 		else if (!it.key()->useControllerValue())
 		{
@@ -434,6 +442,25 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 	}
 }
 
+void Song::renderAutomations(f_cnt_t frameOffsetInPeriod, double frameOffsetInTick, f_cnt_t frames)
+{
+	if (m_automatedCurves.empty()) { return; }
+
+	const double ticksPerFrame = 1.0 / Engine::framesPerTick();
+	auto values = std::array<float, MAXIMUM_BUFFER_SIZE>{};
+	frames = std::min<f_cnt_t>(frames, values.size());
+
+	for (const auto& [model, position] : m_automatedCurves)
+	{
+		if (!model) { continue; }
+
+		// clips that ended hold their last value
+		const double step = position.moving ? ticksPerFrame : 0.0;
+		position.curve->render(position.tick + frameOffsetInTick * step, step, values.data(), frames);
+		model->setAutomatedValues(values.data(), frameOffsetInPeriod, frames);
+	}
+}
+
 void Song::processMetronome(size_t bufferOffset)
 {
 	const auto currentPlayMode = playMode();
@@ -849,11 +876,11 @@ bpm_t Song::getTempo()
 }
 
 
-AutomatedValueMap Song::automatedValuesAt(TimePos time, int clipNum) const
+AutomatedCurveMap Song::automatedCurvesAt(TimePos time, int clipNum) const
 {
 	auto trackList = TrackList{m_globalAutomationTrack};
 	trackList.insert(trackList.end(), tracks().begin(), tracks().end());
-	return TrackContainer::automatedValuesFromTracks(trackList, time, clipNum);
+	return TrackContainer::automatedCurvesFromTracks(trackList, time, clipNum);
 }
 
 
@@ -913,6 +940,7 @@ void Song::clearProject()
 
 	// Clear the m_oldAutomatedValues AutomatedValueMap
 	m_oldAutomatedValues.clear();
+	m_automatedCurves.clear();
 
 	AutomationClip::globalAutomationClip( &m_tempoModel )->clear();
 	AutomationClip::globalAutomationClip( &m_masterVolumeModel )->
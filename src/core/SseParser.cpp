@@ -0,0 +1,105 @@
+/*
+ * SseParser.cpp - incremental parser for server-sent event streams
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ */
+
+#include "SseParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace lmms
+{
+
+//! Consumed bytes are kept until there are at least this many of them
+static constexpr int CompactThreshold = 4096;
+
+void SseParser::feed(const QByteArray& bytes)
+{
+	if (m_cursor >= CompactThreshold && m_cursor * 2 >= m_buffer.size())
+	{
+		m_buffer.remove(0, m_cursor);
+		m_scanned -= m_cursor;
+		m_cursor = 0;
+	}
+	m_buffer.append(bytes);
+}
+
+bool SseParser::next(QByteArray& data)
+{
+	const char* buffer = m_buffer.constData();
+	while (true)
+	{
+		if (m_skipLineFeed && m_cursor < m_buffer.size())
+		{
+			if (buffer[m_cursor] == '\n') { ++m_cursor; }
+			m_skipLineFeed = false;
+		}
+
+		const int end = lineEnd();
+		if (end < 0) { return false; }
+
+		const char* line = buffer + m_cursor;
+		const int length = end - m_cursor;
+		m_cursor = end + 1;
+		if (buffer[end] == '\r')
+		{
+			if (m_cursor < m_buffer.size())
+			{
+				if (buffer[m_cursor] == '\n') { ++m_cursor; }
+			}
+			else { m_skipLineFeed = true; }
+		}
+
+		if (length == 0)
+		{
+			// a blank line dispatches the event
+			if (!m_hasData) { continue; }
+			// swapping lets both buffers keep their capacity
+			std::swap(data, m_data);
+			m_data.resize(0);
+			m_hasData = false;
+			return true;
+		}
+
+		if (length < 5 || std::memcmp(line, "data", 4) != 0 || line[4] != ':') { continue; }
+
+		int offset = 5;
+		if (offset < length && line[offset] == ' ') { ++offset; }
+		if (m_hasData) { m_data.append('\n'); }
+		m_data.append(line + offset, length - offset);
+		m_hasData = true;
+	}
+}
+
+void SseParser::reset()
+{
+	m_buffer.clear();
+	m_cursor = 0;
+	m_scanned = 0;
+	m_data.clear();
+	m_hasData = false;
+	m_skipLineFeed = false;
+}
+
+int SseParser::lineEnd()
+{
+	// don't rescan the start of a line that arrives in many pieces
+	const char* begin = m_buffer.constData() + std::max(m_cursor, m_scanned);
+	const char* end = m_buffer.constData() + m_buffer.size();
+	for (const char* c = begin; c != end; ++c)
+	{
+		if (*c == '\n' || *c == '\r') { return static_cast<int>(c - m_buffer.constData()); }
+	}
+	m_scanned = m_buffer.size();
+	return -1;
+}
+
+} // namespace lmms
@@ -252,11 +252,24 @@ bool TrackContainer::isEmpty() const
 
 AutomatedValueMap TrackContainer::automatedValuesAt(TimePos time, int clipNum) const
 {
-	return automatedValuesFromTracks(tracks(), time, clipNum);
+	const auto curves = automatedCurvesAt(time, clipNum);
+
+	AutomatedValueMap valueMap;
+	for (auto it = curves.begin(); it != curves.end(); ++it)
+	{
+		valueMap[it.key()] = it.value().value();
+	}
+	return valueMap;
 }
 
 
-AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
+AutomatedCurveMap TrackContainer::automatedCurvesAt(TimePos time, int clipNum) const
+{
+	return automatedCurvesFromTracks(tracks(), time, clipNum);
+}
+
+
+AutomatedCurveMap TrackContainer::automatedCurvesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
 {
 	Track::clipVector clips;
 
@@ -282,7 +295,7 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 		}
 	}
 
-	AutomatedValueMap valueMap;
+	AutomatedCurveMap curveMap;
 
 	Q_ASSERT(std::is_sorted(clips.begin(), clips.end(), Clip::comparePosition));
 
@@ -294,18 +307,19 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 
 		if (auto* p = dynamic_cast<AutomationClip *>(clip))
 		{
-			if (! p->hasAutomation()) {
+			auto curve = p->curve();
+			if (curve->empty()) {
 				continue;
 			}
-			TimePos relTime = time - p->startPosition() - p->startTimeOffset();
-			if (!p->isInPattern()) {
-				relTime = std::min(static_cast<int>(relTime), p->length() - p->startTimeOffset());
+			auto position = AutomationCurvePosition{std::move(curve), time - p->startPosition() - p->startTimeOffset()};
+			if (!p->isInPattern() && position.tick >= p->length() - p->startTimeOffset()) {
+				position.tick = p->length() - p->startTimeOffset();
+				position.moving = false;
 			}
-			float value = p->valueAt(relTime);
 
 			for (AutomatableModel* model : p->objects())
 			{
-				valueMap[model] = value;
+				curveMap[model] = position;
 			}
 		}
 		else if (auto* pattern = dynamic_cast<PatternClip*>(clip))
@@ -314,14 +328,17 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 			auto patStore = Engine::patternStore();
 
 			TimePos patTime = time - clip->startPosition();
+			const bool patternEnded = patTime >= clip->length();
 			patTime = std::min(patTime, clip->length());
 			patTime = patTime % (patStore->lengthOfPattern(patIndex) * TimePos::ticksPerBar());
 
-			auto patValues = patStore->automatedValuesAt(patTime, patIndex);
-			for (auto it=patValues.begin(); it != patValues.end(); it++)
+			auto patCurves = patStore->automatedCurvesAt(patTime, patIndex);
+			for (auto it=patCurves.begin(); it != patCurves.end(); it++)
 			{
-				// override old values, pattern track with the highest index takes precedence
-				valueMap[it.key()] = it.value();
+				auto position = it.value();
+				if (patternEnded) { position.moving = false; }
+				// override old curves, pattern track with the highest index takes precedence
+				curveMap[it.key()] = position;
 			}
 		}
 		else
@@ -330,7 +347,7 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 		}
 	}
 
-	return valueMap;
+	return curveMap;
 };
 
 
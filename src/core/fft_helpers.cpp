@@ -27,7 +27,10 @@
 #include "fft_helpers.h"
 
 #include <cmath>
+#include <map>
+#include <mutex>
 #include <numbers>
+#include <tuple>
 
 namespace lmms
 {
@@ -219,4 +222,113 @@ int compressbands(const float *absspec_buffer, float *compressedband, int num_ol
 }
 
 
+namespace
+{
+
+enum class PlanDirection { RealToComplex, ComplexToReal };
+
+// size, direction, input alignment, output alignment
+using PlanKey = std::tuple<unsigned int, PlanDirection, int, int>;
+
+// FFTW's planner is not thread-safe, so everything that plans (or touches
+// wisdom) goes through this mutex
+std::mutex s_planMutex;
+std::map<PlanKey, fftwf_plan> s_plans;
+bool s_wisdomChanged = false;
+
+
+fftwf_plan sharedPlan(unsigned int size, PlanDirection direction, int inAlignment, int outAlignment)
+{
+	const auto lock = std::lock_guard{s_planMutex};
+
+	const auto key = PlanKey{size, direction, inAlignment, outAlignment};
+	if (auto it = s_plans.find(key); it != s_plans.end()) { return it->second; }
+
+	// plan on scratch buffers: FFTW_MEASURE overwrites its arrays, and the
+	// plan must not depend on the caller's buffers anyway. fftwf_malloc()
+	// memory is fully aligned, so offsetting it by the requested alignment
+	// reproduces the caller's alignment.
+	const auto complexBins = size / 2 + 1;
+	const auto realBytes = size * sizeof(float) + 64;
+	const auto complexBytes = complexBins * sizeof(fftwf_complex) + 64;
+	auto realBase = static_cast<char*>(fftwf_malloc(realBytes));
+	auto complexBase = static_cast<char*>(fftwf_malloc(complexBytes));
+
+	fftwf_plan plan = nullptr;
+	if (realBase && complexBase)
+	{
+		if (direction == PlanDirection::RealToComplex)
+		{
+			plan = fftwf_plan_dft_r2c_1d(size,
+				reinterpret_cast<float*>(realBase + inAlignment),
+				reinterpret_cast<fftwf_complex*>(complexBase + outAlignment),
+				FFTW_MEASURE);
+		}
+		else
+		{
+			plan = fftwf_plan_dft_c2r_1d(size,
+				reinterpret_cast<fftwf_complex*>(complexBase + inAlignment),
+				reinterpret_cast<float*>(realBase + outAlignment),
+				FFTW_MEASURE);
+		}
+	}
+
+	fftwf_free(realBase);
+	fftwf_free(complexBase);
+
+	if (plan)
+	{
+		s_plans.emplace(key, plan);
+		s_wisdomChanged = true;
+	}
+	return plan;
+}
+
+} // namespace
+
+
+fftwf_plan sharedPlanR2C(unsigned int size, const float *in, const fftwf_complex *out)
+{
+	return sharedPlan(size, PlanDirection::RealToComplex,
+		fftwf_alignment_of(const_cast<float*>(in)),
+		fftwf_alignment_of(reinterpret_cast<float*>(const_cast<fftwf_complex*>(out))));
+}
+
+
+fftwf_plan sharedPlanC2R(unsigned int size, const fftwf_complex *in, const float *out)
+{
+	return sharedPlan(size, PlanDirection::ComplexToReal,
+		fftwf_alignment_of(reinterpret_cast<float*>(const_cast<fftwf_complex*>(in))),
+		fftwf_alignment_of(const_cast<float*>(out)));
+}
+
+
+void destroySharedPlans()
+{
+	const auto lock = std::lock_guard{s_planMutex};
+	for (auto& [key, plan] : s_plans)
+	{
+		fftwf_destroy_plan(plan);
+	}
+	s_plans.clear();
+}
+
+
+bool loadFFTWisdom(const std::string &path)
+{
+	const auto lock = std::lock_guard{s_planMutex};
+	return fftwf_import_wisdom_from_filename(path.c_str()) != 0;
+}
+
+
+bool saveFFTWisdom(const std::string &path)
+{
+	const auto lock = std::lock_guard{s_planMutex};
+	if (!s_wisdomChanged) { return true; }
+	if (fftwf_export_wisdom_to_filename(path.c_str()) == 0) { return false; }
+	s_wisdomChanged = false;
+	return true;
+}
+
+
 } // namespace lmms
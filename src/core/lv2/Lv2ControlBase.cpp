@@ -161,6 +161,29 @@ void Lv2ControlBase::copyBuffersToLmms(SampleFrame* buf, fpp_t frames) const {
 
 
 
+void Lv2ControlBase::copyBuffersFromLmms(PlanarBufferView<const float, DEFAULT_CHANNELS> buf) {
+	unsigned firstChan = 0; // tell the procs which channels they shall read from
+	for (const auto& c : m_procs)
+	{
+		c->copyBuffersFromCore(buf, firstChan, m_channelsPerProc);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
+void Lv2ControlBase::copyBuffersToLmms(PlanarBufferView<float, DEFAULT_CHANNELS> buf) const {
+	unsigned firstChan = 0; // tell the procs which channels they shall write to
+	for (const auto& c : m_procs) {
+		c->copyBuffersToCore(buf, firstChan, m_channelsPerProc);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
 void Lv2ControlBase::run(fpp_t frames) {
 	for (const auto& c : m_procs) { c->run(frames); }
 }
@@ -27,6 +27,7 @@
 
 #ifdef LMMS_HAVE_LV2
 
+#include <algorithm>
 #include <lv2/atom/atom.h>
 #include <lv2/port-props/port-props.h>
 
@@ -348,6 +349,33 @@ void Audio::copyBuffersToCore(SampleFrame* lmmsBuf,
 
 
 
+void Audio::copyBuffersFromCore(const float* lmmsBuf, fpp_t frames)
+{
+	std::copy_n(lmmsBuf, frames, m_buffer.begin());
+}
+
+
+
+
+void Audio::averageWithBuffersFromCore(const float* lmmsBuf, fpp_t frames)
+{
+	for (std::size_t f = 0; f < static_cast<unsigned>(frames); ++f)
+	{
+		m_buffer[f] = (m_buffer[f] + lmmsBuf[f]) / 2.0f;
+	}
+}
+
+
+
+
+void Audio::copyBuffersToCore(float* lmmsBuf, fpp_t frames) const
+{
+	std::copy_n(m_buffer.begin(), frames, lmmsBuf);
+}
+
+
+
+
 void AtomSeq::Lv2EvbufDeleter::operator()(LV2_Evbuf *n) { lv2_evbuf_free(n); }
 
 
@@ -368,6 +368,45 @@ void Lv2Proc::copyBuffersToCore(SampleFrame* buf,
 
 
 
+void Lv2Proc::copyBuffersFromCore(PlanarBufferView<const float, DEFAULT_CHANNELS> buf,
+									unsigned firstChan, unsigned num)
+{
+	const fpp_t frames = buf.frames();
+	inPorts().m_left->copyBuffersFromCore(buf.bufferPtr(firstChan), frames);
+	if (num > 1)
+	{
+		// see above for the mono input case
+		if (inPorts().m_right)
+		{
+			inPorts().m_right->copyBuffersFromCore(buf.bufferPtr(firstChan + 1), frames);
+		}
+		else
+		{
+			inPorts().m_left->averageWithBuffersFromCore(buf.bufferPtr(firstChan + 1), frames);
+		}
+	}
+}
+
+
+
+
+void Lv2Proc::copyBuffersToCore(PlanarBufferView<float, DEFAULT_CHANNELS> buf,
+								unsigned firstChan, unsigned num) const
+{
+	const fpp_t frames = buf.frames();
+	outPorts().m_left->copyBuffersToCore(buf.bufferPtr(firstChan), frames);
+	if (num > 1)
+	{
+		// see above for the mono output case
+		Lv2Ports::Audio* ap = outPorts().m_right
+			? outPorts().m_right : outPorts().m_left;
+		ap->copyBuffersToCore(buf.bufferPtr(firstChan + 1), frames);
+	}
+}
+
+
+
+
 void Lv2Proc::run(fpp_t frames)
 {
 	if (m_worker)
@@ -27,6 +27,8 @@
 
 #include <array>
 
+#include "AudioEngine.h"
+#include "Engine.h"
 #include "MidiPort.h"
 
 namespace lmms
@@ -60,6 +62,10 @@ void MidiClient::applyPortName( MidiPort* )
 
 void MidiClient::addPort( MidiPort* port )
 {
+	// the audio thread walks the port list in processQueuedInEvents()
+	const auto guard = Engine::audioEngine()
+		? Engine::audioEngine()->requestChangesGuard()
+		: AudioEngine::RequestChangesGuard{};
 	m_midiPorts.push_back( port );
 }
 
@@ -73,6 +79,9 @@ void MidiClient::removePort( MidiPort* port )
 		return;
 	}
 
+	const auto guard = Engine::audioEngine()
+		? Engine::audioEngine()->requestChangesGuard()
+		: AudioEngine::RequestChangesGuard{};
 	auto it = std::find(m_midiPorts.begin(), m_midiPorts.end(), port);
 	if( it != m_midiPorts.end() )
 	{
@@ -83,6 +92,17 @@ void MidiClient::removePort( MidiPort* port )
 
 
 
+void MidiClient::processQueuedInEvents( fpp_t frames, sample_rate_t sampleRate )
+{
+	for (MidiPort* port : m_midiPorts)
+	{
+		port->processQueuedInEvents(frames, sampleRate);
+	}
+}
+
+
+
+
 void MidiClient::subscribeReadablePort( MidiPort*, const QString& , bool )
 {
 }
@@ -23,6 +23,7 @@
  *
  */
 
+#include <algorithm>
 #include <QDomElement>
 
 #include "MidiPort.h"
@@ -40,6 +41,9 @@ namespace lmms
 
 static MidiDummy s_dummyClient;
 
+//! enough for a few periods of dense controller data
+constexpr std::size_t InEventQueueSize = 1024;
+
 
 
 MidiPort::MidiPort( const QString& name,
@@ -63,7 +67,8 @@ MidiPort::MidiPort( const QString& name,
 	m_outputProgramModel( 1, 1, MidiProgramCount, this, tr( "Output MIDI program" ) ),
 	m_baseVelocityModel( MidiMaxVelocity/2, 1, MidiMaxVelocity, this, tr( "Base velocity" ) ),
 	m_readableModel( false, this, tr( "Receive MIDI-events" ) ),
-	m_writableModel( false, this, tr( "Send MIDI-events" ) )
+	m_writableModel( false, this, tr( "Send MIDI-events" ) ),
+	m_inEvents( InEventQueueSize )
 {
 	m_midiClient->addPort( this );
 
@@ -129,10 +134,36 @@ void MidiPort::setMode( Mode mode )
 
 void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 {
-	// mask event
-	if( isInputEnabled() &&
-		( inputChannel() == 0 || inputChannel()-1 == event.channel() ) )
+	if( !isInputEnabled() )
+	{
+		return;
+	}
+
+	if( !m_inEvents.push( { event, time, Clock::now() } ) )
+	{
+		qWarning( "MidiPort: input queue of %s is full, dropping event", qUtf8Printable( displayName() ) );
+	}
+}
+
+
+
+
+void MidiPort::processQueuedInEvents( fpp_t frames, sample_rate_t sampleRate )
+{
+	const auto now = Clock::now();
+
+	QueuedInEvent queued;
+	while( m_inEvents.pop( queued ) )
 	{
+		const MidiEvent& event = queued.event;
+
+		// mask event
+		if( !isInputEnabled() ||
+			( inputChannel() != 0 && inputChannel()-1 != event.channel() ) )
+		{
+			continue;
+		}
+
 		MidiEvent inEvent = event;
 		if( event.type() == MidiNoteOn ||
 			event.type() == MidiNoteOff ||
@@ -140,7 +171,7 @@ void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 		{
 			if( inEvent.key() < 0 || inEvent.key() >= NumKeys )
 			{
-				return;
+				continue;
 			}
 
 			if( fixedInputVelocity() >= 0 && inEvent.velocity() > 0 )
@@ -149,13 +180,31 @@ void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 			}
 		}
 
-		m_midiEventProcessor->processInEvent( inEvent, time );
+		m_midiEventProcessor->processInEvent( inEvent, queued.time,
+				frameOffset( queued.received, now, frames, sampleRate ) );
 	}
 }
 
 
 
 
+f_cnt_t MidiPort::frameOffset( Clock::time_point received, Clock::time_point now,
+		fpp_t frames, sample_rate_t sampleRate )
+{
+	if( frames == 0 )
+	{
+		return 0;
+	}
+
+	const auto age = std::chrono::duration<double>( now - received ).count();
+	const auto framesAgo = static_cast<long long>( age * sampleRate );
+	const auto periodFrames = static_cast<long long>( frames );
+	return static_cast<f_cnt_t>( std::clamp( periodFrames - framesAgo, 0LL, periodFrames - 1 ) );
+}
+
+
+
+
 void MidiPort::processOutEvent( const MidiEvent& event, const TimePos& time )
 {
 	// When output is enabled, route midi events if the selected channel matches
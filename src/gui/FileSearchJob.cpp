@@ -27,6 +27,8 @@
 #include <QDirIterator>
 #include <QRegularExpression>
 
+#include "Engine.h"
+#include "SampleIndex.h"
 #include "ThreadPool.h"
 
 namespace lmms::gui {
@@ -75,10 +77,36 @@ void FileSearchJob::runSearch(Task task)
 		if (!plain.isEmpty()) { tokens.push_back(plain); }
 	}
 
+	// matched like this by both the index and the walk, so they always find the same files
+	const auto hasExtension = [&](const QFileInfo& fileInfo) {
+		return task.extensions.contains(QString{"*.%1"}.arg(fileInfo.completeSuffix()), Qt::CaseInsensitive);
+	};
+
 	emit started();
 
 	for (const auto& path : task.paths)
 	{
+		// the sample directories don't need to be walked again
+		const auto index = Engine::sampleIndex();
+		if (index && index->isReady() && index->covers(path))
+		{
+			auto query = SampleIndex::Query{};
+			query.tokens = tokens;
+			query.directory = path;
+			query.extensions = task.extensions;
+			query.files = task.dirFilters.testFlag(QDir::Files) && !task.extensions.isEmpty();
+			query.directories = task.dirFilters.testFlag(QDir::Dirs);
+			query.hidden = task.dirFilters.testFlag(QDir::Hidden);
+
+			for (const auto& entry : index->find(query))
+			{
+				if (m_stop.test(std::memory_order_relaxed)) { break; }
+				if (!entry.isDir && !hasExtension(QFileInfo{entry.name})) { continue; }
+				emit foundMatch(entry.path);
+			}
+			continue;
+		}
+
 		auto dirIt = QDirIterator{path, task.dirFilters,
 			QDirIterator::IteratorFlag::Subdirectories | QDirIterator::IteratorFlag::FollowSymlinks};
 
@@ -90,8 +118,7 @@ void FileSearchJob::runSearch(Task task)
 				[&](const auto& token) { return fileName.contains(token, Qt::CaseInsensitive); });
 
 			const auto validDir = fileInfo.isDir() && containsToken;
-			const auto validFile = fileInfo.isFile() && containsToken
-				&& task.extensions.contains(QString{"*.%1"}.arg(fileInfo.completeSuffix()), Qt::CaseInsensitive);
+			const auto validFile = fileInfo.isFile() && containsToken && hasExtension(fileInfo);
 
 			if (validDir || validFile) { emit foundMatch(fileInfo.filePath()); }
 		}
@@ -198,6 +198,8 @@ int MixerView::addNewChannel()
 
 void MixerView::refreshDisplay()
 {
+	m_meters.clear();
+
 	// delete all views and re-add them
 	for (int i = 1; i<m_mixerChannelViews.size(); ++i)
 	{
@@ -392,7 +394,8 @@ void MixerView::deleteChannel(int index)
 	// channels will be left in a muted state
 	mixer->clearChannel(index);
 
-	// delete the real channel
+	// delete the real channel, a new one might get its address
+	m_meters.clear();
 	mixer->deleteChannel(index);
 
 	chLayout->removeWidget(m_mixerChannelViews[index]);
@@ -581,34 +584,43 @@ void MixerView::clear()
 
 void MixerView::updateFaders()
 {
+	// nobody looks at the meters, don't make the channels compute them
+	if (!isVisible())
+	{
+		m_meters.clear();
+		return;
+	}
+
 	Mixer * m = getMixer();
 
+	if (m_meters.size() != static_cast<std::size_t>(m_mixerChannelViews.size()))
+	{
+		m_meters.clear();
+	}
 	for (int i = 0; i < m_mixerChannelViews.size(); ++i)
 	{
-		const float opl = m_mixerChannelViews[i]->m_fader->getPeak_L();
-		const float opr = m_mixerChannelViews[i]->m_fader->getPeak_R();
-		const float fallOff = 1.25;
-		if (m->mixerChannel(i)->m_peakLeft >= opl/fallOff)
+		MixerChannel* channel = m->mixerChannel(i);
+		if (m_meters.size() <= static_cast<std::size_t>(i))
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_L(m->mixerChannel(i)->m_peakLeft);
-			// Set to -1 so later we'll know if this value has been refreshed yet.
-			m->mixerChannel(i)->m_peakLeft = -1;
+			m_meters.push_back({channel, std::make_unique<AudioTap::Subscriber>(channel->m_tap)});
 		}
-		else if (m->mixerChannel(i)->m_peakLeft != -1)
+		else if (m_meters[i].channel != channel)
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_L(opl/fallOff);
+			m_meters[i] = {channel, std::make_unique<AudioTap::Subscriber>(channel->m_tap)};
 		}
+	}
 
-		if (m->mixerChannel(i)->m_peakRight >= opr/fallOff)
-		{
-			m_mixerChannelViews[i]->m_fader->setPeak_R(m->mixerChannel(i)->m_peakRight);
-			// Set to -1 so later we'll know if this value has been refreshed yet.
-			m->mixerChannel(i)->m_peakRight = -1;
-		}
-		else if (m->mixerChannel(i)->m_peakRight != -1)
-		{
-			m_mixerChannelViews[i]->m_fader->setPeak_R(opr/fallOff);
-		}
+	for (int i = 0; i < m_mixerChannelViews.size(); ++i)
+	{
+		// nothing new since the last update
+		const auto levels = m_meters[i].levels->levels();
+		if (!levels) { continue; }
+
+		const float opl = m_mixerChannelViews[i]->m_fader->getPeak_L();
+		const float opr = m_mixerChannelViews[i]->m_fader->getPeak_R();
+		const float fallOff = 1.25;
+		m_mixerChannelViews[i]->m_fader->setPeak_L(std::max(levels->peakLeft, opl / fallOff));
+		m_mixerChannelViews[i]->m_fader->setPeak_R(std::max(levels->peakRight, opr / fallOff));
 	}
 }
 
@@ -25,35 +25,118 @@
 
 #include "SampleThumbnail.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFileInfo>
 #include <QPainter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "PathUtil.h"
 #include "Sample.h"
+#include "SharedFileCache.h"
+#include "ThreadPool.h"
 
 namespace {
-	constexpr auto MaxSampleThumbnailCacheSize = 32;
 	constexpr auto AggregationPerZoomStep = 10;
+
+	//! Samples this short are quicker to scan than to load from a file, so they are done right away.
+	constexpr auto SmallSampleFrames = std::size_t{1} << 16;
+
+	constexpr auto PeakCacheMagic = std::uint32_t{0x4b504d4c}; // "LMPK" on little endian machines
+
+	//! Start of a peak cache file, followed by a `PeakCacheLevel` per level and the peaks of all levels.
+	struct PeakCacheHeader
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::int64_t lastModified;
+		std::uint64_t frames;
+		std::uint32_t sampleRate;
+		std::uint32_t levels;
+	};
+
+	struct PeakCacheLevel
+	{
+		std::uint64_t offset; //!< In bytes from the start of the file.
+		std::uint64_t width;
+		double samplesPerPeak;
+	};
+
+	QString peakCachePath(const QString& sampleFile)
+	{
+		const auto cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+		if (cacheDir.isEmpty()) { return {}; }
+
+		const auto hash = QCryptographicHash::hash(sampleFile.toUtf8(), QCryptographicHash::Sha1).toHex();
+		return QDir{cacheDir}.filePath(QStringLiteral("peaks/%1.peaks").arg(QString::fromLatin1(hash)));
+	}
 }
 
 namespace lmms {
 
 SampleThumbnail::Thumbnail::Thumbnail(std::vector<Peak> peaks, double samplesPerPeak)
-	: m_peaks(std::move(peaks))
+	: m_storage(std::move(peaks))
+	, m_peaks(m_storage)
+	, m_samplesPerPeak(samplesPerPeak)
+{
+}
+
+SampleThumbnail::Thumbnail::Thumbnail(std::span<const Peak> peaks, double samplesPerPeak)
+	: m_peaks(peaks)
 	, m_samplesPerPeak(samplesPerPeak)
 {
 }
 
 SampleThumbnail::Thumbnail::Thumbnail(const float* buffer, size_t size, size_t width)
-	: m_peaks(width)
+	: m_storage(width)
+	, m_peaks(m_storage)
 	, m_samplesPerPeak(std::max(static_cast<double>(size) / width, 1.0))
 {
 	for (auto peakIndex = std::size_t{0}; peakIndex < width; ++peakIndex)
 	{
 		const auto beginSample = buffer + static_cast<size_t>(std::floor(peakIndex * m_samplesPerPeak));
 		const auto endSample = buffer + static_cast<size_t>(std::ceil((peakIndex + 1) * m_samplesPerPeak));
-		const auto [min, max] = std::minmax_element(beginSample, endSample);
-		m_peaks[peakIndex] = Peak{*min, *max};
+		m_storage[peakIndex] = peakOf(beginSample, endSample);
+	}
+}
+
+SampleThumbnail::Thumbnail::Peak SampleThumbnail::Thumbnail::peakOf(const float* begin, const float* end)
+{
+	auto peak = Peak{};
+
+#ifdef __SSE2__
+	if (end - begin >= 4)
+	{
+		auto min = _mm_loadu_ps(begin);
+		auto max = min;
+		for (begin += 4; end - begin >= 4; begin += 4)
+		{
+			const auto samples = _mm_loadu_ps(begin);
+			min = _mm_min_ps(min, samples);
+			max = _mm_max_ps(max, samples);
+		}
+
+		alignas(16) float mins[4];
+		alignas(16) float maxs[4];
+		_mm_store_ps(mins, min);
+		_mm_store_ps(maxs, max);
+		peak = Peak{*std::min_element(mins, mins + 4), *std::max_element(maxs, maxs + 4)};
+	}
+#endif
+
+	for (; begin != end; ++begin)
+	{
+		peak = peak + Peak{*begin, *begin};
 	}
+
+	return peak;
 }
 
 SampleThumbnail::Thumbnail SampleThumbnail::Thumbnail::zoomOut(float factor) const
@@ -71,38 +154,167 @@ SampleThumbnail::Thumbnail SampleThumbnail::Thumbnail::zoomOut(float factor) con
 	return Thumbnail{std::move(peaks), m_samplesPerPeak * factor};
 }
 
-SampleThumbnail::SampleThumbnail(const Sample& sample)
+SampleThumbnail::SampleThumbnail(const Sample& sample, std::function<void()> onReady)
 	: m_buffer(sample.buffer())
 {
-	auto entry = SampleThumbnailEntry{sample.sampleFile(), QFileInfo{sample.sampleFile()}.lastModified()};
-	if (!entry.filePath.isEmpty())
+	static auto s_thumbnailCache = SharedFileCache<Thumbnails>{};
+
+	if (sample.sampleFile().isEmpty())
+	{
+		m_thumbnails = std::make_shared<Thumbnails>();
+		start(m_thumbnails, m_buffer);
+	}
+	else
+	{
+		m_thumbnails = s_thumbnailCache.get(PathUtil::toAbsolute(sample.sampleFile()), [&](const QString& path) {
+			auto thumbnails = std::make_shared<Thumbnails>();
+			if (const auto info = QFileInfo{path}; info.exists())
+			{
+				thumbnails->peakCachePath = peakCachePath(path);
+				thumbnails->lastModified = info.lastModified().toMSecsSinceEpoch();
+			}
+			start(thumbnails, m_buffer);
+			return thumbnails;
+		});
+	}
+
+	if (onReady)
+	{
+		const auto lock = std::lock_guard{m_thumbnails->mutex};
+		if (!m_thumbnails->ready) { m_thumbnails->onReady.push_back(std::move(onReady)); }
+	}
+}
+
+void SampleThumbnail::start(std::shared_ptr<Thumbnails> thumbnails, std::shared_ptr<const SampleBuffer> buffer)
+{
+	if (buffer->size() < SmallSampleFrames)
 	{
-		const auto it = s_sampleThumbnailCacheMap.find(entry);
-		if (it != s_sampleThumbnailCacheMap.end())
+		generate(*thumbnails, *buffer);
+		thumbnails->ready = true;
+		return;
+	}
+
+	ThreadPool::instance().enqueue([thumbnails = std::move(thumbnails), buffer = std::move(buffer)] {
+		if (thumbnails->peakCachePath.isEmpty() || !loadPeakCache(*thumbnails, *buffer))
 		{
-			m_thumbnailCache = it->second;
-			return;
+			generate(*thumbnails, *buffer);
+			if (!thumbnails->peakCachePath.isEmpty()) { savePeakCache(*thumbnails, *buffer); }
 		}
+		publish(*thumbnails);
+	});
+}
+
+void SampleThumbnail::generate(Thumbnails& thumbnails, const SampleBuffer& buffer)
+{
+	auto& levels = thumbnails.levels;
+
+	const auto flatBuffer = buffer.data()->data();
+	const auto flatBufferSize = buffer.size() * DEFAULT_CHANNELS;
+	levels.emplace_back(flatBuffer, flatBufferSize, flatBufferSize / AggregationPerZoomStep);
+
+	while (levels.back().width() >= AggregationPerZoomStep)
+	{
+		auto zoomedOutThumbnail = levels.back().zoomOut(AggregationPerZoomStep);
+		levels.emplace_back(std::move(zoomedOutThumbnail));
+	}
+}
+
+void SampleThumbnail::publish(Thumbnails& thumbnails)
+{
+	auto onReady = std::vector<std::function<void()>>{};
+	{
+		const auto lock = std::lock_guard{thumbnails.mutex};
+		thumbnails.ready = true;
+		std::swap(onReady, thumbnails.onReady);
+	}
+
+	const auto app = QCoreApplication::instance();
+	if (!app) { return; }
+
+	for (auto& callback : onReady)
+	{
+		QMetaObject::invokeMethod(app, std::move(callback), Qt::QueuedConnection);
+	}
+}
 
-		if (s_sampleThumbnailCacheMap.size() == MaxSampleThumbnailCacheSize)
+bool SampleThumbnail::loadPeakCache(Thumbnails& thumbnails, const SampleBuffer& buffer)
+{
+	auto file = std::make_unique<QFile>(thumbnails.peakCachePath);
+	if (!file->open(QIODevice::ReadOnly)) { return false; }
+
+	const auto fileSize = static_cast<std::uint64_t>(file->size());
+	if (fileSize < sizeof(PeakCacheHeader)) { return false; }
+
+	// Mapping the file lets the OS read in the peaks of a zoom level only once it is drawn
+	const auto data = file->map(0, file->size());
+	if (!data) { return false; }
+
+	auto header = PeakCacheHeader{};
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != PeakCacheMagic || header.version != PeakCacheVersion
+		|| header.lastModified != thumbnails.lastModified || header.frames != buffer.size()
+		|| header.sampleRate != buffer.sampleRate() || header.levels == 0
+		|| sizeof(PeakCacheHeader) + header.levels * sizeof(PeakCacheLevel) > fileSize)
+	{
+		return false;
+	}
+
+	auto levels = std::vector<Thumbnail>{};
+	for (auto levelIndex = std::uint32_t{0}; levelIndex < header.levels; ++levelIndex)
+	{
+		auto level = PeakCacheLevel{};
+		std::memcpy(&level, data + sizeof(PeakCacheHeader) + levelIndex * sizeof(PeakCacheLevel), sizeof(level));
+		if (level.offset % alignof(Thumbnail::Peak) != 0 || level.offset > fileSize
+			|| level.width > (fileSize - level.offset) / sizeof(Thumbnail::Peak))
 		{
-			const auto leastUsed = std::min_element(s_sampleThumbnailCacheMap.begin(), s_sampleThumbnailCacheMap.end(),
-				[](const auto& a, const auto& b) { return a.second.use_count() < b.second.use_count(); });
-			s_sampleThumbnailCacheMap.erase(leastUsed->first);
+			return false;
 		}
 
-		s_sampleThumbnailCacheMap[std::move(entry)] = m_thumbnailCache;
+		const auto peaks = reinterpret_cast<const Thumbnail::Peak*>(data + level.offset);
+		levels.emplace_back(std::span{peaks, static_cast<std::size_t>(level.width)}, level.samplesPerPeak);
 	}
 
-	const auto flatBuffer = m_buffer->data()->data();
-	const auto flatBufferSize = m_buffer->size() * DEFAULT_CHANNELS;
-	m_thumbnailCache->emplace_back(flatBuffer, flatBufferSize, flatBufferSize / AggregationPerZoomStep);
+	thumbnails.levels = std::move(levels);
+	thumbnails.peakCache = std::move(file);
+	return true;
+}
+
+void SampleThumbnail::savePeakCache(const Thumbnails& thumbnails, const SampleBuffer& buffer)
+{
+	QDir{}.mkpath(QFileInfo{thumbnails.peakCachePath}.absolutePath());
+
+	// Written to a temporary file first, so readers never see a partially written cache
+	auto file = QSaveFile{thumbnails.peakCachePath};
+	if (!file.open(QIODevice::WriteOnly)) { return; }
+
+	const auto header = PeakCacheHeader{
+		.magic = PeakCacheMagic,
+		.version = PeakCacheVersion,
+		.lastModified = thumbnails.lastModified,
+		.frames = buffer.size(),
+		.sampleRate = buffer.sampleRate(),
+		.levels = static_cast<std::uint32_t>(thumbnails.levels.size())
+	};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	auto offset = sizeof(PeakCacheHeader) + thumbnails.levels.size() * sizeof(PeakCacheLevel);
+	for (const auto& thumbnail : thumbnails.levels)
+	{
+		const auto level = PeakCacheLevel{
+			.offset = offset,
+			.width = static_cast<std::uint64_t>(thumbnail.width()),
+			.samplesPerPeak = thumbnail.samplesPerPeak()
+		};
+		file.write(reinterpret_cast<const char*>(&level), sizeof(level));
+		offset += thumbnail.width() * sizeof(Thumbnail::Peak);
+	}
 
-	while (m_thumbnailCache->back().width() >= AggregationPerZoomStep)
+	for (const auto& thumbnail : thumbnails.levels)
 	{
-		auto zoomedOutThumbnail = m_thumbnailCache->back().zoomOut(AggregationPerZoomStep);
-		m_thumbnailCache->emplace_back(std::move(zoomedOutThumbnail));
+		file.write(reinterpret_cast<const char*>(thumbnail.data()), thumbnail.width() * sizeof(Thumbnail::Peak));
 	}
+
+	file.commit();
 }
 
 void SampleThumbnail::visualize(VisualizeParameters parameters, QPainter& painter) const
@@ -114,13 +326,21 @@ void SampleThumbnail::visualize(VisualizeParameters parameters, QPainter& painte
 	if (renderRect.isNull()) { return; }
 
 	const auto sampleRange = parameters.sampleEnd - parameters.sampleStart;
-	if (sampleRange <= 0.0f || sampleRange > 1.0f) { return; }
+	if (sampleRange <= 0.0f || sampleRange > 1.0f || !m_thumbnails) { return; }
+
+	if (!ready())
+	{
+		const auto centerY = renderRect.center().y();
+		painter.drawLine(renderRect.left(), centerY, renderRect.right(), centerY);
+		return;
+	}
 
+	const auto& thumbnails = m_thumbnails->levels;
 	const auto targetThumbnailWidth = static_cast<int>(sampleRect.width() / sampleRange);
-	const auto finerThumbnail = std::find_if(m_thumbnailCache->rbegin(), m_thumbnailCache->rend(),
+	const auto finerThumbnail = std::find_if(thumbnails.rbegin(), thumbnails.rend(),
 		[&](const auto& thumbnail) { return thumbnail.width() >= targetThumbnailWidth; });
 
-	const auto useOriginalBuffer = finerThumbnail == m_thumbnailCache->rend();
+	const auto useOriginalBuffer = finerThumbnail == thumbnails.rend();
 	const auto drawOriginalBuffer = static_cast<size_t>(targetThumbnailWidth) == m_buffer->size();
 
 	painter.save();
@@ -147,8 +367,8 @@ void SampleThumbnail::visualize(VisualizeParameters parameters, QPainter& painte
 		}
 		else
 		{
-			const auto beginIndex = std::clamp<size_t>(std::floor(i * finerThumbnailScaleFactor), 0, finerThumbnail->width() - 1);
-			const auto endIndex = std::clamp<size_t>(std::ceil((i + 1) * finerThumbnailScaleFactor), 0, finerThumbnail->width() - 1);
+			const auto beginIndex = std::clamp<size_t>(std::floor(i * finerThumbnailScaleFactor), 0, finerThumbnailWidth - 1);
+			const auto endIndex = std::clamp<size_t>(std::ceil((i + 1) * finerThumbnailScaleFactor), 0, finerThumbnailWidth - 1);
 
 			auto minPeak = 0.f;
 			auto maxPeak = 0.f;
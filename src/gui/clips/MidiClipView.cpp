@@ -317,6 +317,7 @@ void MidiClipView::mergeClips(QVector<ClipView*> clipvs)
 	}
 
 	newMidiClip->saveJournallingState(false);
+	auto batch = MidiClip::NoteBatch{newMidiClip, false};
 
 	// Add the notes and remove the Clips that are being merged
 	for (auto clipv: clipvs)
@@ -343,9 +344,10 @@ void MidiClipView::mergeClips(QVector<ClipView*> clipvs)
 			const TimePos newLength = newNoteEnd - newNoteStart;
 			if (newLength > 0)
 			{
-				Note* newNote = newMidiClip->addNote(*note, false);
-				newNote->setPos(newNoteStart + (mcViewPos - earliestPos));
-				newNote->setLength(newLength);
+				auto newNote = Note{*note};
+				newNote.setPos(newNoteStart + (mcViewPos - earliestPos));
+				newNote.setLength(newLength);
+				batch.addNote(newNote, false);
 			}
 		}
 
@@ -356,11 +358,10 @@ void MidiClipView::mergeClips(QVector<ClipView*> clipvs)
 		clipv->remove();
 	}
 
+	batch.commit();
 	// Update length to extend from the start of the first clip to the end of the last clip
 	newMidiClip->changeLength(latestPos - earliestPos);
 	newMidiClip->setAutoResize(false);
-	// Rearrange notes because we might have moved them
-	newMidiClip->rearrangeAllNotes();
 	// Restore journalling states now that the operation is finished
 	newMidiClip->restoreJournallingState();
 	track->restoreJournallingState();
@@ -381,6 +382,7 @@ void MidiClipView::clearNotesOutOfBounds()
 	TimePos startBound = -m_clip->startTimeOffset();
 	TimePos endBound = m_clip->length() - m_clip->startTimeOffset();
 
+	auto batch = MidiClip::NoteBatch{newClip, false};
 	for (Note const* note: m_clip->m_notes)
 	{
 		const TimePos newNoteStart = std::max(note->pos(), startBound) - startBound;
@@ -391,9 +393,10 @@ void MidiClipView::clearNotesOutOfBounds()
 			Note newNote = Note{*note};
 			newNote.setPos(newNoteStart);
 			newNote.setLength(newLength);
-			newClip->addNote(newNote, false);
+			batch.addNote(newNote, false);
 		}
 	}
+	batch.commit();
 	newClip->changeLength(m_clip->length());
 	newClip->updateLength();
 
@@ -463,7 +466,7 @@ void MidiClipView::mousePressEvent( QMouseEvent * _me )
 
 		if( getGUI()->pianoRoll()->currentMidiClip() == m_clip )
 		{
-			getGUI()->pianoRoll()->update();
+			getGUI()->pianoRoll()->invalidateStaticLayer();
 		}
 	}
 	else
@@ -535,7 +538,7 @@ void MidiClipView::wheelEvent(QWheelEvent * we)
 			update();
 			if( getGUI()->pianoRoll()->currentMidiClip() == m_clip )
 			{
-				getGUI()->pianoRoll()->update();
+				getGUI()->pianoRoll()->invalidateStaticLayer();
 			}
 		}
 		we->accept();
@@ -892,20 +895,22 @@ bool MidiClipView::destructiveSplitClip(const TimePos pos)
 	auto rightClip =  m_clip->clone();
 	rightClip->clearNotes();
 
+	auto leftNotes = MidiClip::NoteBatch{leftClip, false};
+	auto rightNotes = MidiClip::NoteBatch{rightClip, false};
 	for (Note const* note : m_clip->m_notes)
 	{
 		if (note->pos() >= internalSplitPos)
 		{
 			auto movedNote = Note{*note};
 			movedNote.setPos(note->pos() - internalSplitPos);
-			rightClip->addNote(movedNote, false);
+			rightNotes.addNote(movedNote, false);
 		}
 		else if (note->endPos() > internalSplitPos)
 		{
 			auto movedNote = Note{*note};
 			movedNote.setPos(0);
 			movedNote.setLength(note->endPos() - internalSplitPos);
-			rightClip->addNote(movedNote, false);
+			rightNotes.addNote(movedNote, false);
 		}
 	}
 
@@ -913,15 +918,17 @@ bool MidiClipView::destructiveSplitClip(const TimePos pos)
 	{
 		if (note->endPos() <= internalSplitPos)
 		{
-			leftClip->addNote(*note, false);
+			leftNotes.addNote(*note, false);
 		}
 		else if (note->pos() < internalSplitPos)
 		{
 			auto movedNote = Note{*note};
 			movedNote.setLength(internalSplitPos - note->pos());
-			leftClip->addNote(movedNote, false);
+			leftNotes.addNote(movedNote, false);
 		}
 	}
+	leftNotes.commit();
+	rightNotes.commit();
 
 	leftClip->movePosition(m_initialClipPos);
 	leftClip->setAutoResize(false);
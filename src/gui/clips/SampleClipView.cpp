@@ -25,8 +25,10 @@
 #include "SampleClipView.h"
 
 #include <QApplication>
+#include <QImage>
 #include <QMenu>
 #include <QPainter>
+#include <QPointer>
 
 #include "GuiApplication.h"
 #include "AutomationEditor.h"
@@ -37,6 +39,7 @@
 #include "SampleThumbnail.h"
 #include "Song.h"
 #include "StringPairDrag.h"
+#include "ThreadPool.h"
 #include "TrackContainerView.h"
 #include "TrackView.h"
 
@@ -65,7 +68,12 @@ void SampleClipView::updateSample()
 {
 	update();
 
-	m_sampleThumbnail = SampleThumbnail{m_clip->m_sample};
+	++m_waveformRevision;
+	m_sampleThumbnail = SampleThumbnail{m_clip->m_sample, [view = QPointer{this}] {
+		if (!view) { return; }
+		++view->m_waveformRevision;
+		view->update();
+	}};
 
 	// set tooltip to filename so that user can see what sample this
 	// sample-clip contains
@@ -210,7 +218,9 @@ void SampleClipView::paintEvent( QPaintEvent * pe )
 {
 	QPainter painter( this );
 
-	if( !needsUpdate() )
+	// the pixmap only covers a part of long clips, around where they were visible when it was drawn
+	const auto cachedRect = QRect(m_paintPixmapXPosition, 0, m_paintPixmap.width(), m_paintPixmap.height());
+	if (!needsUpdate() && cachedRect.contains(pe->rect()))
 	{
 		painter.drawPixmap(m_paintPixmapXPosition, 0, m_paintPixmap);
 		return;
@@ -295,7 +305,18 @@ void SampleClipView::paintEvent( QPaintEvent * pe )
 			.reversed = sample.reversed()
 		};
 
-		m_sampleThumbnail.visualize(param, p);
+		const auto key = WaveformKey{
+			.pixelsPerBar = ppb,
+			.height = height(),
+			.revision = m_waveformRevision,
+			.sampleRect = param.sampleRect,
+			.size = viewPortRect.size(),
+			.amplification = param.amplification,
+			.reversed = param.reversed
+		};
+
+		if (!(m_waveformKey == key)) { renderWaveform(key, param); }
+		drawWaveform(p, key, p.pen().color());
 	}
 
 	QString name = PathUtil::cleanName(m_clip->m_sample.sampleFile());
@@ -372,4 +393,75 @@ void SampleClipView::setAutomationGhost()
 	aEditor->setFocus();
 }
 
+
+
+
+void SampleClipView::renderWaveform(const WaveformKey& key, const SampleThumbnail::VisualizeParameters& parameters)
+{
+	if (m_pendingWaveformKey == key) { return; }
+	m_pendingWaveformKey = key;
+
+	// QPixmap can only be used on the GUI thread, so the waveform is drawn into an image
+	// and converted once it is back
+	auto render = [thumbnail = m_sampleThumbnail, parameters] {
+		QImage image(parameters.viewportRect.size(), QImage::Format_ARGB32_Premultiplied);
+		image.fill(Qt::transparent);
+		QPainter p(&image);
+		p.setPen(Qt::black);
+		thumbnail.visualize(parameters, p);
+		return image;
+	};
+
+	ThreadPool::instance().enqueue([render = std::move(render), key, view = QPointer{this}] {
+		const auto app = QCoreApplication::instance();
+		if (!app) { return; }
+
+		QMetaObject::invokeMethod(app, [view, key, image = render()] {
+			// Dropped if the view is gone or a newer waveform was requested meanwhile
+			if (!view || view->m_pendingWaveformKey != key) { return; }
+			view->m_waveform = QPixmap::fromImage(image);
+			view->m_waveformKey = key;
+			view->m_pendingWaveformKey.reset();
+			view->update();
+		}, Qt::QueuedConnection);
+	});
+}
+
+
+
+
+void SampleClipView::drawWaveform(QPainter& p, const WaveformKey& key, const QColor& color) const
+{
+	if (m_waveform.isNull())
+	{
+		const auto centerY = key.sampleRect.center().y();
+		p.drawLine(key.sampleRect.left(), centerY, key.sampleRect.right(), centerY);
+		return;
+	}
+
+	// Until the waveform for the current zoom and size is rendered, the last one is stretched to fit
+	const auto& cached = m_waveformKey.sampleRect;
+	const auto source = QRectF{cached.intersected(m_waveform.rect())};
+	if (source.isEmpty()) { return; }
+
+	const auto scaleX = static_cast<qreal>(key.sampleRect.width()) / cached.width();
+	const auto scaleY = static_cast<qreal>(key.sampleRect.height()) / cached.height();
+	const auto target = QRectF{
+		key.sampleRect.x() + (source.x() - cached.x()) * scaleX,
+		key.sampleRect.y() + (source.y() - cached.y()) * scaleY,
+		source.width() * scaleX,
+		source.height() * scaleY
+	};
+
+	auto tinted = QPixmap{m_waveform.size()};
+	tinted.fill(Qt::transparent);
+	QPainter tp(&tinted);
+	tp.drawPixmap(0, 0, m_waveform);
+	tp.setCompositionMode(QPainter::CompositionMode_SourceIn);
+	tp.fillRect(tinted.rect(), color);
+	tp.end();
+
+	p.drawPixmap(target, tinted, source);
+}
+
 } // namespace lmms::gui
@@ -33,6 +33,7 @@
 #include <QLabel>
 #include <QPainter>
 #include <QPainterPath>  // IWYU pragma: keep
+#include <QPointer>
 #include <QPushButton>
 #include <QScrollBar>
 #include <QStyleOption>
@@ -247,7 +248,7 @@ void AutomationEditor::update()
 	// Note detuning?
 	if( m_clip && !m_clip->getTrack() )
 	{
-		getGUI()->pianoRoll()->update();
+		getGUI()->pianoRoll()->invalidateStaticLayer();
 	}
 }
 
@@ -901,6 +902,7 @@ void AutomationEditor::mouseMoveEvent(QMouseEvent * mouseEvent )
 					{
 						it.value().setInTangent(newTangent);
 					}
+					m_clip->updateCurve();
 				}
 				else if (m_mouseDownRight && m_action == Action::ResetTangents)
 				{
@@ -1030,7 +1032,9 @@ void AutomationEditor::setGhostSample(SampleClip* newGhostSample)
 	// Expects a pointer to a Sample buffer or nullptr.
 	m_ghostSample = newGhostSample;
 	m_renderSample = true;
-	m_sampleThumbnail = SampleThumbnail{newGhostSample->sample()};
+	m_sampleThumbnail = SampleThumbnail{newGhostSample->sample(), [editor = QPointer{this}] {
+		if (editor) { editor->update(); }
+	}};
 }
 
 void AutomationEditor::paintEvent(QPaintEvent * pe )
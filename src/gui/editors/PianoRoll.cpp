@@ -43,7 +43,9 @@
 #include <QStyleOption>
 #include <QToolButton>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <utility>
 
 #include "AutomationEditor.h"
@@ -436,7 +438,7 @@ PianoRoll::PianoRoll() :
 	m_stepRecorder.initialize();
 
 	// trigger a redraw if keymap definitions change (different keys may become disabled)
-	connect(Engine::getSong(), SIGNAL(keymapListChanged(int)), this, SLOT(update()));
+	connect(Engine::getSong(), SIGNAL(keymapListChanged(int)), this, SLOT(invalidateStaticLayer()));
 }
 
 
@@ -488,7 +490,7 @@ void PianoRoll::showPanTextFloat(panning_t pan, const QPoint &pos, int timeout)
 void PianoRoll::changeNoteEditMode( int i )
 {
 	m_noteEditMode = (NoteEditMode) i;
-	repaint();
+	invalidateStaticLayer();
 }
 
 
@@ -592,7 +594,7 @@ void PianoRoll::markSemiTone(SemiToneMarkerAction i, bool fromMenu)
 	QList<int>::iterator new_end = std::unique( m_markedSemiTones.begin(), m_markedSemiTones.end() );
 	m_markedSemiTones.erase( new_end, m_markedSemiTones.end() );
 	// until we move the mouse the window won't update, force redraw
-	update();
+	invalidateStaticLayer();
 }
 
 
@@ -609,6 +611,7 @@ void PianoRoll::setGhostMidiClip( MidiClip* newMidiClip )
 		}
 		emit ghostClipSet( true );
 	}
+	notesChanged();
 }
 
 
@@ -628,6 +631,7 @@ void PianoRoll::loadGhostNotes( const QDomElement & de )
 		}
 		emit ghostClipSet( true );
 	}
+	notesChanged();
 }
 
 
@@ -692,12 +696,11 @@ void PianoRoll::glueNotes()
 		}
 
 		// Remove old notes
-		for (int i = 0; i < noteToRemove.count(); ++i)
-		{
-			m_midiClip->removeNote(noteToRemove[i]);
-		}
+		auto batch = MidiClip::NoteBatch{m_midiClip, false};
+		for (Note* n : noteToRemove) { batch.removeNote(n); }
+		batch.commit();
 
-		update();
+		invalidateStaticLayer();
 	}
 }
 
@@ -750,7 +753,7 @@ void PianoRoll::fitNoteLengths(bool fill)
 		}
 	}
 
-	update();
+	m_midiClip->dataChanged();
 	getGUI()->songEditor()->update();
 	Engine::getSong()->setModified();
 }
@@ -773,7 +776,7 @@ void PianoRoll::constrainNoteLengths(bool constrainMax)
 		}
 	}
 
-	update();
+	m_midiClip->dataChanged();
 	getGUI()->songEditor()->update();
 	Engine::getSong()->setModified();
 }
@@ -787,7 +790,7 @@ void PianoRoll::reverseNotes()
 
 	m_midiClip->reverseNotes(notes);
 
-	update();
+	invalidateStaticLayer();
 	getGUI()->songEditor()->update();
 	Engine::getSong()->setModified();
 }
@@ -816,6 +819,7 @@ void PianoRoll::loadMarkedSemiTones(const QDomElement & de)
 	std::sort(m_markedSemiTones.begin(), m_markedSemiTones.end(), std::greater<int>());
 	QList<int>::iterator new_end = std::unique(m_markedSemiTones.begin(), m_markedSemiTones.end());
 	m_markedSemiTones.erase(new_end, m_markedSemiTones.end());
+	invalidateStaticLayer();
 }
 
 
@@ -897,17 +901,17 @@ void PianoRoll::setCurrentMidiClip( MidiClip* newMidiClip )
 
 	connect( m_midiClip->instrumentTrack(), SIGNAL( midiNoteOn( const lmms::Note& ) ), this, SLOT( startRecordNote( const lmms::Note& ) ) );
 	connect( m_midiClip->instrumentTrack(), SIGNAL( midiNoteOff( const lmms::Note& ) ), this, SLOT( finishRecordNote( const lmms::Note& ) ) );
-	connect( m_midiClip, SIGNAL(dataChanged()), this, SLOT(update()));
+	connect(m_midiClip, &MidiClip::dataChanged, this, &PianoRoll::notesChanged);
 	connect( m_midiClip->instrumentTrack()->pianoModel(), SIGNAL(dataChanged()), this, SLOT(update()));
 
-	connect(m_midiClip->instrumentTrack()->firstKeyModel(), SIGNAL(dataChanged()), this, SLOT(update()));
-	connect(m_midiClip->instrumentTrack()->lastKeyModel(), SIGNAL(dataChanged()), this, SLOT(update()));
-	connect(m_midiClip->instrumentTrack()->microtuner()->keymapModel(), SIGNAL(dataChanged()), this, SLOT(update()));
+	connect(m_midiClip->instrumentTrack()->firstKeyModel(), SIGNAL(dataChanged()), this, SLOT(invalidateStaticLayer()));
+	connect(m_midiClip->instrumentTrack()->lastKeyModel(), SIGNAL(dataChanged()), this, SLOT(invalidateStaticLayer()));
+	connect(m_midiClip->instrumentTrack()->microtuner()->keymapModel(), SIGNAL(dataChanged()), this, SLOT(invalidateStaticLayer()));
 	connect(m_midiClip->instrumentTrack()->microtuner()->keyRangeImportModel(), SIGNAL(dataChanged()),
-		this, SLOT(update()));
-	connect(m_midiClip, &MidiClip::lengthChanged, this, qOverload<>(&QWidget::update));
+		this, SLOT(invalidateStaticLayer()));
+	connect(m_midiClip, &MidiClip::lengthChanged, this, &PianoRoll::invalidateStaticLayer);
 
-	update();
+	notesChanged();
 	emit currentMidiClipChanged();
 }
 
@@ -1078,6 +1082,223 @@ void PianoRoll::drawNoteRect( QPainter & p, int x, int y,
 
 
 
+void PianoRoll::NoteIndex::build(const NoteVector& notes)
+{
+	m_notes.assign(notes.begin(), notes.end());
+	std::stable_sort(m_notes.begin(), m_notes.end(),
+		[](const Note* a, const Note* b) { return a->pos() < b->pos(); });
+
+	m_maxEnd.resize(m_notes.size());
+	int maxEnd = std::numeric_limits<int>::min();
+	for (std::size_t i = 0; i < m_notes.size(); ++i)
+	{
+		// notes with a negative length are drawn 4 ticks long
+		const int length = m_notes[i]->length() < 0 ? 4 : static_cast<int>(m_notes[i]->length());
+		maxEnd = std::max(maxEnd, m_notes[i]->pos() + length);
+		m_maxEnd[i] = maxEnd;
+	}
+}
+
+
+
+
+std::span<const Note* const> PianoRoll::NoteIndex::notesIn(int begin, int end) const
+{
+	// the first note that, or a note before it, ends after begin
+	const auto first = std::lower_bound(m_maxEnd.begin(), m_maxEnd.end(), begin) - m_maxEnd.begin();
+	// the first note that starts after end
+	const auto last = std::upper_bound(m_notes.begin(), m_notes.end(), end,
+		[](int tick, const Note* note) { return tick < note->pos(); }) - m_notes.begin();
+	if (first >= last) { return {}; }
+	return {m_notes.data() + first, static_cast<std::size_t>(last - first)};
+}
+
+
+
+
+void PianoRoll::drawNotes(QPainter& p, bool drawNoteNames)
+{
+	p.setClipRect(
+		m_whiteKeyWidth,
+		PR_TOP_MARGIN,
+		width() - m_whiteKeyWidth,
+		height() - PR_TOP_MARGIN);
+
+	const int topKey = qBound(0, m_startKey + m_pianoKeysVisible - 1, NumKeys - 1);
+	const int bottomKey = topKey - m_pianoKeysVisible;
+
+	QPolygonF editHandles;
+
+	// Return a note's Y position on the grid
+	auto noteYPos = [&](const int key)
+	{
+		return (topKey - key) * m_keyLineHeight + keyAreaTop() - 1;
+	};
+
+	auto xCoordOfTick = [this](int tick) {
+		return m_whiteKeyWidth + (
+			(tick - m_currentPosition) * m_ppb / TimePos::ticksPerBar()
+		);
+	};
+
+	// only look at the notes around the visible ticks, with a bar of margin
+	// for rounding and the note edges
+	const int firstTick = m_currentPosition - TimePos::ticksPerBar();
+	const int lastTick = m_currentPosition + TimePos::ticksPerBar()
+		+ (width() - m_whiteKeyWidth) * TimePos::ticksPerBar() / qMax(1, m_ppb);
+
+	// -- Begin ghost MIDI clip
+	for (const Note* note : m_ghostNoteIndex.notesIn(firstTick, lastTick))
+	{
+		int len_ticks = note->length();
+
+		if( len_ticks == 0 )
+		{
+			continue;
+		}
+		else if( len_ticks < 0 )
+		{
+			len_ticks = 4;
+		}
+
+		int pos_ticks = note->pos();
+
+		int note_width = len_ticks * m_ppb / TimePos::ticksPerBar();
+		const int x = ( pos_ticks - m_currentPosition ) *
+				m_ppb / TimePos::ticksPerBar();
+		// skip this note if not in visible area at all
+		if (!(x + note_width >= 0 && x <= width() - m_whiteKeyWidth))
+		{
+			continue;
+		}
+
+		// is the note in visible area?
+		if (note->key() > bottomKey && note->key() <= topKey)
+		{
+
+			// we've done and checked all, let's draw the note
+			drawNoteRect(
+				p, x + m_whiteKeyWidth, noteYPos(note->key()), note_width,
+				note, m_ghostNoteColor, m_ghostNoteTextColor, m_selectedNoteColor,
+				m_ghostNoteOpacity, m_ghostNoteBorders, drawNoteNames);
+		}
+
+	}
+	// -- End ghost MIDI clip
+
+	for (const Note* note : m_noteIndex.notesIn(firstTick, lastTick))
+	{
+		int len_ticks = note->length();
+
+		if( len_ticks == 0 )
+		{
+			continue;
+		}
+		else if( len_ticks < 0 )
+		{
+			len_ticks = 4;
+		}
+
+		int pos_ticks = note->pos();
+
+		int note_width = len_ticks * m_ppb / TimePos::ticksPerBar();
+		const int x = ( pos_ticks - m_currentPosition ) *
+				m_ppb / TimePos::ticksPerBar();
+		// skip this note if not in visible area at all
+		if (!(x + note_width >= 0 && x <= width() - m_whiteKeyWidth))
+		{
+			continue;
+		}
+
+		// is the note in visible area?
+		if (note->key() > bottomKey && note->key() <= topKey)
+		{
+			// We've done and checked all, let's draw the note with
+			// the appropriate color
+			const auto fillColor = note->type() == Note::Type::Regular ? m_noteColor : m_stepNoteColor;
+
+			drawNoteRect(
+				p, x + m_whiteKeyWidth, noteYPos(note->key()), note_width,
+				note, fillColor, m_noteTextColor, m_selectedNoteColor,
+				m_noteOpacity, m_noteBorders, drawNoteNames
+			);
+		}
+
+		// draw note editing stuff
+		int editHandleTop = 0;
+		if( m_noteEditMode == NoteEditMode::Volume )
+		{
+			QColor color = m_barColor.lighter(30 + (note->getVolume() * 90 / MaxVolume));
+			if( note->selected() )
+			{
+				color = m_selectedNoteColor;
+			}
+			p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
+
+			editHandleTop = noteEditBottom() -
+				( (float)( note->getVolume() - MinVolume ) ) /
+				( (float)( MaxVolume - MinVolume ) ) *
+				( (float)( noteEditBottom() - noteEditTop() ) );
+
+			p.drawLine( QLineF ( noteEditLeft() + x + 0.5, editHandleTop + 0.5,
+						noteEditLeft() + x + 0.5, noteEditBottom() + 0.5 ) );
+
+		}
+		else if( m_noteEditMode == NoteEditMode::Panning )
+		{
+			QColor color = m_noteColor;
+			if( note->selected() )
+			{
+				color = m_selectedNoteColor;
+			}
+
+			p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
+
+			editHandleTop = noteEditBottom() -
+				( (float)( note->getPanning() - PanningLeft ) ) /
+				( (float)( (PanningRight - PanningLeft ) ) ) *
+				( (float)( noteEditBottom() - noteEditTop() ) );
+
+			p.drawLine( QLine( noteEditLeft() + x, noteEditTop() +
+					( (float)( noteEditBottom() - noteEditTop() ) ) / 2.0f,
+					    noteEditLeft() + x , editHandleTop ) );
+		}
+		editHandles << QPoint ( x + noteEditLeft(),
+					editHandleTop );
+
+		if( note->hasDetuningInfo() )
+		{
+			drawDetuningInfo(p, note, x + m_whiteKeyWidth, noteYPos(note->key()));
+			p.setClipRect(
+				m_whiteKeyWidth,
+				PR_TOP_MARGIN,
+				width() - m_whiteKeyWidth,
+				height() - PR_TOP_MARGIN);
+		}
+	}
+
+	// draw clip bounds
+	p.fillRect(
+		xCoordOfTick(m_midiClip->length() - m_midiClip->startTimeOffset()),
+		PR_TOP_MARGIN,
+		width() - 10,
+		noteEditBottom(),
+		m_outOfBoundsShade
+	);
+	p.fillRect(
+		0,
+		PR_TOP_MARGIN,
+		xCoordOfTick(-m_midiClip->startTimeOffset()),
+		noteEditBottom(),
+		m_outOfBoundsShade
+	);
+
+	p.setPen(QPen(m_noteColor, NOTE_EDIT_LINE_WIDTH + 2));
+	p.drawPoints( editHandles );
+}
+
+
+
 
 void PianoRoll::drawDetuningInfo( QPainter & _p, const Note * _n, int _x,
 								int _y ) const
@@ -1206,7 +1427,7 @@ void PianoRoll::shiftSemiTone(const NoteVector& notes, int amount)
 	m_midiClip->rearrangeAllNotes();
 	m_midiClip->dataChanged();
 	//We modified the song
-	update();
+	invalidateStaticLayer();
 	getGUI()->songEditor()->update();
 }
 
@@ -1242,7 +1463,7 @@ void PianoRoll::shiftPos(const NoteVector& notes, int amount)
 	m_midiClip->updateLength();
 	m_midiClip->dataChanged();
 	// we modified the song
-	update();
+	invalidateStaticLayer();
 	getGUI()->songEditor()->update();
 }
 
@@ -1279,7 +1500,7 @@ void PianoRoll::keyPressEvent(QKeyEvent* ke)
 		if(handled)
 		{
 			ke->accept();
-			update();
+			invalidateStaticLayer();
 			return;
 		}
 	}
@@ -1428,7 +1649,7 @@ void PianoRoll::keyPressEvent(QKeyEvent* ke)
 					// Ctrl + A = select all notes
 					selectAll();
 				}
-				update();
+				invalidateStaticLayer();
 			}
 			break;
 
@@ -1514,7 +1735,7 @@ void PianoRoll::keyPressEvent(QKeyEvent* ke)
 			break;
 	}
 
-	update();
+	invalidateStaticLayer();
 }
 
 
@@ -1545,7 +1766,7 @@ void PianoRoll::keyReleaseEvent(QKeyEvent* ke )
 			computeSelectedNotes( ke->modifiers() & Qt::ShiftModifier);
 			m_editMode = m_ctrlMode;
 			if (m_editMode == EditMode::Strum) { setupSelectedChords(); }
-			update();
+			invalidateStaticLayer();
 			break;
 
 		// update after undo/redo
@@ -1553,7 +1774,7 @@ void PianoRoll::keyReleaseEvent(QKeyEvent* ke )
 		case Qt::Key_R:
 			if( hasValidMidiClip() && ke->modifiers() == Qt::ControlModifier )
 			{
-				update();
+				invalidateStaticLayer();
 			}
 			break;
 		default:
@@ -1561,7 +1782,7 @@ void PianoRoll::keyReleaseEvent(QKeyEvent* ke )
 			break;
 	}
 
-	update();
+	invalidateStaticLayer();
 }
 
 
@@ -1671,7 +1892,7 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 			n->createDetuning();
 		}
 		detuningClip = n->detuning()->automationClip();
-		connect(detuningClip.data(), SIGNAL(dataChanged()), this, SLOT(update()));
+		connect(detuningClip.data(), SIGNAL(dataChanged()), this, SLOT(invalidateStaticLayer()));
 		getGUI()->automationEditor()->setGhostMidiClip(m_midiClip);
 		getGUI()->automationEditor()->open(detuningClip);
 		return;
@@ -1922,7 +2143,7 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 						{
 							// added new notes, so must update engine, song, etc
 							Engine::getSong()->setModified();
-							update();
+							invalidateStaticLayer();
 							getGUI()->songEditor()->update();
 						}
 					}
@@ -1962,7 +2183,7 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 				mouseMoveEvent( me );
 			}
 
-			update();
+			invalidateStaticLayer();
 		}
 		else if (pos.y() < keyAreaBottom())
 		{
@@ -1997,7 +2218,7 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 				{
 					m_noteEditMode = (NoteEditMode) 0;
 				}
-				repaint();
+				invalidateStaticLayer();
 			}
 			else if( me->buttons() == Qt::RightButton )
 			{
@@ -2295,7 +2516,7 @@ void PianoRoll::computeSelectedNotes(bool shift)
 	}
 
 	removeSelection();
-	update();
+	invalidateStaticLayer();
 }
 
 
@@ -2399,7 +2620,7 @@ void PianoRoll::mouseReleaseEvent( QMouseEvent * me )
 
 	if( mustRepaint )
 	{
-		repaint();
+		invalidateStaticLayer();
 	}
 }
 
@@ -3219,7 +3440,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		}
 		int x, q = quantization(), tick;
 
-		// draw vertical quantization lines
 		// If we're over 100% zoom, we allow all quantization level grids
 		if (m_zoomingModel.value() <= 3)
 		{
@@ -3229,18 +3449,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 			// allow quantization grid up to 1/32 for normal notes
 			else if (q < 6) { q = 6; }
 		}
-    
-		p.setPen(m_lineColor);
-		for (tick = m_currentPosition - m_currentPosition % q,
-			x = xCoordOfTick(tick);
-			x <= width();
-			tick += q, x = xCoordOfTick(tick))
-		{
-			p.drawLine(x, keyAreaTop(), x, noteEditBottom());
-		}
-
-		// draw horizontal grid lines and piano notes
-		p.setClipRect(0, keyAreaTop(), width(), keyAreaBottom() - keyAreaTop());
 		// the first grid line from the top Y position
 		int grid_line_y = keyAreaTop() + m_keyLineHeight - 1;
 
@@ -3357,109 +3565,159 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		};
 		// lambda for drawing the horizontal grid line
 		auto drawHorizontalLine = [&](
+			QPainter& painter,
 			const int key,
 			const int y
 		)
 		{
-			if (static_cast<Key>(key % KeysPerOctave) == Key::C) { p.setPen(m_beatLineColor); }
-			else { p.setPen(m_lineColor); }
-			p.drawLine(m_whiteKeyWidth, y, width(), y);
+			if (static_cast<Key>(key % KeysPerOctave) == Key::C) { painter.setPen(m_beatLineColor); }
+			else { painter.setPen(m_lineColor); }
+			painter.drawLine(m_whiteKeyWidth, y, width(), y);
 		};
-		// correct y offset of the top key
-		switch (prKeyOrder[topNote])
+		// lambda for calling draw(key, y) for the visible keys, with the Y position
+		// of the grid line below each key
+		auto forEachVisibleKey = [&](auto&& draw)
 		{
-		case KeyType::WhiteSmall:
-		case KeyType::WhiteBig:
-			break;
-		case KeyType::Black:
-			// draw extra white key
-			drawKey(topKey + 1, grid_line_y - m_keyLineHeight);
-		}
-		// loop through visible keys
-		const int lastKey = qMax(0, topKey - m_pianoKeysVisible);
-		for (int key = topKey; key > lastKey; --key)
+			int y = grid_line_y;
+			const int lastKey = qMax(0, topKey - m_pianoKeysVisible);
+			for (int key = topKey; key > lastKey; --key)
+			{
+				if (Piano::isWhiteKey(key))
+				{
+					draw(key, y);
+					y += m_keyLineHeight;
+				}
+				else
+				{
+					// next white key first, the black key goes over it and the previous one
+					draw(key - 1, y + m_keyLineHeight);
+					draw(key, y);
+					// drew two grid keys so skip ahead properly
+					y += m_keyLineHeight + m_keyLineHeight;
+					--key;
+				}
+			}
+		};
+
+		// The grid and the notes only change on edits, scrolling and zooming, but the
+		// keys and the position line repaint all the time during playback. So they are
+		// drawn on top of a cached layer with the grid and the notes.
+		const auto& timeSig = Engine::getSong()->getTimeSigModel();
+		const auto layerState = StaticLayerState{size(), devicePixelRatioF(), m_currentPosition, m_startKey,
+			m_ppb, m_keyLineHeight, m_notesEditHeight, timeSig.getNumerator(), timeSig.getDenominator(),
+			drawNoteNames};
+		if (m_staticLayerOutdated || layerState != m_staticLayerState)
 		{
-			bool whiteKey = Piano::isWhiteKey(key);
-			if (whiteKey)
+			if (m_noteIndexOutdated)
 			{
-				drawKey(key, grid_line_y);
-				drawHorizontalLine(key, grid_line_y);
-				grid_line_y += m_keyLineHeight;
+				m_noteIndex.build(m_midiClip->notes());
+				m_ghostNoteIndex.build(m_ghostNotes);
+				m_noteIndexOutdated = false;
 			}
-			else
+
+			const QSize layerSize = size() * devicePixelRatioF();
+			if (m_staticLayer.size() != layerSize) { m_staticLayer = QPixmap{layerSize}; }
+			m_staticLayer.setDevicePixelRatio(devicePixelRatioF());
+			m_staticLayer.fill(Qt::transparent);
+			QPainter layer(&m_staticLayer);
+
+			// draw vertical quantization lines
+			layer.setPen(m_lineColor);
+			for (tick = m_currentPosition - m_currentPosition % q,
+				x = xCoordOfTick(tick);
+				x <= width();
+				tick += q, x = xCoordOfTick(tick))
 			{
-				// draw next white key
-				drawKey(key - 1, grid_line_y + m_keyLineHeight);
-				drawHorizontalLine(key - 1, grid_line_y + m_keyLineHeight);
-				// draw black key over previous and next white key
-				drawKey(key, grid_line_y);
-				drawHorizontalLine(key, grid_line_y);
-				// drew two grid keys so skip ahead properly
-				grid_line_y += m_keyLineHeight + m_keyLineHeight;
-				// capture double key draw
-				--key;
+				layer.drawLine(x, keyAreaTop(), x, noteEditBottom());
+			}
+
+			// draw horizontal grid lines
+			layer.setClipRect(0, keyAreaTop(), width(), keyAreaBottom() - keyAreaTop());
+			forEachVisibleKey([&](int key, int y) { drawHorizontalLine(layer, key, y); });
+
+			// don't draw over keys
+			layer.setClipRect(m_whiteKeyWidth, keyAreaTop(), width(), noteEditBottom() - keyAreaTop());
+
+			// draw alternating shading on bars
+			float timeSignature =
+				static_cast<float>(Engine::getSong()->getTimeSigModel().getNumerator()) /
+				static_cast<float>(Engine::getSong()->getTimeSigModel().getDenominator());
+			float zoomFactor = m_zoomLevels[m_zoomingModel.value()];
+			//the bars which disappears at the left side by scrolling
+			int leftBars = m_currentPosition * zoomFactor / TimePos::ticksPerBar();
+			//iterates the visible bars and draw the shading on uneven bars
+			for (int x = m_whiteKeyWidth, barCount = leftBars;
+				x < width() + m_currentPosition * zoomFactor / timeSignature;
+				x += m_ppb, ++barCount)
+			{
+				if ((barCount + leftBars) % 2 != 0)
+				{
+					layer.fillRect(x - m_currentPosition * zoomFactor / timeSignature,
+						PR_TOP_MARGIN,
+						m_ppb,
+						height() - (PR_BOTTOM_MARGIN + PR_TOP_MARGIN),
+						m_backgroundShade);
+				}
 			}
-		}
 
-		// don't draw over keys
-		p.setClipRect(m_whiteKeyWidth, keyAreaTop(), width(), noteEditBottom() - keyAreaTop());
-
-		// draw alternating shading on bars
-		float timeSignature =
-			static_cast<float>(Engine::getSong()->getTimeSigModel().getNumerator()) /
-			static_cast<float>(Engine::getSong()->getTimeSigModel().getDenominator());
-		float zoomFactor = m_zoomLevels[m_zoomingModel.value()];
-		//the bars which disappears at the left side by scrolling
-		int leftBars = m_currentPosition * zoomFactor / TimePos::ticksPerBar();
-		//iterates the visible bars and draw the shading on uneven bars
-		for (int x = m_whiteKeyWidth, barCount = leftBars;
-			x < width() + m_currentPosition * zoomFactor / timeSignature;
-			x += m_ppb, ++barCount)
-		{
-			if ((barCount + leftBars) % 2 != 0)
+			// draw vertical beat lines
+			int ticksPerBeat = DefaultTicksPerBar /
+				Engine::getSong()->getTimeSigModel().getDenominator();
+			layer.setPen(m_beatLineColor);
+			for(tick = m_currentPosition - m_currentPosition % ticksPerBeat,
+				x = xCoordOfTick( tick );
+				x <= width();
+				tick += ticksPerBeat, x = xCoordOfTick(tick))
 			{
-				p.fillRect(x - m_currentPosition * zoomFactor / timeSignature,
-					PR_TOP_MARGIN,
-					m_ppb,
-					height() - (PR_BOTTOM_MARGIN + PR_TOP_MARGIN),
-					m_backgroundShade);
+				layer.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
 			}
-		}
 
-		// draw vertical beat lines
-		int ticksPerBeat = DefaultTicksPerBar /
-			Engine::getSong()->getTimeSigModel().getDenominator();
-		p.setPen(m_beatLineColor);
-		for(tick = m_currentPosition - m_currentPosition % ticksPerBeat,
-			x = xCoordOfTick( tick );
-			x <= width();
-			tick += ticksPerBeat, x = xCoordOfTick(tick))
-		{
-			p.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
-		}
+			// draw vertical bar lines
+			layer.setPen(m_barLineColor);
+			for(tick = m_currentPosition - m_currentPosition % TimePos::ticksPerBar(),
+				x = xCoordOfTick( tick );
+				x <= width();
+				tick += TimePos::ticksPerBar(), x = xCoordOfTick(tick))
+			{
+				layer.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
+			}
 
-		// draw vertical bar lines
-		p.setPen(m_barLineColor);
-		for(tick = m_currentPosition - m_currentPosition % TimePos::ticksPerBar(),
-			x = xCoordOfTick( tick );
-			x <= width();
-			tick += TimePos::ticksPerBar(), x = xCoordOfTick(tick))
-		{
-			p.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
+			// draw marked semitones after the grid
+			for(x = 0; x < m_markedSemiTones.size(); ++x)
+			{
+				const int key_num = m_markedSemiTones.at(x);
+				const int y = yCoordOfKey(key_num);
+				if(y >= keyAreaBottom() - 1) { break; }
+				layer.fillRect(m_whiteKeyWidth + 1,
+					y,
+					width() - 10,
+					m_keyLineHeight,
+					m_markedSemitoneColor);
+			}
+
+			QFont noteFont = f;
+			noteFont.setBold(false);
+			layer.setFont(adjustedToPixelSize(noteFont, SMALL_FONT_SIZE));
+			drawNotes(layer, drawNoteNames);
+
+			m_staticLayerOutdated = false;
+			m_staticLayerState = layerState;
 		}
+		p.drawPixmap(0, 0, m_staticLayer);
 
-		// draw marked semitones after the grid
-		for(x = 0; x < m_markedSemiTones.size(); ++x)
-		{
-			const int key_num = m_markedSemiTones.at(x);
-			const int y = yCoordOfKey(key_num);
-			if(y >= keyAreaBottom() - 1) { break; }
-			p.fillRect(m_whiteKeyWidth + 1,
-				y,
-				width() - 10,
-				m_keyLineHeight,
-				m_markedSemitoneColor);
+		// draw piano keys
+		p.setClipRect(0, keyAreaTop(), width(), keyAreaBottom() - keyAreaTop());
+		// correct y offset of the top key
+		switch (prKeyOrder[topNote])
+		{
+		case KeyType::WhiteSmall:
+		case KeyType::WhiteBig:
+			break;
+		case KeyType::Black:
+			// draw extra white key
+			drawKey(topKey + 1, grid_line_y - m_keyLineHeight);
 		}
+		forEachVisibleKey(drawKey);
 	}
 
 	// reset MIDI clip
@@ -3517,163 +3775,12 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		const int topKey = qBound(0, m_startKey + m_pianoKeysVisible - 1, NumKeys - 1);
 		const int bottomKey = topKey - m_pianoKeysVisible;
 
-		QPolygonF editHandles;
-
 		// Return a note's Y position on the grid
 		auto noteYPos = [&](const int key)
 		{
 			return (topKey - key) * m_keyLineHeight + keyAreaTop() - 1;
 		};
 
-		// -- Begin ghost MIDI clip
-		if( !m_ghostNotes.empty() )
-		{
-			for( const Note *note : m_ghostNotes )
-			{
-				int len_ticks = note->length();
-
-				if( len_ticks == 0 )
-				{
-					continue;
-				}
-				else if( len_ticks < 0 )
-				{
-					len_ticks = 4;
-				}
-
-				int pos_ticks = note->pos();
-
-				int note_width = len_ticks * m_ppb / TimePos::ticksPerBar();
-				const int x = ( pos_ticks - m_currentPosition ) *
-						m_ppb / TimePos::ticksPerBar();
-				// skip this note if not in visible area at all
-				if (!(x + note_width >= 0 && x <= width() - m_whiteKeyWidth))
-				{
-					continue;
-				}
-
-				// is the note in visible area?
-				if (note->key() > bottomKey && note->key() <= topKey)
-				{
-
-					// we've done and checked all, let's draw the note
-					drawNoteRect(
-						p, x + m_whiteKeyWidth, noteYPos(note->key()), note_width,
-						note, m_ghostNoteColor, m_ghostNoteTextColor, m_selectedNoteColor,
-						m_ghostNoteOpacity, m_ghostNoteBorders, drawNoteNames);
-				}
-
-			}
-		}
-		// -- End ghost MIDI clip
-
-		for( const Note *note : m_midiClip->notes() )
-		{
-			int len_ticks = note->length();
-
-			if( len_ticks == 0 )
-			{
-				continue;
-			}
-			else if( len_ticks < 0 )
-			{
-				len_ticks = 4;
-			}
-
-			int pos_ticks = note->pos();
-
-			int note_width = len_ticks * m_ppb / TimePos::ticksPerBar();
-			const int x = ( pos_ticks - m_currentPosition ) *
-					m_ppb / TimePos::ticksPerBar();
-			// skip this note if not in visible area at all
-			if (!(x + note_width >= 0 && x <= width() - m_whiteKeyWidth))
-			{
-				continue;
-			}
-
-			// is the note in visible area?
-			if (note->key() > bottomKey && note->key() <= topKey)
-			{
-				// We've done and checked all, let's draw the note with
-				// the appropriate color
-				const auto fillColor = note->type() == Note::Type::Regular ? m_noteColor : m_stepNoteColor;
-
-				drawNoteRect(
-					p, x + m_whiteKeyWidth, noteYPos(note->key()), note_width,
-					note, fillColor, m_noteTextColor, m_selectedNoteColor,
-					m_noteOpacity, m_noteBorders, drawNoteNames
-				);
-			}
-
-			// draw note editing stuff
-			int editHandleTop = 0;
-			if( m_noteEditMode == NoteEditMode::Volume )
-			{
-				QColor color = m_barColor.lighter(30 + (note->getVolume() * 90 / MaxVolume));
-				if( note->selected() )
-				{
-					color = m_selectedNoteColor;
-				}
-				p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
-
-				editHandleTop = noteEditBottom() -
-					( (float)( note->getVolume() - MinVolume ) ) /
-					( (float)( MaxVolume - MinVolume ) ) *
-					( (float)( noteEditBottom() - noteEditTop() ) );
-
-				p.drawLine( QLineF ( noteEditLeft() + x + 0.5, editHandleTop + 0.5,
-							noteEditLeft() + x + 0.5, noteEditBottom() + 0.5 ) );
-
-			}
-			else if( m_noteEditMode == NoteEditMode::Panning )
-			{
-				QColor color = m_noteColor;
-				if( note->selected() )
-				{
-					color = m_selectedNoteColor;
-				}
-
-				p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
-
-				editHandleTop = noteEditBottom() -
-					( (float)( note->getPanning() - PanningLeft ) ) /
-					( (float)( (PanningRight - PanningLeft ) ) ) *
-					( (float)( noteEditBottom() - noteEditTop() ) );
-
-				p.drawLine( QLine( noteEditLeft() + x, noteEditTop() +
-						( (float)( noteEditBottom() - noteEditTop() ) ) / 2.0f,
-						    noteEditLeft() + x , editHandleTop ) );
-			}
-			editHandles << QPoint ( x + noteEditLeft(),
-						editHandleTop );
-
-			if( note->hasDetuningInfo() )
-			{
-				drawDetuningInfo(p, note, x + m_whiteKeyWidth, noteYPos(note->key()));
-				p.setClipRect(
-					m_whiteKeyWidth,
-					PR_TOP_MARGIN,
-					width() - m_whiteKeyWidth,
-					height() - PR_TOP_MARGIN);
-			}
-		}
-
-		// draw clip bounds
-		p.fillRect(
-			xCoordOfTick(m_midiClip->length() - m_midiClip->startTimeOffset()),
-			PR_TOP_MARGIN,
-			width() - 10,
-			noteEditBottom(),
-			m_outOfBoundsShade
-		);
-		p.fillRect(
-			0,
-			PR_TOP_MARGIN,
-			xCoordOfTick(-m_midiClip->startTimeOffset()),
-			noteEditBottom(),
-			m_outOfBoundsShade
-		);
-
 		// -- Knife tool (draw cut line)
 		if (m_action == Action::Knife && m_knifeDown)
 		{
@@ -3721,9 +3828,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 			}
 		}
 
-		p.setPen(QPen(m_noteColor, NOTE_EDIT_LINE_WIDTH + 2));
-		p.drawPoints( editHandles );
-
 	}
 	else
 	{
@@ -3948,7 +4052,7 @@ void PianoRoll::wheelEvent(QWheelEvent * we )
 					showPanTextFloat(nv[0]->getPanning(), pos, 1000);
 				}
 			}
-			update();
+			invalidateStaticLayer();
 		}
 	}
 
@@ -4278,7 +4382,7 @@ void PianoRoll::finishRecordNote(const Note & n )
 						n1.quantizePos(quantization());
 					}
 					m_midiClip->addNote(n1, false);
-					update();
+					invalidateStaticLayer();
 					m_recordingNotes.erase( it );
 					break;
 				}
@@ -4316,6 +4420,24 @@ void PianoRoll::verScrolled( int new_pos )
 
 
 
+void PianoRoll::invalidateStaticLayer()
+{
+	m_staticLayerOutdated = true;
+	update();
+}
+
+
+
+
+void PianoRoll::notesChanged()
+{
+	m_noteIndexOutdated = true;
+	invalidateStaticLayer();
+}
+
+
+
+
 void PianoRoll::setEditMode(int mode)
 {
 	m_ctrlMode = m_editMode = (EditMode) mode;
@@ -4449,6 +4571,7 @@ void PianoRoll::enterValue( NoteVector* nv )
 		}
 
 	}
+	invalidateStaticLayer();
 }
 
 
@@ -4533,7 +4656,7 @@ void PianoRoll::cutSelectedNotes()
 		}
 	}
 
-	update();
+	invalidateStaticLayer();
 	getGUI()->songEditor()->update();
 }
 
@@ -4561,11 +4684,7 @@ void PianoRoll::pasteNotes()
 		// remove selection and select the newly pasted notes
 		clearSelectedNotes();
 
-		if( ! list.isEmpty() )
-		{
-			m_midiClip->addJournalCheckPoint();
-		}
-
+		auto batch = MidiClip::NoteBatch{m_midiClip, !list.isEmpty()};
 		for( int i = 0; ! list.item( i ).isNull(); ++i )
 		{
 			// create the note
@@ -4577,13 +4696,14 @@ void PianoRoll::pasteNotes()
 			cur_note.setSelected( true );
 
 			// add to MIDI clip
-			m_midiClip->addNote( cur_note, false );
+			batch.addNote(cur_note, false);
 		}
+		batch.commit();
 
 		// we only have to do the following lines if we pasted at
 		// least one note...
 		Engine::getSong()->setModified();
-		update();
+		invalidateStaticLayer();
 		getGUI()->songEditor()->update();
 	}
 }
@@ -4599,12 +4719,12 @@ bool PianoRoll::deleteSelectedNotes()
 	auto selectedNotes = getSelectedNotes();
 	if (selectedNotes.empty()) { return false; }
 
-	m_midiClip->addJournalCheckPoint();
-
-	for (Note* note: selectedNotes) { m_midiClip->removeNote( note ); }
+	auto batch = MidiClip::NoteBatch{m_midiClip};
+	for (Note* note: selectedNotes) { batch.removeNote(note); }
+	batch.commit();
 
 	Engine::getSong()->setModified();
-	update();
+	invalidateStaticLayer();
 	getGUI()->songEditor()->update();
 	return true;
 }
@@ -4730,7 +4850,7 @@ void PianoRoll::zoomingYChanged()
 
 void PianoRoll::quantizeChanged()
 {
-	update();
+	invalidateStaticLayer();
 }
 
 void PianoRoll::noteLengthChanged()
@@ -4801,7 +4921,7 @@ void PianoRoll::quantizeNotes(QuantizeAction mode)
 		m_midiClip->addNote(copy, false);
 	}
 
-	update();
+	invalidateStaticLayer();
 	getGUI()->songEditor()->update();
 	Engine::getSong()->setModified();
 }
@@ -123,6 +123,10 @@ void TrackContentWidget::updateBackground()
 		fineGridResolution *= scaleFactor;
 	}
 
+	const auto key = BackgroundKey{ppb, height(), coarseGridResolution, fineGridResolution};
+	if (m_backgroundKey == key) { return; }
+	m_backgroundKey = key;
+
 	int w = ppb * BARS_PER_GROUP;
 	int h = height();
 	m_background = QPixmap( w * 2, height() );
@@ -158,8 +162,8 @@ void TrackContentWidget::updateBackground()
 
 	pmp.end();
 
-	// Force redraw
-	update();
+	// Force redraw, the clips themselves didn't change
+	QWidget::update();
 }
 
 
@@ -271,8 +275,6 @@ void TrackContentWidget::changePosition( const TimePos & newPos )
 	{
 		Clip* clip = clipView->getClip();
 
-		clip->changeLength( clip->length() );
-
 		const int ts = clip->startPosition();
 		const int te = clip->endPosition()-3;
 		if( ( ts >= begin && ts <= end ) ||
@@ -292,9 +294,9 @@ void TrackContentWidget::changePosition( const TimePos & newPos )
 	}
 	setUpdatesEnabled( true );
 
-	// redraw background
-	updateBackground();
-//	update();
+	// the clips keep their cached pixmaps while they are only moved,
+	// the background is tiled from the new position
+	QWidget::update();
 }
 
 
@@ -650,7 +652,8 @@ void TrackContentWidget::resizeEvent( QResizeEvent * resizeEvent )
 {
 	// Update background
 	updateBackground();
-	// Force redraw
+	// Force redraw and adjust the height of the clips
+	update();
 	QWidget::resizeEvent( resizeEvent );
 }
 
@@ -770,46 +773,46 @@ int TrackContentWidget::embossOffset() const
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setDarkerColor( const QBrush & c )
-{ m_darkerColor = c; }
+{ m_darkerColor = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setLighterColor( const QBrush & c )
-{ m_lighterColor = c; }
+{ m_lighterColor = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setCoarseGridColor( const QBrush & c )
-{ m_coarseGridColor = c; }
+{ m_coarseGridColor = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setFineGridColor( const QBrush & c )
-{ m_fineGridColor = c; }
+{ m_fineGridColor = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setHorizontalColor( const QBrush & c )
-{ m_horizontalColor = c; }
+{ m_horizontalColor = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setEmbossColor( const QBrush & c )
-{ m_embossColor = c; }
+{ m_embossColor = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setCoarseGridWidth(int c)
-{ m_coarseGridWidth = c; }
+{ m_coarseGridWidth = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setFineGridWidth(int c)
-{ m_fineGridWidth = c; }
+{ m_fineGridWidth = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setHorizontalWidth(int c)
-{ m_horizontalWidth = c; }
+{ m_horizontalWidth = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setEmbossWidth(int c)
-{ m_embossWidth = c; }
+{ m_embossWidth = c; m_backgroundKey.reset(); }
 
 //! \brief CSS theming qproperty access method
 void TrackContentWidget::setEmbossOffset(int c)
-{ m_embossOffset = c; }
+{ m_embossOffset = c; m_backgroundKey.reset(); }
 
 } // namespace lmms::gui
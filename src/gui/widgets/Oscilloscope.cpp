@@ -73,18 +73,6 @@ Oscilloscope::~Oscilloscope()
 
 
 
-void Oscilloscope::updateAudioBuffer(const SampleFrame* buffer)
-{
-	if( !Engine::getSong()->isExporting() )
-	{
-		const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
-		memcpy(m_buffer, buffer, sizeof(SampleFrame) * fpp);
-	}
-}
-
-
-
-
 void Oscilloscope::setActive( bool _active )
 {
 	m_active = _active;
@@ -93,18 +81,14 @@ void Oscilloscope::setActive( bool _active )
 		connect( getGUI()->mainWindow(),
 					SIGNAL(periodicUpdate()),
 					this, SLOT(update()));
-		connect( Engine::audioEngine(),
-			SIGNAL(nextAudioBuffer(const lmms::SampleFrame*)),
-			this, SLOT(updateAudioBuffer(const lmms::SampleFrame*)));
+		m_subscriber = std::make_unique<AudioTap::Subscriber>(Engine::audioEngine()->outputTap(), true);
 	}
 	else
 	{
 		disconnect( getGUI()->mainWindow(),
 					SIGNAL(periodicUpdate()),
 					this, SLOT(update()));
-		disconnect( Engine::audioEngine(),
-			SIGNAL(nextAudioBuffer(const lmms::SampleFrame*)),
-			this, SLOT(updateAudioBuffer(const lmms::SampleFrame*)));
+		m_subscriber.reset();
 		// we have to update (remove last waves),
 		// because timer doesn't do that anymore
 		update();
@@ -166,6 +150,7 @@ void Oscilloscope::paintEvent( QPaintEvent * )
 		float masterOutput = audioEngine->masterGain();
 
 		const fpp_t frames = audioEngine->framesPerPeriod();
+		m_subscriber->updateWindow(m_buffer, frames);
 		SampleFrame peakValues = getAbsPeakValues(m_buffer, frames);
 
 		auto const leftChannelClips = clips(peakValues.left() * masterOutput);
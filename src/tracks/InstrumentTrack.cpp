@@ -253,6 +253,9 @@ void InstrumentTrack::processAudioBuffer( SampleFrame* buf, const fpp_t frames,
 	// now
 	m_audioBusHandle.effects()->startRunning();
 
+	// the mixer lines up the other tracks with this one
+	m_audioBusHandle.setSourceLatency(m_instrument->latency());
+
 	// get volume knob data
 	static const float DefaultVolumeRatio = 1.0f / DefaultVolume;
 	/*ValueBuffer * volBuf = m_volumeModel.valueBuffer();
@@ -26,6 +26,7 @@
 #include "MidiClip.h"
 
 #include <algorithm>
+#include <iterator>
 #include <QDomElement>
 
 #include "GuiApplication.h"
@@ -199,6 +200,116 @@ Note * MidiClip::addNote( const Note & _new_note, const bool _quant_pos )
 
 
 
+MidiClip::NoteBatch::NoteBatch(MidiClip* clip, bool journal) :
+	m_clip(clip)
+{
+	// before any edits, so notes changed directly while batching can be undone too
+	if (journal) { m_clip->addJournalCheckPoint(); }
+}
+
+
+
+
+MidiClip::NoteBatch::~NoteBatch()
+{
+	commit();
+}
+
+
+
+
+Note* MidiClip::NoteBatch::addNote(const Note& note, bool quantPos)
+{
+	auto newNote = note.clone();
+	if (quantPos && gui::getGUI() && gui::getGUI()->pianoRoll())
+	{
+		newNote->quantizePos(gui::getGUI()->pianoRoll()->quantization());
+	}
+
+	m_added.push_back(newNote);
+	return newNote;
+}
+
+
+
+
+void MidiClip::NoteBatch::removeNote(Note* note)
+{
+	m_removed.insert(note);
+}
+
+
+
+
+void MidiClip::NoteBatch::moveNote(Note* note, TimePos pos, int key)
+{
+	m_moved.emplace_back(note, pos, key);
+}
+
+
+
+
+void MidiClip::NoteBatch::commit()
+{
+	if (m_added.empty() && m_removed.empty() && m_moved.empty()) { return; }
+
+	// notes added and removed again never reach the clip
+	const auto removed = [this](Note* note) { return m_removed.count(note) != 0; };
+	for (auto note : m_added)
+	{
+		if (removed(note)) { delete note; }
+	}
+	m_added.erase(std::remove_if(m_added.begin(), m_added.end(), removed), m_added.end());
+
+	// moved notes are taken out of the clip and merged back like new ones
+	auto moved = std::unordered_set<Note*>{};
+	for (const auto& [note, pos, key] : m_moved)
+	{
+		if (!removed(note)) { moved.insert(note); }
+	}
+
+	m_clip->instrumentTrack()->lock();
+
+	auto& notes = m_clip->m_notes;
+	auto kept = NoteVector{};
+	kept.reserve(notes.size() + m_added.size());
+	for (auto note : notes)
+	{
+		if (removed(note)) { delete note; }
+		else if (moved.count(note)) { m_added.push_back(note); }
+		else { kept.push_back(note); }
+	}
+
+	for (const auto& [note, pos, key] : m_moved)
+	{
+		if (!removed(note))
+		{
+			note->setPos(pos);
+			note->setKey(key);
+		}
+	}
+
+	// the clip is sorted already, so a single merge keeps it sorted
+	std::stable_sort(m_added.begin(), m_added.end(), Note::lessThan);
+	notes.clear();
+	notes.reserve(kept.size() + m_added.size());
+	std::merge(kept.begin(), kept.end(), m_added.begin(), m_added.end(), std::back_inserter(notes), Note::lessThan);
+
+	m_clip->instrumentTrack()->unlock();
+
+	m_added.clear();
+	m_removed.clear();
+	m_moved.clear();
+
+	m_clip->checkType();
+	m_clip->updateLength();
+
+	emit m_clip->dataChanged();
+}
+
+
+
+
 NoteVector::const_iterator MidiClip::removeNote(NoteVector::const_iterator it)
 {
 	instrumentTrack()->lock();
@@ -332,7 +443,7 @@ void MidiClip::splitNotes(const NoteVector& notes, TimePos pos)
 {
 	if (notes.empty()) { return; }
 
-	addJournalCheckPoint();
+	auto batch = NoteBatch{this};
 
 	for (const auto& note : notes)
 	{
@@ -353,7 +464,7 @@ void MidiClip::splitNotes(const NoteVector& notes, TimePos pos)
 		newNote.setLength(rightLength);
 		newNote.setPos(note->pos() + leftLength);
 
-		addNote(newNote, false);
+		batch.addNote(newNote, false);
 	}
 }
 
@@ -364,7 +475,7 @@ void MidiClip::splitNotesAlongLine(const NoteVector notes, TimePos pos1, int key
 	// Don't split if the line is horitzontal
 	if (key1 == key2) { return; }
 
-	addJournalCheckPoint();
+	auto batch = NoteBatch{this};
 
 	const auto slope = 1.f * (pos2 - pos1) / (key2 - key1);
 	const auto& [minKey, maxKey] = std::minmax(key1, key2);
@@ -387,15 +498,15 @@ void MidiClip::splitNotesAlongLine(const NoteVector notes, TimePos pos1, int key
 
 			if (deleteShortEnds)
 			{
-				addNote(newNote1.length() >= newNote2.length() ? newNote1 : newNote2, false);
+				batch.addNote(newNote1.length() >= newNote2.length() ? newNote1 : newNote2, false);
 			}
 			else
 			{
-				addNote(newNote1, false);
-				addNote(newNote2, false);
+				batch.addNote(newNote1, false);
+				batch.addNote(newNote2, false);
 			}
 
-			removeNote(note);
+			batch.removeNote(note);
 		}
 	}
 }
@@ -636,7 +747,7 @@ void MidiClip::updatePatternTrack()
 		&& gui::getGUI()->pianoRoll()
 		&& gui::getGUI()->pianoRoll()->currentMidiClip() == this)
 	{
-		gui::getGUI()->pianoRoll()->update();
+		gui::getGUI()->pianoRoll()->invalidateStaticLayer();
 	}
 }
 
@@ -0,0 +1,123 @@
+/*
+ * AgentContextBudgetTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <vector>
+
+#include "AgentContextBudget.h"
+
+using lmms::AgentContextBudget;
+using lmms::ChatMessage;
+
+namespace
+{
+
+//! Looks like the result of get_track_notes for a track with @p count notes
+QString notesResult(int count)
+{
+	QJsonArray notes;
+	for (int i = 0; i < count; ++i)
+	{
+		notes.append(QJsonObject{{"key", 60 + i % 12}, {"position", i * 48}, {"length", 48}, {"velocity", 100}});
+	}
+	const QJsonObject result{{"track", "Lead"}, {"noteCount", count}, {"notes", notes}};
+	return QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Compact));
+}
+
+//! One turn in which the assistant reads the notes of a track
+void addTurn(std::vector<ChatMessage>& history, const QString& request, int notes)
+{
+	const QJsonObject call{{"id", "call"}, {"function", QJsonObject{{"name", "get_track_notes"}}}};
+	history.push_back({"user", request, {}, {}, {}});
+	history.push_back({"assistant", "", {}, {}, QJsonArray{call}});
+	history.push_back({"tool", notesResult(notes), "call", "get_track_notes", {}});
+	history.push_back({"assistant", "done", {}, {}, {}});
+}
+
+} // namespace
+
+class AgentContextBudgetTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void TruncateTest()
+	{
+		const QString result = notesResult(1000);
+		const QString truncated = AgentContextBudget::truncateToolResult(result, 4000);
+		QVERIFY(truncated.size() <= 4000);
+
+		// still valid json that says how much is missing
+		const QJsonObject object = QJsonDocument::fromJson(truncated.toUtf8()).object();
+		QCOMPARE(object["noteCount"].toInt(), 1000);
+		const QJsonArray notes = object["notes"].toArray();
+		QVERIFY(notes.last().toString().endsWith("more items"));
+
+		QCOMPARE(AgentContextBudget::truncateToolResult("short", 4000), QString("short"));
+	}
+
+	void SummaryTest()
+	{
+		const QString summary = AgentContextBudget::summarizeToolResult("get_track_notes", notesResult(1000));
+		QVERIFY(summary.startsWith("[earlier get_track_notes result]"));
+		QVERIFY(summary.contains("notes: [1000 items]"));
+		QVERIFY(summary.contains("track: Lead"));
+	}
+
+	void BudgetTest()
+	{
+		std::vector<ChatMessage> history;
+		for (int i = 0; i < 50; ++i)
+		{
+			addTurn(history, QString("request %1").arg(i), 200);
+		}
+		history.push_back({"user", "latest", {}, {}, {}});
+
+		const AgentContextBudget budget(2000);
+		const QJsonArray messages = budget.buildMessages("system", history, 500);
+		const int tokens = AgentContextBudget::estimateTokens(
+			QString::fromUtf8(QJsonDocument(messages).toJson(QJsonDocument::Compact)));
+		QVERIFY(tokens <= 1500);
+
+		// the system prompt and the current turn are always there, and
+		// nothing starts with a tool result whose call was dropped
+		QCOMPARE(messages.first().toObject()["role"].toString(), QString("system"));
+		QCOMPARE(messages.last().toObject()["content"].toString(), QString("latest"));
+		QCOMPARE(messages[1].toObject()["role"].toString(), QString("user"));
+	}
+
+	void BuildBenchmark()
+	{
+		std::vector<ChatMessage> history;
+		for (int i = 0; i < 100; ++i)
+		{
+			addTurn(history, QString("request %1").arg(i), 500);
+		}
+		const AgentContextBudget budget(32000);
+		QBENCHMARK { budget.buildMessages("system", history, 4000); }
+	}
+};
+
+QTEST_GUILESS_MAIN(AgentContextBudgetTest)
+#include "AgentContextBudgetTest.moc"
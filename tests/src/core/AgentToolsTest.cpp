@@ -0,0 +1,142 @@
+/*
+ * AgentToolsTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "AgentTools.h"
+#include "Engine.h"
+#include "ProjectJournal.h"
+#include "Song.h"
+
+class AgentToolsTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase()
+	{
+		using namespace lmms;
+		Engine::init(true);
+	}
+
+	void cleanupTestCase()
+	{
+		using namespace lmms;
+		Engine::destroy();
+	}
+
+	void AccessTest()
+	{
+		using namespace lmms;
+
+		AgentTools tools;
+		QCOMPARE(tools.toolAccess("get_tempo"), ToolAccess::ReadOnly);
+		QCOMPARE(tools.toolAccess("set_tempo"), ToolAccess::Mutating);
+		QCOMPARE(tools.toolAccess("play_project"), ToolAccess::Standalone);
+		// may touch anything, so it isn't treated as read-only
+		QCOMPARE(tools.toolAccess("no_such_tool"), ToolAccess::Standalone);
+	}
+
+	void RoutingTest()
+	{
+		using namespace lmms;
+
+		const auto names = [](const QJsonArray& tools) {
+			QStringList result;
+			for (const auto& tool : tools) { result << tool.toObject()["function"].toObject()["name"].toString(); }
+			return result;
+		};
+
+		AgentTools tools;
+		const QStringList all = names(tools.getToolDefinitions());
+
+		// the tempo and track creation come along with everything
+		const QStringList beat = names(tools.getToolDefinitions("make a trap beat at 140"));
+		QVERIFY(beat.size() < all.size());
+		for (const auto& tool : {"set_tempo", "add_instrument_track", "add_notes_to_track", "request_tools"})
+		{
+			QVERIFY2(beat.contains(tool), tool);
+		}
+		QVERIFY(!beat.contains("list_samples"));
+
+		// a group the model asks for is sent like the tools it called
+		const ToolResult requested = tools.executeTool("request_tools", QJsonObject{{"group", "samples"}});
+		QVERIFY(requested.success);
+		QStringList alsoInclude;
+		for (const auto& tool : QJsonDocument::fromJson(requested.result.toUtf8()).object()["tools"].toArray())
+		{
+			alsoInclude << tool.toString();
+		}
+		QVERIFY(names(tools.getToolDefinitions("make a trap beat at 140", alsoInclude)).contains("list_samples"));
+
+		QVERIFY(!tools.executeTool("request_tools", QJsonObject{{"group", "nonsense"}}).success);
+	}
+
+	//! The edits of a turn are undone in one step, even with other calls
+	//! between them, and without touching the edits from before the turn
+	void TurnUndoTest()
+	{
+		using namespace lmms;
+
+		AgentTools tools;
+		Song* song = Engine::getSong();
+		ProjectJournal* journal = Engine::projectJournal();
+		QVERIFY(journal->isJournalling());
+		const int initialTempo = song->getTempo();
+
+		QVERIFY(tools.executeTool("set_tempo", QJsonObject{{"bpm", 90}}).success);
+
+		journal->beginCheckPointGroup();
+		QVERIFY(tools.executeTool("set_tempo", QJsonObject{{"bpm", 100}}).success);
+		QVERIFY(tools.executeTool("get_tempo", QJsonObject{}).success);
+		QVERIFY(!tools.executeTool("no_such_tool", QJsonObject{}).success);
+		QVERIFY(tools.executeTool("set_tempo", QJsonObject{{"bpm", 150}}).success);
+		journal->endCheckPointGroup();
+		QCOMPARE(song->getTempo(), 150);
+
+		journal->undo();
+		QCOMPARE(song->getTempo(), 90);
+
+		journal->redo();
+		QCOMPARE(song->getTempo(), 150);
+
+		journal->undo();
+		journal->undo();
+		QCOMPARE(song->getTempo(), initialTempo);
+
+		// the next turn is a group of its own
+		journal->beginCheckPointGroup();
+		QVERIFY(tools.executeTool("set_tempo", QJsonObject{{"bpm", 120}}).success);
+		journal->endCheckPointGroup();
+		journal->beginCheckPointGroup();
+		QVERIFY(tools.executeTool("set_tempo", QJsonObject{{"bpm", 130}}).success);
+		journal->endCheckPointGroup();
+		journal->undo();
+		QCOMPARE(song->getTempo(), 120);
+	}
+};
+
+QTEST_GUILESS_MAIN(AgentToolsTest)
+#include "AgentToolsTest.moc"
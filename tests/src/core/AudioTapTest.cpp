@@ -0,0 +1,101 @@
+/*
+ * AudioTapTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <memory>
+#include <vector>
+
+#include "AudioTap.h"
+
+using lmms::AudioTap;
+using lmms::SampleFrame;
+
+class AudioTapTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void LevelsTest()
+	{
+		AudioTap tap;
+		std::vector<SampleFrame> period(256, SampleFrame(0.5f, -0.25f));
+
+		// nothing is kept for subscribers that come later
+		QVERIFY(!tap.watched());
+		tap.process(period.data(), period.size());
+
+		AudioTap::Subscriber subscriber(tap);
+		QVERIFY(tap.watched());
+		QVERIFY(!subscriber.levels());
+
+		tap.process(period.data(), period.size(), 2.f);
+		period[10] = SampleFrame(-0.75f, 0.f);
+		tap.process(period.data(), period.size(), 2.f);
+
+		const auto levels = subscriber.levels();
+		QVERIFY(levels);
+		QCOMPARE(levels->peakLeft, 1.5f);
+		QCOMPARE(levels->peakRight, 0.5f);
+		QVERIFY(levels->rmsLeft > 0.9f && levels->rmsLeft < 1.1f);
+		QVERIFY(!subscriber.levels());
+
+		// silence
+		tap.process(nullptr, period.size());
+		QCOMPARE(subscriber.levels()->peakLeft, 0.f);
+	}
+
+	void ScopeTest()
+	{
+		auto tap = std::make_unique<AudioTap>(1024);
+		auto scope = std::make_unique<AudioTap::Subscriber>(*tap, true);
+
+		std::vector<SampleFrame> period(64);
+		for (std::size_t f = 0; f < period.size(); ++f) { period[f] = SampleFrame(float(f), -float(f)); }
+		tap->process(period.data(), period.size());
+		tap->process(period.data(), period.size());
+
+		// the window keeps the newest frames at its end
+		std::vector<SampleFrame> window(96);
+		QCOMPARE(scope->updateWindow(window.data(), window.size()), std::size_t{96});
+		QCOMPARE(window.front().left(), 32.f);
+		QCOMPARE(window.back().left(), 63.f);
+
+		tap->process(period.data(), 16);
+		QCOMPARE(scope->updateWindow(window.data(), window.size()), std::size_t{16});
+		QCOMPARE(window[79].left(), 63.f);
+		QCOMPARE(window.back().left(), 15.f);
+
+		// subscribers may outlive their tap
+		tap.reset();
+		QCOMPARE(scope->read(window.data(), window.size()), std::size_t{0});
+	}
+
+	void UnwatchedBenchmark()
+	{
+		AudioTap tap;
+		std::vector<SampleFrame> period(256);
+		QBENCHMARK { tap.process(period.data(), period.size()); }
+	}
+};
+
+QTEST_GUILESS_MAIN(AudioTapTest)
+#include "AudioTapTest.moc"
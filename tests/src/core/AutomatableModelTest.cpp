@@ -24,6 +24,7 @@
 
 
 #include <QtTest>
+#include "AudioEngine.h"
 #include "AutomatableModel.h"
 #include "ComboBoxModel.h"
 #include "Engine.h"
@@ -114,6 +115,37 @@ private slots: // tests
 		QVERIFY(m2.value());
 		QVERIFY(!m3.value());
 	}
+
+	void ValueBufferTests()
+	{
+		using namespace lmms;
+
+		// the engine's audio thread advances the period counter as well
+		const auto guard = Engine::audioEngine()->requestChangesGuard();
+
+		FloatModel m(0.f, 0.f, 1.f, 0.01f);
+
+		AutomatableModel::incrementPeriodCounter();
+		QVERIFY(m.valueBuffer() == nullptr); // value did not change
+
+		m.setValue(1.f);
+		AutomatableModel::incrementPeriodCounter();
+		ValueBuffer* vb = m.valueBuffer();
+		QVERIFY(vb != nullptr);
+		QCOMPARE(m.valueBuffer(), vb); // computed once per period
+		QCOMPARE(vb->value(0), 0.f);
+		QVERIFY(vb->value(vb->length() - 1) > 0.9f);
+
+		m.setValue(0.5f);
+		AutomatableModel::incrementPeriodCounter();
+		ValueBuffer* next = m.valueBuffer();
+		QVERIFY(next != nullptr);
+		QVERIFY(next != vb); // previous period's buffer stays intact
+		QCOMPARE(vb->value(0), 0.f);
+
+		AutomatableModel::incrementPeriodCounter();
+		QVERIFY(m.valueBuffer() == nullptr);
+	}
 };
 
 QTEST_GUILESS_MAIN(AutomatableModelTest)
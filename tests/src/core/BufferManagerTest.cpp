@@ -0,0 +1,81 @@
+/*
+ * BufferManagerTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "BufferManager.h"
+#include "SampleFrame.h"
+
+class BufferManagerTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase()
+	{
+		lmms::BufferManager::init(256);
+	}
+
+	void cleanupTestCase()
+	{
+		lmms::BufferManager::destroy();
+	}
+
+	void AcquireReleaseTest()
+	{
+		using namespace lmms;
+
+		const auto capacity = BufferManager::stats().capacity;
+		QVERIFY(capacity > 0);
+
+		// drain the pool and then some, the rest has to come from the heap
+		auto buffers = std::vector<SampleFrame*>{};
+		for (std::size_t i = 0; i < capacity + 8; ++i) { buffers.push_back(BufferManager::acquire()); }
+		QCOMPARE(std::set<SampleFrame*>(buffers.begin(), buffers.end()).size(), buffers.size());
+		QCOMPARE(reinterpret_cast<std::uintptr_t>(buffers[0]) % 64, std::uintptr_t{0});
+
+		const auto stats = BufferManager::stats();
+		QCOMPARE(stats.inUse, buffers.size());
+		QVERIFY(stats.highWaterMark >= buffers.size());
+		// unless the pool grew in the meantime
+		QVERIFY(stats.heapAllocations >= 8 || stats.capacity > capacity);
+
+		for (auto buffer : buffers)
+		{
+			buffer[0] = SampleFrame{1.f};
+			BufferManager::release(buffer);
+		}
+		QCOMPARE(BufferManager::stats().inUse, std::size_t{0});
+
+		// recycled buffers are silent again
+		const auto buffer = BufferManager::acquire();
+		QVERIFY(std::all_of(buffer, buffer + 256, [](const SampleFrame& frame) { return frame.left() == 0.f && frame.right() == 0.f; }));
+		BufferManager::release(buffer);
+	}
+};
+
+QTEST_GUILESS_MAIN(BufferManagerTest)
+#include "BufferManagerTest.moc"
@@ -0,0 +1,94 @@
+/*
+ * InstrumentSoundShapingTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <cmath>
+#include <vector>
+
+#include "BasicFilters.h"
+#include "InstrumentSoundShaping.h"
+#include "SampleFrame.h"
+
+class InstrumentSoundShapingTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	//! A pooled filter with ramped cutoff and resonance sounds like a filter of
+	//! its own whose coefficients follow them exactly on every frame, even
+	//! though its coefficients are only computed every few frames
+	void PooledFilterTest()
+	{
+		using namespace lmms;
+		using FilterType = BasicFilters<>::FilterType;
+
+		constexpr sample_rate_t SampleRate = 44100;
+		constexpr fpp_t Period = 500;
+		constexpr int Periods = 4;
+
+		// a fast, linear sweep that stays below self-oscillation, where the
+		// slightest difference would grow
+		const auto cutoffAt = [](float frame) { return 200.f + 4.f * frame; };
+		const auto resonanceAt = [](float frame) { return 0.5f + 0.0001f * frame; };
+
+		BasicFiltersPool pool(4);
+		for (auto type : {FilterType::LowPass, FilterType::DoubleLowPass, FilterType::Moog, FilterType::Lowpass_RC12, FilterType::Lowpass_SV})
+		{
+			auto pooled = pool.acquire(SampleRate);
+			pooled->setFilterType(type);
+			BasicFilters<> reference(SampleRate);
+			reference.setFilterType(type);
+
+			float maxDiff = 0.f;
+			for (int p = 0; p < Periods; ++p)
+			{
+				std::vector<SampleFrame> buffer(Period);
+				std::vector<float> cutoff(Period);
+				std::vector<float> resonance(Period);
+				for (fpp_t f = 0; f < Period; ++f)
+				{
+					const float frame = static_cast<float>(p * Period + f);
+					const float saw = std::fmod(frame / 100.f, 1.f) - 0.5f;
+					buffer[f] = SampleFrame(saw, -saw);
+					cutoff[f] = cutoffAt(frame);
+					resonance[f] = resonanceAt(frame);
+				}
+				auto expected = buffer;
+
+				InstrumentSoundShaping::applyFilter(*pooled, buffer.data(), Period, cutoff.data(), resonance.data());
+
+				for (fpp_t f = 0; f < Period; ++f)
+				{
+					reference.calcFilterCoeffs(cutoff[f], resonance[f]);
+					expected[f][0] = reference.update(expected[f][0], 0);
+					expected[f][1] = reference.update(expected[f][1], 1);
+					maxDiff = std::max({maxDiff, std::abs(buffer[f][0] - expected[f][0]),
+						std::abs(buffer[f][1] - expected[f][1])});
+				}
+			}
+			QVERIFY2(maxDiff < 2e-3f, qPrintable(QString::number(maxDiff)));
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(InstrumentSoundShapingTest)
+#include "InstrumentSoundShapingTest.moc"
@@ -0,0 +1,181 @@
+/*
+ * LatencyCompensatorTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <vector>
+
+#include "LatencyCompensator.h"
+
+using lmms::LatencyCompensator;
+using lmms::SampleFrame;
+
+namespace
+{
+
+//! What the mixer does on the main thread
+void grow(LatencyCompensator& compensator)
+{
+	auto buffer = compensator.allocate();
+	compensator.adopt(buffer);
+}
+
+//! Sets a delay that needs a larger buffer
+void setDelay(LatencyCompensator& compensator, lmms::f_cnt_t frames)
+{
+	if (!compensator.setDelay(frames))
+	{
+		grow(compensator);
+		QVERIFY(compensator.setDelay(frames));
+	}
+	QCOMPARE(compensator.delay(), frames);
+}
+
+} // namespace
+
+class LatencyCompensatorTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void DelayTest()
+	{
+		LatencyCompensator compensator;
+		setDelay(compensator, 5);
+
+		std::vector<SampleFrame> period(4);
+		for (std::size_t f = 0; f < period.size(); ++f) { period[f] = SampleFrame(f + 1.f, -(f + 1.f)); }
+
+		QVERIFY(compensator.process(period.data(), period.size(), true));
+		for (const auto& frame : period) { QCOMPARE(frame.left(), 0.f); }
+
+		// the input comes out 5 frames later, across the period boundary
+		period.assign(4, SampleFrame(0.5f));
+		QVERIFY(compensator.process(period.data(), period.size(), true));
+		QCOMPARE(period[0].left(), 0.f);
+		QCOMPARE(period[1].left(), 1.f);
+		QCOMPARE(period[1].right(), -1.f);
+		QCOMPARE(period[3].left(), 3.f);
+	}
+
+	void TailTest()
+	{
+		LatencyCompensator compensator;
+		setDelay(compensator, 6);
+
+		std::vector<SampleFrame> period(4, SampleFrame(1.f));
+		QVERIFY(compensator.process(period.data(), period.size(), true));
+
+		// the delayed input keeps coming while the path is silent, garbage in
+		// the buffer of a silent path is ignored
+		period.assign(4, SampleFrame(9.f));
+		QVERIFY(compensator.process(period.data(), period.size(), false));
+		QCOMPARE(period[1].left(), 0.f);
+		QCOMPARE(period[2].left(), 1.f);
+		QCOMPARE(period[3].left(), 1.f);
+
+		period.assign(4, SampleFrame(9.f));
+		QVERIFY(compensator.process(period.data(), period.size(), false));
+		QCOMPARE(period[1].left(), 1.f);
+		QCOMPARE(period[2].left(), 0.f);
+
+		// all out, the buffer is left alone
+		period.assign(4, SampleFrame(9.f));
+		QVERIFY(!compensator.process(period.data(), period.size(), false));
+		QCOMPARE(period[0].left(), 9.f);
+	}
+
+	void NoDelayTest()
+	{
+		LatencyCompensator compensator;
+		std::vector<SampleFrame> period(4, SampleFrame(1.f));
+		QVERIFY(compensator.process(period.data(), period.size(), true));
+		QCOMPARE(period[0].left(), 1.f);
+		QVERIFY(!compensator.process(period.data(), period.size(), false));
+
+		// paths without latency don't get a buffer
+		QVERIFY(compensator.setDelay(0));
+		QVERIFY(compensator.allocate().empty());
+	}
+
+	void GrowTest()
+	{
+		LatencyCompensator compensator;
+		QVERIFY(!compensator.setDelay(4));
+		QCOMPARE(compensator.delay(), lmms::f_cnt_t{0});
+		grow(compensator);
+		QVERIFY(compensator.setDelay(4));
+
+		auto period = std::vector<SampleFrame>{SampleFrame(1.f), SampleFrame(2.f), SampleFrame(3.f), SampleFrame(4.f)};
+		QVERIFY(compensator.process(period.data(), period.size(), true));
+
+		// until the buffer grew, the delay is as long as fits
+		QVERIFY(!compensator.setDelay(100));
+		QVERIFY(compensator.delay() < 100);
+		QVERIFY(compensator.delay() >= 4);
+
+		// the audio that was delayed survives the larger buffer
+		grow(compensator);
+		QVERIFY(compensator.setDelay(100));
+		period.assign(100, SampleFrame(9.f));
+		QVERIFY(compensator.process(period.data(), period.size(), false));
+		QCOMPARE(period[95].left(), 0.f);
+		QCOMPARE(period[96].left(), 1.f);
+		QCOMPARE(period[99].left(), 4.f);
+		QVERIFY(!compensator.process(period.data(), period.size(), false));
+	}
+
+	void DelayChangeTest()
+	{
+		const auto ramp = std::vector<SampleFrame>{SampleFrame(1.f), SampleFrame(2.f), SampleFrame(3.f), SampleFrame(4.f)};
+
+		// a longer delay puts silence before the audio that is already delayed
+		LatencyCompensator longer;
+		setDelay(longer, 4);
+		auto period = ramp;
+		QVERIFY(longer.process(period.data(), period.size(), true));
+		setDelay(longer, 6);
+		QVERIFY(longer.process(period.data(), period.size(), false));
+		QCOMPARE(period[0].left(), 0.f);
+		QCOMPARE(period[1].left(), 0.f);
+		QCOMPARE(period[2].left(), 1.f);
+		QCOMPARE(period[3].left(), 2.f);
+		QVERIFY(longer.process(period.data(), period.size(), false));
+		QCOMPARE(period[0].left(), 3.f);
+		QCOMPARE(period[1].left(), 4.f);
+		QVERIFY(!longer.process(period.data(), period.size(), false));
+
+		// a shorter one skips what it doesn't need to wait for anymore
+		LatencyCompensator shorter;
+		setDelay(shorter, 4);
+		period = ramp;
+		QVERIFY(shorter.process(period.data(), period.size(), true));
+		setDelay(shorter, 2);
+		QVERIFY(shorter.process(period.data(), period.size(), false));
+		QCOMPARE(period[0].left(), 3.f);
+		QCOMPARE(period[1].left(), 4.f);
+		QCOMPARE(period[2].left(), 0.f);
+		QVERIFY(!shorter.process(period.data(), period.size(), false));
+	}
+};
+
+QTEST_GUILESS_MAIN(LatencyCompensatorTest)
+#include "LatencyCompensatorTest.moc"
@@ -0,0 +1,163 @@
+/*
+ * MidiPortTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Engine.h"
+#include "MidiClient.h"
+#include "MidiEventProcessor.h"
+#include "MidiPort.h"
+
+namespace
+{
+
+using namespace lmms;
+
+//! Synthetic MIDI source: feeds raw bytes through the same parser the
+//! hardware backends use, without needing a device
+class SyntheticMidiClient : public MidiClientRaw
+{
+public:
+	void feed(const std::vector<unsigned char>& bytes)
+	{
+		for (unsigned char byte : bytes) { parseData(byte); }
+	}
+
+protected:
+	void sendByte(const unsigned char) override {}
+};
+
+class RecordingProcessor : public MidiEventProcessor
+{
+public:
+	struct Received
+	{
+		MidiEvent event;
+		f_cnt_t offset;
+	};
+
+	void processInEvent(const MidiEvent& event, const TimePos&, f_cnt_t offset) override
+	{
+		received.push_back({event, offset});
+	}
+
+	void processOutEvent(const MidiEvent&, const TimePos&, f_cnt_t) override {}
+
+	std::vector<Received> received;
+};
+
+} // namespace
+
+class MidiPortTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase()
+	{
+		Engine::init(true);
+	}
+
+	void cleanupTestCase()
+	{
+		Engine::destroy();
+	}
+
+	void FrameOffsetTest()
+	{
+		const auto now = MidiPort::Clock::now();
+		const auto period = std::chrono::microseconds(10000); // 441 frames at 44.1 kHz
+
+		// received right before the period starts -> end of period
+		QCOMPARE(MidiPort::frameOffset(now, now, 441, 44100), f_cnt_t{440});
+		// received one full period ago -> start of period
+		QCOMPARE(MidiPort::frameOffset(now - period, now, 441, 44100), f_cnt_t{0});
+		// half a period ago -> middle of period
+		QCOMPARE(MidiPort::frameOffset(now - period / 2, now, 441, 44100), f_cnt_t{221});
+		// events older than a period (e.g. after an xrun) are not dropped
+		QCOMPARE(MidiPort::frameOffset(now - period * 3, now, 441, 44100), f_cnt_t{0});
+	}
+
+	void QueueTest()
+	{
+		SyntheticMidiClient client;
+		RecordingProcessor processor;
+		MidiPort port("test", &client, &processor, nullptr, MidiPort::Mode::Input);
+
+		// note on, note off (running status) and a controller on channel 2
+		client.feed({0x90, 60, 100, 60, 0, 0xB1, 7, 64});
+		QVERIFY(processor.received.empty()); // nothing reaches the processor on the MIDI thread
+
+		port.processQueuedInEvents(256, 44100);
+		QCOMPARE(processor.received.size(), std::size_t{3});
+		QCOMPARE(processor.received[0].event.type(), MidiNoteOn);
+		QCOMPARE(processor.received[0].event.key(), int16_t{60});
+		QCOMPARE(processor.received[1].event.velocity(), uint8_t{0});
+		QCOMPARE(processor.received[2].event.type(), MidiControlChange);
+		QCOMPARE(processor.received[2].event.channel(), int8_t{1});
+		for (const auto& r : processor.received) { QVERIFY(r.offset < 256); }
+		QVERIFY(processor.received[0].offset <= processor.received[2].offset);
+
+		processor.received.clear();
+		port.processQueuedInEvents(256, 44100);
+		QVERIFY(processor.received.empty());
+	}
+
+	void ConcurrentQueueTest()
+	{
+		SyntheticMidiClient client;
+		RecordingProcessor processor;
+		MidiPort port("test", &client, &processor, nullptr, MidiPort::Mode::Input);
+
+		constexpr int NoteCount = 10000;
+		std::atomic<int> consumed = 0;
+		std::thread midiThread([&] {
+			for (int i = 0; i < NoteCount; ++i)
+			{
+				// don't overrun the queue, a real device is much slower than this
+				while (i - consumed.load() >= 512) { std::this_thread::yield(); }
+				client.feed({0x90, static_cast<unsigned char>(i % 128), 100});
+			}
+		});
+
+		// drain like the audio thread would, until the source is done
+		while (consumed.load() < NoteCount)
+		{
+			port.processQueuedInEvents(256, 44100);
+			consumed = static_cast<int>(processor.received.size());
+			std::this_thread::yield();
+		}
+		midiThread.join();
+
+		QCOMPARE(processor.received.size(), std::size_t{NoteCount});
+		for (int i = 0; i < NoteCount; ++i)
+		{
+			QCOMPARE(processor.received[i].event.key(), static_cast<int16_t>(i % 128));
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(MidiPortTest)
+#include "MidiPortTest.moc"
@@ -0,0 +1,84 @@
+/*
+ * MixHelpersTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "MixHelpers.h"
+#include "SampleFrame.h"
+
+using namespace lmms;
+
+class MixHelpersTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void InterleaveTest()
+	{
+		std::vector<SampleFrame> frames(64);
+		for (std::size_t f = 0; f < frames.size(); ++f) { frames[f] = SampleFrame(float(f), -float(f)); }
+
+		std::array<std::array<float, 64>, 2> channels{};
+		float* channelPtrs[] = {channels[0].data(), channels[1].data()};
+		const auto planar = PlanarBufferView<float, 2>{channelPtrs, frames.size()};
+
+		MixHelpers::deinterleave(planar, frames.data());
+		QCOMPARE(channels[0][10], 10.f);
+		QCOMPARE(channels[1][10], -10.f);
+
+		std::vector<SampleFrame> result(frames.size());
+		MixHelpers::interleave(result.data(), planar);
+		for (std::size_t f = 0; f < frames.size(); ++f)
+		{
+			QCOMPARE(result[f].left(), frames[f].left());
+			QCOMPARE(result[f].right(), frames[f].right());
+		}
+	}
+
+	void PlanarSanitizeTest()
+	{
+		MixHelpers::setNaNHandler(true);
+
+		std::array<std::array<float, 4>, 2> channels{{{0.5f, 2000.f, -2000.f, 0.f}, {0.f, 0.f, 0.f, 0.f}}};
+		float* channelPtrs[] = {channels[0].data(), channels[1].data()};
+		const auto planar = PlanarBufferView<float, 2>{channelPtrs, 4};
+
+		QVERIFY(!MixHelpers::sanitize(planar));
+		QCOMPARE(channels[0][0], 0.5f);
+		QCOMPARE(channels[0][1], 1000.f);
+		QCOMPARE(channels[0][2], -1000.f);
+
+		// a NaN in one channel silences all of them
+		channels[1][3] = std::numeric_limits<float>::quiet_NaN();
+		QVERIFY(MixHelpers::sanitize(planar));
+		QCOMPARE(channels[0][0], 0.f);
+		QCOMPARE(channels[1][3], 0.f);
+
+		MixHelpers::setNaNHandler(false);
+	}
+};
+
+QTEST_GUILESS_MAIN(MixHelpersTest)
+#include "MixHelpersTest.moc"
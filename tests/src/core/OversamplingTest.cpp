@@ -0,0 +1,180 @@
+/*
+ * OversamplingTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <hiir/PolyphaseIir2Designer.h>
+#include <hiir/Upsampler2xFpu.h>
+
+#include "OversamplingHelpers.h"
+
+using lmms::SampleFrame;
+using lmms::fpp_t;
+
+class OversamplingTest : public QObject
+{
+	Q_OBJECT
+private:
+	using Oversampler = lmms::StereoOversampler<4>;
+
+	static void addStages()
+	{
+		QTest::addColumn<int>("stages");
+		for (int stages = 0; stages <= 4; ++stages)
+		{
+			QTest::addRow("%dx", 1 << stages) << stages;
+		}
+	}
+
+private slots:
+	void DcTest_data() { addStages(); }
+	void DcTest()
+	{
+		QFETCH(int, stages);
+		Oversampler oversampler;
+		oversampler.setup(stages, 44100.f);
+		QCOMPARE(oversampler.factor(), 1 << stages);
+
+		// both channels pass unchanged once the filters settled
+		std::vector<SampleFrame> buffer(1024, SampleFrame(0.5f, -0.25f));
+		int calls = 0;
+		oversampler.process(buffer.data(), buffer.size(), [&](SampleFrame*, fpp_t frame) {
+			QCOMPARE(frame, static_cast<fpp_t>(calls++));
+		});
+		QCOMPARE(calls, 1024);
+		QVERIFY(std::abs(buffer.back().left() - 0.5f) < 1e-4f);
+		QVERIFY(std::abs(buffer.back().right() + 0.25f) < 1e-4f);
+	}
+
+	void LatencyTest_data() { addStages(); }
+	void LatencyTest()
+	{
+		QFETCH(int, stages);
+		Oversampler oversampler;
+		oversampler.setup(stages, 44100.f);
+
+		// a slow ramp comes out as late as the reported latency
+		constexpr float slope = 1e-4f;
+		std::vector<SampleFrame> buffer(2048);
+		for (std::size_t f = 0; f < buffer.size(); ++f) { buffer[f] = SampleFrame(slope * f, -slope * f); }
+		oversampler.process(buffer.data(), buffer.size(), [](SampleFrame*, fpp_t) {});
+
+		const float delay = (buffer.size() - 1) - buffer.back().left() / slope;
+		QVERIFY(std::abs(delay - oversampler.latency()) < 0.05f);
+		QVERIFY(std::abs(buffer.back().left() + buffer.back().right()) < 1e-6f);
+	}
+
+	void SineTest_data() { addStages(); }
+	void SineTest()
+	{
+		QFETCH(int, stages);
+		Oversampler oversampler;
+		oversampler.setup(stages, 44100.f);
+
+		// the same filters, one stage after the other over the whole signal,
+		// so every filter sees its input in time order
+		auto signal = std::vector<float>(256);
+		for (std::size_t f = 0; f < signal.size(); ++f) { signal[f] = std::sin(0.3f * f); }
+		auto expected = signal;
+		float bw = 0.5f - HIIR_DEFAULT_PASSBAND / 44100.f;
+		const auto upsampleStage = [&]<int Coefs>(hiir::Upsampler2xFpu<Coefs> filter) {
+			auto coefs = std::array<double, Coefs>{};
+			hiir::PolyphaseIir2Designer::compute_coefs_spec_order_tbw(coefs.data(), Coefs, bw);
+			bw = (bw + 0.5f) * 0.5f;
+			filter.set_coefs(coefs.data());
+			filter.clear_buffers();
+
+			auto upsampled = std::vector<float>(expected.size() * 2);
+			for (std::size_t f = 0; f < expected.size(); ++f)
+			{
+				filter.process_sample(upsampled[2 * f], upsampled[2 * f + 1], expected[f]);
+			}
+			expected = std::move(upsampled);
+		};
+		for (int stage = 0; stage < stages; ++stage)
+		{
+			if (stage == 0) { upsampleStage(hiir::Upsampler2xFpu<8>{}); }
+			else if (stage == 1) { upsampleStage(hiir::Upsampler2xFpu<4>{}); }
+			else { upsampleStage(hiir::Upsampler2xFpu<2>{}); }
+		}
+
+		const int factor = oversampler.factor();
+		auto frames = std::vector<SampleFrame>(factor);
+		for (std::size_t f = 0; f < signal.size(); ++f)
+		{
+			oversampler.upsample(SampleFrame(signal[f], -signal[f]), frames.data());
+			for (int i = 0; i < factor; ++i)
+			{
+				QVERIFY(std::abs(frames[i].left() - expected[f * factor + i]) < 1e-5f);
+				QVERIFY(std::abs(frames[i].right() + expected[f * factor + i]) < 1e-5f);
+			}
+		}
+	}
+
+	void SineLatencyTest_data() { addStages(); }
+	void SineLatencyTest()
+	{
+		QFETCH(int, stages);
+		Oversampler oversampler;
+		oversampler.setup(stages, 44100.f);
+
+		// a low sine comes out unchanged but as late as the reported latency
+		constexpr float omega = 2 * 3.14159265f * 200 / 44100;
+		std::vector<SampleFrame> buffer(4096);
+		for (std::size_t f = 0; f < buffer.size(); ++f) { buffer[f] = SampleFrame(std::sin(omega * f)); }
+		oversampler.process(buffer.data(), buffer.size(), [](SampleFrame*, fpp_t) {});
+
+		for (std::size_t f = buffer.size() - 512; f < buffer.size(); ++f)
+		{
+			const float expected = std::sin(omega * (f - oversampler.latency()));
+			QVERIFY(std::abs(buffer[f].left() - expected) < 5e-3f);
+		}
+	}
+
+	void FactorBenchmark_data() { addStages(); }
+	void FactorBenchmark()
+	{
+		QFETCH(int, stages);
+		Oversampler oversampler;
+		oversampler.setup(stages, 44100.f);
+
+		// the cost of the filters around a cheap distortion
+		std::vector<SampleFrame> period(256, SampleFrame(0.5f, -0.5f));
+		const int factor = oversampler.factor();
+		QBENCHMARK
+		{
+			oversampler.process(period.data(), period.size(), [factor](SampleFrame* frames, fpp_t) {
+				for (int i = 0; i < factor; ++i)
+				{
+					frames[i] = SampleFrame(std::tanh(frames[i].left()), std::tanh(frames[i].right()));
+				}
+			});
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(OversamplingTest)
+#include "OversamplingTest.moc"
@@ -0,0 +1,179 @@
+/*
+ * SampleIndexTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "SampleIndex.h"
+
+namespace
+{
+
+void touch(const QString& path)
+{
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+}
+
+QStringList names(const std::vector<lmms::SampleIndex::Entry>& entries)
+{
+	QStringList result;
+	for (const auto& entry : entries) { result << entry.name; }
+	return result;
+}
+
+} // namespace
+
+class SampleIndexTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase()
+	{
+		QVERIFY(m_dir.isValid());
+		QVERIFY(QDir(m_dir.path()).mkpath("samples/drums/kicks"));
+		QVERIFY(QDir(m_dir.path()).mkpath("samples/bass"));
+		QVERIFY(QDir(m_dir.path()).mkpath("samples/.hidden"));
+		touch(root() + "/drums/kick01.wav");
+		touch(root() + "/drums/kicks/Kick02.wav");
+		touch(root() + "/drums/snare01.wav");
+		touch(root() + "/bass/bass_loop.ogg");
+		touch(root() + "/bass/readme.txt");
+		touch(root() + "/.hidden/kick03.wav");
+	}
+
+	void QueryTest()
+	{
+		using namespace lmms;
+
+		SampleIndex index({root()}, QString());
+		index.waitUntilReady();
+		QVERIFY(index.covers(root() + "/drums"));
+		QVERIFY(!index.covers(m_dir.path()));
+
+		SampleIndex::Query query;
+		query.tokens = {"KICK"};
+		QCOMPARE(names(index.find(query)), (QStringList{"kick01.wav", "Kick02.wav"}));
+
+		query.hidden = true;
+		QCOMPARE(names(index.find(query)), (QStringList{"kick01.wav", "Kick02.wav", "kick03.wav"}));
+
+		query = {};
+		query.prefix = "s";
+		QCOMPARE(names(index.find(query)), QStringList{"snare01.wav"});
+
+		query = {};
+		query.category = "drums";
+		query.directories = true;
+		QCOMPARE(names(index.find(query)), (QStringList{"kick01.wav", "Kick02.wav", "kicks", "snare01.wav"}));
+
+		query = {};
+		query.extensions = {"*.wav", "*.ogg"};
+		query.directory = root() + "/bass";
+		QCOMPARE(names(index.find(query)), QStringList{"bass_loop.ogg"});
+
+		query = {};
+		query.limit = 2;
+		QCOMPARE(index.find(query).size(), std::size_t{2});
+
+		const auto categories = index.categories();
+		QCOMPARE(categories.size(), std::size_t{2});
+		QCOMPARE(categories[0].name, QString("bass"));
+		QCOMPARE(categories[0].path, root() + "/bass");
+		QCOMPARE(categories[0].fileCount, 1);
+		QCOMPARE(categories[1].name, QString("drums"));
+		QCOMPARE(categories[1].fileCount, 3);
+	}
+
+	void RescanTest()
+	{
+		using namespace lmms;
+
+		SampleIndex index({root()}, QString());
+		index.waitUntilReady();
+
+		SampleIndex::Query query;
+		query.tokens = {"clap"};
+		QVERIFY(index.find(query).empty());
+
+		touch(root() + "/drums/clap01.wav");
+		index.rescan(root() + "/drums");
+		QTRY_COMPARE(names(index.find(query)), QStringList{"clap01.wav"});
+
+		QVERIFY(QFile::remove(root() + "/drums/clap01.wav"));
+		index.rescan(root() + "/drums");
+		QTRY_VERIFY(index.find(query).empty());
+
+		// rescanned files are merged into the index in order, so prefixes still find them
+		touch(root() + "/drums/a_tom.wav");
+		touch(root() + "/drums/Z_tom.wav");
+		index.rescan(root() + "/drums");
+		query = {};
+		query.prefix = "a_";
+		QTRY_COMPARE(names(index.find(query)), QStringList{"a_tom.wav"});
+		query.prefix = "z_";
+		QCOMPARE(names(index.find(query)), QStringList{"Z_tom.wav"});
+		query.prefix = "kick";
+		QCOMPARE(names(index.find(query)), (QStringList{"kick01.wav", "Kick02.wav"}));
+
+		QVERIFY(QFile::remove(root() + "/drums/a_tom.wav"));
+		QVERIFY(QFile::remove(root() + "/drums/Z_tom.wav"));
+		index.rescan(root() + "/drums");
+		query.prefix = "a_";
+		QTRY_VERIFY(index.find(query).empty());
+	}
+
+	void CacheTest()
+	{
+		using namespace lmms;
+
+		const auto cacheFile = m_dir.path() + "/index";
+		{
+			SampleIndex index({root()}, cacheFile);
+			index.waitUntilReady();
+		}
+		QVERIFY(QFile::exists(cacheFile));
+
+		// a cached index can be queried right away
+		SampleIndex index({root()}, cacheFile);
+		QVERIFY(index.isReady());
+		SampleIndex::Query query;
+		query.tokens = {"snare"};
+		QCOMPARE(names(index.find(query)), QStringList{"snare01.wav"});
+
+		// but not if it was built for other directories
+		SampleIndex other({root() + "/drums"}, cacheFile);
+		other.waitUntilReady();
+		query.tokens = {"bass"};
+		QVERIFY(other.find(query).empty());
+	}
+
+private:
+	QString root() const { return m_dir.path() + "/samples"; }
+
+	QTemporaryDir m_dir;
+};
+
+QTEST_GUILESS_MAIN(SampleIndexTest)
+#include "SampleIndexTest.moc"
@@ -0,0 +1,76 @@
+/*
+ * SharedFileCacheTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <QTemporaryDir>
+#include <memory>
+
+#include "SharedFileCache.h"
+
+using lmms::SharedFileCache;
+
+class SharedFileCacheTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void SharingTest()
+	{
+		QTemporaryDir dir;
+		const QString path = dir.filePath("font.sf2");
+		QFile file(path);
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write("data");
+		file.close();
+
+		SharedFileCache<QString> cache;
+		int loads = 0;
+		const auto load = [&loads](const QString& p) {
+			++loads;
+			return std::make_shared<QString>(p);
+		};
+
+		auto first = cache.get(path, load);
+		auto second = cache.get(dir.path() + "/./font.sf2", load);
+		QCOMPARE(loads, 1);
+		QCOMPARE(first.get(), second.get());
+		QCOMPARE(cache.size(), std::size_t{1});
+
+		// gone with its last user
+		first.reset();
+		second.reset();
+		QCOMPARE(cache.size(), std::size_t{0});
+		cache.get(path, load);
+		QCOMPARE(loads, 2);
+	}
+
+	void FailureTest()
+	{
+		SharedFileCache<QString> cache;
+		const auto fail = [](const QString&) { return std::shared_ptr<QString>{}; };
+		QVERIFY(!cache.get("missing.sf2", fail));
+		QCOMPARE(cache.size(), std::size_t{0});
+	}
+};
+
+QTEST_GUILESS_MAIN(SharedFileCacheTest)
+#include "SharedFileCacheTest.moc"
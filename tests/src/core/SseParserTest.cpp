@@ -0,0 +1,149 @@
+/*
+ * SseParserTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <vector>
+
+#include "SseParser.h"
+
+namespace
+{
+
+//! Feeds \p stream in pieces of \p chunkSize bytes and collects all events
+std::vector<QByteArray> parse(const QByteArray& stream, int chunkSize)
+{
+	lmms::SseParser parser;
+	std::vector<QByteArray> events;
+	QByteArray data;
+	for (int pos = 0; pos < stream.size(); pos += chunkSize)
+	{
+		parser.feed(stream.mid(pos, chunkSize));
+		while (parser.next(data)) { events.push_back(data); }
+	}
+	return events;
+}
+
+//! Feeds \p stream split at the sorted offsets in \p splits and collects all events
+std::vector<QByteArray> parse(const QByteArray& stream, const std::vector<int>& splits)
+{
+	lmms::SseParser parser;
+	std::vector<QByteArray> events;
+	QByteArray data;
+	int pos = 0;
+	for (int end : splits)
+	{
+		parser.feed(stream.mid(pos, end - pos));
+		pos = end;
+		while (parser.next(data)) { events.push_back(data); }
+	}
+	parser.feed(stream.mid(pos));
+	while (parser.next(data)) { events.push_back(data); }
+	return events;
+}
+
+//! Looks like an OpenRouter response that streams a tool call's arguments
+QByteArray recordedToolCallStream(int deltas)
+{
+	QByteArray stream = ": OPENROUTER PROCESSING\n\n";
+	stream += R"(data: {"choices":[{"delta":{"tool_calls":[{"index":0,"id":"call_0","function":{"name":"add_notes","arguments":""}}]}}]})";
+	stream += "\n\n";
+	for (int i = 0; i < deltas; ++i)
+	{
+		stream += R"(data: {"choices":[{"delta":{"tool_calls":[{"index":0,"function":{"arguments":"{\"key\":60,"}}]}}]})";
+		stream += "\n\n";
+	}
+	stream += "data: [DONE]\n\n";
+	return stream;
+}
+
+} // namespace
+
+class SseParserTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void EventsTest()
+	{
+		const QByteArray stream =
+			": comment\n"
+			"data: first\n\n"
+			"event: message\r\n"
+			"data:second\r\n"
+			"data: line\r\n\r\n"
+			"id: 3\r"
+			"data: third\r\r"
+			"data: unterminated";
+
+		// the result must not depend on how the stream is split
+		for (int chunkSize : {1, 2, 3, 7, 1000})
+		{
+			const auto events = parse(stream, chunkSize);
+			QCOMPARE(events.size(), std::size_t{3});
+			QCOMPARE(events[0], QByteArray("first"));
+			QCOMPARE(events[1], QByteArray("second\nline"));
+			QCOMPARE(events[2], QByteArray("third"));
+		}
+	}
+
+	void SplitReplayTest()
+	{
+		// a recorded response, with a text delta that isn't ASCII and CRLF line ends
+		// that splits can fall into the middle of
+		QByteArray stream = recordedToolCallStream(3);
+		stream.insert(stream.indexOf("data: [DONE]"),
+			R"(data: {"choices":[{"delta":{"content":"Stück für \u00e9 – ♪"}}]})" "\r\n\r\n"
+			": keep-alive\r\n\r\n");
+		const auto expected = parse(stream, stream.size());
+		QCOMPARE(expected.size(), std::size_t{6});
+
+		// every split into two pieces
+		for (int split = 0; split <= stream.size(); ++split)
+		{
+			QCOMPARE(parse(stream, std::vector<int>{split}), expected);
+		}
+
+		// and many into random pieces, the seed keeps failures reproducible
+		auto random = QRandomGenerator{32};
+		for (int run = 0; run < 500; ++run)
+		{
+			auto splits = std::vector<int>(random.bounded(1, 40));
+			for (int& split : splits) { split = random.bounded(stream.size() + 1); }
+			std::sort(splits.begin(), splits.end());
+			QCOMPARE(parse(stream, splits), expected);
+		}
+	}
+
+	void ReplayBenchmark()
+	{
+		const auto stream = recordedToolCallStream(20000);
+		std::size_t events = 0;
+		// tcp packets are usually much smaller than a response
+		QBENCHMARK { events = parse(stream, 1400).size(); }
+		QCOMPARE(events, std::size_t{20002});
+	}
+};
+
+QTEST_GUILESS_MAIN(SseParserTest)
+#include "SseParserTest.moc"
@@ -0,0 +1,272 @@
+/*
+ * ExprBlockTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <string>
+
+#include <exprtk.hpp>
+
+#include "ExprBlock.h"
+
+using lmms::ExprBlock;
+
+namespace
+{
+
+constexpr std::size_t Blocks = 4;
+constexpr std::size_t Frames = Blocks * ExprBlock::BlockSize;
+
+//! An expression compiled by both evaluators, with the symbols Xpressive gives them
+class Evaluators
+{
+public:
+	explicit Evaluators(const std::string& text)
+	{
+		m_symbols.add_pi();
+		m_symbols.add_constant("e", std::numbers::e_v<float>);
+		m_symbols.add_variable("t", m_t);
+		m_symbols.add_variable("f", m_f);
+		m_expression.register_symbol_table(m_symbols);
+
+		// the same settings as ExprFront::compile()
+		exprtk::parser<float>::settings_store settings;
+		settings.disable_all_logic_ops();
+		settings.disable_all_assignment_ops();
+		settings.disable_all_control_structures();
+		exprtk::parser<float> parser(settings);
+		exprtkValid = parser.compile(text, m_expression);
+
+		m_block.addConstant("pi", std::numbers::pi_v<float>);
+		m_block.addConstant("e", std::numbers::e_v<float>);
+		m_block.addInput("t", m_blockT.data());
+		m_block.addVariable("f", &m_f);
+		blockValid = m_block.compile(text);
+	}
+
+	//! Time of frame @p frame, so each block sees a different part of a function
+	static float timeAt(std::size_t frame) { return static_cast<float>(frame) / Frames; }
+
+	void evaluateBlocks(float* out)
+	{
+		for (std::size_t offset = 0; offset < Frames; offset += ExprBlock::BlockSize)
+		{
+			for (std::size_t frame = 0; frame < ExprBlock::BlockSize; ++frame)
+			{
+				m_blockT[frame] = timeAt(offset + frame);
+			}
+			m_block.evaluate(out + offset, ExprBlock::BlockSize);
+		}
+	}
+
+	void evaluateExprtk(float* out)
+	{
+		for (std::size_t frame = 0; frame < Frames; ++frame)
+		{
+			m_t = timeAt(frame);
+			out[frame] = m_expression.value();
+		}
+	}
+
+	bool exprtkValid = false;
+	bool blockValid = false;
+
+private:
+	float m_t = 0;
+	float m_f = 4.4f;
+	std::array<float, ExprBlock::BlockSize> m_blockT = {};
+
+	exprtk::symbol_table<float> m_symbols;
+	exprtk::expression<float> m_expression;
+	ExprBlock m_block;
+};
+
+//! Which evaluators accept an expression
+enum class Support
+{
+	Both,
+	//! Valid, but left to exprtk by ExprBlock
+	ExprtkOnly,
+	Neither
+};
+
+struct Case
+{
+	const char* expression;
+	Support support;
+};
+
+//! Like a typical Xpressive patch
+constexpr auto BenchmarkExpression = "sin(2 * pi * f * t) * exp(-3 * t) + 0.25 * sin(4 * pi * f * t)";
+
+constexpr Case Cases[] = {
+	// functions
+	{"abs(t - 0.5)", Support::Both},
+	{"sin(t)", Support::Both},
+	{"cos(2 * pi * f * t)", Support::Both},
+	{"tan(t)", Support::Both},
+	{"cot(t + 0.1)", Support::Both},
+	{"asin(t)", Support::Both},
+	{"acos(t)", Support::Both},
+	{"atan(t)", Support::Both},
+	{"sinh(t)", Support::Both},
+	{"cosh(t)", Support::Both},
+	{"tanh(t * 4 - 2)", Support::Both},
+	{"asinh(t)", Support::Both},
+	{"acosh(t + 1)", Support::Both},
+	{"atanh(t * 0.5)", Support::Both},
+	{"sinc(t * 10 - 5)", Support::Both},
+	{"exp(t)", Support::Both},
+	{"log(t + 1)", Support::Both},
+	{"log2(t + 1)", Support::Both},
+	{"log10(t + 1)", Support::Both},
+	{"sqrt(t)", Support::Both},
+	{"floor(t * 10)", Support::Both},
+	{"ceil(t * 10)", Support::Both},
+	{"round(t * 10 - 5)", Support::Both},
+	{"trunc(t * 10 - 5)", Support::Both},
+	{"frac(t * 10 - 5)", Support::Both},
+	{"sgn(t - 0.5)", Support::Both},
+	{"atan2(t, 0.5)", Support::Both},
+	{"hypot(t, 2)", Support::Both},
+	{"logn(t + 1, 3)", Support::Both},
+	{"pow(t, 3)", Support::Both},
+	{"mod(t * 10, 3)", Support::Both},
+	{"clamp(0.2, t, 0.7)", Support::Both},
+	{"min(t, 0.3, f / 10)", Support::Both},
+	{"max(t, 0.3)", Support::Both},
+	{"sum(t, 1, 2)", Support::Both},
+	{"avg(t, 1, 2, 3)", Support::Both},
+	{"sin(cos(t) * exp(-t))", Support::Both},
+
+	// operators and precedence
+	{"1 + 2 * t", Support::Both},
+	{"(1 + 2) * t", Support::Both},
+	{"t - 1 - 2", Support::Both},
+	{"t / 2 / 4", Support::Both},
+	{"t % 0.3", Support::Both},
+	{"2 ^ t", Support::Both},
+	{"3 * t ^ 2 + 1", Support::Both},
+	{"(-t) ^ 2", Support::Both},
+	{"-(t - 1)", Support::Both},
+	{"+t", Support::Both},
+	{"- -t", Support::Both},
+	{"t < 0.5", Support::Both},
+	{"t <= 0.5", Support::Both},
+	{"t > 0.5", Support::Both},
+	{"t >= 0.5", Support::Both},
+	{"t == 0", Support::Both},
+	{"t != 0", Support::Both},
+	{"t <> 0", Support::Both},
+	{"t = 0", Support::Both},
+	{"1 + (t < 0.5) * 2", Support::Both},
+	{"1 + 2 < t * 4", Support::Both},
+	{"2 * 3 + sin(pi / 2) * t", Support::Both},
+	{"1e-3 * f + .5 * t", Support::Both},
+	{"-t ^ 2", Support::ExprtkOnly},
+	{"t ^ 2 ^ 3", Support::ExprtkOnly},
+
+	// variables
+	{"f", Support::Both},
+	{"t * f", Support::Both},
+	{"T * F", Support::Both},
+	{"e * t + pi", Support::Both},
+	{BenchmarkExpression, Support::Both},
+
+	// errors
+	{"sin(", Support::Neither},
+	{"t +", Support::Neither},
+	{"(t", Support::Neither},
+	{"t)", Support::Neither},
+	{"sin()", Support::Neither},
+	{"sin(t, t)", Support::Neither},
+	{"undefined(t)", Support::Neither},
+	{"undefined * t", Support::Neither},
+	{"t $ 2", Support::Neither},
+};
+
+//! Relative to the magnitude of the result, exprtk computes some functions differently
+bool closeEnough(float actual, float expected)
+{
+	if (std::isnan(actual) || std::isnan(expected)) { return std::isnan(actual) && std::isnan(expected); }
+	if (std::isinf(actual) || std::isinf(expected)) { return actual == expected; }
+	return std::abs(actual - expected) <= 1e-5f * std::max(1.f, std::abs(expected));
+}
+
+} // namespace
+
+
+class ExprBlockTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void ExprtkComparisonTest()
+	{
+		for (const auto& test : Cases)
+		{
+			auto evaluators = Evaluators{test.expression};
+			QVERIFY2(evaluators.exprtkValid == (test.support != Support::Neither), test.expression);
+			QVERIFY2(evaluators.blockValid == (test.support == Support::Both), test.expression);
+			if (!evaluators.blockValid) { continue; }
+
+			auto actual = std::array<float, Frames>{};
+			auto expected = std::array<float, Frames>{};
+			evaluators.evaluateBlocks(actual.data());
+			evaluators.evaluateExprtk(expected.data());
+			for (std::size_t frame = 0; frame < Frames; ++frame)
+			{
+				QVERIFY2(closeEnough(actual[frame], expected[frame]), qPrintable(QString{"%1 at frame %2: %3, exprtk %4"}
+					.arg(test.expression).arg(frame).arg(actual[frame]).arg(expected[frame])));
+			}
+		}
+	}
+
+	void BlockBenchmark()
+	{
+		auto evaluators = Evaluators{BenchmarkExpression};
+		QVERIFY(evaluators.blockValid);
+
+		auto out = std::array<float, Frames>{};
+		QBENCHMARK
+		{
+			evaluators.evaluateBlocks(out.data());
+		}
+	}
+
+	void ExprtkBenchmark()
+	{
+		auto evaluators = Evaluators{BenchmarkExpression};
+		QVERIFY(evaluators.exprtkValid);
+
+		auto out = std::array<float, Frames>{};
+		QBENCHMARK
+		{
+			evaluators.evaluateExprtk(out.data());
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(ExprBlockTest)
+#include "ExprBlockTest.moc"
@@ -0,0 +1,113 @@
+/*
+ * VibratingStringTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "VibratingString.h"
+#include "denormals.h"
+
+using lmms::fpp_t;
+using lmms::sample_t;
+using lmms::VibratingString;
+
+class VibratingStringTest : public QObject
+{
+	Q_OBJECT
+private:
+	static constexpr int StringCount = 9;
+	static constexpr int ImpulseLength = 128;
+
+	std::array<float, ImpulseLength> m_impulse;
+
+	//! The same string every time for the same @p id, like one of Vibed's nine strings
+	VibratingString makeString(int id, float pitch = 220.f) const
+	{
+		constexpr auto octave = std::array{0.25f, 0.5f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+		constexpr auto steps = std::array{2, 4, 2, 6, 2, 8, 4, 2, 2};
+		std::srand(id + 1);
+		return VibratingString{pitch * octave[id], 0.1f * id, 0.05f + 0.1f * id, m_impulse.data(), ImpulseLength,
+			44100, steps[id], 0.01f, 0.05f * (id % 3), 0.f, id % 2 == 1};
+	}
+
+private slots:
+	void initTestCase()
+	{
+		// like on the audio threads, the strings decay into denormals otherwise
+		lmms::disable_denormals();
+
+		for (int i = 0; i < ImpulseLength; ++i) { m_impulse[i] = std::sin(i * 0.1f) * (1.f - i / 128.f); }
+	}
+
+	void PeriodTest()
+	{
+		// the delay line positions carry over from one period to the next
+		for (int id = 0; id < StringCount; ++id)
+		{
+			VibratingString whole = makeString(id);
+			VibratingString split = makeString(id);
+
+			auto expected = std::vector<sample_t>(610);
+			whole.process(expected.data(), expected.size());
+
+			auto actual = std::vector<sample_t>(expected.size());
+			fpp_t done = 0;
+			for (const fpp_t frames : {256, 1, 97, 256})
+			{
+				split.process(actual.data() + done, frames);
+				done += frames;
+			}
+			for (std::size_t f = 0; f < expected.size(); ++f) { QCOMPARE(actual[f], expected[f]); }
+		}
+	}
+
+	void ShortStringTest()
+	{
+		// strings only a few samples long, where every read wraps around
+		for (const float pitch : {20000.f, 40000.f, 88200.f})
+		{
+			VibratingString string = makeString(8, pitch / 7.f);
+			auto out = std::vector<sample_t>(256);
+			string.process(out.data(), out.size());
+			for (const sample_t sample : out) { QVERIFY(std::isfinite(sample)); }
+		}
+	}
+
+	void ProcessBenchmark()
+	{
+		std::array<VibratingString, StringCount> strings;
+		for (int id = 0; id < StringCount; ++id) { strings[id] = makeString(id); }
+
+		auto period = std::vector<sample_t>(256);
+		QBENCHMARK
+		{
+			for (auto& string : strings) { string.process(period.data(), period.size()); }
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(VibratingStringTest)
+#include "VibratingStringTest.moc"
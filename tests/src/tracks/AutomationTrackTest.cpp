@@ -24,6 +24,7 @@
 
 #include <QtTest>
 
+#include <cmath>
 
 #include "AutomationClip.h"
 #include "AutomationTrack.h"
@@ -85,6 +86,78 @@ private slots:
 		QCOMPARE(c.valueAt(150), 1.0f);
 	}
 
+	void testClipRender()
+	{
+		using namespace lmms;
+
+		AutomationClip c(nullptr);
+		c.setProgressionType(AutomationClip::ProgressionType::Linear);
+		c.putValue(0, 0.0, false);
+		c.putValue(10, 1.0, false);
+		c.putValue(20, 0.0, false);
+
+		// four frames per tick, across the node at tick 10
+		float values[8];
+		c.curve()->render(9.0, 0.25, values, 8);
+		QCOMPARE(values[0], 0.9f);
+		QCOMPARE(values[2], 0.95f);
+		QCOMPARE(values[4], 1.0f);
+		QCOMPARE(values[6], 0.95f);
+
+		// edits compile a new curve
+		const auto linear = c.curve();
+		c.setProgressionType(AutomationClip::ProgressionType::Discrete);
+		QVERIFY(c.curve() != linear);
+		c.curve()->render(9.0, 0.25, values, 8);
+		QCOMPARE(values[0], 0.0f);
+		QCOMPARE(values[6], 1.0f);
+	}
+
+	void testPutValues()
+	{
+		using namespace lmms;
+
+		// a ramp up and down, with a step that must not be thinned out
+		auto values = std::vector<std::pair<TimePos, float>>{};
+		for (int tick = 0; tick <= 100; ++tick) { values.emplace_back(tick, tick / 100.f); }
+		for (int tick = 101; tick <= 200; ++tick) { values.emplace_back(tick, (200 - tick) / 100.f); }
+		values.emplace_back(201, 0.5f);
+
+		AutomationClip c(nullptr);
+		c.setProgressionType(AutomationClip::ProgressionType::Linear);
+		c.putValues(values);
+
+		QCOMPARE(c.getTimeMap().size(), 4);
+		QCOMPARE(c.getTimeMap().firstKey(), TimePos(0));
+		QCOMPARE(c.valueAt(50), 0.5f);
+		QCOMPARE(c.valueAt(100), 1.0f);
+		QCOMPARE(c.valueAt(150), 0.5f);
+		QCOMPARE(c.valueAt(200), 0.0f);
+		QCOMPARE(c.valueAt(201), 0.5f);
+
+		// held values only need a node where they change
+		AutomationClip d(nullptr);
+		d.setProgressionType(AutomationClip::ProgressionType::Discrete);
+		d.putValues(std::vector<std::pair<TimePos, float>>{{0, 0.f}, {10, 0.f}, {20, 1.f}, {30, 1.f}, {40, 1.f}});
+
+		QCOMPARE(d.getTimeMap().size(), 3);
+		QCOMPARE(d.valueAt(15), 0.0f);
+		QCOMPARE(d.valueAt(25), 1.0f);
+
+		// jitter within the tolerance is dropped, a spike above it is kept
+		auto jittery = std::vector<std::pair<TimePos, float>>{};
+		for (int tick = 0; tick <= 1000; ++tick) { jittery.emplace_back(tick, tick / 1000.f + (tick % 2) * 0.005f); }
+		jittery[500].second += 0.1f;
+
+		AutomationClip e(nullptr);
+		e.setProgressionType(AutomationClip::ProgressionType::Linear);
+		e.putValues(jittery, 0.01f);
+
+		QVERIFY(e.getTimeMap().size() <= 5);
+		QVERIFY(e.getTimeMap().contains(500));
+		QVERIFY(std::abs(e.valueAt(250) - 0.25f) <= 0.01f);
+	}
+
 	void testClips()
 	{
 		using namespace lmms;
@@ -0,0 +1,107 @@
+/*
+ * MidiClipTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <algorithm>
+
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "MidiClip.h"
+#include "Song.h"
+
+class MidiClipTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase()
+	{
+		using namespace lmms;
+		Engine::init(true);
+	}
+
+	void cleanupTestCase()
+	{
+		using namespace lmms;
+		Engine::destroy();
+	}
+
+	void NoteBatchTest()
+	{
+		using namespace lmms;
+
+		InstrumentTrack instrumentTrack(Engine::getSong());
+		MidiClip batched(&instrumentTrack);
+		MidiClip single(&instrumentTrack);
+
+		// unsorted, with duplicate positions
+		std::vector<Note> notes;
+		for (int i = 0; i < 1000; ++i)
+		{
+			notes.emplace_back(TimePos(12), TimePos((i * 7919) % 500 * 12), 40 + i % 3);
+		}
+
+		QSignalSpy changed(&batched, &MidiClip::dataChanged);
+		{
+			MidiClip::NoteBatch batch(&batched, false);
+			for (const auto& note : notes) { batch.addNote(note, false); }
+			QVERIFY(batched.notes().empty());
+		}
+		QCOMPARE(changed.count(), 1);
+
+		for (const auto& note : notes) { single.addNote(note, false); }
+
+		QCOMPARE(batched.notes().size(), single.notes().size());
+		for (std::size_t i = 0; i < batched.notes().size(); ++i)
+		{
+			QCOMPARE(batched.notes()[i]->pos().getTicks(), single.notes()[i]->pos().getTicks());
+			QCOMPARE(batched.notes()[i]->key(), single.notes()[i]->key());
+		}
+		QCOMPARE(batched.length().getTicks(), single.length().getTicks());
+
+		// remove every other note and move the first one to the end
+		Note* first = batched.notes().front();
+		Note* last = batched.notes().back();
+		const auto toRemove = [&] {
+			NoteVector result;
+			for (std::size_t i = 1; i < batched.notes().size(); i += 2) { result.push_back(batched.notes()[i]); }
+			return result;
+		}();
+		{
+			MidiClip::NoteBatch batch(&batched, false);
+			for (Note* note : toRemove) { batch.removeNote(note); }
+			batch.moveNote(first, last->pos() + 12, 60);
+			Note* added = batch.addNote(Note(TimePos(12), TimePos(0), 10), false);
+			batch.removeNote(added);
+		}
+		QCOMPARE(changed.count(), 2);
+
+		const auto& result = batched.notes();
+		QCOMPARE(result.size(), notes.size() / 2);
+		QVERIFY(std::is_sorted(result.begin(), result.end(), Note::lessThan));
+		QCOMPARE(result.back(), first);
+		QCOMPARE(first->key(), 60);
+	}
+};
+
+QTEST_GUILESS_MAIN(MidiClipTest)
+#include "MidiClipTest.moc"